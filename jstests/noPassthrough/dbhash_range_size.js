@@ -0,0 +1,122 @@
+// Tests the 'rangeSize' option of dbHash, which also reports a hash for each consecutive range of
+// at most 'rangeSize' documents in _id order.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("test");
+    const coll = testDB.dbhash_range_size;
+
+    assert.commandFailedWithCode(testDB.runCommand({dbHash: 1, rangeSize: "a"}),
+                                 ErrorCodes.TypeMismatch);
+    assert.commandFailedWithCode(testDB.runCommand({dbHash: 1, rangeSize: 0}),
+                                 ErrorCodes.BadValue);
+
+    function getRanges(rangeSize) {
+        const res = assert.commandWorked(
+            testDB.runCommand({dbHash: 1, collections: [coll.getName()], rangeSize: rangeSize}));
+        assert(res.ranges.hasOwnProperty(coll.getName()), tojson(res));
+        return {
+            collectionHash: res.collections[coll.getName()],
+            ranges: res.ranges[coll.getName()]
+        };
+    }
+
+    function keysEqual(a, b) {
+        return bsonWoCompare({k: a}, {k: b}) === 0;
+    }
+
+    // Checks that 'ranges' cover the whole _id space in consecutive ranges of 'rangeSize'
+    // documents, and that each range hashes exactly the documents it holds: copying them to a
+    // collection of their own and hashing it yields the hash of the range.
+    function checkRanges(rangeSize) {
+        const res = getRanges(rangeSize);
+        const ranges = res.ranges;
+        const nDocs = coll.find().itcount();
+        assert.eq(Math.max(1, Math.ceil(nDocs / rangeSize)), ranges.length, tojson(ranges));
+
+        let seen = 0;
+        ranges.forEach((range, i) => {
+            assert(keysEqual(i === 0 ? MinKey : ranges[i - 1].maxKey, range.minKey),
+                   tojson(ranges));
+            if (i === ranges.length - 1) {
+                assert(keysEqual(MaxKey, range.maxKey), tojson(ranges));
+                assert.eq(nDocs - seen, range.count, tojson(ranges));
+            } else {
+                assert.eq(rangeSize, range.count, tojson(ranges));
+            }
+
+            // $sort and $out keep the documents byte for byte, whatever the types of their _ids.
+            const rangeColl = testDB.getCollection(coll.getName() + "_range");
+            if (range.count > 0) {
+                coll.aggregate([
+                    {$sort: {_id: 1}},
+                    {$skip: seen},
+                    {$limit: range.count},
+                    {$out: rangeColl.getName()}
+                ]);
+            } else {
+                assert.commandWorked(testDB.createCollection(rangeColl.getName()));
+            }
+            const rangeDocs = rangeColl.find().sort({_id: 1}).toArray();
+            if (i < ranges.length - 1) {
+                assert(keysEqual(rangeDocs[rangeDocs.length - 1]._id, range.maxKey),
+                       tojson(ranges));
+            }
+
+            const rangeRes = assert.commandWorked(
+                testDB.runCommand({dbHash: 1, collections: [rangeColl.getName()]}));
+            assert.eq(rangeRes.collections[rangeColl.getName()], range.md5, tojson(range));
+            assert(rangeColl.drop());
+
+            seen += range.count;
+        });
+        assert.eq(nDocs, seen);
+
+        // A single range holding every document hashes the same as the whole collection.
+        const whole = getRanges(nDocs + 1);
+        assert.eq(1, whole.ranges.length, tojson(whole.ranges));
+        assert.eq(res.collectionHash, whole.ranges[0].md5);
+    }
+
+    // An empty collection is a single empty range.
+    assert.commandWorked(testDB.createCollection(coll.getName()));
+    checkRanges(5);
+
+    // _ids of every type, so that ranges start and end on keys of different types.
+    const ids = [
+        null,
+        NumberInt(-3),
+        -2.5,
+        NumberLong(7),
+        NumberDecimal("8.5"),
+        "",
+        "a",
+        "b",
+        {x: 1},
+        {x: "y"},
+        BinData(0, "AAAA"),
+        ObjectId(),
+        ObjectId(),
+        false,
+        true,
+        ISODate("2018-01-01T00:00:00Z"),
+        Timestamp(1, 1),
+    ];
+    for (let i = 0; i < 20; ++i) {
+        ids.push(i + 100);
+        ids.push("s" + i);
+    }
+    assert.commandWorked(
+        coll.insert(ids.map((id, i) => ({_id: id, i: i, payload: "x".repeat(i)}))));
+    assert.eq(ids.length, coll.find().itcount());
+
+    // A number of documents that is a multiple of the range size, and one that is not.
+    assert.eq(0, ids.length % 19);
+    checkRanges(19);
+    checkRanges(5);
+    checkRanges(1);
+
+    MongoRunner.stopMongod(conn);
+})();
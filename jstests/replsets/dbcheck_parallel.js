@@ -0,0 +1,109 @@
+/**
+ * Tests the 'parallelism' option of dbCheck, which checks a collection as several concurrently
+ * hashed _id ranges, and the throttling of dbCheck batches on replication lag.
+ */
+(function() {
+    "use strict";
+
+    const replSet =
+        new ReplSetTest({name: "dbCheckParallel", nodes: [{}, {rsConfig: {priority: 0}}]});
+    replSet.startSet();
+    replSet.initiate();
+    replSet.awaitSecondaryNodes();
+
+    const primary = replSet.getPrimary();
+    const secondary = replSet.getSecondary();
+    const db = primary.getDB("test");
+    const coll = db.dbcheck_parallel;
+    assert.commandWorked(coll.insert([...Array(10000).keys()].map(x => ({_id: x}))));
+    replSet.awaitReplication();
+
+    function clearLog() {
+        [primary, secondary].forEach(conn => conn.getDB("local").system.healthlog.drop());
+    }
+
+    function healthLog(conn) {
+        return conn.getDB("local").system.healthlog;
+    }
+
+    function awaitSummary() {
+        let summary;
+        assert.soon(() => {
+            summary = healthLog(primary).findOne(
+                {operation: "dbCheckSummary", namespace: coll.getFullName()});
+            return summary !== null;
+        }, "dbCheck wrote no summary to the health log");
+        return summary;
+    }
+
+    // Checks that the summary accounts for every document, over complete ranges that follow each
+    // other from MinKey to MaxKey, and that the secondary found every batch consistent.
+    function checkSummary(summary) {
+        assert.eq(summary.severity, "info", tojson(summary));
+        assert(summary.data.success, tojson(summary));
+
+        const ranges = summary.data.ranges;
+        assert.gte(ranges.length, 1, tojson(summary));
+        ranges.forEach((range, i) => {
+            assert(range.complete, tojson(summary));
+            assert.gt(range.batches, 0, tojson(summary));
+            assert.eq(i === 0 ? MinKey : ranges[i - 1].maxKey, range.minKey, tojson(summary));
+        });
+        assert.eq(MaxKey, ranges[ranges.length - 1].maxKey, tojson(summary));
+        assert.eq(coll.count(), ranges.reduce((total, range) => total + range.count, 0));
+
+        replSet.awaitReplication();
+        assert.soon(() => healthLog(secondary).find({operation: "dbCheckBatch"}).itcount() >=
+                        ranges.reduce((total, range) => total + range.batches, 0),
+                    "the secondary did not check every batch");
+        assert.eq(0,
+                  healthLog(secondary).find({severity: {$ne: "info"}}).itcount(),
+                  tojson(healthLog(secondary).find({severity: {$ne: "info"}}).toArray()));
+    }
+
+    assert.commandFailedWithCode(db.runCommand({dbCheck: coll.getName(), parallelism: 0}),
+                                 ErrorCodes.BadValue);
+    assert.commandFailedWithCode(db.runCommand({dbCheck: coll.getName(), parallelism: 65}),
+                                 ErrorCodes.BadValue);
+
+    // The collection is split into several ranges, given a storage engine that can sample
+    // documents to pick their bounds.
+    clearLog();
+    assert.commandWorked(db.runCommand({dbCheck: coll.getName(), parallelism: 4}));
+    let summary = awaitSummary();
+    checkSummary(summary);
+    if (db.serverStatus().storageEngine.name === "wiredTiger") {
+        assert.gt(summary.data.ranges.length, 1, tojson(summary));
+        assert.lte(summary.data.ranges.length, 4, tojson(summary));
+    }
+
+    // A document limit applies to the collection as a whole, so it is checked as a single range.
+    clearLog();
+    assert.commandWorked(db.runCommand({dbCheck: coll.getName(), parallelism: 4, maxCount: 20000}));
+    summary = awaitSummary();
+    checkSummary(summary);
+    assert.eq(1, summary.data.ranges.length, tojson(summary));
+
+    // While the secondary stops applying the oplog, the majority commit point falls behind and
+    // dbCheck holds back its batches.
+    clearLog();
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "alwaysOn"}));
+    sleep(2500);
+    assert.commandWorked(coll.insert({_id: "after the commit point"}));
+    assert.commandWorked(primary.adminCommand({setParameter: 1, dbCheckMaxReplicationLagSecs: 1}));
+
+    assert.commandWorked(db.runCommand({dbCheck: coll.getName()}));
+    sleep(3000);
+    assert.eq(0,
+              healthLog(primary).find({operation: "dbCheckBatch"}).itcount(),
+              tojson(healthLog(primary).find().toArray()));
+
+    // Once the secondary catches up, the check proceeds.
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "off"}));
+    checkSummary(awaitSummary());
+
+    assert.commandWorked(primary.adminCommand({setParameter: 1, dbCheckMaxReplicationLagSecs: 0}));
+    replSet.stopSet();
+})();
@@ -76,6 +76,14 @@
                   100);
     }
 
+    // The reads above were served from the last applied snapshot rather than waiting for the
+    // batch to finish.
+    let secondaryReadsMetrics = secondaryDB.serverStatus().metrics.repl.secondaryReads;
+    assert.gt(secondaryReadsMetrics.lastAppliedSnapshot, 0, tojson(secondaryReadsMetrics));
+    // The paused batch has been applying since before the reads, so the snapshot they see is
+    // reported as stale.
+    assert.gt(secondaryReadsMetrics.snapshotAgeMillis, 0, tojson(secondaryReadsMetrics));
+
     // Disable the failpoint and let the batch complete.
     secondaryReadsTest.resumeSecondaryBatchApplication();
 
@@ -89,5 +97,9 @@
         assert.eq(secondaryDB.getCollection(collName).find({x: 1}).readConcern(levels[i]).itcount(),
                   100);
     }
+
+    // Once the secondary has caught up and is not applying a batch, its snapshot is not stale.
+    assert.soon(() => secondaryDB.serverStatus().metrics.repl.secondaryReads.snapshotAgeMillis ==
+                    0);
     secondaryReadsTest.stop();
 })();
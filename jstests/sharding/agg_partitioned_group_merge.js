@@ -0,0 +1,91 @@
+// Tests that an aggregation whose merge begins with a $group returns the same results when the
+// partial groups are completed on several of the targeted shards as when they are completed in a
+// single place.
+(function() {
+    'use strict';
+
+    const st = new ShardingTest({shards: 3});
+
+    const mongosDB = st.s0.getDB("test");
+    const coll = mongosDB.agg_partitioned_group_merge;
+    coll.drop();
+
+    assert.commandWorked(st.s0.adminCommand({enableSharding: mongosDB.getName()}));
+    st.ensurePrimaryShard(mongosDB.getName(), st.shard0.shardName);
+    assert.commandWorked(st.s0.adminCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+
+    // Split the collection into three chunks, one per shard.
+    assert.commandWorked(st.s0.adminCommand({split: coll.getFullName(), middle: {_id: 400}}));
+    assert.commandWorked(st.s0.adminCommand({split: coll.getFullName(), middle: {_id: 800}}));
+    assert.commandWorked(st.s0.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 500}, to: st.shard1.shardName}));
+    assert.commandWorked(st.s0.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 900}, to: st.shard2.shardName}));
+
+    // Every group has documents on every shard.
+    const nDocs = 1200;
+    const nGroups = 50;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < nDocs; ++i) {
+        bulk.insert({_id: i, g: i % nGroups, h: i % 7, x: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    const pipelines = [
+        [{$group: {_id: "$g", count: {$sum: 1}, total: {$sum: "$x"}, avg: {$avg: "$x"}}}],
+        [{$group: {_id: {g: "$g", h: "$h"}, min: {$min: "$x"}, max: {$max: "$x"}}}],
+        [
+          {$match: {x: {$gte: 100}}},
+          {$group: {_id: "$g", xs: {$push: "$x"}}},
+          {$project: {n: {$size: "$xs"}}}
+        ],
+        [{$group: {_id: "$g", total: {$sum: "$x"}}}, {$sort: {total: -1}}, {$limit: 10}],
+    ];
+
+    function setMaxMergers(maxMergers) {
+        assert.commandWorked(st.s0.adminCommand(
+            {setParameter: 1, internalQueryMaxPartitionedGroupMergers: maxMergers}));
+    }
+
+    function runPipeline(pipeline, comment) {
+        // Use a small batch size so that the merging cursors are iterated through getMores.
+        return coll.aggregate(pipeline, {comment: comment, cursor: {batchSize: 5}}).toArray();
+    }
+
+    function sortById(results) {
+        return results.sort((a, b) => bsonWoCompare({_id: a._id}, {_id: b._id}));
+    }
+
+    // Profile the shards so that we can tell which of them merged a partition.
+    for (let shardDB of [st.shard0, st.shard1, st.shard2].map(shard => shard.getDB("test"))) {
+        assert.commandWorked(shardDB.setProfilingLevel(2));
+    }
+
+    pipelines.forEach((pipeline, i) => {
+        setMaxMergers(0);
+        const expected = runPipeline(pipeline, "unpartitioned_" + i);
+
+        setMaxMergers(3);
+        const comment = "partitioned_" + i;
+        const actual = runPipeline(pipeline, comment);
+
+        const hasSort = pipeline.some(stage => stage.hasOwnProperty("$sort"));
+        assert.eq(hasSort ? actual : sortById(actual),
+                  hasSort ? expected : sortById(expected),
+                  tojson(pipeline));
+
+        // More than one shard completed a partition of the groups.
+        const nMergingShards =
+            [st.shard0, st.shard1, st.shard2]
+                .filter(shard => shard.getDB("test").system.profile.findOne({
+                    "command.aggregate": coll.getName(),
+                    "command.comment": comment,
+                    "command.pipeline.0.$mergeCursors": {$exists: true}
+                }) !== null)
+                .length;
+        assert.gt(nMergingShards, 1, tojson(pipeline));
+    });
+
+    setMaxMergers(0);
+    st.stop();
+})();
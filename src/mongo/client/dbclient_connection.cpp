@@ -327,6 +327,9 @@ Status DBClientConnection::connectSocketOnly(const HostAndPort& serverAddress) {
     }
 
     _session = std::move(sws.getValue());
+    // Nothing is negotiated on a new connection yet, including the state of any compressed stream
+    // on the old one, so start over uncompressed.
+    _compressorManager = MessageCompressorManager();
     _sessionCreationMicros = curTimeMicros64();
     _lastConnectivityCheck = Date_t::now();
     _session->setTimeout(_socketTimeout);
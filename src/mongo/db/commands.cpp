@@ -636,6 +636,7 @@ BSONObjBuilder CommandReplyBuilder::getBodyBuilder() const {
 
 void CommandReplyBuilder::reset() {
     getBodyBuilder().resetToEmpty();
+    OpMsgBuilder::discardSplicedBuffers(*_bodyBuf);
 }
 
 //////////////////////////////////////////////////////////////
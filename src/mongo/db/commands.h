@@ -283,6 +283,14 @@ public:
         return 0u;
     }
 
+    /**
+     * Like reserveBytesForReply(), but for an OP_MSG reply, into which large cursor batches are
+     * spliced rather than copied.
+     */
+    virtual std::size_t reserveBytesForSplicedReply() const {
+        return reserveBytesForReply();
+    }
+
     /**
      * Return true for "user management commands", a distinction that affects
      * backward compatible output formatting.
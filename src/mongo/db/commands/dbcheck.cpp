@@ -44,7 +44,11 @@
 #include "mongo/db/repl/dbcheck.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/optime.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 #include "mongo/util/log.h"
 
@@ -54,6 +58,38 @@ namespace {
 constexpr uint64_t kBatchDocs = 5'000;
 constexpr uint64_t kBatchBytes = 20'000'000;
 
+// Upper bound on the 'parallelism' option.
+constexpr int64_t kMaxParallelism = 64;
+
+// Number of random documents sampled per concurrently checked range to pick its _id bounds.
+constexpr int64_t kSamplesPerRange = 10;
+
+// Longest dbCheck holds back a batch for replication lag or cache pressure before failing the
+// check of its range.
+constexpr Seconds kMaxThrottleWait{60};
+
+// dbCheck holds back its next batch while the majority commit point trails this node's last
+// applied optime by more than this many seconds. 0 disables lag-based throttling.
+MONGO_EXPORT_SERVER_PARAMETER(dbCheckMaxReplicationLagSecs, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "dbCheckMaxReplicationLagSecs must be greater than or equal to 0");
+        }
+        return Status::OK();
+    });
+
+// dbCheck holds back its next batch while modified data that has not been written out yet takes up
+// more than this percentage of the storage engine's cache. 0 disables cache-based throttling.
+MONGO_EXPORT_SERVER_PARAMETER(dbCheckMaxDirtyCachePercent, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0 || newVal > 100) {
+            return Status(ErrorCodes::BadValue,
+                          "dbCheckMaxDirtyCachePercent must be between 0 and 100");
+        }
+        return Status::OK();
+    });
+
 
 /**
  * All the information needed to run dbCheck on a single collection.
@@ -65,6 +101,7 @@ struct DbCheckCollectionInfo {
     int64_t maxCount;
     int64_t maxSize;
     int64_t maxRate;
+    int64_t parallelism;
 };
 
 /**
@@ -97,6 +134,12 @@ bool canRunDbCheckOn(const NamespaceString& nss) {
     return true;
 }
 
+void validateParallelism(int64_t parallelism) {
+    uassert(ErrorCodes::BadValue,
+            str::stream() << "parallelism must be between 1 and " << kMaxParallelism,
+            parallelism >= 1 && parallelism <= kMaxParallelism);
+}
+
 std::unique_ptr<DbCheckRun> singleCollectionRun(OperationContext* opCtx,
                                                 const std::string& dbName,
                                                 const DbCheckSingleInvocation& invocation) {
@@ -116,7 +159,9 @@ std::unique_ptr<DbCheckRun> singleCollectionRun(OperationContext* opCtx,
     auto maxCount = invocation.getMaxCount();
     auto maxSize = invocation.getMaxSize();
     auto maxRate = invocation.getMaxCountPerSecond();
-    auto info = DbCheckCollectionInfo{nss, start, end, maxCount, maxSize, maxRate};
+    auto parallelism = invocation.getParallelism();
+    validateParallelism(parallelism);
+    auto info = DbCheckCollectionInfo{nss, start, end, maxCount, maxSize, maxRate, parallelism};
     auto result = stdx::make_unique<DbCheckRun>();
     result->push_back(info);
     return result;
@@ -137,9 +182,12 @@ std::unique_ptr<DbCheckRun> fullDatabaseRun(OperationContext* opCtx,
 
     int64_t max = std::numeric_limits<int64_t>::max();
     auto rate = invocation.getMaxCountPerSecond();
+    auto parallelism = invocation.getParallelism();
+    validateParallelism(parallelism);
 
     for (Collection* coll : *db) {
-        DbCheckCollectionInfo info{coll->ns(), BSONKey::min(), BSONKey::max(), max, max, rate};
+        DbCheckCollectionInfo info{
+            coll->ns(), BSONKey::min(), BSONKey::max(), max, max, rate, parallelism};
         result->push_back(info);
     }
 
@@ -182,7 +230,7 @@ std::unique_ptr<DbCheckRun> getRun(OperationContext* opCtx,
 class DbCheckJob : public BackgroundJob {
 public:
     DbCheckJob(const StringData& dbName, std::unique_ptr<DbCheckRun> run)
-        : BackgroundJob(true), _done(false), _dbName(dbName.toString()), _run(std::move(run)) {}
+        : BackgroundJob(true), _dbName(dbName.toString()), _run(std::move(run)) {}
 
 protected:
     virtual std::string name() const override {
@@ -204,7 +252,7 @@ protected:
                 return;
             }
 
-            if (_done) {
+            if (_done.load()) {
                 log() << "dbCheck terminated due to stepdown";
                 return;
             }
@@ -218,12 +266,121 @@ private:
             return;
         }
 
-        if (_done) {
+        if (_done.load()) {
             return;
         }
 
+        auto bounds = _splitRange(info);
+        // A range that fails or stops early keeps the progress it made and is reported incomplete.
+        std::vector<DbCheckRangeSummary> summaries(bounds.size() - 1);
+        for (std::size_t i = 0; i < summaries.size(); ++i) {
+            summaries[i].minKey = bounds[i];
+            summaries[i].maxKey = bounds[i];
+        }
+        if (summaries.size() == 1) {
+            _doRange(info, bounds[0], bounds[1], info.maxRate, &summaries[0]);
+        } else {
+            // Each range gets an equal share of the collection's rate limit.
+            const int64_t rangeRate =
+                std::max<int64_t>(1, info.maxRate / static_cast<int64_t>(summaries.size()));
+
+            ThreadPool::Options options;
+            options.poolName = "dbCheck";
+            options.minThreads = 0;
+            options.maxThreads = summaries.size();
+            options.onCreateThread = [](const std::string& threadName) {
+                Client::initThread(threadName);
+            };
+            ThreadPool pool(options);
+            pool.startup();
+            for (std::size_t i = 0; i < summaries.size(); ++i) {
+                fassert(50951, pool.schedule([&, i] {
+                    try {
+                        _doRange(info, bounds[i], bounds[i + 1], rangeRate, &summaries[i]);
+                    } catch (const DBException& e) {
+                        auto logEntry = dbCheckErrorHealthLogEntry(
+                            info.nss, "dbCheck failed", OplogEntriesEnum::Batch, e.toStatus());
+                        HealthLog::get(Client::getCurrent()->getServiceContext()).log(*logEntry);
+                    }
+                }));
+            }
+            pool.waitForIdle();
+            pool.shutdown();
+            pool.join();
+        }
+
+        if (_done.load()) {
+            return;
+        }
+
+        auto entry = dbCheckSummaryEntry(info.nss, summaries);
+        HealthLog::get(Client::getCurrent()->getServiceContext()).log(*entry);
+    }
+
+    /**
+     * Splits (info.start, info.end] into up to info.parallelism ranges to be checked concurrently,
+     * returning their bounds in order, including info.start and info.end. The split keys are
+     * quantiles of a random sample of _ids. A single range is returned when parallelism is 1, when
+     * a document or size limit is set (so that it keeps applying to the collection as a whole), or
+     * when the storage engine cannot sample documents.
+     */
+    std::vector<BSONKey> _splitRange(const DbCheckCollectionInfo& info) {
+        std::vector<BSONKey> bounds{info.start};
+
+        const int64_t unlimited = std::numeric_limits<int64_t>::max();
+        if (info.parallelism > 1 && info.maxCount == unlimited && info.maxSize == unlimited) {
+            auto uniqueOpCtx = Client::getCurrent()->makeOperationContext();
+            auto opCtx = uniqueOpCtx.get();
+            AutoGetCollectionForRead agc(opCtx, info.nss);
+
+            auto collection = agc.getCollection();
+            auto cursor =
+                collection ? collection->getRecordStore()->getRandomCursor(opCtx) : nullptr;
+
+            std::vector<BSONKey> samples;
+            for (int64_t i = 0; cursor && i < info.parallelism * kSamplesPerRange; ++i) {
+                auto record = cursor->next();
+                if (!record) {
+                    break;
+                }
+                auto id = record->data.toBson()["_id"];
+                if (id.eoo()) {
+                    continue;
+                }
+                auto key = BSONKey::parseFromBSON(id);
+                if (info.start < key && key < info.end) {
+                    samples.push_back(std::move(key));
+                }
+            }
+
+            std::sort(samples.begin(), samples.end());
+            for (int64_t i = 1; !samples.empty() && i < info.parallelism; ++i) {
+                const auto& key = samples[i * samples.size() / info.parallelism];
+                if (bounds.back() < key) {
+                    bounds.push_back(key);
+                }
+            }
+        }
+
+        bounds.push_back(info.end);
+        return bounds;
+    }
+
+    /**
+     * Checks the documents in (first, last] in batches, logging each batch to the oplog and the
+     * health log, without exceeding 'maxRate' documents per second. Records its progress in
+     * 'summary' after every batch, and marks it complete once the check reaches 'last'.
+     */
+    void _doRange(const DbCheckCollectionInfo& info,
+                  const BSONKey& first,
+                  const BSONKey& last,
+                  int64_t maxRate,
+                  DbCheckRangeSummary* summary) {
+        md5_state_t rangeState;
+        md5_init(&rangeState);
+
         // Parameters for the hasher.
-        auto start = info.start;
+        auto start = first;
         bool reachedEnd = false;
 
         // Make sure the totals over all of our batches don't exceed the provided limits.
@@ -244,10 +401,13 @@ private:
                 docsInCurrentInterval = 0;
             }
 
-            auto result = _runBatch(info, start, kBatchDocs, kBatchBytes);
+            auto throttleStatus = _throttleForNodePressure();
+            auto result = throttleStatus.isOK()
+                ? _runBatch(info, start, last, kBatchDocs, kBatchBytes)
+                : StatusWith<BatchStats>(throttleStatus);
 
-            if (_done) {
-                return;
+            if (_done.load()) {
+                break;
             }
 
             std::unique_ptr<HealthLogEntry> entry;
@@ -256,7 +416,7 @@ private:
                 entry = dbCheckErrorHealthLogEntry(
                     info.nss, "dbCheck batch failed", OplogEntriesEnum::Batch, result.getStatus());
                 HealthLog::get(Client::getCurrent()->getServiceContext()).log(*entry);
-                return;
+                break;
             } else {
                 auto stats = result.getValue();
                 entry = dbCheckBatchEntry(info.nss,
@@ -279,20 +439,86 @@ private:
             totalBytesSeen += stats.nBytes;
             docsInCurrentInterval += stats.nDocs;
 
+            summary->maxKey = stats.lastKey;
+            summary->nDocs += stats.nDocs;
+            summary->nBytes += stats.nBytes;
+            summary->nBatches += 1;
+            md5_append(&rangeState,
+                       reinterpret_cast<const md5_byte_t*>(stats.md5.data()),
+                       stats.md5.size());
+
             // Check if we've exceeded any limits.
-            bool reachedLast = stats.lastKey >= info.end;
+            bool reachedLast = stats.lastKey >= last;
+            summary->complete = reachedLast;
             bool tooManyDocs = totalDocsSeen >= info.maxCount;
             bool tooManyBytes = totalBytesSeen >= info.maxSize;
             reachedEnd = reachedLast || tooManyDocs || tooManyBytes;
 
-            if (docsInCurrentInterval > info.maxRate && info.maxRate > 0) {
+            if (docsInCurrentInterval > maxRate && maxRate > 0) {
                 // If an extremely low max rate has been set (substantially smaller than the batch
                 // size) we might want to sleep for multiple seconds between batches.
-                int64_t timesExceeded = docsInCurrentInterval / info.maxRate;
+                int64_t timesExceeded = docsInCurrentInterval / maxRate;
 
                 stdx::this_thread::sleep_for(timesExceeded * 1s - (Clock::now() - lastStart));
             }
         } while (!reachedEnd);
+
+        md5digest digest;
+        md5_finish(&rangeState, digest);
+        summary->md5 = digestToString(digest);
+    }
+
+    /**
+     * Holds back the next batch while the majority commit point trails this node by more than
+     * dbCheckMaxReplicationLagSecs, so that the check does not add to the load on lagging
+     * secondaries, which hash every batch too, or while the storage engine's cache is more than
+     * dbCheckMaxDirtyCachePercent dirty. Backs off exponentially up to a second at a time.
+     * Returns ExceededTimeLimit if the pressure has not eased within kMaxThrottleWait, e.g.
+     * because a majority of the set is down.
+     */
+    Status _throttleForNodePressure() {
+        const int maxLagSecs = dbCheckMaxReplicationLagSecs.load();
+        const int maxDirtyPercent = dbCheckMaxDirtyCachePercent.load();
+        if (maxLagSecs == 0 && maxDirtyPercent == 0) {
+            return Status::OK();
+        }
+
+        auto serviceContext = Client::getCurrent()->getServiceContext();
+        auto coord = repl::ReplicationCoordinator::get(serviceContext);
+        auto storageEngine = serviceContext->getStorageEngine();
+        const auto deadline = Date_t::now() + kMaxThrottleWait;
+        Milliseconds backoff{10};
+        while (!_done.load() && coord->getMemberState().primary()) {
+            std::string pressure;
+            if (maxLagSecs > 0) {
+                const auto applied = coord->getMyLastAppliedOpTime().getTimestamp();
+                const auto committed = coord->getLastCommittedOpTime().getTimestamp();
+                if (applied.getSecs() > committed.getSecs() + maxLagSecs) {
+                    pressure = str::stream() << "Replication lag stayed above " << maxLagSecs
+                                             << " seconds";
+                }
+            }
+            if (pressure.empty() && maxDirtyPercent > 0) {
+                const auto dirtyFraction = storageEngine->getCacheDirtyFraction();
+                if (dirtyFraction && *dirtyFraction * 100 > maxDirtyPercent) {
+                    pressure = str::stream() << "Dirty data stayed above " << maxDirtyPercent
+                                             << "% of the storage engine cache";
+                }
+            }
+            if (pressure.empty()) {
+                return Status::OK();
+            }
+            if (Date_t::now() >= deadline) {
+                return {ErrorCodes::ExceededTimeLimit,
+                        str::stream() << pressure << " for "
+                                      << durationCount<Seconds>(kMaxThrottleWait)
+                                      << " seconds"};
+            }
+
+            sleepFor(backoff);
+            backoff = std::min(backoff * 2, Milliseconds{1000});
+        }
+        return Status::OK();
     }
 
     /**
@@ -307,7 +533,7 @@ private:
     };
 
     // Set if the job cannot proceed.
-    bool _done;
+    AtomicBool _done{false};
     std::string _dbName;
     std::unique_ptr<DbCheckRun> _run;
 
@@ -320,7 +546,7 @@ private:
         AutoGetDbForDbCheck agd(opCtx, info.nss);
 
         if (_stepdownHasOccurred(opCtx, info.nss)) {
-            _done = true;
+            _done.store(true);
             return true;
         }
 
@@ -379,6 +605,7 @@ private:
 
     StatusWith<BatchStats> _runBatch(const DbCheckCollectionInfo& info,
                                      const BSONKey& first,
+                                     const BSONKey& last,
                                      int64_t batchDocs,
                                      int64_t batchBytes) {
         // New OperationContext for each batch.
@@ -390,7 +617,7 @@ private:
         AutoGetCollectionForDbCheck agc(opCtx, info.nss, OplogEntriesEnum::Batch);
 
         if (_stepdownHasOccurred(opCtx, info.nss)) {
-            _done = true;
+            _done.store(true);
             return Status(ErrorCodes::PrimarySteppedDown, "dbCheck terminated due to stepdown");
         }
 
@@ -405,7 +632,7 @@ private:
             hasher.emplace(opCtx,
                            collection,
                            first,
-                           info.end,
+                           last,
                            std::min(batchDocs, info.maxCount),
                            std::min(batchBytes, info.maxSize));
         } catch (const DBException& e) {
@@ -512,7 +739,8 @@ public:
                "              maxKey: <last key, inclusive>,\n"
                "              maxCount: <max number of docs>,\n"
                "              maxSize: <max size of docs>,\n"
-               "              maxCountPerSecond: <max rate in docs/sec> } "
+               "              maxCountPerSecond: <max rate in docs/sec>,\n"
+               "              parallelism: <number of _id ranges to check concurrently> } "
                "to check a collection.\n"
                "Invoke with {dbCheck: 1} to check all collections in the database.";
     }
@@ -45,6 +45,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/repl/dbcheck.h"
 #include "mongo/db/session_catalog.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
@@ -107,6 +108,18 @@ public:
             }
         }
 
+        // When 'rangeSize' is given, each collection is additionally split into consecutive _id
+        // ranges of at most that many documents and a hash is reported for every range, so that
+        // two members whose collection hashes differ can narrow down where.
+        long long rangeSize = 0;
+        if (auto rangeSizeElem = cmdObj["rangeSize"]) {
+            uassert(ErrorCodes::TypeMismatch,
+                    "rangeSize must be a number",
+                    rangeSizeElem.isNumber());
+            rangeSize = rangeSizeElem.safeNumberLong();
+            uassert(ErrorCodes::BadValue, "rangeSize must be positive", rangeSize > 0);
+        }
+
         const std::string ns = parseNs(dbname, cmdObj);
         uassert(ErrorCodes::InvalidNamespace,
                 str::stream() << "Invalid db name: " << ns,
@@ -145,6 +158,7 @@ public:
 
         BSONArrayBuilder cappedCollections;
         BSONObjBuilder collectionsByUUID;
+        BSONObjBuilder rangesByCollection;
 
         BSONObjBuilder bb(result.subobjStart("collections"));
         for (const auto& collectionName : colls) {
@@ -190,11 +204,18 @@ public:
 
             bb.append(collNss.coll(), hash);
             md5_append(&globalState, (const md5_byte_t*)hash.c_str(), hash.size());
+
+            if (rangeSize > 0) {
+                _hashCollectionRanges(opCtx, db, collNss, rangeSize, &rangesByCollection);
+            }
         }
         bb.done();
 
         result.append("capped", BSONArray(cappedCollections.done()));
         result.append("uuids", collectionsByUUID.done());
+        if (rangeSize > 0) {
+            result.append("ranges", rangesByCollection.done());
+        }
 
         md5digest d;
         md5_finish(&globalState, d);
@@ -289,6 +310,40 @@ private:
         return hash;
     }
 
+    /**
+     * Appends to 'builder' an array, named after the collection, of {minKey, maxKey, count, md5}
+     * documents covering the whole _id space of 'nss'. 'minKey' is exclusive and 'maxKey'
+     * inclusive; the first range starts at MinKey and the last one ends at MaxKey. Collections
+     * without an _id index are skipped.
+     */
+    void _hashCollectionRanges(OperationContext* opCtx,
+                               Database* db,
+                               const NamespaceString& nss,
+                               long long rangeSize,
+                               BSONObjBuilder* builder) {
+        Collection* collection = db->getCollection(opCtx, nss);
+        if (!collection || !collection->getIndexCatalog()->findIdIndex(opCtx))
+            return;
+
+        BSONArrayBuilder ranges(builder->subarrayStart(nss.coll()));
+        BSONKey start = BSONKey::min();
+        const BSONKey end = BSONKey::max();
+        do {
+            DbCheckHasher hasher(opCtx, collection, start, end, rangeSize);
+            uassertStatusOK(hasher.hashAll());
+
+            BSONObjBuilder range(ranges.subobjStart());
+            start.serializeToBSON("minKey", &range);
+            hasher.lastKey().serializeToBSON("maxKey", &range);
+            range.appendNumber("count", static_cast<long long>(hasher.docsSeen()));
+            range.append("md5", hasher.total());
+            range.done();
+
+            start = hasher.lastKey();
+        } while (start != end);
+        ranges.done();
+    }
+
 } dbhashCmd;
 
 }  // namespace
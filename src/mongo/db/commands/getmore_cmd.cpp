@@ -189,6 +189,11 @@ public:
         return FindCommon::kMaxBytesToReturnToClientAtOnce + 1024u;
     }
 
+    std::size_t reserveBytesForSplicedReply() const override {
+        // Only the start of the batch is built in the reply buffer. The rest is spliced in.
+        return CursorResponseBuilder::kMaxInPlaceBatchBytes + 1024u;
+    }
+
     /**
      * A getMore command increments the getMore counter, not the command counter.
      */
@@ -45,6 +45,8 @@
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/pipeline/exchange.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
@@ -304,6 +306,29 @@ std::unique_ptr<CollatorInterface> resolveCollator(OperationContext* opCtx,
                 ? collection->getDefaultCollator()->clone()
                 : nullptr);
 }
+
+/**
+ * Distributes the output of 'pipeline' between 'nConsumers' consumer pipelines by the hash of each
+ * document's '_id', and returns the consumer pipelines. Each of them is driven by getMores on a
+ * cursor of its own, so each gets an ExpressionContext and a MongoDInterface of its own.
+ */
+std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> createExchangePipelines(
+    OperationContext* opCtx,
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline,
+    size_t nConsumers) {
+    auto exchange = Exchange::create(std::move(pipeline), nConsumers);
+
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> pipelines;
+    for (size_t consumerId = 0; consumerId < nConsumers; ++consumerId) {
+        auto consumerExpCtx = expCtx->copyWith(expCtx->ns);
+        consumerExpCtx->mongoProcessInterface = std::make_shared<PipelineD::MongoDInterface>(opCtx);
+        pipelines.emplace_back(uassertStatusOK(Pipeline::create(
+            {DocumentSourceExchange::create(consumerExpCtx, exchange, consumerId)},
+            consumerExpCtx)));
+    }
+    return pipelines;
+}
 }  // namespace
 
 Status runAggregate(OperationContext* opCtx,
@@ -322,9 +347,8 @@ Status runAggregate(OperationContext* opCtx,
     // streams, this will be the UUID of the original namespace instead of the oplog namespace.
     boost::optional<UUID> uuid;
 
-    unique_ptr<PlanExecutor, PlanExecutor::Deleter> exec;
+    std::vector<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> execs;
     boost::intrusive_ptr<ExpressionContext> expCtx;
-    Pipeline* unownedPipeline;
     auto curOp = CurOp::get(opCtx);
     {
         const LiteParsedPipeline liteParsedPipeline(request);
@@ -498,22 +522,41 @@ Status runAggregate(OperationContext* opCtx,
         // this process uses the correct collation if it does any string comparisons.
         pipeline->optimizePipeline();
 
-        // Transfer ownership of the Pipeline to the PipelineProxyStage.
-        unownedPipeline = pipeline.get();
-        auto ws = make_unique<WorkingSet>();
-        auto proxy = make_unique<PipelineProxyStage>(opCtx, std::move(pipeline), ws.get());
+        // If mongos asked for the output of this pipeline to be hash-partitioned between several
+        // merging hosts, run it behind an Exchange which feeds one pipeline per partition.
+        std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> pipelines;
+        if (request.getExchangePartitions() > 0) {
+            uassert(50954,
+                    "Cannot partition the output of an explain or tailable aggregation",
+                    !expCtx->explain && expCtx->tailableMode == TailableModeEnum::kNormal);
+            uassert(50955,
+                    "The initial batch of a partitioned aggregation must be empty",
+                    request.getBatchSize() == 0);
+            pipelines = createExchangePipelines(
+                opCtx, expCtx, std::move(pipeline), request.getExchangePartitions());
+        } else {
+            pipelines.emplace_back(std::move(pipeline));
+        }
 
-        // This PlanExecutor will simply forward requests to the Pipeline, so does not need to
-        // yield or to be registered with any collection's CursorManager to receive invalidations.
-        // The Pipeline may contain PlanExecutors which *are* yielding PlanExecutors and which *are*
-        // registered with their respective collection's CursorManager
-        auto statusWithPlanExecutor =
-            PlanExecutor::make(opCtx, std::move(ws), std::move(proxy), nss, PlanExecutor::NO_YIELD);
-        invariant(statusWithPlanExecutor.isOK());
-        exec = std::move(statusWithPlanExecutor.getValue());
+        for (auto&& pipelineToExecute : pipelines) {
+            // Transfer ownership of the Pipeline to the PipelineProxyStage.
+            auto ws = make_unique<WorkingSet>();
+            auto proxy =
+                make_unique<PipelineProxyStage>(opCtx, std::move(pipelineToExecute), ws.get());
+
+            // This PlanExecutor will simply forward requests to the Pipeline, so does not need to
+            // yield or to be registered with any collection's CursorManager to receive
+            // invalidations. The Pipeline may contain PlanExecutors which *are* yielding
+            // PlanExecutors and which *are* registered with their respective collection's
+            // CursorManager
+            auto statusWithPlanExecutor = PlanExecutor::make(
+                opCtx, std::move(ws), std::move(proxy), nss, PlanExecutor::NO_YIELD);
+            invariant(statusWithPlanExecutor.isOK());
+            execs.emplace_back(std::move(statusWithPlanExecutor.getValue()));
+        }
 
         {
-            auto planSummary = Explain::getPlanSummary(exec.get());
+            auto planSummary = Explain::getPlanSummary(execs.front().get());
             stdx::lock_guard<Client> lk(*opCtx->getClient());
             curOp->setPlanSummary_inlock(std::move(planSummary));
         }
@@ -524,30 +567,49 @@ Status runAggregate(OperationContext* opCtx,
     // cursor manager. The global cursor manager does not deliver invalidations or kill
     // notifications; the underlying PlanExecutor(s) used by the pipeline will be receiving
     // invalidations and kill notifications themselves, not the cursor we create here.
-    ClientCursorParams cursorParams(
-        std::move(exec),
-        origNss,
-        AuthorizationSession::get(opCtx->getClient())->getAuthenticatedUserNames(),
-        repl::ReadConcernArgs::get(opCtx).getLevel(),
-        cmdObj);
-    if (expCtx->tailableMode == TailableModeEnum::kTailableAndAwaitData) {
-        cursorParams.setTailable(true);
-        cursorParams.setAwaitData(true);
-    }
-
-    auto pin =
-        CursorManager::getGlobalCursorManager()->registerCursor(opCtx, std::move(cursorParams));
+    std::vector<ClientCursorPin> pins;
+    ScopeGuard cursorFreer = MakeGuard([&pins] {
+        for (auto&& pin : pins) {
+            pin.deleteUnderlying();
+        }
+    });
+    for (auto&& exec : execs) {
+        ClientCursorParams cursorParams(
+            std::move(exec),
+            origNss,
+            AuthorizationSession::get(opCtx->getClient())->getAuthenticatedUserNames(),
+            repl::ReadConcernArgs::get(opCtx).getLevel(),
+            cmdObj);
+        if (expCtx->tailableMode == TailableModeEnum::kTailableAndAwaitData) {
+            cursorParams.setTailable(true);
+            cursorParams.setAwaitData(true);
+        }
 
-    ScopeGuard cursorFreer = MakeGuard(&ClientCursorPin::deleteUnderlying, &pin);
+        auto cursorManager = CursorManager::getGlobalCursorManager();
+        pins.emplace_back(cursorManager->registerCursor(opCtx, std::move(cursorParams)));
+    }
 
     // If both explain and cursor are specified, explain wins.
     if (expCtx->explain) {
         Explain::explainPipelineExecutor(
-            pin.getCursor()->getExecutor(), *(expCtx->explain), &result);
+            pins.front().getCursor()->getExecutor(), *(expCtx->explain), &result);
+    } else if (pins.size() > 1) {
+        // Each partition of an exchange is returned as a separate cursor response. Their initial
+        // batches are empty, so the cursors are always kept.
+        BSONArrayBuilder cursorsBuilder(result.subarrayStart("cursors"));
+        for (auto&& pin : pins) {
+            BSONObjBuilder cursorResult(cursorsBuilder.subobjStart());
+            const bool keepCursor =
+                handleCursorCommand(opCtx, origNss, pin.getCursor(), request, cursorResult);
+            invariant(keepCursor);
+            CommandHelpers::appendSimpleCommandStatus(cursorResult, true);
+        }
+        cursorsBuilder.doneFast();
+        cursorFreer.Dismiss();
     } else {
         // Cursor must be specified, if explain is not.
         const bool keepCursor =
-            handleCursorCommand(opCtx, origNss, pin.getCursor(), request, result);
+            handleCursorCommand(opCtx, origNss, pins.front().getCursor(), request, result);
         if (keepCursor) {
             cursorFreer.Dismiss();
         }
@@ -555,7 +617,7 @@ Status runAggregate(OperationContext* opCtx,
 
     if (!expCtx->explain) {
         PlanSummaryStats stats;
-        Explain::getSummaryStats(*(pin.getCursor()->getExecutor()), &stats);
+        Explain::getSummaryStats(*(pins.front().getCursor()->getExecutor()), &stats);
         curOp->debug().setPlanSummaryMetrics(stats);
         curOp->debug().nreturned = stats.nReturned;
     }
@@ -37,6 +37,7 @@
 #include "mongo/util/net/hostname_canonicalization.h"
 #include "mongo/util/net/socket_utils.h"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/shared_buffer_pool.h"
 
 namespace mongo {
 
@@ -82,6 +83,16 @@ public:
         BSONObjBuilder b;
         networkCounter.append(b);
         appendMessageCompressionStats(&b);
+
+        const auto bufferPoolStats = SharedBufferPool::getStats();
+        BSONObjBuilder bufferPoolSection(b.subobjStart("bufferPool"));
+        bufferPoolSection.append("hits", bufferPoolStats.hits);
+        bufferPoolSection.append("misses", bufferPoolStats.misses);
+        bufferPoolSection.append("recycled", bufferPoolStats.recycled);
+        bufferPoolSection.append("discarded", bufferPoolStats.discarded);
+        bufferPoolSection.append("cachedBytes", bufferPoolStats.cachedBytes);
+        bufferPoolSection.doneFast();
+
         auto executor = opCtx->getServiceContext()->getServiceExecutor();
         if (executor)
             executor->appendStats(&b);
@@ -461,6 +461,10 @@ void CurOp::reportState(BSONObjBuilder* builder, bool truncateOps) {
         builder->append("planSummary", _planSummary);
     }
 
+    if (!_remoteCursorStats.isEmpty()) {
+        builder->append("remoteCursors", _remoteCursorStats);
+    }
+
     if (!_message.empty()) {
         if (_progressMeter.isActive()) {
             StringBuilder buf;
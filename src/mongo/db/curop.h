@@ -554,6 +554,14 @@ public:
         _planSummary = std::move(summary);
     }
 
+    /**
+     * Sets the per-remote statistics reported by currentOp for an operation which merges results
+     * from remote cursors. Must be called while holding the Client lock.
+     */
+    void setRemoteCursorStats_inlock(BSONArray stats) {
+        _remoteCursorStats = std::move(stats);
+    }
+
 private:
     class CurOpStack;
 
@@ -596,6 +604,9 @@ private:
     int _numYields{0};
 
     std::string _planSummary;
+
+    // Statistics about the remote cursors whose results this operation is merging, if any.
+    BSONArray _remoteCursorStats;
 };
 
 /**
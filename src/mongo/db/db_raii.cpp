@@ -33,6 +33,7 @@
 #include "mongo/db/db_raii.h"
 
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/repl/replication_coordinator.h"
@@ -46,6 +47,17 @@ namespace {
 
 const boost::optional<int> kDoNotChangeProfilingLevel = boost::none;
 
+// Reads on secondaries served from the last applied batch's snapshot without the PBWM lock.
+Counter64 lastAppliedSnapshotReads;
+ServerStatusMetricField<Counter64> displayLastAppliedSnapshotReads(
+    "repl.secondaryReads.lastAppliedSnapshot", &lastAppliedSnapshotReads);
+
+// Reads that tried the last applied snapshot but had to retry under the PBWM lock because of
+// catalog changes newer than that snapshot.
+Counter64 pbwmRetryReads;
+ServerStatusMetricField<Counter64> displayPbwmRetryReads("repl.secondaryReads.pbwmRetries",
+                                                         &pbwmRetryReads);
+
 }  // namespace
 
 // If true, do not take the PBWM lock in AutoGetCollectionForRead on secondaries during batch
@@ -139,6 +151,9 @@ AutoGetCollectionForRead::AutoGetCollectionForRead(OperationContext* opCtx,
 
         auto minSnapshot = coll->getMinimumVisibleSnapshot();
         if (!_conflictingCatalogChanges(opCtx, minSnapshot, lastAppliedTimestamp)) {
+            if (readAtLastAppliedTimestamp) {
+                lastAppliedSnapshotReads.increment();
+            }
             return;
         }
 
@@ -163,6 +178,7 @@ AutoGetCollectionForRead::AutoGetCollectionForRead(OperationContext* opCtx,
                    << *minSnapshot << ". Trying again without reading at last-applied time.";
             _shouldNotConflictWithSecondaryBatchApplicationBlock = boost::none;
             opCtx->recoveryUnit()->setTimestampReadSource(RecoveryUnit::ReadSource::kUnset);
+            pbwmRetryReads.increment();
         }
 
         if (readSource == RecoveryUnit::ReadSource::kMajorityCommitted) {
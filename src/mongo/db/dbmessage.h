@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bson_validate.h"
 #include "mongo/client/constants.h"
@@ -446,6 +448,12 @@ Message makeGetMoreMessage(StringData ns, long long cursorId, int nToReturn, int
 struct DbResponse {
     Message response;       // If empty, nothing will be returned to the client.
     std::string exhaustNS;  // Namespace of cursor if exhaust mode, else "".
+
+    // For OP_MSG exhaust: if set, 'response' is sent with the moreToCome flag and
+    // 'nextInvocation' is then run on the client's behalf as if it had sent it, with
+    // OpMsg::kExhaustSupported set.
+    bool shouldRunAgainForExhaust = false;
+    boost::optional<BSONObj> nextInvocation;
 };
 
 /**
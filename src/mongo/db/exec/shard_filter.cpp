@@ -35,7 +35,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
-#include "mongo/s/shard_key_pattern.h"
+#include "mongo/db/query/index_bounds.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -46,6 +46,14 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+namespace {
+
+// Bounds the number of chunks coalesced into one ownership range on either side of a looked up
+// key, so that a lookup stays cheap when this shard owns a long run of adjacent chunks
+const size_t kMaxChunksPerOwnershipRange = 256;
+
+}  // namespace
+
 // static
 const char* ShardFilterStage::kStageType = "SHARDING_FILTER";
 
@@ -55,6 +63,11 @@ ShardFilterStage::ShardFilterStage(OperationContext* opCtx,
                                    PlanStage* child)
     : PlanStage(kStageType, opCtx), _ws(ws), _metadata(std::move(metadata)) {
     _children.emplace_back(child);
+
+    if (_metadata->isSharded()) {
+        _chunkManager = _metadata->getChunkManager();
+        _shardKeyPattern.emplace(_metadata->getKeyPattern());
+    }
 }
 
 ShardFilterStage::~ShardFilterStage() {}
@@ -75,11 +88,10 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
         // If we're sharded make sure that we don't return data that is not owned by us,
         // including pending documents from in-progress migrations and orphaned documents from
         // aborted migrations
-        if (_metadata->isSharded()) {
-            ShardKeyPattern shardKeyPattern(_metadata->getKeyPattern());
+        if (_metadata->isSharded() && !_skipFiltering) {
             WorkingSetMember* member = _ws->get(*out);
             WorkingSetMatchableDocument matchable(member);
-            BSONObj shardKey = shardKeyPattern.extractShardKeyFromMatchable(matchable);
+            BSONObj shardKey = _shardKeyPattern->extractShardKeyFromMatchable(matchable);
 
             if (shardKey.isEmpty()) {
                 // We can't find a shard key for this document - this should never happen with
@@ -105,7 +117,7 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
                           << "document may have been inserted manually into shard";
             }
 
-            if (!_metadata->keyBelongsToMe(shardKey)) {
+            if (!_keyBelongsToMe(shardKey)) {
                 _ws->free(*out);
                 ++_specificStats.chunkSkips;
                 return PlanStage::NEED_TIME;
@@ -120,6 +132,70 @@ PlanStage::StageState ShardFilterStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+bool ShardFilterStage::_keyBelongsToMe(const BSONObj& shardKey) {
+    if (shardKey.isEmpty())
+        return false;
+
+    const auto keyString = _chunkManager->extractKeyString(shardKey);
+    if (!_lastRange || keyString < _lastRange->min || !(keyString < _lastRange->max)) {
+        _lastRange =
+            _chunkManager->getKeyStringOwnershipRange(keyString, kMaxChunksPerOwnershipRange);
+        if (!_lastRange)
+            return false;
+    }
+
+    return _lastRange->shardId == _metadata->shardId();
+}
+
+void ShardFilterStage::skipFilteringIfBoundsAreOwned(const BSONObj& indexKeyPattern,
+                                                     const CollatorInterface* collator,
+                                                     const IndexBounds& bounds) {
+    // Bounds over collation keys do not bound the shard key values themselves
+    if (!_metadata->isSharded() || collator || bounds.isSimpleRange)
+        return;
+
+    // Build the smallest and largest shard keys within the bounds on the leading index fields,
+    // which must be the shard key fields in order and with the same types
+    BSONObjBuilder minBuilder;
+    BSONObjBuilder maxBuilder;
+
+    BSONObjIterator indexIt(indexKeyPattern);
+    size_t fieldNum = 0;
+    for (const auto& shardKeyElem : _metadata->getKeyPattern()) {
+        if (!indexIt.more())
+            return;
+
+        const auto indexElem = indexIt.next();
+        if (shardKeyElem.fieldNameStringData() != indexElem.fieldNameStringData() ||
+            shardKeyElem.woCompare(indexElem, false) != 0)
+            return;
+
+        invariant(fieldNum < bounds.fields.size());
+        const auto& intervals = bounds.fields[fieldNum++].intervals;
+        if (intervals.empty()) {
+            // The scan cannot produce any documents
+            _skipFiltering = true;
+            return;
+        }
+
+        // The intervals are ordered in the direction of the scan
+        BSONElement low = intervals.front().start;
+        BSONElement high = intervals.back().end;
+        if (low.woCompare(high, false) > 0) {
+            std::swap(low, high);
+        }
+
+        minBuilder.appendAs(low, shardKeyElem.fieldNameStringData());
+        maxBuilder.appendAs(high, shardKeyElem.fieldNameStringData());
+    }
+
+    const auto range = _chunkManager->getKeyStringOwnershipRange(
+        _chunkManager->extractKeyString(minBuilder.obj()), kMaxChunksPerOwnershipRange);
+
+    _skipFiltering = range && range->shardId == _metadata->shardId() &&
+        _chunkManager->extractKeyString(maxBuilder.obj()) < range->max;
+}
+
 unique_ptr<PlanStageStats> ShardFilterStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret =
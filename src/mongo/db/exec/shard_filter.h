@@ -28,11 +28,18 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/s/scoped_collection_metadata.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/shard_key_pattern.h"
 
 namespace mongo {
 
+class CollatorInterface;
+struct IndexBounds;
+
 /**
  * This stage drops documents that didn't belong to the shard we're executing on at the time of
  * construction. This matches the contract for sharded cursorids which guarantees that a
@@ -87,9 +94,24 @@ public:
 
     const SpecificStats* getSpecificStats() const final;
 
+    /**
+     * Turns filtering off if the child is a scan over the index "indexKeyPattern", which starts
+     * with the shard key fields, and every shard key within "bounds" falls within a single range
+     * of chunks owned by this shard. No document produced by such a scan can be an orphan.
+     */
+    void skipFilteringIfBoundsAreOwned(const BSONObj& indexKeyPattern,
+                                       const CollatorInterface* collator,
+                                       const IndexBounds& bounds);
+
     static const char* kStageType;
 
 private:
+    /**
+     * Returns whether "shardKey" belongs to this shard, checking it against the most recently
+     * looked up ownership range before falling back to the routing table.
+     */
+    bool _keyBelongsToMe(const BSONObj& shardKey);
+
     WorkingSet* _ws;
 
     // Stats
@@ -98,6 +120,18 @@ private:
     // Note: it is important that this is the metadata from the time this stage is constructed.
     // See class comment for details.
     ScopedCollectionMetadata _metadata;
+
+    // The routing table and shard key pattern of the metadata, if the collection is sharded
+    std::shared_ptr<ChunkManager> _chunkManager;
+    boost::optional<ShardKeyPattern> _shardKeyPattern;
+
+    // The ownership range which contained the last checked shard key. Scans produce runs of
+    // documents from the same chunks, so most documents are checked against it with a single
+    // KeyString comparison instead of a routing table lookup.
+    boost::optional<ChunkManager::KeyStringOwnershipRange> _lastRange;
+
+    // Set if the child is known to only produce documents owned by this shard
+    bool _skipFiltering = false;
 };
 
 }  // namespace mongo
@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/exec/shard_filter.cpp
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/shard_filter.h"
+
+#include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/s/collection_metadata.h"
+#include "mongo/db/service_context_d_test_fixture.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const std::string kThisShard{"thisShard"};
+const std::string kOtherShard{"otherShard"};
+
+/**
+ * Metadata that stays the same for as long as it is referenced.
+ */
+class FixedMetadata : public ScopedCollectionMetadata::Impl {
+public:
+    explicit FixedMetadata(CollectionMetadata metadata) : _metadata(std::move(metadata)) {}
+
+    const CollectionMetadata& get() override {
+        return _metadata;
+    }
+
+private:
+    const CollectionMetadata _metadata;
+};
+
+class ShardFilterStageTest : public ServiceContextMongoDTest {
+public:
+    ShardFilterStageTest() : _opCtx(makeOperationContext()) {}
+
+protected:
+    /**
+     * Returns metadata for a collection sharded on {x: 1}, of which this shard owns the two
+     * adjacent chunks [0, 10) and [10, 20), and another shard owns everything else.
+     */
+    static ScopedCollectionMetadata makeMetadata() {
+        const OID epoch = OID::gen();
+        auto chunk = [&](BSONObj min, BSONObj max, int major, const std::string& shard) {
+            return ChunkType{kNss, ChunkRange{min, max}, ChunkVersion(major, 0, epoch), shard};
+        };
+
+        auto rt = RoutingTableHistory::makeNew(
+            kNss,
+            UUID::gen(),
+            KeyPattern(BSON("x" << 1)),
+            nullptr,
+            false,
+            epoch,
+            {chunk(BSON("x" << MINKEY), BSON("x" << 0), 1, kOtherShard),
+             chunk(BSON("x" << 0), BSON("x" << 10), 2, kThisShard),
+             chunk(BSON("x" << 10), BSON("x" << 20), 3, kThisShard),
+             chunk(BSON("x" << 20), BSON("x" << MAXKEY), 4, kOtherShard)});
+
+        return {std::make_shared<FixedMetadata>(CollectionMetadata(
+            std::make_shared<ChunkManager>(rt, boost::none), kThisShard))};
+    }
+
+    /**
+     * Returns bounds for a scan of the index {x: 1} over the closed interval [min, max].
+     */
+    static IndexBounds makeBounds(int min, int max) {
+        OrderedIntervalList oil("x");
+        oil.intervals.push_back(Interval(BSON("" << min << "" << max), true, true));
+        IndexBounds bounds;
+        bounds.fields.push_back(oil);
+        return bounds;
+    }
+
+    /**
+     * Returns a filter over a child which produces 'docs' in order.
+     */
+    std::unique_ptr<ShardFilterStage> makeFilter(const std::vector<BSONObj>& docs) {
+        auto queuedDataStage = stdx::make_unique<QueuedDataStage>(_opCtx.get(), &_ws);
+        for (auto&& doc : docs) {
+            WorkingSetID id = _ws.allocate();
+            WorkingSetMember* member = _ws.get(id);
+            member->obj = Snapshotted<BSONObj>(SnapshotId(), doc);
+            member->transitionToOwnedObj();
+            queuedDataStage->pushBack(id);
+        }
+
+        // The ShardFilterStage takes ownership of its child.
+        return stdx::make_unique<ShardFilterStage>(
+            _opCtx.get(), makeMetadata(), &_ws, queuedDataStage.release());
+    }
+
+    /**
+     * Works 'filter' until EOF, returning the values of 'x' of the documents it produced.
+     */
+    std::vector<int> drain(ShardFilterStage* filter) {
+        std::vector<int> values;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (state != PlanStage::IS_EOF) {
+            state = filter->work(&id);
+            ASSERT_NE(state, PlanStage::FAILURE);
+            if (state == PlanStage::ADVANCED) {
+                values.push_back(_ws.get(id)->obj.value()["x"].numberInt());
+                _ws.free(id);
+            }
+        }
+        return values;
+    }
+
+    static size_t getChunkSkips(ShardFilterStage* filter) {
+        return static_cast<const ShardingFilterStats*>(filter->getSpecificStats())->chunkSkips;
+    }
+
+private:
+    ServiceContext::UniqueOperationContext _opCtx;
+    WorkingSet _ws;
+};
+
+std::vector<BSONObj> makeDocs(std::initializer_list<int> values) {
+    std::vector<BSONObj> docs;
+    for (auto value : values) {
+        docs.push_back(BSON("_id" << value << "x" << value));
+    }
+    return docs;
+}
+
+TEST_F(ShardFilterStageTest, DropsDocumentsInUnownedRanges) {
+    auto filter = makeFilter(makeDocs({-5, 3, 12, 25, 15, 19, 20, 0}));
+    ASSERT(std::vector<int>({3, 12, 15, 19, 0}) == drain(filter.get()));
+    ASSERT_EQ(3U, getChunkSkips(filter.get()));
+}
+
+TEST_F(ShardFilterStageTest, SkipsFilteringForBoundsWithinOwnedChunks) {
+    // The bounds span both chunks owned by this shard, which make up a single ownership range.
+    auto filter = makeFilter(makeDocs({2, 15, 19}));
+    filter->skipFilteringIfBoundsAreOwned(BSON("x" << 1), nullptr, makeBounds(2, 19));
+    ASSERT(std::vector<int>({2, 15, 19}) == drain(filter.get()));
+    ASSERT_EQ(0U, getChunkSkips(filter.get()));
+}
+
+TEST_F(ShardFilterStageTest, FiltersBoundsStraddlingTheEndOfOwnedChunks) {
+    // 20 belongs to the other shard, so the scan may produce orphans.
+    auto filter = makeFilter(makeDocs({5, 19, 20}));
+    filter->skipFilteringIfBoundsAreOwned(BSON("x" << 1), nullptr, makeBounds(5, 20));
+    ASSERT(std::vector<int>({5, 19}) == drain(filter.get()));
+    ASSERT_EQ(1U, getChunkSkips(filter.get()));
+}
+
+TEST_F(ShardFilterStageTest, FiltersBoundsStraddlingTheStartOfOwnedChunks) {
+    auto filter = makeFilter(makeDocs({-1, 0, 9}));
+    filter->skipFilteringIfBoundsAreOwned(BSON("x" << 1), nullptr, makeBounds(-1, 9));
+    ASSERT(std::vector<int>({0, 9}) == drain(filter.get()));
+    ASSERT_EQ(1U, getChunkSkips(filter.get()));
+}
+
+TEST_F(ShardFilterStageTest, FiltersBoundsOverIndexNotLedByShardKey) {
+    auto filter = makeFilter(makeDocs({25, 5}));
+    filter->skipFilteringIfBoundsAreOwned(BSON("y" << 1), nullptr, makeBounds(2, 19));
+    ASSERT(std::vector<int>({5}) == drain(filter.get()));
+    ASSERT_EQ(1U, getChunkSkips(filter.get()));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -53,6 +53,7 @@ constexpr StringData AggregationRequest::kCursorName;
 constexpr StringData AggregationRequest::kBatchSizeName;
 constexpr StringData AggregationRequest::kFromMongosName;
 constexpr StringData AggregationRequest::kNeedsMergeName;
+constexpr StringData AggregationRequest::kExchangePartitionsName;
 constexpr StringData AggregationRequest::kPipelineName;
 constexpr StringData AggregationRequest::kCollationName;
 constexpr StringData AggregationRequest::kExplainName;
@@ -110,6 +111,7 @@ StatusWith<AggregationRequest> AggregationRequest::parseFromBSON(
 
     bool hasFromMongosElem = false;
     bool hasNeedsMergeElem = false;
+    bool hasExchangePartitionsElem = false;
 
     // Parse optional parameters.
     for (auto&& elem : cmdObj) {
@@ -202,6 +204,21 @@ StatusWith<AggregationRequest> AggregationRequest::parseFromBSON(
 
             hasNeedsMergeElem = true;
             request.setNeedsMerge(elem.Bool());
+        } else if (kExchangePartitionsName == fieldName) {
+            if (!elem.isNumber()) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << kExchangePartitionsName << " must be a number, not a "
+                                      << typeName(elem.type())};
+            }
+            if (elem.numberInt() < 1 || elem.numberInt() != elem.numberDouble()) {
+                return {ErrorCodes::BadValue,
+                        str::stream() << kExchangePartitionsName
+                                      << " must be a positive integer, not "
+                                      << elem};
+            }
+
+            hasExchangePartitionsElem = true;
+            request.setExchangePartitions(elem.numberInt());
         } else if (kAllowDiskUseName == fieldName) {
             if (storageGlobalParams.readOnly) {
                 return {ErrorCodes::IllegalOperation,
@@ -256,6 +273,13 @@ StatusWith<AggregationRequest> AggregationRequest::parseFromBSON(
                               << "'"};
     }
 
+    if (hasExchangePartitionsElem && !request.needsMerge()) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "Cannot specify '" << kExchangePartitionsName << "' without '"
+                              << kNeedsMergeName
+                              << "'"};
+    }
+
     return request;
 }
 
@@ -294,6 +318,7 @@ Document AggregationRequest::serializeToCommandObj() const {
         {kAllowDiskUseName, _allowDiskUse ? Value(true) : Value()},
         {kFromMongosName, _fromMongos ? Value(true) : Value()},
         {kNeedsMergeName, _needsMerge ? Value(true) : Value()},
+        {kExchangePartitionsName, _exchangePartitions ? Value(_exchangePartitions) : Value()},
         {bypassDocumentValidationCommandOption(),
          _bypassDocumentValidation ? Value(true) : Value()},
         // Only serialize a collation if one was specified.
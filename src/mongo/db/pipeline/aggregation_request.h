@@ -52,6 +52,7 @@ public:
     static constexpr StringData kBatchSizeName = "batchSize"_sd;
     static constexpr StringData kFromMongosName = "fromMongos"_sd;
     static constexpr StringData kNeedsMergeName = "needsMerge"_sd;
+    static constexpr StringData kExchangePartitionsName = "exchangePartitions"_sd;
     static constexpr StringData kPipelineName = "pipeline"_sd;
     static constexpr StringData kCollationName = "collation"_sd;
     static constexpr StringData kExplainName = "explain"_sd;
@@ -147,6 +148,15 @@ public:
         return _needsMerge;
     }
 
+    /**
+     * Returns the number of consumers between which the output of this shards part of a split
+     * pipeline should be hash-partitioned, or 0 if the output should be returned through a single
+     * cursor.
+     */
+    int getExchangePartitions() const {
+        return _exchangePartitions;
+    }
+
     bool shouldAllowDiskUse() const {
         return _allowDiskUse;
     }
@@ -226,6 +236,10 @@ public:
         _needsMerge = needsMerge;
     }
 
+    void setExchangePartitions(int exchangePartitions) {
+        _exchangePartitions = exchangePartitions;
+    }
+
     void setBypassDocumentValidation(bool shouldBypassDocumentValidation) {
         _bypassDocumentValidation = shouldBypassDocumentValidation;
     }
@@ -280,6 +294,10 @@ private:
     bool _needsMerge = false;
     bool _bypassDocumentValidation = false;
 
+    // The number of cursors between which the output is hash-partitioned, or 0 if the output is
+    // not partitioned.
+    int _exchangePartitions = 0;
+
     // A user-specified maxTimeMS limit, or a value of '0' if not specified.
     unsigned int _maxTimeMS = 0;
 };
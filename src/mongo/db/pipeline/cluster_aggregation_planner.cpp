@@ -144,6 +144,18 @@ void performSplitPipelineOptimizations(Pipeline* shardPipeline, Pipeline* mergin
     limitFieldsSentFromShardsToMerger(shardPipeline, mergingPipeline);
 }
 
+void performPartitionedMergeOptimizations(Pipeline* partitionPipeline, Pipeline* mergingPipeline) {
+    // Unlike the shards, each partition produces final rather than mergeable results, so a
+    // splittable stage cannot be divided between the partitions and the merger the way
+    // findSplitPoint() does. Stop at the first one and leave it whole in the merger.
+    while (!mergingPipeline->getSources().empty() &&
+           !dynamic_cast<NeedsMergerDocumentSource*>(
+               mergingPipeline->getSources().front().get())) {
+        partitionPipeline->pushBack(mergingPipeline->popFront());
+    }
+    moveFinalUnwindFromShardsToMerger(partitionPipeline, mergingPipeline);
+}
+
 boost::optional<BSONObj> popLeadingMergeSort(Pipeline* pipeline) {
     // Remove a leading $sort iff it is a mergesort, since the ARM cannot handle blocking $sort.
     auto frontSort = pipeline->popFrontWithNameAndCriteria(
@@ -40,6 +40,13 @@ namespace cluster_aggregation_planner {
  */
 void performSplitPipelineOptimizations(Pipeline* shardPipeline, Pipeline* mergingPipeline);
 
+/**
+ * Moves the stages at the front of 'mergingPipeline' which can be applied to each hash partition of
+ * a partitioned merge independently to the end of 'partitionPipeline', stopping at the first stage
+ * which needs to see the output of every partition.
+ */
+void performPartitionedMergeOptimizations(Pipeline* partitionPipeline, Pipeline* mergingPipeline);
+
 /**
  * Rips off an initial $sort stage that can be handled by cursor merging machinery. Returns the
  * sort key pattern of such a $sort stage if there was one, and boost::none otherwise.
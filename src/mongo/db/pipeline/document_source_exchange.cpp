@@ -0,0 +1,69 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_exchange.h"
+
+#include "mongo/db/pipeline/document.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+constexpr StringData DocumentSourceExchange::kStageName;
+
+DocumentSourceExchange::DocumentSourceExchange(const intrusive_ptr<ExpressionContext>& expCtx,
+                                               const intrusive_ptr<Exchange>& exchange,
+                                               size_t consumerId)
+    : DocumentSource(expCtx), _exchange(exchange), _consumerId(consumerId) {}
+
+intrusive_ptr<DocumentSourceExchange> DocumentSourceExchange::create(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    const intrusive_ptr<Exchange>& exchange,
+    size_t consumerId) {
+    invariant(consumerId < exchange->getConsumers());
+    return new DocumentSourceExchange(expCtx, exchange, consumerId);
+}
+
+DocumentSource::GetNextResult DocumentSourceExchange::getNext() {
+    pExpCtx->checkForInterrupt();
+    return _exchange->getNext(pExpCtx->opCtx, _consumerId);
+}
+
+void DocumentSourceExchange::doDispose() {
+    _exchange->dispose(pExpCtx->opCtx, _consumerId);
+}
+
+Value DocumentSourceExchange::serialize(boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(DOC(getSourceName() << DOC("consumer" << static_cast<long long>(_consumerId)
+                                                       << "consumers"
+                                                       << static_cast<long long>(
+                                                              _exchange->getConsumers()))));
+}
+}  // namespace mongo
@@ -95,6 +95,13 @@ public:
         _doingMerge = doingMerge;
     }
 
+    /**
+     * Returns true if this source is merging the partial groups computed by the shards.
+     */
+    bool doingMerge() const {
+        return _doingMerge;
+    }
+
     bool isStreaming() const {
         return _streaming;
     }
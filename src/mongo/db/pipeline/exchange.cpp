@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/exchange.h"
+
+#include <algorithm>
+
+#include "mongo/db/operation_context.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+Exchange::Exchange(std::unique_ptr<Pipeline, PipelineDeleter> pipeline,
+                   size_t nConsumers,
+                   size_t bufferSizeBytes)
+    : _bufferSizeBytes(bufferSizeBytes),
+      _valueComparator(pipeline->getContext()->getValueComparator()),
+      _pipeline(std::move(pipeline)),
+      _consumers(nConsumers) {
+    // The pipeline is driven by whichever consumer needs more input, and is disposed of with the
+    // OperationContext of the last consumer to go away, never with the one it was created under.
+    _pipeline.get_deleter().dismissDisposal();
+    _pipeline->detachFromOperationContext();
+}
+
+boost::intrusive_ptr<Exchange> Exchange::create(
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline, size_t nConsumers, int bufferSizeBytes) {
+    uassert(50952, "need at least one consumer for an Exchange", nConsumers > 0);
+    uassert(50953,
+            str::stream() << "Exchange requires a positive buffer size, was given "
+                          << bufferSizeBytes,
+            bufferSizeBytes > 0);
+    return new Exchange(std::move(pipeline), nConsumers, bufferSizeBytes);
+}
+
+size_t Exchange::getTargetConsumer(const Document& input) const {
+    return _valueComparator.hash(input["_id"]) % _consumers.size();
+}
+
+DocumentSource::GetNextResult Exchange::getNext(OperationContext* opCtx, size_t consumerId) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    auto& consumer = _consumers[consumerId];
+    invariant(consumer.stillInUse);
+
+    while (true) {
+        uassertStatusOK(_errorStatus);
+
+        if (!consumer.buffer.empty()) {
+            const bool wasFull = consumer.bytesInBuffer >= _bufferSizeBytes;
+            Document next = std::move(consumer.buffer.front());
+            consumer.buffer.pop_front();
+            consumer.bytesInBuffer -= next.getApproximateSize();
+
+            // A consumer may be waiting for this buffer to drain before it can run the pipeline.
+            if (wasFull && consumer.bytesInBuffer < _bufferSizeBytes) {
+                _bufferStateChanged.notify_all();
+            }
+            return std::move(next);
+        }
+
+        if (_eof) {
+            return DocumentSource::GetNextResult::makeEOF();
+        }
+
+        if (!anyBufferFull()) {
+            loadNextBatch(opCtx);
+            continue;
+        }
+
+        // Some other consumer has yet to drain its buffer. Running the pipeline now could only
+        // grow that buffer further, so wait for it to make progress.
+        opCtx->waitForConditionOrInterrupt(_bufferStateChanged, lk);
+    }
+}
+
+void Exchange::dispose(OperationContext* opCtx, size_t consumerId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& consumer = _consumers[consumerId];
+    if (!consumer.stillInUse) {
+        return;
+    }
+
+    consumer.stillInUse = false;
+    consumer.buffer.clear();
+    consumer.bytesInBuffer = 0;
+    _bufferStateChanged.notify_all();
+
+    if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+            return info.stillInUse;
+        })) {
+        _pipeline->dispose(opCtx);
+    }
+}
+
+bool Exchange::anyBufferFull() const {
+    return std::any_of(_consumers.begin(), _consumers.end(), [this](const ConsumerInfo& info) {
+        return info.bytesInBuffer >= _bufferSizeBytes;
+    });
+}
+
+void Exchange::loadNextBatch(OperationContext* opCtx) {
+    _pipeline->reattachToOperationContext(opCtx);
+    ON_BLOCK_EXIT([this] { _pipeline->detachFromOperationContext(); });
+
+    try {
+        while (true) {
+            auto input = _pipeline->getNext();
+            if (!input) {
+                _eof = true;
+                break;
+            }
+
+            auto& target = _consumers[getTargetConsumer(*input)];
+            if (!target.stillInUse) {
+                continue;
+            }
+
+            target.bytesInBuffer += input->getApproximateSize();
+            target.buffer.push_back(std::move(*input));
+
+            if (target.bytesInBuffer >= _bufferSizeBytes) {
+                break;
+            }
+        }
+    } catch (const DBException& ex) {
+        _errorStatus = ex.toStatus();
+    }
+
+    _bufferStateChanged.notify_all();
+}
+
+}  // namespace mongo
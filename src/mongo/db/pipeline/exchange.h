@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <deque>
+#include <vector>
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/intrusive_counter.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Hash-partitions the output of a pipeline between a fixed number of consumers by the value of
+ * each document's '_id' field, so that every consumer sees a disjoint set of '_id' values. This is
+ * used on the shards to send the partial results of a $group to several merging hosts, each of
+ * which then completes the groups of one partition.
+ *
+ * Unlike TeeBuffer, consumers are expected to run concurrently on different threads, each with
+ * its own OperationContext. Whichever consumer finds its buffer empty runs the shared pipeline
+ * and distributes documents into every consumer's buffer until one of them is full. A consumer
+ * which finds its buffer empty while another is full waits for that buffer to be drained.
+ */
+class Exchange : public RefCountable {
+public:
+    /**
+     * Creates an Exchange which distributes the results of 'pipeline' between 'nConsumers'
+     * consumers. Note that 'bufferSizeBytes' is a soft cap on the size of each consumer's buffer,
+     * and may be exceeded by one document's worth (~16MB).
+     */
+    static boost::intrusive_ptr<Exchange> create(
+        std::unique_ptr<Pipeline, PipelineDeleter> pipeline,
+        size_t nConsumers,
+        int bufferSizeBytes = internalQueryExchangeBufferSizeBytes.load());
+
+    /**
+     * Retrieves the next document meant for 'consumerId', blocking until one is available, the
+     * pipeline is exhausted, or 'opCtx' is interrupted. An error raised by the pipeline is reported
+     * to every consumer.
+     */
+    DocumentSource::GetNextResult getNext(OperationContext* opCtx, size_t consumerId);
+
+    /**
+     * Removes 'consumerId' as a consumer of this exchange; documents meant for it are discarded
+     * from then on. The pipeline is disposed of once every consumer has been removed.
+     */
+    void dispose(OperationContext* opCtx, size_t consumerId);
+
+    /**
+     * Returns the consumer to which 'input' belongs.
+     */
+    size_t getTargetConsumer(const Document& input) const;
+
+    size_t getConsumers() const {
+        return _consumers.size();
+    }
+
+private:
+    Exchange(std::unique_ptr<Pipeline, PipelineDeleter> pipeline,
+             size_t nConsumers,
+             size_t bufferSizeBytes);
+
+    /**
+     * Runs the pipeline on behalf of 'opCtx', pushing each result into the buffer of the consumer
+     * it belongs to, until either a buffer reaches '_bufferSizeBytes' or the pipeline is exhausted.
+     * Must be called with '_mutex' held.
+     */
+    void loadNextBatch(OperationContext* opCtx);
+
+    bool anyBufferFull() const;
+
+    const size_t _bufferSizeBytes;
+
+    // Hashes '_id' values consistently with the pipeline's collation, so that group keys which
+    // compare equal are routed to the same consumer on every shard.
+    const ValueComparator _valueComparator;
+
+    // Protects all of the members below. It is held while the pipeline runs, so that only one
+    // consumer at a time drives it.
+    stdx::mutex _mutex;
+
+    // Signalled whenever a batch has been loaded, a full buffer has been drained, or a consumer
+    // has been disposed of.
+    stdx::condition_variable _bufferStateChanged;
+
+    std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
+
+    // True once the pipeline has been exhausted.
+    bool _eof = false;
+
+    // The error raised by the pipeline, if any.
+    Status _errorStatus = Status::OK();
+
+    struct ConsumerInfo {
+        bool stillInUse = true;
+        size_t bytesInBuffer = 0;
+        std::deque<Document> buffer;
+    };
+    std::vector<ConsumerInfo> _consumers;
+};
+}  // namespace mongo
@@ -0,0 +1,164 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/exchange.h"
+
+#include <map>
+#include <numeric>
+
+#include "mongo/db/client.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using ExchangeTest = AggregationContextFixture;
+
+std::unique_ptr<Pipeline, PipelineDeleter> makeMockPipeline(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::deque<DocumentSource::GetNextResult> inputs) {
+    return uassertStatusOK(
+        Pipeline::create({DocumentSourceMock::create(std::move(inputs))}, expCtx));
+}
+
+std::deque<DocumentSource::GetNextResult> makeInputs(int nGroups, int docsPerGroup) {
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < docsPerGroup; ++i) {
+        for (int id = 0; id < nGroups; ++id) {
+            inputs.emplace_back(Document{{"_id", id}, {"count", i}});
+        }
+    }
+    return inputs;
+}
+
+TEST_F(ExchangeTest, ShouldRequireAtLeastOneConsumer) {
+    ASSERT_THROWS_CODE(Exchange::create(makeMockPipeline(getExpCtx(), {}), 0),
+                       AssertionException,
+                       50952);
+}
+
+TEST_F(ExchangeTest, ShouldRequirePositiveBufferSize) {
+    ASSERT_THROWS_CODE(Exchange::create(makeMockPipeline(getExpCtx(), {}), 1, 0),
+                       AssertionException,
+                       50953);
+}
+
+TEST_F(ExchangeTest, ShouldBeExhaustedIfInputIsExhausted) {
+    auto exchange = Exchange::create(makeMockPipeline(getExpCtx(), {}), 2);
+    auto opCtx = getExpCtx()->opCtx;
+
+    ASSERT_TRUE(exchange->getNext(opCtx, 0).isEOF());
+    ASSERT_TRUE(exchange->getNext(opCtx, 1).isEOF());
+    ASSERT_TRUE(exchange->getNext(opCtx, 0).isEOF());
+
+    exchange->dispose(opCtx, 0);
+    exchange->dispose(opCtx, 1);
+}
+
+TEST_F(ExchangeTest, ShouldRouteEachGroupKeyToExactlyOneConsumer) {
+    const size_t nConsumers = 4;
+    auto exchange = Exchange::create(makeMockPipeline(getExpCtx(), makeInputs(50, 3)), nConsumers);
+    auto opCtx = getExpCtx()->opCtx;
+
+    std::map<int, size_t> consumerForId;
+    size_t nReturned = 0;
+    for (size_t consumerId = 0; consumerId < nConsumers; ++consumerId) {
+        for (auto next = exchange->getNext(opCtx, consumerId); !next.isEOF();
+             next = exchange->getNext(opCtx, consumerId)) {
+            ASSERT_TRUE(next.isAdvanced());
+            ASSERT_EQ(exchange->getTargetConsumer(next.getDocument()), consumerId);
+
+            const int id = next.getDocument()["_id"].getInt();
+            auto inserted = consumerForId.emplace(id, consumerId);
+            ASSERT_EQ(inserted.first->second, consumerId);
+            ++nReturned;
+        }
+        exchange->dispose(opCtx, consumerId);
+    }
+
+    ASSERT_EQ(nReturned, 150U);
+    ASSERT_EQ(consumerForId.size(), 50U);
+}
+
+TEST_F(ExchangeTest, ShouldDiscardDocumentsForDisposedConsumers) {
+    // With a one byte buffer, every document fills the buffer of its consumer. Documents for a
+    // disposed consumer must not count against the remaining ones, or this test would block.
+    auto exchange = Exchange::create(makeMockPipeline(getExpCtx(), makeInputs(20, 2)), 2, 1);
+    auto opCtx = getExpCtx()->opCtx;
+
+    exchange->dispose(opCtx, 1);
+
+    size_t nReturned = 0;
+    for (auto next = exchange->getNext(opCtx, 0); !next.isEOF();
+         next = exchange->getNext(opCtx, 0)) {
+        ASSERT_EQ(exchange->getTargetConsumer(next.getDocument()), 0U);
+        ++nReturned;
+    }
+    ASSERT_GT(nReturned, 0U);
+    ASSERT_LT(nReturned, 40U);
+
+    exchange->dispose(opCtx, 0);
+}
+
+TEST_F(ExchangeTest, ConcurrentConsumersShouldReceiveEveryDocument) {
+    const size_t nConsumers = 3;
+    const size_t bufferSizeBytes = 256;
+    auto exchange = Exchange::create(
+        makeMockPipeline(getExpCtx(), makeInputs(100, 10)), nConsumers, bufferSizeBytes);
+
+    std::vector<size_t> nReturned(nConsumers, 0);
+    std::vector<stdx::thread> consumers;
+    for (size_t consumerId = 0; consumerId < nConsumers; ++consumerId) {
+        consumers.emplace_back([&, consumerId] {
+            auto client = getServiceContext()->makeClient("exchangeConsumer");
+            auto opCtx = client->makeOperationContext();
+            for (auto next = exchange->getNext(opCtx.get(), consumerId); !next.isEOF();
+                 next = exchange->getNext(opCtx.get(), consumerId)) {
+                invariant(exchange->getTargetConsumer(next.getDocument()) == consumerId);
+                ++nReturned[consumerId];
+            }
+            exchange->dispose(opCtx.get(), consumerId);
+        });
+    }
+
+    for (auto&& consumer : consumers) {
+        consumer.join();
+    }
+
+    ASSERT_EQ(std::accumulate(nReturned.begin(), nReturned.end(), size_t{0}), 1000U);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -42,6 +42,7 @@
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
 #include "mongo/db/pipeline/document_source_out.h"
@@ -333,6 +334,42 @@ std::unique_ptr<Pipeline, PipelineDeleter> Pipeline::splitForSharded() {
     return shardPipeline;
 }
 
+std::unique_ptr<Pipeline, PipelineDeleter> Pipeline::splitForPartitionedMerge() {
+    invariant(isSplitForMerge());
+
+    auto group =
+        _sources.empty() ? nullptr : dynamic_cast<DocumentSourceGroup*>(_sources.front().get());
+    if (!group || !group->doingMerge()) {
+        return nullptr;
+    }
+
+    // The stages up to the next splittable stage will run against each partition in isolation.
+    for (auto it = std::next(_sources.begin()); it != _sources.end(); ++it) {
+        if (dynamic_cast<NeedsMergerDocumentSource*>(it->get())) {
+            break;
+        }
+
+        auto constraints = (*it)->constraints(SplitState::kSplitForMerge);
+        if (constraints.streamType != StreamType::kStreaming ||
+            (constraints.hostRequirement != HostTypeRequirement::kNone &&
+             constraints.hostRequirement != HostTypeRequirement::kAnyShard)) {
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<Pipeline, PipelineDeleter> partitionPipeline(new Pipeline(pCtx),
+                                                                 PipelineDeleter(pCtx->opCtx));
+    partitionPipeline->pushBack(popFront());
+
+    cluster_aggregation_planner::performPartitionedMergeOptimizations(partitionPipeline.get(),
+                                                                      this);
+    partitionPipeline->_splitState = SplitState::kSplitForMerge;
+
+    stitch();
+
+    return partitionPipeline;
+}
+
 BSONObj Pipeline::getInitialQuery() const {
     if (_sources.empty())
         return BSONObj();
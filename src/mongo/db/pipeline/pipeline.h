@@ -164,6 +164,17 @@ public:
     */
     std::unique_ptr<Pipeline, PipelineDeleter> splitForSharded();
 
+    /**
+     * Split a Pipeline which merges the results of the shards and begins with a merging $group, so
+     * that the groups can be completed on several hosts at once, each of them merging a disjoint
+     * hash partition of the group keys. Returns a Pipeline holding the $group and the stages after
+     * it which can be applied to each partition independently, and leaves in this Pipeline only
+     * what must see the output of every partition. Returns nullptr, leaving this Pipeline
+     * untouched, if it does not begin with a merging $group or if a stage which would move into the
+     * partitions must run on a particular host or cannot process each document independently.
+     */
+    std::unique_ptr<Pipeline, PipelineDeleter> splitForPartitionedMerge();
+
     /**
      * Returns true if this pipeline has not been split.
      */
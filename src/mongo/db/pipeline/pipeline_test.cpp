@@ -2304,6 +2304,84 @@ TEST_F(PipelineMustRunOnMongoSTest, SplittablePipelineRunsUnsplitOnMongoSIfSplit
 }
 
 }  // namespace mustRunOnMongoS
+
+namespace partitionedMerge {
+
+using PipelinePartitionedMergeTest = AggregationContextFixture;
+
+std::unique_ptr<Pipeline, PipelineDeleter> makeMergingPipeline(
+    const intrusive_ptr<ExpressionContext>& expCtx, const std::string& pipelineJson) {
+    const BSONObj inputBson = fromjson("{pipeline: " + pipelineJson + "}");
+    vector<BSONObj> rawPipeline;
+    for (auto&& stageElem : inputBson["pipeline"].Array()) {
+        rawPipeline.push_back(stageElem.embeddedObject());
+    }
+
+    NamespaceString lookupCollNs("a", "lookupColl");
+    expCtx->setResolvedNamespace_forTest(lookupCollNs, {lookupCollNs, std::vector<BSONObj>{}});
+
+    auto pipeline = uassertStatusOK(Pipeline::parse(rawPipeline, expCtx));
+    pipeline->optimizePipeline();
+    auto shardPipe = pipeline->splitForSharded();
+    ASSERT(shardPipe);
+    return pipeline;
+}
+
+std::vector<std::string> stageNames(const Pipeline& pipeline) {
+    std::vector<std::string> names;
+    for (auto&& stage : pipeline.getSources()) {
+        names.push_back(stage->getSourceName());
+    }
+    return names;
+}
+
+TEST_F(PipelinePartitionedMergeTest, GroupAndStreamingStagesMoveToPartitions) {
+    auto mergePipe = makeMergingPipeline(
+        getExpCtx(),
+        "[{$group: {_id: '$a', n: {$sum: 1}}}, {$match: {n: {$gt: 1}}}, {$project: {n: 1}}]");
+
+    auto partitionPipe = mergePipe->splitForPartitionedMerge();
+    ASSERT(partitionPipe);
+    ASSERT_TRUE(partitionPipe->isSplitForMerge());
+    ASSERT((stageNames(*partitionPipe) ==
+            std::vector<std::string>{"$group", "$match", "$project"}));
+    ASSERT_TRUE(mergePipe->getSources().empty());
+}
+
+TEST_F(PipelinePartitionedMergeTest, SplittableStageStaysWholeInFinalMerge) {
+    auto mergePipe = makeMergingPipeline(getExpCtx(),
+                                         "[{$group: {_id: '$a', n: {$sum: 1}}}, {$match: {n: 2}}, "
+                                         "{$sort: {n: -1}}, {$limit: 5}]");
+
+    auto partitionPipe = mergePipe->splitForPartitionedMerge();
+    ASSERT(partitionPipe);
+    ASSERT((stageNames(*partitionPipe) == std::vector<std::string>{"$group", "$match"}));
+    ASSERT((stageNames(*mergePipe) == std::vector<std::string>{"$sort"}));
+    auto finalSort = dynamic_cast<DocumentSourceSort*>(mergePipe->getSources().front().get());
+    ASSERT(finalSort);
+    ASSERT_FALSE(finalSort->mergingPresorted());
+}
+
+TEST_F(PipelinePartitionedMergeTest, NotSplitIfMergeDoesNotBeginWithGroup) {
+    auto mergePipe = makeMergingPipeline(getExpCtx(), "[{$sort: {a: 1}}, {$limit: 5}]");
+
+    auto namesBefore = stageNames(*mergePipe);
+    ASSERT_FALSE(mergePipe->splitForPartitionedMerge());
+    ASSERT(stageNames(*mergePipe) == namesBefore);
+}
+
+TEST_F(PipelinePartitionedMergeTest, NotSplitIfPartitionStageMustRunOnPrimaryShard) {
+    auto mergePipe = makeMergingPipeline(
+        getExpCtx(),
+        "[{$group: {_id: '$a'}}, {$graphLookup: {from: 'lookupColl', startWith: '$_id', "
+        "connectFromField: 'x', connectToField: 'y', as: 'out'}}]");
+
+    auto namesBefore = stageNames(*mergePipe);
+    ASSERT_FALSE(mergePipe->splitForPartitionedMerge());
+    ASSERT(stageNames(*mergePipe) == namesBefore);
+}
+
+}  // namespace partitionedMerge
 }  // namespace Sharded
 }  // namespace Optimizations
 
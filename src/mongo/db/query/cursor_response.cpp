@@ -32,32 +32,79 @@
 
 #include "mongo/db/query/cursor_response.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "mongo/bson/bsontypes.h"
 #include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/itoa.h"
 
 namespace mongo {
 
 namespace {
 
 const char kCursorField[] = "cursor";
+const char kCursorsField[] = "cursors";
 const char kIdField[] = "id";
 const char kNsField[] = "ns";
 const char kBatchField[] = "nextBatch";
 const char kBatchFieldInitial[] = "firstBatch";
 const char kInternalLatestOplogTimestampField[] = "$_internalLatestOplogTimestamp";
 
+// Spliced documents go into buffers that start at the in-place limit and double in size up to
+// this, which keeps the number of pieces writev has to gather small for the largest batches.
+const size_t kMaxSplicedChunkBytes = 1024 * 1024;
+
 }  // namespace
 
 CursorResponseBuilder::CursorResponseBuilder(bool isInitialResponse,
                                              BSONObjBuilder* commandResponse)
     : _responseInitialLen(commandResponse->bb().len()),
       _commandResponse(commandResponse),
+      _splicer(OpMsgBuilder::getSplicingBuilder(*commandResponse)),
       _cursorObject(commandResponse->subobjStart(kCursorField)),
-      _batch(_cursorObject.subarrayStart(isInitialResponse ? kBatchFieldInitial : kBatchField)) {}
+      // The array's length follows its type byte and NUL-terminated field name.
+      _batchLengthOffset(_cursorObject.bb().len() + 1 +
+                         strlen(isInitialResponse ? kBatchFieldInitial : kBatchField) + 1),
+      _batch(_cursorObject.subarrayStart(isInitialResponse ? kBatchFieldInitial : kBatchField)),
+      _nextChunkBytes(kMaxInPlaceBatchBytes) {}
+
+void CursorResponseBuilder::_appendSpliced(const BSONObj& obj) {
+    ItoA fieldName(_numDocs);
+    StringData name(fieldName);
+    const size_t elementSize = 1 + name.size() + 1 + obj.objsize();
+
+    if (!_chunk || _chunkUsed + elementSize > _chunk.capacity()) {
+        _chunk = SharedBuffer::allocate(std::max(elementSize, _nextChunkBytes));
+        _chunkUsed = 0;
+        _nextChunkBytes = std::min(_nextChunkBytes * 2, kMaxSplicedChunkBytes);
+        _spliced.push_back({_chunk, 0});
+    }
+
+    char* out = _chunk.get() + _chunkUsed;
+    *out++ = static_cast<char>(BSONType::Object);
+    memcpy(out, name.rawData(), name.size());
+    out += name.size();
+    *out++ = '\0';
+    memcpy(out, obj.objdata(), obj.objsize());
+
+    _chunkUsed += elementSize;
+    _spliced.back().size = _chunkUsed;
+    _splicedBytes += elementSize;
+}
 
 void CursorResponseBuilder::done(CursorId cursorId, StringData cursorNamespace) {
     invariant(_active);
     _batch.doneFast();
+    if (_splicedBytes) {
+        // The spliced documents follow the in-place ones, right before the array's EOO byte. The
+        // array, the cursor object and the body all enclose them.
+        const int spliceOffset = _commandResponse->bb().len() - 1;
+        const int cursorLengthOffset = _responseInitialLen + 1 + sizeof(kCursorField);
+        _splicer->splice(
+            spliceOffset, std::move(_spliced), {_batchLengthOffset, cursorLengthOffset});
+        _chunk = {};
+    }
     _cursorObject.append(kIdField, cursorId);
     _cursorObject.append(kNsField, cursorNamespace);
     _cursorObject.doneFast();
@@ -72,6 +119,9 @@ void CursorResponseBuilder::abandon() {
     _batch.doneFast();
     _cursorObject.doneFast();
     _commandResponse->bb().setlen(_responseInitialLen);  // Removes everything we've added.
+    _spliced.clear();
+    _chunk = {};
+    _splicedBytes = 0;
     _numDocs = 0;
     _active = false;
 }
@@ -111,6 +161,45 @@ CursorResponse::CursorResponse(NamespaceString nss,
       _latestOplogTimestamp(latestOplogTimestamp),
       _writeConcernError(std::move(writeConcernError)) {}
 
+std::vector<StatusWith<CursorResponse>> CursorResponse::parseFromBSONMany(
+    const BSONObj& cmdResponse) {
+    std::vector<StatusWith<CursorResponse>> cursors;
+    BSONElement cursorsElt = cmdResponse[kCursorsField];
+
+    // If there is not a "cursors" field, this is a response carrying a single cursor.
+    if (cursorsElt.eoo()) {
+        cursors.push_back(parseFromBSON(cmdResponse));
+        return cursors;
+    }
+
+    Status cmdStatus = getStatusFromCommandResult(cmdResponse);
+    if (!cmdStatus.isOK()) {
+        cursors.push_back(cmdStatus);
+        return cursors;
+    }
+
+    if (cursorsElt.type() != BSONType::Array) {
+        cursors.push_back({ErrorCodes::TypeMismatch,
+                           str::stream() << "Field '" << kCursorsField
+                                         << "' must be an array in: "
+                                         << cmdResponse});
+        return cursors;
+    }
+
+    for (auto&& elt : cursorsElt.Obj()) {
+        if (elt.type() != BSONType::Object) {
+            cursors.push_back({ErrorCodes::TypeMismatch,
+                               str::stream() << "Elements of '" << kCursorsField
+                                             << "' must be objects in: "
+                                             << cmdResponse});
+        } else {
+            cursors.push_back(parseFromBSON(elt.Obj()));
+        }
+    }
+
+    return cursors;
+}
+
 StatusWith<CursorResponse> CursorResponse::parseFromBSON(const BSONObj& cmdResponse) {
     Status cmdStatus = getStatusFromCommandResult(cmdResponse);
     if (!cmdStatus.isOK()) {
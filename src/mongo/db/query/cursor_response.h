@@ -35,6 +35,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/rpc/op_msg.h"
 
 namespace mongo {
 
@@ -56,6 +57,11 @@ public:
      */
     CursorResponseBuilder(bool isInitialResponse, BSONObjBuilder* commandResponse);
 
+    /**
+     * When the reply can splice, a batch is built in place only up to this many bytes.
+     */
+    static constexpr int kMaxInPlaceBatchBytes = 64 * 1024;
+
     ~CursorResponseBuilder() {
         if (_active)
             abandon();
@@ -63,12 +69,20 @@ public:
 
     size_t bytesUsed() const {
         invariant(_active);
-        return _batch.len();
+        return _batch.len() + _splicedBytes;
     }
 
     void append(const BSONObj& obj) {
         invariant(_active);
-        _batch.append(obj);
+        // Once a batch outgrows the in-place limit, the rest of it goes into separate buffers that
+        // are spliced into the OP_MSG reply and sent with writev, rather than into the reply
+        // buffer where they'd have to be copied again whenever it grows.
+        if (_splicedBytes ||
+            (_splicer && _batch.len() + obj.objsize() > kMaxInPlaceBatchBytes)) {
+            _appendSpliced(obj);
+        } else {
+            _batch.append(obj);
+        }
         _numDocs++;
     }
 
@@ -94,13 +108,25 @@ public:
     void abandon();
 
 private:
+    void _appendSpliced(const BSONObj& obj);
+
     const int _responseInitialLen;  // Must be the first member so its initializer runs first.
     bool _active = true;
     BSONObjBuilder* const _commandResponse;
+    OpMsgBuilder* const _splicer;
     BSONObjBuilder _cursorObject;
+    const int _batchLengthOffset;  // Must be initialized before _batch is started.
     BSONArrayBuilder _batch;
     long long _numDocs = 0;
     Timestamp _latestOplogTimestamp;
+
+    // Documents past the in-place limit, in buffers to be spliced in right before the end of the
+    // batch array.
+    std::vector<Message::SplicedBuffer> _spliced;
+    SharedBuffer _chunk;
+    size_t _chunkUsed = 0;
+    size_t _nextChunkBytes;
+    size_t _splicedBytes = 0;
 };
 
 /**
@@ -158,6 +184,14 @@ public:
         return uassertStatusOK(parseFromBSON(cmdResponse));
     }
 
+    /**
+     * Parses a command response which may carry several cursors, as an aggregation whose output is
+     * partitioned between several consumers does. Such a response has the form
+     * {cursors: [<cursor response>, ...], ok: 1}, where each element is parsed by 'parseFromBSON'.
+     * A response with a single 'cursor' field is returned as a vector of one element.
+     */
+    static std::vector<StatusWith<CursorResponse>> parseFromBSONMany(const BSONObj& cmdResponse);
+
     /**
      * Constructs an empty cursor response.
      */
@@ -30,6 +30,7 @@
 
 #include "mongo/db/query/cursor_response.h"
 
+#include "mongo/rpc/op_msg.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -242,6 +243,58 @@ TEST(CursorResponseTest, parseFromBSONHandleErrorResponse) {
     ASSERT_EQ(result.getStatus().reason(), "does not work");
 }
 
+TEST(CursorResponseTest, parseFromBSONManySingleCursor) {
+    std::vector<StatusWith<CursorResponse>> result = CursorResponse::parseFromBSONMany(
+        BSON("cursor" << BSON("id" << CursorId(123) << "ns"
+                                   << "db.coll"
+                                   << "firstBatch"
+                                   << BSON_ARRAY(BSON("_id" << 1)))
+                      << "ok"
+                      << 1));
+    ASSERT_EQ(result.size(), 1U);
+    ASSERT_OK(result[0].getStatus());
+    ASSERT_EQ(result[0].getValue().getCursorId(), CursorId(123));
+    ASSERT_EQ(result[0].getValue().getBatch().size(), 1U);
+}
+
+TEST(CursorResponseTest, parseFromBSONManyMultipleCursors) {
+    std::vector<StatusWith<CursorResponse>> result = CursorResponse::parseFromBSONMany(
+        BSON("cursors" << BSON_ARRAY(BSON("cursor" << BSON("id" << CursorId(123) << "ns"
+                                                                << "db.coll"
+                                                                << "firstBatch"
+                                                                << BSONArray())
+                                                   << "ok"
+                                                   << 1)
+                                     << BSON("cursor" << BSON("id" << CursorId(456) << "ns"
+                                                                << "db.coll"
+                                                                << "firstBatch"
+                                                                << BSONArray())
+                                                      << "ok"
+                                                      << 1))
+                       << "ok"
+                       << 1));
+    ASSERT_EQ(result.size(), 2U);
+    ASSERT_OK(result[0].getStatus());
+    ASSERT_EQ(result[0].getValue().getCursorId(), CursorId(123));
+    ASSERT_OK(result[1].getStatus());
+    ASSERT_EQ(result[1].getValue().getCursorId(), CursorId(456));
+}
+
+TEST(CursorResponseTest, parseFromBSONManyCursorsFieldWrongType) {
+    std::vector<StatusWith<CursorResponse>> result =
+        CursorResponse::parseFromBSONMany(BSON("cursors" << 3 << "ok" << 1));
+    ASSERT_EQ(result.size(), 1U);
+    ASSERT_EQ(result[0].getStatus(), ErrorCodes::TypeMismatch);
+}
+
+TEST(CursorResponseTest, parseFromBSONManyHandleErrorResponse) {
+    std::vector<StatusWith<CursorResponse>> result =
+        CursorResponse::parseFromBSONMany(BSON("ok" << 0 << "code" << 123 << "errmsg"
+                                                    << "does not work"));
+    ASSERT_EQ(result.size(), 1U);
+    ASSERT_EQ(result[0].getStatus().code(), 123);
+}
+
 TEST(CursorResponseTest, toBSONInitialResponse) {
     std::vector<BSONObj> batch = {BSON("_id" << 1), BSON("_id" << 2)};
     CursorResponse response(NamespaceString("testdb.testcoll"), CursorId(123), batch);
@@ -330,6 +383,64 @@ TEST(CursorResponseTest, serializeLatestOplogEntry) {
     ASSERT_EQ(*reparsedResponse.getLastOplogTimestamp(), Timestamp(1, 2));
 }
 
+TEST(CursorResponseBuilderTest, largeBatchIsSplicedIntoOpMsgReply) {
+    const std::string filler(1024, 'x');
+    const int kNumDocs = 1000;
+
+    OpMsgBuilder builder;
+    builder.enableSplicing();
+    {
+        auto body = builder.beginBody();
+        CursorResponseBuilder cursorBuilder(true, &body);
+        for (int i = 0; i < kNumDocs; i++) {
+            cursorBuilder.append(BSON("_id" << i << "filler" << filler));
+        }
+        ASSERT_GT(cursorBuilder.bytesUsed(), size_t(kNumDocs * filler.size()));
+        cursorBuilder.done(CursorId(123), "db.coll");
+        body.append("ok", 1);
+    }
+    auto message = builder.finish();
+    ASSERT_TRUE(message.isSpliced());
+
+    size_t segmentBytes = 0;
+    message.forEachSegment([&](const char* data, size_t size) { segmentBytes += size; });
+    ASSERT_EQ(segmentBytes, size_t(message.header().getLen()));
+
+    // Parsing flattens the message, after which it must read as one ordinary reply.
+    auto reply = OpMsg::parse(message);
+    ASSERT_FALSE(message.isSpliced());
+    ASSERT_EQ(message.size(), segmentBytes);
+
+    auto response = CursorResponse::parseFromBSONThrowing(reply.body);
+    ASSERT_EQ(response.getCursorId(), CursorId(123));
+    ASSERT_EQ(response.getNSS().ns(), "db.coll");
+    ASSERT_EQ(response.getBatch().size(), size_t(kNumDocs));
+    for (int i = 0; i < kNumDocs; i++) {
+        ASSERT_BSONOBJ_EQ(response.getBatch()[i], BSON("_id" << i << "filler" << filler));
+    }
+    ASSERT_EQ(reply.body["ok"].numberInt(), 1);
+}
+
+TEST(CursorResponseBuilderTest, batchIsNotSplicedWithoutSplicingBuilder) {
+    const std::string filler(1024, 'x');
+
+    OpMsgBuilder builder;
+    {
+        auto body = builder.beginBody();
+        CursorResponseBuilder cursorBuilder(false, &body);
+        for (int i = 0; i < 100; i++) {
+            cursorBuilder.append(BSON("_id" << i << "filler" << filler));
+        }
+        cursorBuilder.done(CursorId(0), "db.coll");
+        body.append("ok", 1);
+    }
+    auto message = builder.finish();
+    ASSERT_FALSE(message.isSpliced());
+
+    auto response = CursorResponse::parseFromBSONThrowing(OpMsg::parse(message).body);
+    ASSERT_EQ(response.getBatch().size(), 100U);
+}
+
 }  // namespace
 
 }  // namespace mongo
@@ -116,6 +116,10 @@ const int64_t insertVectorMaxBytes = 256 * 1024;
 // The number of bytes to buffer at once during a $facet stage.
 extern AtomicInt32 internalQueryFacetBufferSizeBytes;
 
+// The number of bytes of documents which may be buffered for each consumer of a hash-partitioned
+// aggregation before the pipeline producing them is paused.
+extern AtomicInt32 internalQueryExchangeBufferSizeBytes;
+
 extern AtomicInt32 internalInsertMaxBatchSize;
 
 extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
@@ -295,11 +295,24 @@ PlanStage* buildStages(OperationContext* opCtx,
             if (nullptr == childStage) {
                 return nullptr;
             }
-            return new ShardFilterStage(
+            auto shardFilterStage = new ShardFilterStage(
                 opCtx,
                 CollectionShardingState::get(opCtx, collection->ns())->getMetadata(opCtx),
                 ws,
                 childStage);
+
+            // Filtering can be skipped if the documents come from an index scan whose bounds lie
+            // within a range owned by this shard
+            const QuerySolutionNode* scanNode = fn->children[0];
+            if (STAGE_FETCH == scanNode->getType()) {
+                scanNode = scanNode->children[0];
+            }
+            if (STAGE_IXSCAN == scanNode->getType()) {
+                const IndexScanNode* ixn = static_cast<const IndexScanNode*>(scanNode);
+                shardFilterStage->skipFilteringIfBoundsAreOwned(
+                    ixn->index.keyPattern, ixn->index.collator, ixn->bounds);
+            }
+            return shardFilterStage;
         }
         case STAGE_KEEP_MUTATIONS: {
             const KeepMutationsNode* km = static_cast<const KeepMutationsNode*>(root);
@@ -36,6 +36,8 @@
 #include <iterator>
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/sync_tail.h"
@@ -53,6 +55,163 @@ const auto kInsertGroupMaxBatchSize = insertVectorMaxBytes;
 // Limit number of ops in a single group.
 constexpr auto kInsertGroupMaxBatchCount = 64;
 
+// Must not create too large an update document when coalescing.
+const auto kUpdateGroupMaxSize = insertVectorMaxBytes;
+
+constexpr StringData kSetFieldName = "$set"_sd;
+constexpr StringData kUnsetFieldName = "$unset"_sd;
+constexpr StringData kUpdateSemanticsFieldName = "$v"_sd;
+
+/**
+ * Returns true if 'update' is a modifier-style update document. Anything else is treated as a full
+ * document replacement.
+ */
+bool isModifierUpdate(const BSONObj& update) {
+    return update.firstElementFieldName()[0] == '$';
+}
+
+/**
+ * Returns true if 'entry' is an update that coalesceUpdates() knows how to fold: a full document
+ * replacement, or a modifier update consisting only of $set, $unset and $v.
+ */
+bool isCoalescableUpdate(const OplogEntry& entry) {
+    if (entry.getOpType() != OpTypeEnum::kUpdate || !entry.getObject2()) {
+        return false;
+    }
+
+    const auto& update = entry.getObject();
+    if (update.isEmpty() || !isModifierUpdate(update)) {
+        return true;
+    }
+
+    for (auto&& elem : update) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName == kUpdateSemanticsFieldName) {
+            continue;
+        }
+        if ((fieldName != kSetFieldName && fieldName != kUnsetFieldName) ||
+            elem.type() != BSONType::Object) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the fields of the $set or $unset object named 'modifierName' in 'update', or an empty
+ * object if 'update' has no such modifier.
+ */
+BSONObj getModifierFields(const BSONObj& update, StringData modifierName) {
+    const auto modifier = update[modifierName];
+    return modifier.eoo() ? BSONObj() : modifier.Obj();
+}
+
+/**
+ * Returns true if 'path' is a strict prefix of 'other' in dotted path notation, e.g. "a" is a
+ * prefix of "a.b" but not of "ab".
+ */
+bool isPathPrefixOf(StringData path, StringData other) {
+    return other.size() > path.size() && other.startsWith(path) && other[path.size()] == '.';
+}
+
+/**
+ * Combines two update documents on the same document into one, such that applying the result is
+ * equivalent to applying 'earlier' followed by 'later', down to the order of the document's fields.
+ * Returns boost::none if the updates cannot be expressed as a single update, e.g. when 'later'
+ * modifies a subfield of a path that 'earlier' sets, sets a path that 'earlier' does not set,
+ * unsets a dotted path that 'earlier' sets, or 'earlier' is a replacement followed by modifiers.
+ */
+boost::optional<BSONObj> mergeUpdates(const BSONObj& earlier, const BSONObj& later) {
+    // A replacement discards everything that came before it.
+    if (!isModifierUpdate(later)) {
+        return later;
+    }
+    if (!isModifierUpdate(earlier)) {
+        return boost::none;
+    }
+
+    // Both updates must have been generated with the same update semantics.
+    const auto earlierVersion = earlier[kUpdateSemanticsFieldName];
+    const auto laterVersion = later[kUpdateSemanticsFieldName];
+    if (earlierVersion.eoo() != laterVersion.eoo() ||
+        (!earlierVersion.eoo() &&
+         SimpleBSONElementComparator::kInstance.evaluate(earlierVersion != laterVersion))) {
+        return boost::none;
+    }
+
+    // Each modification is the field in the $set or $unset object, paired with whether it is an
+    // $unset.
+    using Modification = std::pair<BSONElement, bool>;
+    std::vector<Modification> modifications;
+    for (auto&& elem : getModifierFields(earlier, kSetFieldName)) {
+        modifications.emplace_back(elem, false);
+    }
+    for (auto&& elem : getModifierFields(earlier, kUnsetFieldName)) {
+        modifications.emplace_back(elem, true);
+    }
+
+    auto applyLater = [&](const BSONObj& fields, bool isUnset) {
+        for (auto&& elem : fields) {
+            const auto path = elem.fieldNameStringData();
+            bool overwritesEarlierSet = false;
+            for (auto it = modifications.begin(); it != modifications.end();) {
+                const auto existingPath = it->first.fieldNameStringData();
+                if (isPathPrefixOf(existingPath, path)) {
+                    // Modifying part of a value set by 'earlier' would require evaluating the
+                    // modifier against that value.
+                    return false;
+                }
+                if (existingPath == path || isPathPrefixOf(path, existingPath)) {
+                    if (isUnset && !it->second && existingPath.find('.') != std::string::npos) {
+                        // A dotted $set may have created the objects along its path or padded an
+                        // array, and those outlive the $unset of the field it set.
+                        return false;
+                    }
+                    overwritesEarlierSet |= existingPath == path && !it->second;
+                    it = modifications.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            // An update appends the fields it creates in sorted order, so a field created by
+            // 'later' would land in a different place if it were created along with those of
+            // 'earlier'. The same goes for a field 'earlier' unsets and 'later' sets again. Only a
+            // path 'earlier' already sets is known to exist, in the right place, after 'earlier'.
+            if (!isUnset && !overwritesEarlierSet) {
+                return false;
+            }
+            modifications.emplace_back(elem, isUnset);
+        }
+        return true;
+    };
+    if (!applyLater(getModifierFields(later, kSetFieldName), false) ||
+        !applyLater(getModifierFields(later, kUnsetFieldName), true)) {
+        return boost::none;
+    }
+
+    BSONObjBuilder mergedBuilder;
+    if (!laterVersion.eoo()) {
+        mergedBuilder.append(laterVersion);
+    }
+    for (auto isUnset : {false, true}) {
+        auto hasModifications = std::any_of(
+            modifications.begin(), modifications.end(), [isUnset](const Modification& mod) {
+                return mod.second == isUnset;
+            });
+        if (!hasModifications) {
+            continue;
+        }
+        BSONObjBuilder fieldsBuilder(
+            mergedBuilder.subobjStart(isUnset ? kUnsetFieldName : kSetFieldName));
+        for (auto&& mod : modifications) {
+            if (mod.second == isUnset) {
+                fieldsBuilder.append(mod.first);
+            }
+        }
+    }
+    return mergedBuilder.obj();
+}
+
 }  // namespace
 
 // static
@@ -66,6 +225,109 @@ void ApplierHelpers::stableSortByNamespace(MultiApplier::OperationPtrs* oplogEnt
     std::stable_sort(oplogEntryPointers->begin(), oplogEntryPointers->end(), nssComparator);
 }
 
+// static
+std::size_t ApplierHelpers::coalesceUpdates(OperationPtrs* oplogEntryPointers,
+                                            MultiApplier::Operations* coalescedOps) {
+    invariant(coalescedOps->empty());
+
+    // A run of coalescable updates to one document.
+    struct UpdateRun {
+        // Position of the first entry of the run in 'oplogEntryPointers'.
+        std::size_t first;
+        // The most recent entry folded into the run.
+        const OplogEntry* last;
+        // The update equivalent to applying all entries of the run in order.
+        BSONObj update;
+        std::size_t count;
+    };
+    std::vector<UpdateRun> runs;
+
+    // Runs that may still be extended on the current namespace, keyed by document _id.
+    auto openRuns = SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::size_t>();
+    NamespaceString currentNss;
+
+    std::vector<bool> folded(oplogEntryPointers->size(), false);
+    std::size_t numFolded = 0;
+
+    for (std::size_t i = 0; i < oplogEntryPointers->size(); ++i) {
+        const auto& entry = *(*oplogEntryPointers)[i];
+        if (!entry.isCrudOpType()) {
+            // Be conservative and do not fold updates across anything that is not a CRUD op.
+            openRuns.clear();
+            continue;
+        }
+        if (entry.getNamespace() != currentNss) {
+            openRuns.clear();
+            currentNss = entry.getNamespace();
+        }
+
+        const auto id = entry.getIdElement().wrap();
+        if (!isCoalescableUpdate(entry)) {
+            // Inserts, deletes and other updates end any run on this document.
+            openRuns.erase(id);
+            continue;
+        }
+
+        auto it = openRuns.find(id);
+        if (it != openRuns.end()) {
+            auto& run = runs[it->second];
+            const auto& last = *run.last;
+            if (last.getUuid() == entry.getUuid() && last.getUpsert() == entry.getUpsert() &&
+                SimpleBSONObjComparator::kInstance.evaluate(*last.getObject2() ==
+                                                            *entry.getObject2())) {
+                auto merged = mergeUpdates(run.update, entry.getObject());
+                if (merged && merged->objsize() <= kUpdateGroupMaxSize) {
+                    run.update = std::move(*merged);
+                    run.last = &entry;
+                    ++run.count;
+                    folded[i] = true;
+                    ++numFolded;
+                    continue;
+                }
+            }
+        }
+
+        // Start a new run with this entry.
+        openRuns[id] = runs.size();
+        runs.push_back({i, &entry, entry.getObject(), 1U});
+    }
+
+    if (numFolded == 0) {
+        return 0;
+    }
+
+    // Reserve up front so that pointers to the coalesced entries remain valid.
+    coalescedOps->reserve(std::count_if(
+        runs.begin(), runs.end(), [](const UpdateRun& run) { return run.count > 1; }));
+    for (auto&& run : runs) {
+        if (run.count == 1) {
+            continue;
+        }
+
+        // The coalesced entry is the last entry of the run with its update replaced.
+        BSONObjBuilder coalescedBuilder;
+        for (auto&& elem : run.last->raw) {
+            if (elem.fieldNameStringData() == "o"_sd) {
+                coalescedBuilder.append("o", run.update);
+            } else {
+                coalescedBuilder.append(elem);
+            }
+        }
+        coalescedOps->emplace_back(coalescedBuilder.obj());
+        (*oplogEntryPointers)[run.first] = &coalescedOps->back();
+    }
+
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < oplogEntryPointers->size(); ++i) {
+        if (!folded[i]) {
+            (*oplogEntryPointers)[next++] = (*oplogEntryPointers)[i];
+        }
+    }
+    oplogEntryPointers->resize(next);
+
+    return numFolded;
+}
+
 using InsertGroup = ApplierHelpers::InsertGroup;
 
 InsertGroup::InsertGroup(ApplierHelpers::OperationPtrs* ops,
@@ -50,6 +50,21 @@ public:
      */
     static void stableSortByNamespace(OperationPtrs* oplogEntryPointers);
 
+    /**
+     * Folds runs of update operations on the same document into a single update that produces the
+     * same final document, with its fields in the same order. Only updates made of $set/$unset
+     * modifiers and full document replacements are folded, and a $set is only folded into an
+     * earlier update that sets the same path; any other operation on the document ends the run. The
+     * coalesced update takes the place of the first entry of its run and carries the optime of the
+     * last one.
+     *
+     * Coalesced entries are stored in 'coalescedOps', which must be empty and must outlive
+     * 'oplogEntryPointers'. Expects entries sorted by namespace. Returns the number of oplog
+     * entries removed from 'oplogEntryPointers'.
+     */
+    static std::size_t coalesceUpdates(OperationPtrs* oplogEntryPointers,
+                                       MultiApplier::Operations* coalescedOps);
+
     class InsertGroup;
 };
 
@@ -716,7 +716,8 @@ void BackgroundSync::_fallBackOnRollbackViaRefetch(
     RollbackSourceImpl rollbackSource(getConnection,
                                       source,
                                       NamespaceString::kRsOplogNamespace.ns(),
-                                      rollbackRemoteOplogQueryBatchSize.load());
+                                      rollbackRemoteOplogQueryBatchSize.load(),
+                                      kRollbackOplogSocketTimeout);
 
     rollback(opCtx, *localOplog, rollbackSource, requiredRBID, _replCoord, _replicationProcess);
 }
@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/bson/simple_bsonelement_comparator.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/database.h"
@@ -176,6 +178,39 @@ std::unique_ptr<HealthLogEntry> dbCheckBatchEntry(const NamespaceString& nss,
     return dbCheckHealthLogEntry(nss, severity, msg, OplogEntriesEnum::Batch, data);
 }
 
+std::unique_ptr<HealthLogEntry> dbCheckSummaryEntry(
+    const NamespaceString& nss, const std::vector<DbCheckRangeSummary>& ranges) {
+    const bool complete =
+        std::all_of(ranges.begin(), ranges.end(), [](const DbCheckRangeSummary& range) {
+            return range.complete;
+        });
+
+    BSONObjBuilder data;
+    data.append("success", complete);
+    BSONArrayBuilder rangesBuilder(data.subarrayStart("ranges"));
+    for (const auto& range : ranges) {
+        BSONObjBuilder rangeBuilder(rangesBuilder.subobjStart());
+        range.minKey.serializeToBSON("minKey", &rangeBuilder);
+        range.maxKey.serializeToBSON("maxKey", &rangeBuilder);
+        rangeBuilder.append("count", static_cast<long long>(range.nDocs));
+        rangeBuilder.append("bytes", static_cast<long long>(range.nBytes));
+        rangeBuilder.append("batches", static_cast<long long>(range.nBatches));
+        rangeBuilder.append("md5", range.md5);
+        rangeBuilder.append("complete", range.complete);
+    }
+    rangesBuilder.done();
+
+    auto entry = stdx::make_unique<HealthLogEntry>();
+    entry->setNamespace(nss);
+    entry->setTimestamp(Date_t::now());
+    entry->setSeverity(complete ? SeverityEnum::Info : SeverityEnum::Warning);
+    entry->setScope(ScopeEnum::Cluster);
+    entry->setMsg("dbCheck summary");
+    entry->setOperation("dbCheckSummary");
+    entry->setData(data.obj());
+    return entry;
+}
+
 DbCheckHasher::DbCheckHasher(OperationContext* opCtx,
                              Collection* collection,
                              const BSONKey& start,
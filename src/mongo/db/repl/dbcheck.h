@@ -66,6 +66,29 @@ std::unique_ptr<HealthLogEntry> dbCheckBatchEntry(const NamespaceString& nss,
                                                   const BSONKey& maxKey,
                                                   const repl::OpTime& optime);
 
+/**
+ * The outcome of checking one _id range of a collection, in (minKey, maxKey]. 'md5' is the hash of
+ * the concatenated MD5s of the range's batches. 'complete' is false if the check failed or stopped
+ * before the end of the range it was given, in which case (minKey, maxKey] covers only the part
+ * that was checked.
+ */
+struct DbCheckRangeSummary {
+    BSONKey minKey;
+    BSONKey maxKey;
+    int64_t nDocs = 0;
+    int64_t nBytes = 0;
+    int64_t nBatches = 0;
+    std::string md5;
+    bool complete = false;
+};
+
+/**
+ * Get a HealthLogEntry summarizing a dbCheck of a collection, with one entry per _id range. The
+ * entry is a warning, with 'success' false, if any range is incomplete.
+ */
+std::unique_ptr<HealthLogEntry> dbCheckSummaryEntry(
+    const NamespaceString& nss, const std::vector<DbCheckRangeSummary>& ranges);
+
 /**
  * The collection metadata dbCheck sends between nodes.
  */
@@ -0,0 +1,89 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/rollback_refetch_progress.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+const auto getRollbackRefetchProgress =
+    ServiceContext::declareDecoration<RollbackRefetchProgress>();
+
+}  // namespace
+
+RollbackRefetchProgress* RollbackRefetchProgress::get(ServiceContext* service) {
+    return &getRollbackRefetchProgress(service);
+}
+
+void RollbackRefetchProgress::start(long long docsToRefetch, long long batchesToRefetch) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inProgress = true;
+    _startTime = Date_t::now();
+    _docsToRefetch = docsToRefetch;
+    _batchesToRefetch = batchesToRefetch;
+    _docsFetched = 0;
+    _batchesFetched = 0;
+    _bytesFetched = 0;
+}
+
+void RollbackRefetchProgress::recordBatchFetched(long long numDocs, long long numBytes) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _docsFetched += numDocs;
+    _bytesFetched += numBytes;
+    ++_batchesFetched;
+}
+
+void RollbackRefetchProgress::finish() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inProgress = false;
+}
+
+void RollbackRefetchProgress::append(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_inProgress) {
+        return;
+    }
+
+    BSONObjBuilder progress(builder->subobjStart("rollbackRefetchProgress"));
+    progress.appendDate("startTime", _startTime);
+    progress.append("docsToRefetch", _docsToRefetch);
+    progress.append("docsFetched", _docsFetched);
+    progress.append("batchesToRefetch", _batchesToRefetch);
+    progress.append("batchesFetched", _batchesFetched);
+    progress.append("bytesFetched", _bytesFetched);
+}
+
+}  // namespace repl
+}  // namespace mongo
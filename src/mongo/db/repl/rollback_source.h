@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
@@ -88,6 +90,16 @@ public:
                                                               UUID uuid,
                                                               const BSONObj& filter) const = 0;
 
+    /**
+     * Fetches all documents matching the filter from the sync source using the UUID. Returns the
+     * namespace matching the UUID on the sync source as well.
+     *
+     * Unlike the other functions of this interface, this may be called concurrently from multiple
+     * threads.
+     */
+    virtual std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+        const std::string& db, UUID uuid, const BSONObj& filter) const = 0;
+
     /**
      * Clones a single collection from the sync source.
      */
@@ -35,6 +35,8 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/oplogreader.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -44,11 +46,15 @@ namespace repl {
 RollbackSourceImpl::RollbackSourceImpl(GetConnectionFn getConnection,
                                        const HostAndPort& source,
                                        const std::string& collectionName,
-                                       int batchSize)
+                                       int batchSize,
+                                       Milliseconds socketTimeout)
     : _getConnection(getConnection),
       _source(source),
       _collectionName(collectionName),
-      _oplog(source, getConnection, collectionName, batchSize) {}
+      _oplog(source, getConnection, collectionName, batchSize),
+      _socketTimeout(socketTimeout) {}
+
+RollbackSourceImpl::~RollbackSourceImpl() = default;
 
 const OplogInterface& RollbackSourceImpl::getOplog() const {
     return _oplog;
@@ -80,6 +86,69 @@ std::pair<BSONObj, NamespaceString> RollbackSourceImpl::findOneByUUID(const std:
     return _getConnection()->findOneByUUID(db, uuid, filter);
 }
 
+std::pair<std::vector<BSONObj>, NamespaceString> RollbackSourceImpl::findByUUID(
+    const std::string& db, UUID uuid, const BSONObj& filter) const {
+    std::unique_ptr<DBClientConnection> conn;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_findConnectionsMutex);
+        if (!_findConnections.empty()) {
+            conn = std::move(_findConnections.back());
+            _findConnections.pop_back();
+        }
+    }
+    if (!conn) {
+        std::string errmsg;
+        conn = stdx::make_unique<DBClientConnection>();
+        // A sync source that stops responding must not block rollback forever.
+        conn->setSoTimeout(durationCount<Milliseconds>(_socketTimeout) / 1000.0);
+        uassert(ErrorCodes::HostUnreachable,
+                str::stream() << "replSet rollback error connecting to " << _source << ": "
+                              << errmsg,
+                conn->connect(_source, StringData(), errmsg) && replAuthenticate(conn.get()));
+    }
+
+    BSONObjBuilder cmdBuilder;
+    uuid.appendToBuilder(&cmdBuilder, "find");
+    cmdBuilder.append("filter", filter);
+    BSONObj cmd = cmdBuilder.obj();
+
+    BSONObj res;
+    if (!conn->runCommand(db, cmd, res, QueryOption_SlaveOk)) {
+        uassertStatusOKWithContext(getStatusFromCommandResult(res),
+                                   str::stream() << "find command using UUID failed. Command: "
+                                                 << cmd);
+    }
+
+    std::vector<BSONObj> docs;
+    BSONObj cursorObj = res.getObjectField("cursor");
+    NamespaceString resNss(cursorObj["ns"].valueStringData());
+    for (auto&& doc : cursorObj.getObjectField("firstBatch")) {
+        docs.push_back(doc.Obj().getOwned());
+    }
+
+    auto cursorId = cursorObj["id"].numberLong();
+    while (cursorId != 0) {
+        BSONObj getMoreCmd = BSON("getMore" << cursorId << "collection" << resNss.coll());
+        if (!conn->runCommand(db, getMoreCmd, res, QueryOption_SlaveOk)) {
+            uassertStatusOKWithContext(getStatusFromCommandResult(res),
+                                       str::stream() << "getMore command failed. Command: "
+                                                     << getMoreCmd);
+        }
+        cursorObj = res.getObjectField("cursor");
+        for (auto&& doc : cursorObj.getObjectField("nextBatch")) {
+            docs.push_back(doc.Obj().getOwned());
+        }
+        cursorId = cursorObj["id"].numberLong();
+    }
+
+    // Only return the connection for reuse once it is known to be in a good state.
+    {
+        stdx::lock_guard<stdx::mutex> lk(_findConnectionsMutex);
+        _findConnections.push_back(std::move(conn));
+    }
+    return {std::move(docs), resNss};
+}
+
 void RollbackSourceImpl::copyCollectionFromRemote(OperationContext* opCtx,
                                                   const NamespaceString& nss) const {
     std::string errmsg;
@@ -28,16 +28,21 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/db/repl/oplog_interface_remote.h"
 #include "mongo/db/repl/rollback_source.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
 class DBClientBase;
+class DBClientConnection;
 
 namespace repl {
 
@@ -52,10 +57,17 @@ public:
      */
     using GetConnectionFn = stdx::function<DBClientBase*()>;
 
+    /**
+     * The connections opened by findByUUID() time out sends and receives after 'socketTimeout', as
+     * the connection returned by 'getConnection' does.
+     */
     RollbackSourceImpl(GetConnectionFn getConnection,
                        const HostAndPort& source,
                        const std::string& collectionName,
-                       int batchSize);
+                       int batchSize,
+                       Milliseconds socketTimeout);
+
+    ~RollbackSourceImpl();
 
     const OplogInterface& getOplog() const override;
 
@@ -71,6 +83,9 @@ public:
                                                       UUID uuid,
                                                       const BSONObj& filter) const override;
 
+    std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+        const std::string& db, UUID uuid, const BSONObj& filter) const override;
+
     void copyCollectionFromRemote(OperationContext* opCtx,
                                   const NamespaceString& nss) const override;
 
@@ -84,6 +99,12 @@ private:
     HostAndPort _source;
     std::string _collectionName;
     OplogInterfaceRemote _oplog;
+    Milliseconds _socketTimeout;
+
+    // Idle connections to the sync source used by findByUUID(). Each concurrent caller of
+    // findByUUID() takes a connection from here, or opens a new one if there are none left.
+    mutable stdx::mutex _findConnectionsMutex;
+    mutable std::vector<std::unique_ptr<DBClientConnection>> _findConnections;
 };
 
 
@@ -214,6 +214,21 @@ std::pair<BSONObj, NamespaceString> RollbackSourceMock::findOneByUUID(const std:
     return {BSONObj(), NamespaceString()};
 }
 
+std::pair<std::vector<BSONObj>, NamespaceString> RollbackSourceMock::findByUUID(
+    const std::string& db, UUID uuid, const BSONObj& filter) const {
+    stdx::lock_guard<stdx::mutex> lk(_findByUUIDMutex);
+    std::vector<BSONObj> docs;
+    NamespaceString nss;
+    for (auto&& id : filter["_id"]["$in"].Obj()) {
+        BSONObj doc;
+        std::tie(doc, nss) = findOneByUUID(db, uuid, id.wrap("_id"));
+        if (!doc.isEmpty()) {
+            docs.push_back(doc);
+        }
+    }
+    return {docs, nss};
+}
+
 void RollbackSourceMock::copyCollectionFromRemote(OperationContext* opCtx,
                                                   const NamespaceString& nss) const {}
 
@@ -38,6 +38,7 @@
 #include "mongo/db/repl/storage_interface_impl.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d_test_fixture.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 namespace repl {
@@ -244,6 +245,13 @@ public:
                                                       UUID uuid,
                                                       const BSONObj& filter) const override;
 
+    /**
+     * Answers each _id of an {_id: {$in: [...]}} filter with findOneByUUID(), so that tests only
+     * need to override findOneByUUID(). Calls are serialized.
+     */
+    std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+        const std::string& db, UUID uuid, const BSONObj& filter) const override;
+
     void copyCollectionFromRemote(OperationContext* opCtx,
                                   const NamespaceString& nss) const override;
     StatusWith<BSONObj> getCollectionInfoByUUID(const std::string& db,
@@ -253,6 +261,7 @@ public:
 private:
     std::unique_ptr<OplogInterface> _oplog;
     HostAndPort _source;
+    mutable stdx::mutex _findByUUIDMutex;
 };
 
 /**
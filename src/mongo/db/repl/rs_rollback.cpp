@@ -67,10 +67,13 @@
 #include "mongo/db/repl/replication_coordinator_impl.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/repl/roll_back_local_operations.h"
+#include "mongo/db/repl/rollback_refetch_progress.h"
 #include "mongo/db/repl/rollback_source.h"
 #include "mongo/db/repl/rslog.h"
 #include "mongo/db/s/shard_identity_rollback_notifier.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -580,6 +583,133 @@ Status rollback_internal::updateFixUpInfoFromLocalOplogEntry(FixUpInfo& fixUpInf
 
 namespace {
 
+// Maximum number of documents whose current version is fetched from the sync source with a single
+// query during rollback via refetch.
+MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchBatchSize, int, 1000)
+    ->withValidator([](const int& potentialNewValue) {
+        if (potentialNewValue < 1) {
+            return Status(ErrorCodes::BadValue, "rollbackRefetchBatchSize must be positive.");
+        }
+
+        return Status::OK();
+    });
+
+// Number of connections used concurrently to fetch documents from the sync source during rollback
+// via refetch.
+MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchThreadCount, int, 4)
+    ->withValidator([](const int& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "rollbackRefetchThreadCount must be between 1 and 64.");
+        }
+
+        return Status::OK();
+    });
+
+// We do not roll back more than 300 MB of documents in order to prevent out of memory errors from
+// too much data being stored. See SERVER-23392.
+const unsigned long long kMaxRefetchedBytes = 300 * 1024 * 1024;
+
+/**
+ * A batch of documents from the same collection whose current versions are fetched from the sync
+ * source with a single query.
+ */
+struct RefetchBatch {
+    RefetchBatch(UUID uuid) : uuid(std::move(uuid)) {}
+
+    UUID uuid;
+    NamespaceString nss;
+    std::vector<const DocID*> docs;
+
+    // Filled in by fetchRefetchBatches().
+    std::vector<BSONObj> fetched;
+    NamespaceString resNss;
+    std::exception_ptr error;
+};
+
+/**
+ * Splits the documents to refetch into batches of at most 'batchSize' documents from the same
+ * collection.
+ */
+std::vector<RefetchBatch> makeRefetchBatches(const FixUpInfo& fixUpInfo, int batchSize) {
+    std::vector<RefetchBatch> batches;
+    for (auto&& doc : fixUpInfo.docsToRefetch) {
+        invariant(!doc._id.eoo());  // This is checked when we insert to the set.
+
+        // 'docsToRefetch' is ordered by UUID first, so documents from the same collection are
+        // adjacent.
+        if (batches.empty() || batches.back().uuid != doc.uuid ||
+            batches.back().docs.size() >= static_cast<size_t>(batchSize)) {
+            batches.emplace_back(doc.uuid);
+        }
+        batches.back().docs.push_back(&doc);
+    }
+    return batches;
+}
+
+/**
+ * Fetches the documents of every batch from the sync source with an {_id: {$in: [...]}} query,
+ * using up to 'rollbackRefetchThreadCount' concurrent queries. Errors are recorded in the batch
+ * rather than thrown. Batches are skipped once the total size of the fetched documents exceeds the
+ * rollback limit, since the rollback is going to fail anyway.
+ */
+void fetchRefetchBatches(std::vector<RefetchBatch>* batches,
+                         const RollbackSource& rollbackSource,
+                         RollbackRefetchProgress* progress) {
+    AtomicUInt64 totalSize;
+    auto fetchBatch = [&](RefetchBatch* batch) {
+        if (totalSize.load() >= kMaxRefetchedBytes) {
+            return;
+        }
+        try {
+            LOG(2) << "Refetching " << batch->docs.size() << " documents, collection: "
+                   << batch->nss << ", UUID: " << batch->uuid;
+            BSONObjBuilder filter;
+            {
+                BSONObjBuilder idBuilder(filter.subobjStart("_id"));
+                BSONArrayBuilder inBuilder(idBuilder.subarrayStart("$in"));
+                for (auto&& doc : batch->docs) {
+                    inBuilder.append(doc->_id);
+                }
+            }
+            std::tie(batch->fetched, batch->resNss) =
+                rollbackSource.findByUUID(batch->nss.db().toString(), batch->uuid, filter.obj());
+
+            long long batchSize = 0;
+            for (auto&& good : batch->fetched) {
+                batchSize += good.objsize();
+            }
+            totalSize.fetchAndAdd(batchSize);
+            progress->recordBatchFetched(batch->docs.size(), batchSize);
+        } catch (...) {
+            batch->error = std::current_exception();
+        }
+    };
+
+    const auto numThreads =
+        std::min(static_cast<size_t>(rollbackRefetchThreadCount.load()), batches->size());
+    if (numThreads <= 1) {
+        for (auto&& batch : *batches) {
+            fetchBatch(&batch);
+        }
+        return;
+    }
+
+    ThreadPool::Options options;
+    options.poolName = "rollbackRefetch";
+    options.minThreads = 0;
+    options.maxThreads = numThreads;
+    ThreadPool pool(options);
+    pool.startup();
+    for (auto&& batch : *batches) {
+        auto batchPtr = &batch;
+        fassert(50950, pool.schedule([&fetchBatch, batchPtr] { fetchBatch(batchPtr); }));
+    }
+    pool.waitForIdle();
+    pool.shutdown();
+    pool.join();
+}
+
 /**
  * This must be called before making any changes to our local data and after fetching any
  * information from the upstream node. If any information is fetched from the upstream node after we
@@ -978,27 +1108,34 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
     stdx::unordered_map<UUID, std::map<DocID, BSONObj>, UUID::Hash> goodVersions;
     auto& catalog = UUIDCatalog::get(opCtx);
 
-    // Fetches all the goodVersions of each document from the current sync source.
-    unsigned long long numFetched = 0;
-
     log() << "Starting refetching documents";
 
-    for (auto&& doc : fixUpInfo.docsToRefetch) {
-        invariant(!doc._id.eoo());  // This is checked when we insert to the set.
+    // Fetches all the goodVersions of each document from the current sync source, in batches of
+    // documents from the same collection.
+    auto batches = makeRefetchBatches(fixUpInfo, rollbackRefetchBatchSize.load());
+    for (auto&& batch : batches) {
+        batch.nss = catalog.lookupNSSByUUID(batch.uuid);
+    }
 
-        UUID uuid = doc.uuid;
-        NamespaceString nss = catalog.lookupNSSByUUID(uuid);
+    auto progress = RollbackRefetchProgress::get(opCtx->getServiceContext());
+    progress->start(fixUpInfo.docsToRefetch.size(), batches.size());
+    ON_BLOCK_EXIT([&] { progress->finish(); });
 
-        try {
-            LOG(2) << "Refetching document, collection: " << nss << ", UUID: " << uuid << ", "
-                   << redact(doc._id);
-            // TODO : Slow. Lots of round trips.
-            numFetched++;
+    fetchRefetchBatches(&batches, rollbackSource, progress);
+
+    const StringData::ComparatorInterface* stringComparator = nullptr;
+    BSONElementComparator eltCmp(BSONElementComparator::FieldNamesMode::kIgnore, stringComparator);
+
+    unsigned long long numFetched = 0;
+    for (auto&& batch : batches) {
+        const UUID& uuid = batch.uuid;
+        const NamespaceString& nss = batch.nss;
+        numFetched += batch.docs.size();
 
-            BSONObj good;
-            NamespaceString resNss;
-            std::tie(good, resNss) =
-                rollbackSource.findOneByUUID(nss.db().toString(), uuid, doc._id.wrap());
+        try {
+            if (batch.error) {
+                std::rethrow_exception(batch.error);
+            }
 
             // To prevent inconsistencies in the transactions collection, rollback fails if the UUID
             // of the collection is different on the sync source than on the node rolling back,
@@ -1006,27 +1143,60 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
             // a transaction table document is not "config.transactions," which implies a rename or
             // drop of the collection occured on either node.
             if (uuid == fixUpInfo.transactionTableUUID &&
-                resNss != NamespaceString::kSessionTransactionsTableNamespace) {
+                batch.resNss != NamespaceString::kSessionTransactionsTableNamespace) {
                 throw RSFatalException(
                     str::stream()
                     << "A fetch on the transactions collection returned an unexpected namespace: "
-                    << resNss.ns()
+                    << batch.resNss.ns()
                     << ". The transactions collection cannot be correctly rolled back, a full "
                        "resync is required.");
             }
 
-            totalSize += good.objsize();
-
-            // Checks that the total amount of data that needs to be refetched is at most
-            // 300 MB. We do not roll back more than 300 MB of documents in order to
-            // prevent out of memory errors from too much data being stored. See SERVER-23392.
-            if (totalSize >= 300 * 1024 * 1024) {
-                throw RSFatalException("replSet too much data to roll back.");
+            // Match up the fetched documents with the documents we asked for. A fetched document
+            // that matches none of them by binary comparison of the _id (e.g. due to the
+            // collection's collation) makes us fall back to fetching the unmatched ones one at a
+            // time.
+            auto fetchedById = eltCmp.makeBSONEltIndexedMap<BSONObj>();
+            bool allFetchedMatched = true;
+            {
+                auto requestedIds = eltCmp.makeBSONEltSet();
+                for (auto&& doc : batch.docs) {
+                    requestedIds.insert(doc->_id);
+                }
+                for (auto&& good : batch.fetched) {
+                    auto id = good["_id"];
+                    if (requestedIds.count(id)) {
+                        fetchedById[id] = good;
+                    } else {
+                        allFetchedMatched = false;
+                    }
+                }
             }
 
-            // Note good might be empty, indicating we should delete it.
-            goodVersions[uuid].insert(std::pair<DocID, BSONObj>(doc, good));
+            for (auto&& doc : batch.docs) {
+                BSONObj good;
+                auto it = fetchedById.find(doc->_id);
+                if (it != fetchedById.end()) {
+                    good = it->second;
+                } else if (!allFetchedMatched) {
+                    LOG(2) << "Refetching document individually, collection: " << nss
+                           << ", UUID: " << uuid << ", " << redact(doc->_id);
+                    std::tie(good, std::ignore) =
+                        rollbackSource.findOneByUUID(nss.db().toString(), uuid, doc->_id.wrap());
+                }
+
+                totalSize += good.objsize();
+
+                // Checks that the total amount of data that needs to be refetched is at most
+                // 300 MB. We do not roll back more than 300 MB of documents in order to
+                // prevent out of memory errors from too much data being stored. See SERVER-23392.
+                if (totalSize >= kMaxRefetchedBytes) {
+                    throw RSFatalException("replSet too much data to roll back.");
+                }
 
+                // Note good might be empty, indicating we should delete it.
+                goodVersions[uuid].insert(std::pair<DocID, BSONObj>(*doc, good));
+            }
         } catch (const DBException& ex) {
             // If the collection turned into a view, we might get an error trying to
             // refetch documents, but these errors should be ignored, as we'll be creating
@@ -1038,9 +1208,10 @@ void rollback_internal::syncFixUp(OperationContext* opCtx,
                 ex.code() == ErrorCodes::NamespaceNotFound)
                 continue;
 
-            log() << "Rollback couldn't re-fetch from uuid: " << uuid << " _id: " << redact(doc._id)
-                  << ' ' << numFetched << '/' << fixUpInfo.docsToRefetch.size() << ": "
-                  << redact(ex);
+            log() << "Rollback couldn't re-fetch from uuid: " << uuid << " a batch of "
+                  << batch.docs.size() << " documents starting at _id: "
+                  << redact(batch.docs.front()->_id) << ' ' << numFetched << '/'
+                  << fixUpInfo.docsToRefetch.size() << ": " << redact(ex);
             throw;
         }
     }
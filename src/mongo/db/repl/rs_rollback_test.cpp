@@ -1763,6 +1763,72 @@ TEST_F(RSRollbackTest, RollbackApplyOpsCommand) {
         << result;
 }
 
+TEST_F(RSRollbackTest, RollbackRefetchesDocumentsOfACollectionWithOneQuery) {
+    createOplog(_opCtx.get());
+    CollectionOptions options;
+    options.uuid = UUID::gen();
+    auto coll = _createCollection(_opCtx.get(), "test.t", options);
+    {
+        AutoGetCollection autoColl(_opCtx.get(), NamespaceString("test.t"), MODE_X);
+        mongo::WriteUnitOfWork wuow(_opCtx.get());
+        OpDebug* const nullOpDebug = nullptr;
+        for (int id = 1; id <= 3; ++id) {
+            ASSERT_OK(coll->insertDocument(
+                _opCtx.get(), InsertStatement(BSON("_id" << id)), nullOpDebug, false));
+        }
+        wuow.commit();
+    }
+    UUID uuid = coll->uuid().get();
+
+    auto commonOperation = makeOpAndRecordId(1, 1);
+    OplogInterfaceMock::Operations localOperations;
+    for (int id = 3; id >= 1; --id) {
+        localOperations.push_back(
+            std::make_pair(BSON("ts" << Timestamp(Seconds(1 + id), 0) << "h" << 1LL << "op"
+                                     << "i"
+                                     << "ui"
+                                     << uuid
+                                     << "ns"
+                                     << "test.t"
+                                     << "o"
+                                     << BSON("_id" << id)),
+                           RecordId(1 + id)));
+    }
+    localOperations.push_back(commonOperation);
+
+    class RollbackSourceLocal : public RollbackSourceMock {
+    public:
+        RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+            : RollbackSourceMock(std::move(oplog)) {}
+
+        std::pair<std::vector<BSONObj>, NamespaceString> findByUUID(
+            const std::string& db, UUID uuid, const BSONObj& filter) const override {
+            filters.push_back(filter.getOwned());
+            return {{BSON("_id" << 1 << "v" << 1)}, NamespaceString("test.t")};
+        }
+
+        mutable std::vector<BSONObj> filters;
+    } rollbackSource(std::unique_ptr<OplogInterface>(new OplogInterfaceMock({commonOperation})));
+
+    ASSERT_OK(syncRollback(_opCtx.get(),
+                           OplogInterfaceMock(localOperations),
+                           rollbackSource,
+                           {},
+                           _coordinator,
+                           _replicationProcess.get()));
+
+    ASSERT_EQUALS(1U, rollbackSource.filters.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << BSON("$in" << BSON_ARRAY(1 << 2 << 3))),
+                      rollbackSource.filters.front());
+
+    AutoGetCollectionForReadCommand acr(_opCtx.get(), NamespaceString("test.t"));
+    BSONObj result;
+    ASSERT(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 1), result));
+    ASSERT_EQUALS(1, result["v"].numberInt()) << result;
+    ASSERT_FALSE(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 2), result));
+    ASSERT_FALSE(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 3), result));
+}
+
 TEST_F(RSRollbackTest, RollbackCreateCollectionCommand) {
     createOplog(_opCtx.get());
     CollectionOptions options;
@@ -33,6 +33,7 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include "third_party/murmurhash3/MurmurHash3.h"
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 #include <memory>
 
@@ -149,6 +150,38 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+// Wall clock time, in milliseconds since the epoch, at which the batch being applied started. Zero
+// while no batch is being applied.
+AtomicInt64 batchApplyStartMillis(0);
+
+/**
+ * Reports how long the batch being applied has been applying. Reads at lastApplied see the data as
+ * of the end of the previous batch, so this is how long they have been missing the writes in the
+ * current one. It is 0 when no batch is being applied, e.g. on an idle secondary that is caught up.
+ */
+class LocalSnapshotAgeSSM : public ServerStatusMetric {
+public:
+    LocalSnapshotAgeSSM() : ServerStatusMetric("repl.secondaryReads.snapshotAgeMillis") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        const long long startMillis = batchApplyStartMillis.load();
+        const long long ageMillis =
+            startMillis ? Date_t::now().toMillisSinceEpoch() - startMillis : 0;
+        b.appendNumber(_leafName, std::max(ageMillis, 0LL));
+    }
+} localSnapshotAgeSSM;
+
+// If true, writer threads fold runs of $set/$unset updates to the same document within a batch into
+// a single update before applying them. Reads at timestamps in the middle of a batch will then see
+// the document as of the end of the run.
+MONGO_EXPORT_SERVER_PARAMETER(replCoalesceUpdatesInBatch, bool, false);
+
+// The oplog entries that did not need to be applied individually because they were coalesced into
+// another update to the same document.
+Counter64 updatesCoalescedStats;
+ServerStatusMetricField<Counter64> displayUpdatesCoalesced("repl.apply.updatesCoalesced",
+                                                           &updatesCoalescedStats);
+
 class ApplyBatchFinalizer {
 public:
     ApplyBatchFinalizer(ReplicationCoordinator* replCoord) : _replCoord(replCoord) {}
@@ -1259,6 +1292,12 @@ Status multiSyncApply(OperationContext* opCtx,
 
     ApplierHelpers::stableSortByNamespace(ops);
 
+    // Holds the updates produced by coalescing. Must outlive any use of 'ops'.
+    MultiApplier::Operations coalescedOps;
+    if (replCoalesceUpdatesInBatch.load()) {
+        updatesCoalescedStats.increment(ApplierHelpers::coalesceUpdates(ops, &coalescedOps));
+    }
+
     // This function is only called in steady state replication and recovering.
     // Assume we are recovering if oplog writes are disabled in the options.
     const auto oplogApplicationMode = st->getOptions().skipWritesToOplog
@@ -1379,6 +1418,9 @@ Status multiInitialSyncApply(OperationContext* opCtx,
 StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::Operations ops) {
     invariant(!ops.empty());
 
+    batchApplyStartMillis.store(Date_t::now().toMillisSinceEpoch());
+    ON_BLOCK_EXIT([] { batchApplyStartMillis.store(0); });
+
     if (isMMAPV1()) {
         // Use a ThreadPool to prefetch all the operations in a batch.
         prefetchOps(ops, _writerPool);
@@ -49,6 +49,7 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/repl/applier_helpers.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
 #include "mongo/db/repl/idempotency_test_fixture.h"
@@ -996,6 +997,207 @@ TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingInsertsIndividuallyWhenGro
     ASSERT_EQUALS(1U, numFailedGroupedInserts);
 }
 
+TEST_F(SyncTailTest, CoalesceUpdatesFoldsSetAndUnsetOnSameDocument) {
+    NamespaceString nss("test.t");
+    auto op1 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$set" << BSON("a" << 1 << "b.c" << 1)));
+    auto op2 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 1),
+                                            BSON("$set" << BSON("a" << 2)));
+    auto op3 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$set" << BSON("a" << 3) << "$unset"
+                                                        << BSON("b" << true)));
+
+    MultiApplier::OperationPtrs ops = {&op1, &op2, &op3};
+    MultiApplier::Operations coalescedOps;
+    ASSERT_EQUALS(1U, ApplierHelpers::coalesceUpdates(&ops, &coalescedOps));
+
+    ASSERT_EQUALS(2U, ops.size());
+    ASSERT_EQUALS(1U, coalescedOps.size());
+    ASSERT_EQUALS(&coalescedOps.front(), ops[0]);
+    ASSERT_EQUALS(&op2, ops[1]);
+
+    // The coalesced update carries the optime of the last update it folds.
+    ASSERT_EQUALS(op3.getOpTime(), ops[0]->getOpTime());
+    ASSERT_BSONOBJ_EQ(*op3.getObject2(), *ops[0]->getObject2());
+    ASSERT_BSONOBJ_EQ(BSON("$set" << BSON("a" << 3) << "$unset" << BSON("b" << true)),
+                      ops[0]->getObject());
+}
+
+TEST_F(SyncTailTest, CoalesceUpdatesReplacementOverridesEarlierUpdates) {
+    NamespaceString nss("test.t");
+    auto op1 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$set" << BSON("a" << 1)));
+    auto op2 = makeUpdateDocumentOplogEntry(
+        {Timestamp(Seconds(2), 0), 1LL}, nss, BSON("_id" << 0), BSON("_id" << 0 << "x" << 2));
+
+    MultiApplier::OperationPtrs ops = {&op1, &op2};
+    MultiApplier::Operations coalescedOps;
+    ASSERT_EQUALS(1U, ApplierHelpers::coalesceUpdates(&ops, &coalescedOps));
+
+    ASSERT_EQUALS(1U, ops.size());
+    ASSERT_BSONOBJ_EQ(op2.getObject(), ops[0]->getObject());
+}
+
+TEST_F(SyncTailTest, CoalesceUpdatesDoesNotFoldModificationOfSubfieldOfEarlierSet) {
+    NamespaceString nss("test.t");
+    auto op1 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$set" << BSON("a" << BSON("b" << 1))));
+    auto op2 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$set" << BSON("a.c" << 2)));
+
+    MultiApplier::OperationPtrs ops = {&op1, &op2};
+    MultiApplier::Operations coalescedOps;
+    ASSERT_EQUALS(0U, ApplierHelpers::coalesceUpdates(&ops, &coalescedOps));
+    ASSERT_EQUALS(2U, ops.size());
+    ASSERT_TRUE(coalescedOps.empty());
+}
+
+TEST_F(SyncTailTest, CoalesceUpdatesDoesNotFoldAcrossOtherOperationsOnSameDocument) {
+    NamespaceString nss("test.t");
+    auto op1 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$set" << BSON("a" << 1)));
+    auto op2 = makeDeleteDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss, BSON("_id" << 0));
+    auto op3 = makeInsertDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL}, nss, BSON("_id" << 0));
+    auto op4 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(4), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$set" << BSON("a" << 2)));
+    auto op5 = makeUpdateDocumentOplogEntry({Timestamp(Seconds(5), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << 0),
+                                            BSON("$inc" << BSON("a" << 1)));
+
+    MultiApplier::OperationPtrs ops = {&op1, &op2, &op3, &op4, &op5};
+    MultiApplier::Operations coalescedOps;
+    ASSERT_EQUALS(0U, ApplierHelpers::coalesceUpdates(&ops, &coalescedOps));
+    ASSERT_EQUALS(5U, ops.size());
+}
+
+class SyncTailCoalesceUpdatesTest : public SyncTailTest {
+protected:
+    /**
+     * Applies 'updates' to a copy of 'doc' one at a time, and to another copy after coalescing
+     * them, and checks that both copies end up byte-for-byte the same, down to the order of their
+     * fields. Returns the number of updates that were folded.
+     */
+    std::size_t applyCoalescedAndSequentially(const BSONObj& doc,
+                                              const std::vector<BSONObj>& updates) {
+        auto makeOps = [&](const NamespaceString& nss) {
+            createCollection(_opCtx.get(), nss, {});
+            int seconds = 1;
+            MultiApplier::Operations ops = {
+                makeInsertDocumentOplogEntry({Timestamp(Seconds(seconds++), 0), 1LL}, nss, doc)};
+            for (auto&& update : updates) {
+                ops.push_back(makeUpdateDocumentOplogEntry(
+                    {Timestamp(Seconds(seconds++), 0), 1LL}, nss, doc["_id"].wrap(), update));
+            }
+            return ops;
+        };
+
+        NamespaceString sequentialNss("test.sequential");
+        ASSERT_OK(runOpsSteadyState(makeOps(sequentialNss)));
+
+        NamespaceString coalescedNss("test.coalesced");
+        auto ops = makeOps(coalescedNss);
+        MultiApplier::OperationPtrs opPtrs;
+        for (auto&& op : ops) {
+            opPtrs.push_back(&op);
+        }
+        MultiApplier::Operations coalescedOps;
+        auto numFolded = ApplierHelpers::coalesceUpdates(&opPtrs, &coalescedOps);
+        MultiApplier::Operations opsToApply;
+        for (auto&& op : opPtrs) {
+            opsToApply.push_back(*op);
+        }
+        ASSERT_OK(runOpsSteadyState(opsToApply));
+
+        auto storage = getStorageInterface();
+        auto sequentialDoc =
+            unittest::assertGet(storage->findById(_opCtx.get(), sequentialNss, doc["_id"]));
+        auto coalescedDoc =
+            unittest::assertGet(storage->findById(_opCtx.get(), coalescedNss, doc["_id"]));
+        ASSERT_TRUE(sequentialDoc.binaryEqual(coalescedDoc))
+            << "applied one at a time: " << sequentialDoc << ", coalesced: " << coalescedDoc;
+        return numFolded;
+    }
+};
+
+TEST_F(SyncTailCoalesceUpdatesTest, FoldedUpdatesLeaveFieldsInPlace) {
+    ASSERT_EQUALS(2U,
+                  applyCoalescedAndSequentially(
+                      BSON("_id" << 0 << "x" << 1 << "c" << 1),
+                      {BSON("$set" << BSON("b" << 1 << "a" << 1 << "c" << 2)),
+                       BSON("$set" << BSON("a" << 2)),
+                       BSON("$set" << BSON("b" << 3) << "$unset" << BSON("x" << true))}));
+}
+
+TEST_F(SyncTailCoalesceUpdatesTest, DoesNotFoldSetOfPathUnsetEarlier) {
+    // Applied one at a time, 'a' is removed and then appended after 'b'.
+    ASSERT_EQUALS(0U,
+                  applyCoalescedAndSequentially(BSON("_id" << 0 << "a" << 1 << "b" << 1),
+                                                {BSON("$unset" << BSON("a" << true)),
+                                                 BSON("$set" << BSON("a" << 2))}));
+}
+
+TEST_F(SyncTailCoalesceUpdatesTest, DoesNotFoldSetOfNewFields) {
+    // Applied one at a time, 'z' is appended before 'a'.
+    ASSERT_EQUALS(
+        0U,
+        applyCoalescedAndSequentially(
+            BSON("_id" << 0), {BSON("$set" << BSON("z" << 1)), BSON("$set" << BSON("a" << 1))}));
+}
+
+TEST_F(SyncTailCoalesceUpdatesTest, DoesNotFoldSetOfNewSubfields) {
+    ASSERT_EQUALS(0U,
+                  applyCoalescedAndSequentially(BSON("_id" << 0 << "x" << BSONObj()),
+                                                {BSON("$set" << BSON("x.z" << 1)),
+                                                 BSON("$set" << BSON("x.a" << 1))}));
+}
+
+TEST_F(SyncTailCoalesceUpdatesTest, FoldsUnsetOfTopLevelFieldSetEarlier) {
+    ASSERT_EQUALS(1U,
+                  applyCoalescedAndSequentially(BSON("_id" << 0 << "a" << 1 << "b" << 1),
+                                                {BSON("$set" << BSON("a" << 2)),
+                                                 BSON("$unset" << BSON("a" << true))}));
+}
+
+TEST_F(SyncTailCoalesceUpdatesTest, DoesNotFoldUnsetOfDottedPathSetEarlier) {
+    // Applied one at a time, the $set creates 'a' and the $unset leaves it empty.
+    ASSERT_EQUALS(0U,
+                  applyCoalescedAndSequentially(BSON("_id" << 0),
+                                                {BSON("$set" << BSON("a.b" << 1)),
+                                                 BSON("$unset" << BSON("a.b" << true))}));
+}
+
+TEST_F(SyncTailCoalesceUpdatesTest, DoesNotFoldUnsetOfParentOfDottedPathSetEarlier) {
+    ASSERT_EQUALS(0U,
+                  applyCoalescedAndSequentially(BSON("_id" << 0),
+                                                {BSON("$set" << BSON("a.b.c" << 1)),
+                                                 BSON("$unset" << BSON("a.b" << true))}));
+}
+
+TEST_F(SyncTailCoalesceUpdatesTest, DoesNotFoldUnsetOfArrayElementSetEarlier) {
+    // Applied one at a time, the $set pads 'arr' with nulls and the $unset only nulls element 5.
+    ASSERT_EQUALS(0U,
+                  applyCoalescedAndSequentially(BSON("_id" << 0 << "arr" << BSON_ARRAY(0)),
+                                                {BSON("$set" << BSON("arr.5" << 1)),
+                                                 BSON("$unset" << BSON("arr.5" << true))}));
+}
+
 TEST_F(SyncTailTest, MultiInitialSyncApplyDisablesDocumentValidationWhileApplyingOperations) {
     SyncTailWithOperationContextChecker syncTail;
     NamespaceString nss("test.t");
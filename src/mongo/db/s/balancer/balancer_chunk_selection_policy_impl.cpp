@@ -37,6 +37,8 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj_comparator_interface.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/balancer_configuration.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_tags.h"
@@ -54,6 +56,109 @@ using std::shared_ptr;
 using std::unique_ptr;
 using std::vector;
 
+// Maximum number of migrations a shard may take part in during a single balancing round. Shards
+// execute one migration at a time, so the migrations scheduled on the same shard run back to back.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxMigrationsPerShard, int, 1)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 32) {
+            return Status(ErrorCodes::BadValue,
+                          "balancerMaxMigrationsPerShard must be between 1 and 32");
+        }
+        return Status::OK();
+    });
+
+// Maximum amount of data, estimated from the maximum chunk size, which a shard may donate or
+// receive during a single balancing round. Zero means no limit besides the number of migrations.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMigrationBudgetPerShardMB, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "balancerMigrationBudgetPerShardMB must not be negative");
+        }
+        return Status::OK();
+    });
+
+// Shards serving more operations per second than this take part in at most one migration per
+// balancing round. Zero disables the check.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMigrationMaxShardOpsPerSec, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "balancerMigrationMaxShardOpsPerSec must not be negative");
+        }
+        return Status::OK();
+    });
+
+/**
+ * Keeps track of the migrations selected during a balancing round. Each selection pass uses every
+ * shard at most once across all collections, and shards only take part in passes after the first
+ * one while they are within their data and load budgets.
+ */
+class BalancerChunkSelectionPolicyImpl::RoundBudget {
+    MONGO_DISALLOW_COPYING(RoundBudget);
+
+public:
+    RoundBudget(int numPasses,
+                uint64_t maxBytesPerShard,
+                double maxOpsPerSec,
+                uint64_t estimatedMigrationBytes)
+        : _usedShardsPerPass(numPasses),
+          _maxBytesPerShard(maxBytesPerShard),
+          _maxOpsPerSec(maxOpsPerSec),
+          _estimatedMigrationBytes(estimatedMigrationBytes) {}
+
+    int numPasses() const {
+        return _usedShardsPerPass.size();
+    }
+
+    /**
+     * Returns the shards, which must not take part in any more migrations during the specified
+     * pass.
+     */
+    std::set<ShardId> unavailableShards(const ShardStatisticsVector& shardStats, int pass) const {
+        std::set<ShardId> shards(_usedShardsPerPass[pass]);
+
+        // The first migration of every shard is always allowed
+        if (pass == 0) {
+            return shards;
+        }
+
+        for (const auto& stat : shardStats) {
+            if (_maxOpsPerSec > 0 && stat.opsPerSec > _maxOpsPerSec) {
+                shards.insert(stat.shardId);
+                continue;
+            }
+
+            const auto it = _scheduledBytes.find(stat.shardId);
+            const uint64_t scheduledBytes = (it == _scheduledBytes.end()) ? 0 : it->second;
+            if (_maxBytesPerShard > 0 &&
+                scheduledBytes + _estimatedMigrationBytes > _maxBytesPerShard) {
+                shards.insert(stat.shardId);
+            }
+        }
+
+        return shards;
+    }
+
+    /**
+     * Charges a migration selected during the specified pass to its donor and recipient.
+     */
+    void add(const MigrateInfo& migration, int pass) {
+        _usedShardsPerPass[pass].insert(migration.from);
+        _usedShardsPerPass[pass].insert(migration.to);
+        _scheduledBytes[migration.from] += _estimatedMigrationBytes;
+        _scheduledBytes[migration.to] += _estimatedMigrationBytes;
+    }
+
+private:
+    std::vector<std::set<ShardId>> _usedShardsPerPass;
+    std::map<ShardId, uint64_t> _scheduledBytes;
+
+    const uint64_t _maxBytesPerShard;
+    const double _maxOpsPerSec;
+    const uint64_t _estimatedMigrationBytes;
+};
+
 namespace {
 
 /**
@@ -254,7 +359,11 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
     }
 
     MigrateInfoVector candidateChunks;
-    std::set<ShardId> usedShards;
+    RoundBudget budget(balancerMaxMigrationsPerShard.load(),
+                       static_cast<uint64_t>(balancerMigrationBudgetPerShardMB.load()) * 1024 *
+                           1024,
+                       balancerMigrationMaxShardOpsPerSec.load(),
+                       Grid::get(opCtx)->getBalancerConfiguration()->getMaxChunkSizeBytes());
 
     std::shuffle(collections.begin(), collections.end(), _random);
 
@@ -271,7 +380,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
         }
 
         auto candidatesStatus = _getMigrateCandidatesForCollection(
-            opCtx, nss, shardStats, aggressiveBalanceHint, &usedShards);
+            opCtx, nss, shardStats, aggressiveBalanceHint, &budget);
         if (candidatesStatus == ErrorCodes::NamespaceNotFound) {
             // Namespace got dropped before we managed to get to it, so just skip it
             continue;
@@ -414,7 +523,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
     const NamespaceString& nss,
     const ShardStatisticsVector& shardStats,
     bool aggressiveBalanceHint,
-    std::set<ShardId>* usedShards) {
+    RoundBudget* budget) {
     auto routingInfoStatus =
         Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx, nss);
     if (!routingInfoStatus.isOK()) {
@@ -425,12 +534,12 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
 
     const auto& shardKeyPattern = cm->getShardKeyPattern().getKeyPattern();
 
-    const auto collInfoStatus = createCollectionDistributionStatus(opCtx, shardStats, cm);
+    auto collInfoStatus = createCollectionDistributionStatus(opCtx, shardStats, cm);
     if (!collInfoStatus.isOK()) {
         return collInfoStatus.getStatus();
     }
 
-    const DistributionStatus& distribution = collInfoStatus.getValue();
+    DistributionStatus& distribution = collInfoStatus.getValue();
 
     for (const auto& tagRangeEntry : distribution.tagRanges()) {
         const auto& tagRange = tagRangeEntry.second;
@@ -471,7 +580,24 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
         }
     }
 
-    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, usedShards);
+    MigrateInfoVector candidateChunks;
+
+    for (int pass = 0; pass < budget->numPasses(); pass++) {
+        auto usedShards = budget->unavailableShards(shardStats, pass);
+
+        auto passCandidates =
+            BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, &usedShards);
+
+        // Account for the selected migrations, so the next pass continues from the distribution
+        // they will produce
+        for (auto& migration : passCandidates) {
+            distribution.applyPendingMigration(migration);
+            budget->add(migration, pass);
+            candidateChunks.push_back(std::move(migration));
+        }
+    }
+
+    return candidateChunks;
 }
 
 }  // namespace mongo
@@ -53,6 +53,8 @@ public:
                             const ShardId& newShardId) override;
 
 private:
+    class RoundBudget;
+
     /**
      * Synchronous method, which iterates the collection's chunks and uses the tags information to
      * figure out whether some of them validate the tag range boundaries and need to be split.
@@ -64,14 +66,15 @@ private:
 
     /**
      * Synchronous method, which iterates the collection's chunks and uses the cluster statistics to
-     * figure out where to place them.
+     * figure out where to place them. Makes one selection pass for each migration a shard may take
+     * part in during the round, charging the selected migrations against 'budget'.
      */
     StatusWith<MigrateInfoVector> _getMigrateCandidatesForCollection(
         OperationContext* opCtx,
         const NamespaceString& nss,
         const ShardStatisticsVector& shardStats,
         bool aggressiveBalanceHint,
-        std::set<ShardId>* usedShards);
+        RoundBudget* budget);
 
     // Source for obtaining cluster statistics. Not owned and must not be destroyed before the
     // policy object is destroyed.
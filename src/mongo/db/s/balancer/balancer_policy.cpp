@@ -32,6 +32,9 @@
 
 #include "mongo/db/s/balancer/balancer_policy.h"
 
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
 #include "mongo/util/log.h"
@@ -45,6 +48,15 @@ using std::set;
 using std::string;
 using std::vector;
 
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxRecipientReplicationLagSecs, int, 30)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "balancerMaxRecipientReplicationLagSecs must not be negative");
+        }
+        return Status::OK();
+    });
+
 namespace {
 
 // These values indicate the minimum deviation shard's number of chunks need to have from the
@@ -106,6 +118,21 @@ const vector<ChunkType>& DistributionStatus::getChunks(const ShardId& shardId) c
     return i->second;
 }
 
+void DistributionStatus::applyPendingMigration(const MigrateInfo& migration) {
+    auto& donorChunks = _shardChunks[migration.from];
+    auto it = std::find_if(donorChunks.begin(), donorChunks.end(), [&](const ChunkType& chunk) {
+        return !chunk.getMin().woCompare(migration.minKey);
+    });
+    invariant(it != donorChunks.end());
+
+    ChunkType chunk = std::move(*it);
+    donorChunks.erase(it);
+
+    chunk.setShard(migration.to);
+    chunk.setJumbo(true);
+    _shardChunks[migration.to].push_back(std::move(chunk));
+}
+
 Status DistributionStatus::addRangeToZone(const ZoneRange& range) {
     const auto minIntersect = _zoneRanges.upper_bound(range.min);
     const auto maxIntersect = _zoneRanges.upper_bound(range.max);
@@ -243,6 +270,9 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
                                                      const set<ShardId>& excludedShards) {
     ShardId best;
     unsigned minChunks = numeric_limits<unsigned>::max();
+    double minOpsPerSec = 0;
+
+    const Seconds maxReplicationLag(balancerMaxRecipientReplicationLagSecs.load());
 
     for (const auto& stat : shardStats) {
         if (excludedShards.count(stat.shardId))
@@ -253,13 +283,22 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
             continue;
         }
 
+        // Don't pile more data onto a shard, whose secondaries are already struggling to keep up
+        if (maxReplicationLag > Seconds(0) && stat.replicationLag > maxReplicationLag) {
+            LOG(1) << "Not using " << stat.shardId << " as a recipient because its replication lag "
+                   << "of " << stat.replicationLag << " exceeds " << maxReplicationLag;
+            continue;
+        }
+
+        // Among shards with the same number of chunks prefer the one with the least load
         unsigned myChunks = distribution.numberOfChunksInShard(stat.shardId);
-        if (myChunks >= minChunks) {
+        if (myChunks > minChunks || (myChunks == minChunks && stat.opsPerSec >= minOpsPerSec)) {
             continue;
         }
 
         best = stat.shardId;
         minChunks = myChunks;
+        minOpsPerSec = stat.opsPerSec;
     }
 
     return best;
@@ -271,18 +310,22 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
                                                 const set<ShardId>& excludedShards) {
     ShardId worst;
     unsigned maxChunks = 0;
+    double maxOpsPerSec = 0;
 
     for (const auto& stat : shardStats) {
         if (excludedShards.count(stat.shardId))
             continue;
 
+        // Among shards with the same number of chunks prefer to offload the busiest one
         const unsigned shardChunkCount =
             distribution.numberOfChunksInShardWithTag(stat.shardId, chunkTag);
-        if (shardChunkCount <= maxChunks)
+        if (shardChunkCount == 0 || shardChunkCount < maxChunks ||
+            (shardChunkCount == maxChunks && stat.opsPerSec <= maxOpsPerSec))
             continue;
 
         worst = stat.shardId;
         maxChunks = shardChunkCount;
+        maxOpsPerSec = stat.opsPerSec;
     }
 
     return worst;
@@ -36,11 +36,16 @@
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_id.h"
 
 namespace mongo {
 
+// Shards whose secondaries lag behind their primary by more than this many seconds are not chosen
+// as recipients by the balancer. Zero disables the check. Exposed so that tests can override it.
+extern AtomicInt32 balancerMaxRecipientReplicationLagSecs;
+
 struct ZoneRange {
     ZoneRange(const BSONObj& a_min, const BSONObj& a_max, const std::string& _zone);
 
@@ -120,6 +125,13 @@ public:
      */
     const std::vector<ChunkType>& getChunks(const ShardId& shardId) const;
 
+    /**
+     * Reflects a migration, which has been selected but not executed yet, so that subsequent
+     * balancing decisions account for it. The chunk is moved to the recipient shard and is marked
+     * as jumbo, so that it does not get selected for another migration in the meantime.
+     */
+    void applyPendingMigration(const MigrateInfo& migration);
+
     /**
      * Returns all tag ranges defined for the collection.
      */
@@ -194,6 +194,73 @@ TEST(BalancerPolicy, ParallelBalancing) {
     ASSERT_BSONOBJ_EQ(cluster.second[kShardId1][0].getMax(), migrations[1].maxKey);
 }
 
+TEST(BalancerPolicy, ApplyPendingMigrationAllowsSecondBalancingPass) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+
+    const auto firstPass(balanceChunks(cluster.first, distribution, false));
+    ASSERT_EQ(1U, firstPass.size());
+    ASSERT_EQ(kShardId0, firstPass[0].from);
+    ASSERT_EQ(kShardId1, firstPass[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), firstPass[0].minKey);
+
+    distribution.applyPendingMigration(firstPass[0]);
+    ASSERT_EQ(7U, distribution.numberOfChunksInShard(kShardId0));
+    ASSERT_EQ(1U, distribution.numberOfChunksInShard(kShardId1));
+
+    // The chunk, which is already scheduled to move must not be picked again
+    const auto secondPass(balanceChunks(cluster.first, distribution, false));
+    ASSERT_EQ(1U, secondPass.size());
+    ASSERT_EQ(kShardId0, secondPass[0].from);
+    ASSERT_EQ(kShardId2, secondPass[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), secondPass[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), secondPass[0].maxKey);
+}
+
+TEST(BalancerPolicy, ReplicationLaggingShardIsNotUsedAsRecipient) {
+    ShardStatistics laggingShard(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion);
+    laggingShard.replicationLag = Seconds(balancerMaxRecipientReplicationLagSecs.load() + 1);
+
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {laggingShard, 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    const auto migrations(
+        balanceChunks(cluster.first, DistributionStatus(kNamespace, cluster.second), false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+}
+
+TEST(BalancerPolicy, LoadBreaksTiesBetweenShardsWithEqualChunkCounts) {
+    ShardStatistics idleDonor(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion);
+    idleDonor.opsPerSec = 10;
+    ShardStatistics busyDonor(kShardId1, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion);
+    busyDonor.opsPerSec = 1000;
+    ShardStatistics busyRecipient(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion);
+    busyRecipient.opsPerSec = 1000;
+    ShardStatistics idleRecipient(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion);
+    idleRecipient.opsPerSec = 10;
+
+    auto cluster = generateCluster(
+        {{idleDonor, 4}, {busyDonor, 4}, {busyRecipient, 0}, {idleRecipient, 0}});
+
+    const auto migrations(
+        balanceChunks(cluster.first, DistributionStatus(kNamespace, cluster.second), false));
+    ASSERT_EQ(2U, migrations.size());
+
+    ASSERT_EQ(kShardId1, migrations[0].from);
+    ASSERT_EQ(kShardId3, migrations[0].to);
+
+    ASSERT_EQ(kShardId0, migrations[1].from);
+    ASSERT_EQ(kShardId2, migrations[1].to);
+}
+
 TEST(BalancerPolicy, ParallelBalancingDoesNotPutChunksOnShardsAboveTheOptimal) {
     auto cluster = generateCluster(
         {{ShardStatistics(kShardId0, kNoMaxSize, 100, false, emptyTagSet, emptyShardVersion), 100},
@@ -72,6 +72,8 @@ BSONObj ClusterStatistics::ShardStatistics::toBSON() const {
     }
 
     builder.append("version", mongoVersion);
+    builder.append("opsPerSec", opsPerSec);
+    builder.append("replicationLagSecs", durationCount<Seconds>(replicationLag));
     return builder.obj();
 }
 
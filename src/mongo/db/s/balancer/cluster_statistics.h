@@ -35,6 +35,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/s/client/shard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -92,6 +93,14 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // Rate of operations per second served by this shard's primary since the previous time
+        // statistics were collected. Zero if not yet measured.
+        double opsPerSec{0};
+
+        // How far the most lagged healthy secondary of this shard is behind its primary. Zero if
+        // the shard is not a replica set or the lag could not be determined.
+        Seconds replicationLag{0};
     };
 
     virtual ~ClusterStatistics();
@@ -33,6 +33,7 @@
 #include "mongo/db/s/balancer/cluster_statistics_impl.h"
 
 #include <algorithm>
+#include <set>
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/util/bson_extract.h"
@@ -48,16 +49,28 @@ namespace mongo {
 namespace {
 
 const char kVersionField[] = "version";
+const char kOpCountersField[] = "opcounters";
+const char kConfigField[] = "config";
+const char kMembersField[] = "members";
+const char kIdField[] = "_id";
+const char kStateField[] = "state";
+const char kHealthField[] = "health";
+const char kOptimeDateField[] = "optimeDate";
+const char kHiddenField[] = "hidden";
+const char kSlaveDelayField[] = "slaveDelay";
+
+// Member states as reported by replSetGetStatus
+const int kPrimaryState = 1;
+const int kSecondaryState = 2;
 
 /**
- * Executes the serverStatus command against the specified shard and obtains the version of the
- * running MongoD service.
- *
- * Returns the MongoD version in strig format or an error. Known error codes are:
+ * Runs the specified command against the primary of the specified shard and returns its response.
+ * Known error codes are:
  *  ShardNotFound if shard by that id is not available on the registry
- *  NoSuchKey if the version could not be retrieved
  */
-StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId shardId) {
+StatusWith<BSONObj> runCommandOnShardPrimary(OperationContext* opCtx,
+                                             const ShardId& shardId,
+                                             const BSONObj& cmdObj) {
     auto shardRegistry = Grid::get(opCtx)->shardRegistry();
     auto shardStatus = shardRegistry->getShard(opCtx, shardId);
     if (!shardStatus.isOK()) {
@@ -69,7 +82,7 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         shard->runCommandWithFixedRetryAttempts(opCtx,
                                                 ReadPreferenceSetting{ReadPreference::PrimaryOnly},
                                                 "admin",
-                                                BSON("serverStatus" << 1),
+                                                cmdObj,
                                                 Shard::RetryPolicy::kIdempotent);
     if (!commandResponse.isOK()) {
         return commandResponse.getStatus();
@@ -78,8 +91,16 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         return commandResponse.getValue().commandStatus;
     }
 
-    BSONObj serverStatus = std::move(commandResponse.getValue().response);
+    return std::move(commandResponse.getValue().response);
+}
 
+/**
+ * Extracts the version of the running MongoD service from its serverStatus response.
+ *
+ * Returns the MongoD version in strig format or an error. Known error codes are:
+ *  NoSuchKey if the version could not be retrieved
+ */
+StatusWith<std::string> extractMongoDVersion(const BSONObj& serverStatus) {
     std::string version;
     Status status = bsonExtractStringField(serverStatus, kVersionField, &version);
     if (!status.isOK()) {
@@ -89,12 +110,113 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
     return version;
 }
 
+/**
+ * Sums up all the operation counters in a serverStatus response. Returns zero if they are not
+ * reported.
+ */
+long long extractTotalOpCounters(const BSONObj& serverStatus) {
+    const auto opCountersElem = serverStatus[kOpCountersField];
+    if (opCountersElem.type() != Object) {
+        return 0;
+    }
+
+    long long totalOps = 0;
+    for (const auto& counter : opCountersElem.Obj()) {
+        if (counter.isNumber()) {
+            totalOps += counter.safeNumberLong();
+        }
+    }
+
+    return totalOps;
+}
+
+/**
+ * Executes the replSetGetStatus and replSetGetConfig commands against the specified shard and
+ * computes how far its most lagged healthy secondary is behind the primary. Returns zero for
+ * shards, which are not replica sets or have no secondaries.
+ */
+StatusWith<Seconds> retrieveShardReplicationLag(OperationContext* opCtx, const ShardId& shardId) {
+    auto replSetStatus = runCommandOnShardPrimary(opCtx, shardId, BSON("replSetGetStatus" << 1));
+    if (replSetStatus == ErrorCodes::NoReplicationEnabled) {
+        return Seconds(0);
+    }
+    if (!replSetStatus.isOK()) {
+        return replSetStatus.getStatus();
+    }
+
+    auto replSetConfig = runCommandOnShardPrimary(opCtx, shardId, BSON("replSetGetConfig" << 1));
+    if (!replSetConfig.isOK()) {
+        return replSetConfig.getStatus();
+    }
+
+    return ClusterStatisticsImpl::computeReplicationLag(replSetStatus.getValue(),
+                                                        replSetConfig.getValue());
+}
+
 }  // namespace
 
 using ShardStatistics = ClusterStatistics::ShardStatistics;
 
 ClusterStatisticsImpl::ClusterStatisticsImpl(BalancerRandomSource& random) : _random(random) {}
 
+StatusWith<Seconds> ClusterStatisticsImpl::computeReplicationLag(const BSONObj& replSetStatus,
+                                                                 const BSONObj& replSetConfig) {
+    const auto configElem = replSetConfig[kConfigField];
+    if (configElem.type() != Object || configElem.Obj()[kMembersField].type() != Array) {
+        return {ErrorCodes::NoSuchKey,
+                str::stream() << "replSetGetConfig response has no members: " << replSetConfig};
+    }
+
+    std::set<int> exemptMemberIds;
+    for (const auto& memberElem : configElem.Obj()[kMembersField].Obj()) {
+        if (memberElem.type() != Object) {
+            continue;
+        }
+        const auto member = memberElem.Obj();
+        if (member[kHiddenField].trueValue() || member[kSlaveDelayField].safeNumberLong() > 0) {
+            exemptMemberIds.insert(member[kIdField].numberInt());
+        }
+    }
+
+    const auto membersElem = replSetStatus[kMembersField];
+    if (membersElem.type() != Array) {
+        return {ErrorCodes::NoSuchKey,
+                str::stream() << "replSetGetStatus response has no members: " << replSetStatus};
+    }
+
+    boost::optional<Date_t> primaryOpTimeDate;
+    boost::optional<Date_t> oldestSecondaryOpTimeDate;
+
+    for (const auto& memberElem : membersElem.Obj()) {
+        if (memberElem.type() != Object) {
+            continue;
+        }
+        const auto member = memberElem.Obj();
+        if (member[kOptimeDateField].type() != Date) {
+            continue;
+        }
+
+        const auto opTimeDate = member[kOptimeDateField].Date();
+        const auto state = member[kStateField].numberInt();
+
+        if (state == kPrimaryState) {
+            primaryOpTimeDate = opTimeDate;
+        } else if (state == kSecondaryState && member[kHealthField].numberInt() == 1 &&
+                   !exemptMemberIds.count(member[kIdField].numberInt())) {
+            if (!oldestSecondaryOpTimeDate || opTimeDate < *oldestSecondaryOpTimeDate) {
+                oldestSecondaryOpTimeDate = opTimeDate;
+            }
+        }
+    }
+
+    if (!primaryOpTimeDate || !oldestSecondaryOpTimeDate ||
+        *oldestSecondaryOpTimeDate >= *primaryOpTimeDate) {
+        return Seconds(0);
+    }
+
+    return duration_cast<Seconds>(*primaryOpTimeDate - *oldestSecondaryOpTimeDate);
+}
+
 ClusterStatisticsImpl::~ClusterStatisticsImpl() = default;
 
 StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationContext* opCtx) {
@@ -133,8 +255,13 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
         }
 
         std::string mongoDVersion;
+        double opsPerSec = 0;
 
-        auto mongoDVersionStatus = retrieveShardMongoDVersion(opCtx, shard.getName());
+        auto serverStatus =
+            runCommandOnShardPrimary(opCtx, shard.getName(), BSON("serverStatus" << 1));
+        auto mongoDVersionStatus = serverStatus.isOK()
+            ? extractMongoDVersion(serverStatus.getValue())
+            : StatusWith<std::string>(serverStatus.getStatus());
         if (mongoDVersionStatus.isOK()) {
             mongoDVersion = std::move(mongoDVersionStatus.getValue());
         } else {
@@ -144,6 +271,24 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
                   << causedBy(mongoDVersionStatus.getStatus());
         }
 
+        if (serverStatus.isOK()) {
+            opsPerSec = _updateOpsPerSec(shard.getName(),
+                                         extractTotalOpCounters(serverStatus.getValue()),
+                                         Date_t::now());
+        }
+
+        // The replication lag is only used to throttle migrations to the shard, so failing to
+        // obtain it should not fail the entire round either
+        Seconds replicationLag(0);
+
+        auto replicationLagStatus = retrieveShardReplicationLag(opCtx, shard.getName());
+        if (replicationLagStatus.isOK()) {
+            replicationLag = replicationLagStatus.getValue();
+        } else {
+            LOG(1) << "Unable to obtain replication lag for " << shard.getName()
+                   << causedBy(replicationLagStatus.getStatus());
+        }
+
         std::set<std::string> shardTags;
 
         for (const auto& shardTag : shard.getTags()) {
@@ -156,9 +301,35 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+        stats.back().opsPerSec = opsPerSec;
+        stats.back().replicationLag = replicationLag;
     }
 
     return stats;
 }
 
+double ClusterStatisticsImpl::_updateOpsPerSec(const ShardId& shardId,
+                                               long long totalOps,
+                                               Date_t now) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _opCountersSamples.find(shardId);
+    if (it == _opCountersSamples.end()) {
+        _opCountersSamples.emplace(shardId, OpCountersSample{totalOps, now});
+        return 0;
+    }
+
+    const auto previousSample = it->second;
+    it->second = OpCountersSample{totalOps, now};
+
+    // The counters go backwards if the primary restarted or changed, in which case the rate cannot
+    // be measured until the next sample
+    const auto elapsed = now - previousSample.sampledAt;
+    if (totalOps < previousSample.totalOps || elapsed <= Milliseconds(0)) {
+        return 0;
+    }
+
+    return (totalOps - previousSample.totalOps) * 1000.0 / durationCount<Milliseconds>(elapsed);
+}
+
 }  // namespace mongo
@@ -28,15 +28,20 @@
 
 #pragma once
 
+#include <map>
+
 #include "mongo/db/s/balancer/balancer_random.h"
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
 /**
  * Default implementation for the cluster statistics gathering utility. Uses a blocking method to
- * fetch the statistics and does not perform any caching. If any of the shards fails to report
- * statistics fails the entire refresh.
+ * fetch the statistics and does not perform any caching, except for the previous sample of each
+ * shard's operation counters, which is needed in order to measure its load. If any of the shards
+ * fails to report statistics fails the entire refresh.
  */
 class ClusterStatisticsImpl final : public ClusterStatistics {
 public:
@@ -45,9 +50,39 @@ public:
 
     StatusWith<std::vector<ShardStatistics>> getStats(OperationContext* opCtx) override;
 
+    /**
+     * Computes how far the most lagged healthy secondary of a replica set is behind its primary
+     * from the set's replSetGetStatus and replSetGetConfig responses. Hidden and delayed members
+     * are not counted, since they are behind by design. Returns zero if there is no primary or no
+     * counted secondary.
+     */
+    static StatusWith<Seconds> computeReplicationLag(const BSONObj& replSetStatus,
+                                                     const BSONObj& replSetConfig);
+
 private:
+    /**
+     * Sample of the cumulative operation counters of a shard's primary, used to derive the rate of
+     * operations between two consecutive calls to getStats.
+     */
+    struct OpCountersSample {
+        long long totalOps;
+        Date_t sampledAt;
+    };
+
+    /**
+     * Records 'totalOps' as the latest sample for 'shardId' and returns the rate of operations per
+     * second since the previous sample, or zero if there was none.
+     */
+    double _updateOpsPerSec(const ShardId& shardId, long long totalOps, Date_t now);
+
     // Source of randomness when metadata needs to be randomized.
     BalancerRandomSource& _random;
+
+    // Protects _opCountersSamples
+    stdx::mutex _mutex;
+
+    // Latest operation counters sample for each shard
+    std::map<ShardId, OpCountersSample> _opCountersSamples;
 };
 
 }  // namespace mongo
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/db/s/balancer/cluster_statistics_impl.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -47,5 +48,50 @@ TEST(ShardStatistics, SizeMaxedTest) {
                .isSizeMaxed());
 }
 
+BSONObj makeMemberStatus(int id, int state, Date_t optimeDate) {
+    return BSON("_id" << id << "health" << 1 << "state" << state << "optimeDate" << optimeDate);
+}
+
+TEST(ClusterStatisticsImpl, ReplicationLagIsThatOfTheMostLaggedSecondary) {
+    const auto now = Date_t::now();
+    const auto status = BSON("members" << BSON_ARRAY(makeMemberStatus(0, 1, now)
+                                                     << makeMemberStatus(1, 2, now - Seconds(5))
+                                                     << makeMemberStatus(2, 2, now - Seconds(1))));
+    const auto config = BSON("config" << BSON("members" << BSON_ARRAY(BSON("_id" << 0)
+                                                                      << BSON("_id" << 1)
+                                                                      << BSON("_id" << 2))));
+    ASSERT_EQ(Seconds(5),
+              unittest::assertGet(ClusterStatisticsImpl::computeReplicationLag(status, config)));
+}
+
+TEST(ClusterStatisticsImpl, ReplicationLagIgnoresHiddenAndDelayedMembers) {
+    const auto now = Date_t::now();
+    const auto status = BSON("members" << BSON_ARRAY(makeMemberStatus(0, 1, now)
+                                                     << makeMemberStatus(1, 2, now - Seconds(1))
+                                                     << makeMemberStatus(2, 2, now - Hours(1))
+                                                     << makeMemberStatus(3, 2, now - Minutes(10))));
+    const auto config = BSON(
+        "config" << BSON("members" << BSON_ARRAY(
+                             BSON("_id" << 0) << BSON("_id" << 1)
+                                              << BSON("_id" << 2 << "hidden" << true << "priority"
+                                                            << 0
+                                                            << "slaveDelay"
+                                                            << 3600)
+                                              << BSON("_id" << 3 << "hidden" << true << "priority"
+                                                            << 0))));
+    ASSERT_EQ(Seconds(1),
+              unittest::assertGet(ClusterStatisticsImpl::computeReplicationLag(status, config)));
+}
+
+TEST(ClusterStatisticsImpl, ReplicationLagRequiresMembers) {
+    const auto config = BSON("config" << BSON("members" << BSONArray()));
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              ClusterStatisticsImpl::computeReplicationLag(BSON("ok" << 1), config).getStatus());
+    ASSERT_EQ(ErrorCodes::NoSuchKey,
+              ClusterStatisticsImpl::computeReplicationLag(
+                  BSON("members" << BSONArray()), BSON("ok" << 1))
+                  .getStatus());
+}
+
 }  // namespace
 }  // namespace mongo
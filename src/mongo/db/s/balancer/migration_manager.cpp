@@ -32,7 +32,10 @@
 
 #include "mongo/db/s/balancer/migration_manager.h"
 
+#include <algorithm>
+#include <list>
 #include <memory>
+#include <set>
 
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
@@ -122,38 +125,90 @@ MigrationStatuses MigrationManager::executeMigrationsForAutoBalance(
 
     {
         std::map<MigrationIdentifier, ScopedMigrationRequest> scopedMigrationRequests;
-        vector<std::pair<shared_ptr<Notification<RemoteCommandResponse>>, MigrateInfo>> responses;
-
-        for (const auto& migrateInfo : migrateInfos) {
-            // Write a document to the config.migrations collection, in case this migration must be
-            // recovered by the Balancer. Fail if the chunk is already moving.
-            auto statusWithScopedMigrationRequest =
-                ScopedMigrationRequest::writeMigration(opCtx, migrateInfo, waitForDelete);
-            if (!statusWithScopedMigrationRequest.isOK()) {
-                migrationStatuses.emplace(migrateInfo.getName(),
-                                          std::move(statusWithScopedMigrationRequest.getStatus()));
+        std::list<std::pair<shared_ptr<Notification<RemoteCommandResponse>>, MigrateInfo>>
+            responses;
+
+        // Shards execute one migration at a time, so the balancer may have selected several
+        // migrations for the same shard. These are started one after another, in the order in
+        // which they were selected, as soon as the shards they involve become idle.
+        std::list<MigrateInfo> pendingMigrations(migrateInfos.begin(), migrateInfos.end());
+        std::set<ShardId> busyShards;
+
+        while (!pendingMigrations.empty() || !responses.empty()) {
+            // A migration must not overtake an earlier selected one, which involves the same shard
+            std::set<ShardId> blockedShards(busyShards);
+
+            for (auto it = pendingMigrations.begin(); it != pendingMigrations.end();) {
+                const bool canStart =
+                    !blockedShards.count(it->from) && !blockedShards.count(it->to);
+                blockedShards.insert(it->from);
+                blockedShards.insert(it->to);
+
+                if (!canStart) {
+                    ++it;
+                    continue;
+                }
+
+                const MigrateInfo migrateInfo = std::move(*it);
+                it = pendingMigrations.erase(it);
+
+                // Write a document to the config.migrations collection, in case this migration
+                // must be recovered by the Balancer. Fail if the chunk is already moving.
+                auto statusWithScopedMigrationRequest =
+                    ScopedMigrationRequest::writeMigration(opCtx, migrateInfo, waitForDelete);
+                if (!statusWithScopedMigrationRequest.isOK()) {
+                    migrationStatuses.emplace(
+                        migrateInfo.getName(),
+                        std::move(statusWithScopedMigrationRequest.getStatus()));
+                    continue;
+                }
+                scopedMigrationRequests.emplace(
+                    migrateInfo.getName(), std::move(statusWithScopedMigrationRequest.getValue()));
+
+                busyShards.insert(migrateInfo.from);
+                busyShards.insert(migrateInfo.to);
+
+                responses.emplace_back(
+                    _schedule(
+                        opCtx, migrateInfo, maxChunkSizeBytes, secondaryThrottle, waitForDelete),
+                    migrateInfo);
+            }
+
+            if (responses.empty()) {
                 continue;
             }
-            scopedMigrationRequests.emplace(migrateInfo.getName(),
-                                            std::move(statusWithScopedMigrationRequest.getValue()));
 
-            responses.emplace_back(
-                _schedule(opCtx, migrateInfo, maxChunkSizeBytes, secondaryThrottle, waitForDelete),
-                migrateInfo);
-        }
+            // Wait for any of the scheduled migrations to complete
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                _condVar.wait(lock, [&responses] {
+                    return std::any_of(
+                        responses.begin(), responses.end(), [](const auto& response) {
+                            return bool(*response.first);
+                        });
+                });
+            }
+
+            for (auto it = responses.begin(); it != responses.end();) {
+                if (!*it->first) {
+                    ++it;
+                    continue;
+                }
 
-        // Wait for all the scheduled migrations to complete.
-        for (auto& response : responses) {
-            auto notification = std::move(response.first);
-            auto migrateInfo = std::move(response.second);
+                const auto& remoteCommandResponse = it->first->get();
+                const auto& migrateInfo = it->second;
 
-            const auto& remoteCommandResponse = notification->get();
+                auto itRequest = scopedMigrationRequests.find(migrateInfo.getName());
+                invariant(itRequest != scopedMigrationRequests.end());
+                Status commandStatus =
+                    _processRemoteCommandResponse(remoteCommandResponse, &itRequest->second);
+                migrationStatuses.emplace(migrateInfo.getName(), std::move(commandStatus));
 
-            auto it = scopedMigrationRequests.find(migrateInfo.getName());
-            invariant(it != scopedMigrationRequests.end());
-            Status commandStatus =
-                _processRemoteCommandResponse(remoteCommandResponse, &it->second);
-            migrationStatuses.emplace(migrateInfo.getName(), std::move(commandStatus));
+                busyShards.erase(migrateInfo.from);
+                busyShards.erase(migrateInfo.to);
+
+                it = responses.erase(it);
+            }
         }
     }
 
@@ -560,6 +615,9 @@ void MigrationManager::_complete(WithLock lock,
     }
 
     notificationToSignal->set(remoteCommandResponse);
+
+    // Wake up the auto-balance round, which may have further migrations waiting for these shards
+    _condVar.notify_all();
 }
 
 void MigrationManager::_checkDrained(WithLock) {
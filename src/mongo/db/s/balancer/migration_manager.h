@@ -72,7 +72,8 @@ public:
     /**
      * A blocking method that attempts to schedule all the migrations specified in
      * "candidateMigrations" and wait for them to complete. Takes the distributed lock for each
-     * collection with a chunk being migrated.
+     * collection with a chunk being migrated. Migrations, which involve the same shard are
+     * executed one after another, in the order in which they appear in "candidateMigrations".
      *
      * If any of the migrations, which were scheduled in parallel fails with a LockBusy error
      * reported from the shard, retries it serially without the distributed lock.
@@ -265,7 +266,7 @@ private:
     State _state{State::kStopped};
 
     // Condition variable, which is waited on when the migration manager's state is changing and
-    // signaled when the state change is complete.
+    // signaled when the state change is complete. Also signaled whenever a migration completes.
     stdx::condition_variable _condVar;
 
     // Maps collection namespaces to that collection's active migrations.
@@ -333,6 +333,64 @@ TEST_F(MigrationManagerTest, OneCollectionTwoMigrations) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationManagerTest, MigrationsOnTheSameShardRunOneAfterAnother) {
+    // Set up two shards in the metadata.
+    ASSERT_OK(catalogClient()->insertConfigDocument(
+        operationContext(), ShardType::ConfigNS, kShard0, kMajorityWriteConcern));
+    ASSERT_OK(catalogClient()->insertConfigDocument(
+        operationContext(), ShardType::ConfigNS, kShard2, kMajorityWriteConcern));
+
+    // Set up the database and collection as sharded in the metadata.
+    const std::string dbName = "foo";
+    const NamespaceString collName(dbName, "bar");
+    ChunkVersion version(2, 0, OID::gen());
+
+    setUpDatabase(dbName, kShardId0);
+    setUpCollection(collName, version);
+
+    // Set up three chunks in the metadata, two of which are on the same shard.
+    ChunkType chunk1 =
+        setUpChunk(collName, kKeyPattern.globalMin(), BSON(kPattern << 33), kShardId0, version);
+    version.incMinor();
+    ChunkType chunk2 =
+        setUpChunk(collName, BSON(kPattern << 33), BSON(kPattern << 66), kShardId0, version);
+    version.incMinor();
+    ChunkType chunk3 =
+        setUpChunk(collName, BSON(kPattern << 66), kKeyPattern.globalMax(), kShardId2, version);
+
+    // Going to request that these three chunks get migrated. The second migration involves the
+    // same shards as the first one, so it must only start after the first one completes.
+    const std::vector<MigrateInfo> migrationRequests{
+        {kShardId1, chunk1}, {kShardId1, chunk2}, {kShardId3, chunk3}};
+
+    auto future = launchAsync([this, migrationRequests] {
+        ON_BLOCK_EXIT([&] { Client::destroy(); });
+        Client::initThreadIfNotAlready("Test");
+        auto opCtx = cc().makeOperationContext();
+
+        // Scheduling the moveChunk commands requires finding a host to which to send the command.
+        // Set up dummy hosts for the source shards.
+        shardTargeterMock(opCtx.get(), kShardId0)->setFindHostReturnValue(kShardHost0);
+        shardTargeterMock(opCtx.get(), kShardId2)->setFindHostReturnValue(kShardHost2);
+
+        MigrationStatuses migrationStatuses = _migrationManager->executeMigrationsForAutoBalance(
+            opCtx.get(), migrationRequests, 0, kDefaultSecondaryThrottle, false);
+
+        for (const auto& migrateInfo : migrationRequests) {
+            ASSERT_OK(migrationStatuses.at(migrateInfo.getName()));
+        }
+    });
+
+    // The migration of the third chunk overtakes the one of the second chunk, which has to wait
+    // for its shards to become available.
+    expectMoveChunkCommand(chunk1, kShardId1, Status::OK());
+    expectMoveChunkCommand(chunk3, kShardId3, Status::OK());
+    expectMoveChunkCommand(chunk2, kShardId1, Status::OK());
+
+    // Run the MigrationManager code.
+    future.timed_get(kFutureTimeout);
+}
+
 TEST_F(MigrationManagerTest, TwoCollectionsTwoMigrationsEach) {
     // Set up two shards in the metadata.
     ASSERT_OK(catalogClient()->insertConfigDocument(
@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog_raii.h"
@@ -48,15 +49,18 @@
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/repl_client_info.h"
+#include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_runtime.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -68,6 +72,54 @@ MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchDelayMS, int, 20)
         return Status::OK();
     });
 
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 128)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue, "rangeDeleterBatchSize must be at least 1");
+        }
+        return Status::OK();
+    });
+
+// Upper bound for the number of documents deleted by a single batch of deletions.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxBatchSize, int, 1024)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue, "rangeDeleterMaxBatchSize must be at least 1");
+        }
+        return Status::OK();
+    });
+
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterDocsPerWriteUnit, int, 16)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 1000) {
+            return Status(ErrorCodes::BadValue,
+                          "rangeDeleterDocsPerWriteUnit must be between 1 and 1000");
+        }
+        return Status::OK();
+    });
+
+// Range deletion backs off while the majority commit point lags the last applied operation by
+// more than this many seconds. Zero disables the check.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxMajorityLagSecs, int, 10)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "rangeDeleterMaxMajorityLagSecs must not be negative");
+        }
+        return Status::OK();
+    });
+
+// Range deletion backs off while more than this percentage of the storage engine's cache is dirty.
+// Zero disables the check.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxDirtyCachePercent, int, 10)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0 || newVal > 100) {
+            return Status(ErrorCodes::BadValue,
+                          "rangeDeleterMaxDirtyCachePercent must be between 0 and 100");
+        }
+        return Status::OK();
+    });
+
 namespace {
 
 using Deletion = CollectionRangeDeleter::Deletion;
@@ -90,6 +142,127 @@ boost::optional<DeleteNotification> checkOverlap(std::list<Deletion> const& dele
     return boost::none;
 }
 
+// Longest delay between two batches of deletions, regardless of how far behind the node is
+const Milliseconds kMaxBatchDelay = Seconds(1);
+
+/**
+ * Returns how far the node is beyond the limits on majority commit lag and dirty cache, which
+ * range deletion should respect. A value of 1 or more means at least one limit is exceeded.
+ */
+double getNodePressure(OperationContext* opCtx) {
+    double pressure = 0;
+
+    const int maxLagSecs = rangeDeleterMaxMajorityLagSecs.load();
+    auto const replCoord = repl::ReplicationCoordinator::get(opCtx);
+    if (maxLagSecs > 0 &&
+        replCoord->getReplicationMode() == repl::ReplicationCoordinator::modeReplSet) {
+        const auto lastApplied = replCoord->getMyLastAppliedOpTime();
+        const auto lastCommitted = replCoord->getLastCommittedOpTime();
+        if (!lastCommitted.isNull() && lastCommitted < lastApplied) {
+            const double lagSecs = double(lastApplied.getTimestamp().getSecs()) -
+                lastCommitted.getTimestamp().getSecs();
+            pressure = std::max(pressure, lagSecs / maxLagSecs);
+        }
+    }
+
+    const int maxDirtyPercent = rangeDeleterMaxDirtyCachePercent.load();
+    auto const storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    if (maxDirtyPercent > 0 && storageEngine) {
+        if (const auto dirtyFraction = storageEngine->getCacheDirtyFraction()) {
+            pressure = std::max(pressure, *dirtyFraction * 100 / maxDirtyPercent);
+        }
+    }
+
+    return pressure;
+}
+
+/**
+ * Process-wide state shared by the range deleters of all collections. Keeps the size of the
+ * deletion batches and the delay between them, along with the statistics reported in
+ * serverStatus.
+ */
+class RangeDeleterThrottle {
+public:
+    int getNextBatchSize(double pressure) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        const int initialBatchSize = rangeDeleterBatchSize.load();
+        const int maxBatchSize = std::max(initialBatchSize, rangeDeleterMaxBatchSize.load());
+        const Milliseconds minDelay(rangeDeleterBatchDelayMS.load());
+
+        int batchSize = _batchSize ? _batchSize : initialBatchSize;
+        Milliseconds delay = std::max(_delay, minDelay);
+
+        if (pressure >= 1) {
+            // Back off quickly, so replication and cache eviction can catch up
+            batchSize = batchSize / 2;
+            delay = std::min(std::max(delay * 2, Milliseconds(10)), kMaxBatchDelay);
+            _numThrottledBatches++;
+        } else if (pressure < 0.5) {
+            // Speed up gradually while there is plenty of headroom
+            batchSize = batchSize + batchSize / 2 + 1;
+            delay = delay / 2;
+        }
+
+        _batchSize = std::min(std::max(batchSize, 1), maxBatchSize);
+        _delay = std::max(delay, minDelay);
+
+        return _batchSize;
+    }
+
+    Milliseconds getDelay() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return std::max(_delay, Milliseconds(rangeDeleterBatchDelayMS.load()));
+    }
+
+    void recordBatch(long long numDocs, long long numBytes, Milliseconds elapsed) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        _numDocsDeleted += numDocs;
+        _numBytesDeleted += numBytes;
+        _deletionTime += elapsed;
+
+        // Exponentially weighted, so the reported rate follows the current throughput
+        const double bytesPerSec =
+            double(numBytes) * 1000 / std::max(elapsed, Milliseconds(1)).count();
+        _bytesPerSec = _bytesPerSec * 0.8 + bytesPerSec * 0.2;
+    }
+
+    void append(BSONObjBuilder* builder) const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        builder->append("rangesQueued", numRangesQueued.load());
+        builder->append("docsDeleted", _numDocsDeleted);
+        builder->append("bytesDeleted", _numBytesDeleted);
+        builder->append("totalDeletionTimeMillis", durationCount<Milliseconds>(_deletionTime));
+        builder->append("bytesPerSec", static_cast<long long>(_bytesPerSec));
+        builder->append("batchSize", _batchSize ? _batchSize : rangeDeleterBatchSize.load());
+        builder->append(
+            "batchDelayMillis",
+            durationCount<Milliseconds>(
+                std::max(_delay, Milliseconds(rangeDeleterBatchDelayMS.load()))));
+        builder->append("throttledBatches", _numThrottledBatches);
+    }
+
+    // Number of ranges scheduled for deletion across all collections
+    AtomicInt64 numRangesQueued{0};
+
+private:
+    mutable stdx::mutex _mutex;
+
+    // Zero until the first batch size has been chosen
+    int _batchSize{0};
+    Milliseconds _delay{0};
+
+    long long _numDocsDeleted{0};
+    long long _numBytesDeleted{0};
+    long long _numThrottledBatches{0};
+    Milliseconds _deletionTime{0};
+    double _bytesPerSec{0};
+};
+
+RangeDeleterThrottle rangeDeleterThrottle;
+
 }  // namespace
 
 CollectionRangeDeleter::CollectionRangeDeleter() = default;
@@ -107,6 +280,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     CollectionRangeDeleter* forTestOnly) {
 
     StatusWith<int> wrote = 0;
+    long long bytesDeleted = 0;
 
     auto range = boost::optional<ChunkRange>(boost::none);
     auto notification = DeleteNotification();
@@ -207,13 +381,23 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
             }
         }
 
+        Timer deletionTimer;
         try {
-            wrote = self->_doDeletion(
-                opCtx, collection, scopedCollectionMetadata->getKeyPattern(), *range, maxToDelete);
+            wrote = self->_doDeletion(opCtx,
+                                      collection,
+                                      scopedCollectionMetadata->getKeyPattern(),
+                                      *range,
+                                      maxToDelete,
+                                      &bytesDeleted);
         } catch (const DBException& e) {
             wrote = e.toStatus();
             warning() << e.what();
         }
+
+        if (wrote.isOK() && wrote.getValue() > 0) {
+            rangeDeleterThrottle.recordBatch(
+                wrote.getValue(), bytesDeleted, Milliseconds(deletionTimer.millis()));
+        }
     }  // drop autoColl
 
     if (!wrote.isOK() || wrote.getValue() == 0) {
@@ -278,7 +462,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
                    << redact(self->_orphans.front().range.toString()) << " next.";
         }
 
-        return Date_t::now() + stdx::chrono::milliseconds{rangeDeleterBatchDelayMS.load()};
+        return Date_t::now() + rangeDeleterThrottle.getDelay();
     }
 
     invariant(range);
@@ -286,14 +470,23 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     invariant(wrote.getValue() > 0);
 
     notification.abandon();
-    return Date_t::now() + stdx::chrono::milliseconds{rangeDeleterBatchDelayMS.load()};
+    return Date_t::now() + rangeDeleterThrottle.getDelay();
+}
+
+int CollectionRangeDeleter::getNextBatchSize(OperationContext* opCtx) {
+    return rangeDeleterThrottle.getNextBatchSize(getNodePressure(opCtx));
+}
+
+void CollectionRangeDeleter::appendStats(BSONObjBuilder* builder) {
+    rangeDeleterThrottle.append(builder);
 }
 
 StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
                                                     Collection* collection,
                                                     BSONObj const& keyPattern,
                                                     ChunkRange const& range,
-                                                    int maxToDelete) {
+                                                    int maxToDelete,
+                                                    long long* bytesDeleted) {
     invariant(collection != nullptr);
     invariant(!isEmpty());
 
@@ -343,32 +536,66 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
     auto exec = InternalPlanner::indexScan(
         opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
 
+    const int docsPerWriteUnit = rangeDeleterDocsPerWriteUnit.load();
+
+    struct DocToDelete {
+        RecordId recordId;
+        BSONObj obj;  // Only kept if the document needs to be saved before deletion
+    };
+    std::vector<DocToDelete> docsToDelete;
+
     int numDeleted = 0;
-    do {
-        RecordId rloc;
-        BSONObj obj;
-        PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
-        if (state == PlanExecutor::IS_EOF) {
-            break;
+    bool isEOF = false;
+    while (!isEOF && numDeleted < maxToDelete) {
+        // Collect the next documents in shard key order and then delete them together, in a single
+        // storage engine transaction
+        docsToDelete.clear();
+        const int writeUnitSize = std::min(docsPerWriteUnit, maxToDelete - numDeleted);
+        long long writeUnitBytes = 0;
+
+        while (int(docsToDelete.size()) < writeUnitSize) {
+            RecordId rloc;
+            BSONObj obj;
+            PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+            if (state == PlanExecutor::IS_EOF) {
+                isEOF = true;
+                break;
+            }
+            if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                warning() << PlanExecutor::statestr(state)
+                          << " - cursor error while trying to delete " << redact(min) << " to "
+                          << redact(max) << " in " << nss << ": "
+                          << redact(WorkingSetCommon::toStatusString(obj))
+                          << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                isEOF = true;
+                break;
+            }
+            invariant(PlanExecutor::ADVANCED == state);
+
+            writeUnitBytes += obj.objsize();
+            docsToDelete.push_back({rloc, saver ? obj.getOwned() : BSONObj()});
         }
-        if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
-            warning() << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
-                      << redact(min) << " to " << redact(max) << " in " << nss << ": "
-                      << redact(WorkingSetCommon::toStatusString(obj))
-                      << ", stats: " << Explain::getWinningPlanStats(exec.get());
+
+        if (docsToDelete.empty()) {
             break;
         }
-        invariant(PlanExecutor::ADVANCED == state);
 
         exec->saveState();
         writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
             WriteUnitOfWork wuow(opCtx);
-            if (saver) {
-                uassertStatusOK(saver->goingToDelete(obj));
+            for (const auto& doc : docsToDelete) {
+                if (saver) {
+                    uassertStatusOK(saver->goingToDelete(doc.obj));
+                }
+                collection->deleteDocument(
+                    opCtx, kUninitializedStmtId, doc.recordId, nullptr, true);
             }
-            collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             wuow.commit();
         });
+
+        numDeleted += docsToDelete.size();
+        *bytesDeleted += writeUnitBytes;
+
         auto restoreStateStatus = exec->restoreState();
         if (!restoreStateStatus.isOK()) {
             warning() << "error restoring cursor state while trying to delete " << redact(min)
@@ -377,8 +604,7 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
                       << redact(restoreStateStatus);
             break;
         }
-
-    } while (++numDeleted < maxToDelete);
+    }
 
     return numDeleted;
 }
@@ -398,6 +624,8 @@ boost::optional<Date_t> CollectionRangeDeleter::add(std::list<Deletion> ranges)
     const bool wasScheduledImmediate = !_orphans.empty();
     const bool wasScheduledLater = !_delayedOrphans.empty();
 
+    rangeDeleterThrottle.numRangesQueued.addAndFetch(ranges.size());
+
     while (!ranges.empty()) {
         if (ranges.front().whenToDelete != Date_t{}) {
             _delayedOrphans.splice(_delayedOrphans.end(), ranges, ranges.begin());
@@ -443,6 +671,8 @@ bool CollectionRangeDeleter::isEmpty() const {
 }
 
 void CollectionRangeDeleter::clear(Status status) {
+    rangeDeleterThrottle.numRangesQueued.subtractAndFetch(size());
+
     for (auto& range : _orphans) {
         range.notification.notify(status);  // wake up anything still waiting
     }
@@ -456,6 +686,7 @@ void CollectionRangeDeleter::clear(Status status) {
 void CollectionRangeDeleter::_pop(Status result) {
     _orphans.front().notification.notify(result);  // wake up waitForClean
     _orphans.pop_front();
+    rangeDeleterThrottle.numRangesQueued.subtractAndFetch(1);
 }
 
 // DeleteNotification
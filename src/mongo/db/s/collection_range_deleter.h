@@ -32,6 +32,7 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/time_support.h"
@@ -39,13 +40,21 @@
 namespace mongo {
 
 class BSONObj;
+class BSONObjBuilder;
 class Collection;
 class OperationContext;
 
-// After completing a batch of document deletions, the time in millis to wait before commencing the
-// next batch of deletions.
+// After completing a batch of document deletions, the minimum time in millis to wait before
+// commencing the next batch of deletions. The actual delay grows while the node is falling behind.
 extern AtomicInt32 rangeDeleterBatchDelayMS;
 
+// Number of documents deleted by the first batch of deletions. Subsequent batches grow up to
+// rangeDeleterMaxBatchSize documents while the node keeps up and shrink while it falls behind.
+extern AtomicInt32 rangeDeleterBatchSize;
+
+// Number of documents deleted within a single storage engine transaction.
+extern AtomicInt32 rangeDeleterDocsPerWriteUnit;
+
 class CollectionRangeDeleter {
     MONGO_DISALLOW_COPYING(CollectionRangeDeleter);
 
@@ -173,19 +182,33 @@ public:
                                                     int maxToDelete,
                                                     CollectionRangeDeleter* forTestOnly = nullptr);
 
+    /**
+     * Returns how many documents the next call to cleanUpNextRange should delete. Shrinks the
+     * batches and lengthens the delay between them while the majority commit point or the storage
+     * engine's cache eviction are falling behind, and grows them back once they have caught up.
+     */
+    static int getNextBatchSize(OperationContext* opCtx);
+
+    /**
+     * Appends the process-wide range deletion statistics for serverStatus.
+     */
+    static void appendStats(BSONObjBuilder* builder);
+
 private:
     /**
-     * Performs the deletion of up to maxToDelete entries within the range in progress. Must be
-     * called under the collection lock.
+     * Performs the deletion of up to maxToDelete entries within the range in progress, in shard key
+     * order and rangeDeleterDocsPerWriteUnit documents at a time. Must be called under the
+     * collection lock.
      *
      * Returns the number of documents deleted, 0 if done with the range, or bad status if deleting
-     * the range failed.
+     * the range failed. Adds the size of the deleted documents to 'bytesDeleted'.
      */
     StatusWith<int> _doDeletion(OperationContext* opCtx,
                                 Collection* collection,
                                 const BSONObj& keyPattern,
                                 ChunkRange const& range,
-                                int maxToDelete);
+                                int maxToDelete,
+                                long long* bytesDeleted);
 
     /**
      * Removes the latest-scheduled range from the ranges to be cleaned up, and notifies any
@@ -45,6 +45,7 @@
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/shard_server_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -234,6 +235,66 @@ TEST_F(CollectionRangeDeleterTest, MultipleCleanupNextRangeCalls) {
     ASSERT_EQUALS(0ULL, dbclient.count(kAdminSysVer.ns(), BSON(kShardKey << "startRangeDeletion")));
 }
 
+// Tests that a batch of deletions spanning several write units deletes exactly the requested number
+// of documents, in shard key order, and is accounted for in the statistics.
+TEST_F(CollectionRangeDeleterTest, BatchSpanningMultipleWriteUnits) {
+    const int originalDocsPerWriteUnit = rangeDeleterDocsPerWriteUnit.load();
+    ON_BLOCK_EXIT([&] { rangeDeleterDocsPerWriteUnit.store(originalDocsPerWriteUnit); });
+    rangeDeleterDocsPerWriteUnit.store(3);
+
+    const auto getDocsDeleted = [] {
+        BSONObjBuilder builder;
+        CollectionRangeDeleter::appendStats(&builder);
+        return builder.obj()["docsDeleted"].numberLong();
+    };
+    const auto docsDeletedBefore = getDocsDeleted();
+
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 0; i < 10; i++) {
+        dbclient.insert(kNss.toString(), BSON(kShardKey << i));
+    }
+
+    std::list<Deletion> ranges;
+    ranges.emplace_back(
+        Deletion{ChunkRange(BSON(kShardKey << 0), BSON(kShardKey << 10)), Date_t{}});
+    auto when = rangeDeleter.add(std::move(ranges));
+    ASSERT(when && *when == Date_t{});
+
+    ASSERT_TRUE(next(rangeDeleter, 7));
+    ASSERT_EQUALS(3ULL, dbclient.count(kNss.toString(), BSON(kShardKey << LT << 10)));
+    ASSERT_EQUALS(3ULL, dbclient.count(kNss.toString(), BSON(kShardKey << GTE << 7)));
+    ASSERT_EQUALS(docsDeletedBefore + 7, getDocsDeleted());
+
+    ASSERT_TRUE(next(rangeDeleter, 7));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSON(kShardKey << LT << 10)));
+    ASSERT_EQUALS(docsDeletedBefore + 10, getDocsDeleted());
+
+    ASSERT_TRUE(next(rangeDeleter, 7));
+    ASSERT_FALSE(next(rangeDeleter, 7));
+}
+
+// Tests that without replication lag or cache pressure the batches grow up to the configured limit.
+TEST_F(CollectionRangeDeleterTest, BatchSizeGrowsUpToMaximumWithoutPressure) {
+    const int originalBatchSize = rangeDeleterBatchSize.load();
+    ON_BLOCK_EXIT([&] { rangeDeleterBatchSize.store(originalBatchSize); });
+    rangeDeleterBatchSize.store(4);
+
+    int batchSize = 0;
+    for (int i = 0; i < 50; i++) {
+        const int nextBatchSize = CollectionRangeDeleter::getNextBatchSize(operationContext());
+        ASSERT_GTE(nextBatchSize, batchSize);
+        batchSize = nextBatchSize;
+    }
+
+    BSONObjBuilder builder;
+    CollectionRangeDeleter::appendStats(&builder);
+    const auto stats = builder.obj();
+    ASSERT_EQ(batchSize, stats["batchSize"].numberInt());
+    ASSERT_EQ(rangeDeleterBatchDelayMS.load(), stats["batchDelayMillis"].numberInt());
+    ASSERT_GT(batchSize, 4);
+}
+
 // Tests the case that there are two ranges to clean, each containing multiple documents.
 TEST_F(CollectionRangeDeleterTest, MultipleDocumentsInMultipleRangesToClean) {
     CollectionRangeDeleter rangeDeleter;
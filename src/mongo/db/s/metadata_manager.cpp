@@ -147,10 +147,10 @@ void scheduleCleanup(executor::TaskExecutor* executor,
             auto uniqueOpCtx = Client::getCurrent()->makeOperationContext();
             auto opCtx = uniqueOpCtx.get();
 
-            const int maxToDelete = std::max(int(internalQueryExecYieldIterations.load()), 1);
-
             MONGO_FAIL_POINT_PAUSE_WHILE_SET(suspendRangeDeletion);
 
+            const int maxToDelete = CollectionRangeDeleter::getNextBatchSize(opCtx);
+
             auto next = CollectionRangeDeleter::cleanUpNextRange(opCtx, nss, epoch, maxToDelete);
             if (next) {
                 scheduleCleanup(executor, std::move(nss), std::move(epoch), *next);
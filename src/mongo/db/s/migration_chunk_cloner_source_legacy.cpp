@@ -37,7 +37,6 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/dbhelpers.h"
-#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/query/internal_plans.h"
@@ -57,6 +56,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -88,45 +88,6 @@ BSONObj createRequestWithSessionId(StringData commandName,
 
 }  // namespace
 
-/**
- * Used to receive invalidation notifications from operations, which delete documents.
- */
-class DeleteNotificationStage final : public PlanStage {
-public:
-    DeleteNotificationStage(MigrationChunkClonerSourceLegacy* cloner, OperationContext* opCtx)
-        : PlanStage("SHARDING_NOTIFY_DELETE", opCtx), _cloner(cloner) {}
-
-    void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) override {
-        if (type == INVALIDATION_DELETION) {
-            stdx::lock_guard<stdx::mutex> sl(_cloner->_mutex);
-            _cloner->_cloneLocs.erase(dl);
-        }
-    }
-
-    StageState doWork(WorkingSetID* out) override {
-        MONGO_UNREACHABLE;
-    }
-
-    bool isEOF() override {
-        MONGO_UNREACHABLE;
-    }
-
-    std::unique_ptr<PlanStageStats> getStats() override {
-        MONGO_UNREACHABLE;
-    }
-
-    SpecificStats* getSpecificStats() const override {
-        MONGO_UNREACHABLE;
-    }
-
-    StageType stageType() const override {
-        return STAGE_NOTIFY_DELETE;
-    }
-
-private:
-    MigrationChunkClonerSourceLegacy* const _cloner;
-};
-
 /**
  * Used to commit work for LogOpForSharding. Used to keep track of changes in documents that are
  * part of a chunk being migrated.
@@ -200,7 +161,7 @@ MigrationChunkClonerSourceLegacy::MigrationChunkClonerSourceLegacy(MoveChunkRequ
 
 MigrationChunkClonerSourceLegacy::~MigrationChunkClonerSourceLegacy() {
     invariant(_state == kDone);
-    invariant(!_deleteNotifyExec);
+    invariant(!_cloneExec);
 }
 
 Status MigrationChunkClonerSourceLegacy::startClone(OperationContext* opCtx) {
@@ -216,10 +177,10 @@ Status MigrationChunkClonerSourceLegacy::startClone(OperationContext* opCtx) {
         _sessionCatalogSource->fetchNextOplog(opCtx);
     }
 
-    // Load the ids of the currently available documents
-    auto storeCurrentLocsStatus = _storeCurrentLocs(opCtx);
-    if (!storeCurrentLocsStatus.isOK()) {
-        return storeCurrentLocsStatus;
+    // Size the chunk and position the scan, which will stream its documents to the recipient
+    auto prepareCloneScanStatus = _prepareCloneScan(opCtx);
+    if (!prepareCloneScanStatus.isOK()) {
+        return prepareCloneScanStatus;
     }
 
     // Tell the recipient shard to start cloning
@@ -277,17 +238,18 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
 
         stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-        const std::size_t cloneLocsRemaining = _cloneLocs.size();
+        const long long cloneRecordsRemaining = _cloneRecordsRemaining;
 
         log() << "moveChunk data transfer progress: " << redact(res) << " mem used: " << _memoryUsed
-              << " documents remaining to clone: " << cloneLocsRemaining;
+              << " documents remaining to clone: " << cloneRecordsRemaining;
 
         if (res["state"].String() == "steady") {
-            if (cloneLocsRemaining != 0) {
+            if (_cloneExec) {
                 return {ErrorCodes::OperationIncomplete,
                         str::stream() << "Unable to enter critical section because the recipient "
                                          "shard thinks all data is cloned while there are still "
-                                      << cloneLocsRemaining
+                                      << "about "
+                                      << cloneRecordsRemaining
                                       << " documents remaining"};
             }
 
@@ -351,7 +313,11 @@ StatusWith<BSONObj> MigrationChunkClonerSourceLegacy::commitClone(OperationConte
                     "metadata that needs to be transferred"};
         }
 
-        return responseStatus;
+        // Report the donor side of the initial clone along with the recipient's response
+        BSONObjBuilder responseBuilder;
+        responseBuilder.appendElements(responseStatus.getValue());
+        _appendCloneStats(&responseBuilder);
+        return responseBuilder.obj();
     }
 
     cancelClone(opCtx);
@@ -462,7 +428,8 @@ uint64_t MigrationChunkClonerSourceLegacy::getCloneBatchBufferAllocationSize() {
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     return std::min(static_cast<uint64_t>(BSONObjMaxUserSize),
-                    _averageObjectSizeForCloneLocs * _cloneLocs.size());
+                    _averageObjectSizeForClone *
+                        static_cast<uint64_t>(std::max(_cloneRecordsRemaining, 0LL)));
 }
 
 Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
@@ -476,39 +443,80 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
 
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-    std::set<RecordId>::iterator it;
+    // An exhausted scan means that all the initial clone data has been transferred already
+    if (!_cloneExec) {
+        return Status::OK();
+    }
 
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
+    Timer readTimer;
+    if (!_cloneStartDate) {
+        _cloneStartDate = Date_t::now();
+    }
+
+    _cloneExec->reattachToOperationContext(opCtx);
+    auto restoreStatus = _cloneExec->restoreState();
+    if (!restoreStatus.isOK()) {
+        _disposeCloneExec(sl, opCtx, collection);
+        return restoreStatus.withContext("Chunk clone scan was killed between batches");
+    }
+
+    BSONObj obj;
+    PlanExecutor::ExecState state;
+    while (true) {
         // We must always make progress in this method by at least one document because empty return
         // indicates there is no more initial clone data.
         if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
+            state = PlanExecutor::ADVANCED;
             break;
         }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(opCtx, *it, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so that we
-            // take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
-                break;
-            }
+        state = _cloneExec->getNext(&obj, nullptr);
+        if (state != PlanExecutor::ADVANCED) {
+            break;
+        }
 
-            arrBuilder->append(doc.value());
+        if (_clonedIds && _clonedIds->count(obj["_id"].wrap())) {
+            continue;
         }
+
+        // Use the builder size instead of accumulating the document sizes directly so that we
+        // take into consideration the overhead of BSONArray indices. A document, which doesn't fit
+        // is stashed in the executor so that it begins the next batch.
+        if (arrBuilder->arrSize() &&
+            (arrBuilder->len() + obj.objsize() + 1024) > BSONObjMaxUserSize) {
+            _cloneExec->enqueue(obj.getOwned());
+            break;
+        }
+
+        arrBuilder->append(obj);
+        if (_clonedIds) {
+            _clonedIds->insert(obj["_id"].wrap());
+        }
+
+        --_cloneRecordsRemaining;
+        ++_numClonedDocs;
+        _numClonedBytes += obj.objsize();
     }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+    ++_numCloneBatches;
+    _cloneReadTime += Milliseconds(readTimer.millis());
+
+    if (PlanExecutor::DEAD == state || PlanExecutor::FAILURE == state) {
+        _disposeCloneExec(sl, opCtx, collection);
+        return WorkingSetCommon::getMemberObjectStatus(obj).withContext(
+            "Executor error while cloning documents belonging to chunk");
+    }
 
-    // If we have drained all the cloned data, there is no need to keep the delete notify executor
-    // around
-    if (_cloneLocs.empty() && _deleteNotifyExec) {
-        // We have a different OperationContext than when we created the PlanExecutor, so need to
-        // manually destroy it ourselves.
-        _deleteNotifyExec->dispose(opCtx, collection->getCursorManager());
-        _deleteNotifyExec.reset();
+    // If we have drained all the cloned data, there is no need to keep the scan around
+    if (PlanExecutor::IS_EOF == state) {
+        _cloneEndDate = Date_t::now();
+        _disposeCloneExec(sl, opCtx, collection);
+        return Status::OK();
     }
 
+    _cloneExec->saveState();
+    _cloneExec->detachFromOperationContext();
+
     return Status::OK();
 }
 
@@ -520,7 +528,7 @@ Status MigrationChunkClonerSourceLegacy::nextModsBatch(OperationContext* opCtx,
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     // All clone data must have been drained before starting to fetch the incremental changes
-    invariant(_cloneLocs.empty());
+    invariant(!_cloneExec);
 
     long long docSizeAccumulator = 0;
 
@@ -538,21 +546,60 @@ void MigrationChunkClonerSourceLegacy::_cleanup(OperationContext* opCtx) {
         _state = kDone;
         _reload.clear();
         _deleted.clear();
+
+        if (!_cloneExec) {
+            return;
+        }
+    }
+
+    // Don't allow an Interrupt exception to prevent _cloneExec from getting cleaned up.
+    UninterruptibleLockGuard noInterrupt(opCtx->lockState());
+
+    AutoGetCollection autoColl(opCtx, _args.getNss(), MODE_IS);
+
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    _disposeCloneExec(sl, opCtx, autoColl.getCollection());
+}
+
+void MigrationChunkClonerSourceLegacy::_disposeCloneExec(WithLock,
+                                                         OperationContext* opCtx,
+                                                         Collection* collection) {
+    // Implicitly resets _cloneExec to avoid possible invariant failure on destruction of
+    // MigrationChunkClonerSourceLegacy, even if disposing of it throws.
+    auto cloneExec = std::move(_cloneExec);
+    _clonedIds.reset();
+    if (!cloneExec) {
+        return;
     }
-    // Implicitly resets _deleteNotifyExec to avoid possible invariant failure
-    // in on destruction of MigrationChunkClonerSourceLegacy, and will always
-    // call deleteNotifyExec destructor on scope exit even if something in the
-    // below if statement fails
-    auto deleteNotifyExec = std::move(_deleteNotifyExec);
 
-    if (deleteNotifyExec) {
-        // Don't allow an Interrupt exception to prevent _deleteNotifyExec from getting cleaned up.
-        UninterruptibleLockGuard noInterrupt(opCtx->lockState());
+    // We may have a different OperationContext than when we created the PlanExecutor, so need to
+    // manually destroy it ourselves.
+    cloneExec->dispose(opCtx, collection ? collection->getCursorManager() : nullptr);
+}
+
+void MigrationChunkClonerSourceLegacy::_appendCloneStats(BSONObjBuilder* builder) {
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
+
+    const auto cloneTime = (_cloneStartDate && _cloneEndDate) ? *_cloneEndDate - *_cloneStartDate
+                                                              : Milliseconds(0);
+
+    BSONObjBuilder statsBuilder(builder->subobjStart("donorCloneStats"));
+    statsBuilder.appendNumber("clonedDocs", _numClonedDocs);
+    statsBuilder.appendNumber("clonedBytes", _numClonedBytes);
+    statsBuilder.appendNumber("batches", _numCloneBatches);
+    statsBuilder.appendNumber("cloneMillis", durationCount<Milliseconds>(cloneTime));
+    statsBuilder.appendNumber("readMillis", durationCount<Milliseconds>(_cloneReadTime));
 
-        AutoGetCollection autoColl(opCtx, _args.getNss(), MODE_IS);
-        const auto cursorManager =
-            autoColl.getCollection() ? autoColl.getCollection()->getCursorManager() : nullptr;
-        deleteNotifyExec->dispose(opCtx, cursorManager);
+    // Whatever part of the clone was not spent reading documents on the donor was spent waiting
+    // for the recipient to ask for the next batch
+    statsBuilder.appendNumber(
+        "waitForRecipientMillis",
+        durationCount<Milliseconds>(std::max(cloneTime - _cloneReadTime, Milliseconds(0))));
+
+    if (cloneTime > Milliseconds(0)) {
+        const double seconds = durationCount<Milliseconds>(cloneTime) / 1000.0;
+        statsBuilder.append("docsPerSec", _numClonedDocs / seconds);
+        statsBuilder.append("bytesPerSec", _numClonedBytes / seconds);
     }
 }
 
@@ -586,7 +633,7 @@ StatusWith<BSONObj> MigrationChunkClonerSourceLegacy::_callRecipient(const BSONO
     return responseStatus.data.getOwned();
 }
 
-Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opCtx) {
+Status MigrationChunkClonerSourceLegacy::_prepareCloneScan(OperationContext* opCtx) {
     AutoGetCollection autoColl(opCtx, _args.getNss(), MODE_IS);
 
     Collection* const collection = autoColl.getCollection();
@@ -604,23 +651,10 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
     if (!idx) {
         return {ErrorCodes::IndexNotFound,
                 str::stream() << "can't find index with prefix " << _shardKeyPattern.toBSON()
-                              << " in storeCurrentLocs for "
+                              << " in prepareCloneScan for "
                               << _args.getNss().ns()};
     }
 
-    // Install the stage, which will listen for notifications on the collection
-    auto statusWithDeleteNotificationPlanExecutor =
-        PlanExecutor::make(opCtx,
-                           stdx::make_unique<WorkingSet>(),
-                           stdx::make_unique<DeleteNotificationStage>(this, opCtx),
-                           collection,
-                           PlanExecutor::YIELD_MANUAL);
-    if (!statusWithDeleteNotificationPlanExecutor.isOK()) {
-        return statusWithDeleteNotificationPlanExecutor.getStatus();
-    }
-
-    _deleteNotifyExec = std::move(statusWithDeleteNotificationPlanExecutor.getValue());
-
     // Assume both min and max non-empty, append MinKey's to make them fit chosen index
     const KeyPattern kp(idx->keyPattern());
 
@@ -654,24 +688,19 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
     }
 
     // Do a full traversal of the chunk and don't stop even if we think it is a large chunk we want
-    // the number of records to better report, in that case.
+    // the number of records to better report, in that case. Only the index keys are read here, the
+    // documents themselves are fetched in shard key order as they are being cloned.
     bool isLargeChunk = false;
     unsigned long long recCount = 0;
 
     BSONObj obj;
-    RecordId recordId;
     PlanExecutor::ExecState state;
-    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &recordId))) {
+    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, nullptr))) {
         Status interruptStatus = opCtx->checkForInterruptNoAssert();
         if (!interruptStatus.isOK()) {
             return interruptStatus;
         }
 
-        if (!isLargeChunk) {
-            stdx::lock_guard<stdx::mutex> lk(_mutex);
-            _cloneLocs.insert(recordId);
-        }
-
         if (++recCount > maxRecsWhenFull) {
             isLargeChunk = true;
             // Continue on despite knowing that it will fail, just to get the correct value for
@@ -706,8 +735,28 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
                           << _args.getMaxKey()};
     }
 
+    // The clone scan is registered with the collection's cursor manager, so it survives yields and
+    // being detached between batches. We can afford to miss changes here for the same reason as
+    // above.
+    auto cloneExec = InternalPlanner::indexScan(opCtx,
+                                                collection,
+                                                idx,
+                                                min,
+                                                max,
+                                                BoundInclusion::kIncludeStartKeyOnly,
+                                                PlanExecutor::YIELD_MANUAL,
+                                                InternalPlanner::FORWARD,
+                                                InternalPlanner::IXSCAN_FETCH);
+    cloneExec->saveState();
+    cloneExec->detachFromOperationContext();
+
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    _averageObjectSizeForCloneLocs = collectionAverageObjectSize + 12;
+    _cloneExec = std::move(cloneExec);
+    if (isMMAPV1()) {
+        _clonedIds.emplace();
+    }
+    _cloneRecordsRemaining = recCount;
+    _averageObjectSizeForClone = collectionAverageObjectSize + 12;
 
     return Status::OK();
 }
@@ -28,10 +28,11 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <list>
-#include <set>
 
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
@@ -43,7 +44,9 @@
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -161,7 +164,6 @@ public:
                                                             BSONArrayBuilder* arrBuilder);
 
 private:
-    friend class DeleteNotificationStage;
     friend class LogOpForShardingHandler;
 
     // Represents the states in which the cloner can be
@@ -180,12 +182,25 @@ private:
     StatusWith<BSONObj> _callRecipient(const BSONObj& cmdObj);
 
     /**
-     * Get the disklocs that belong to the chunk migrated and sort them in _cloneLocs (to avoid
-     * seeking disk later).
+     * Counts the documents, which belong to the chunk being migrated (failing with ChunkTooBig if
+     * there are too many of them) and installs _cloneExec, which will stream them to the
+     * recipient in shard key order on subsequent calls to nextCloneBatch.
      *
      * Returns OK or any error status otherwise.
      */
-    Status _storeCurrentLocs(OperationContext* opCtx);
+    Status _prepareCloneScan(OperationContext* opCtx);
+
+    /**
+     * Disposes of _cloneExec, if it is still installed. Must be called with the collection lock
+     * held in at least IS mode, if the collection still exists.
+     */
+    void _disposeCloneExec(WithLock, OperationContext* opCtx, Collection* collection);
+
+    /**
+     * Appends the throughput statistics of the initial clone, as seen from the donor, to
+     * 'builder' under the 'donorCloneStats' field.
+     */
+    void _appendCloneStats(BSONObjBuilder* builder);
 
     /**
      * Insert items from docIdList to a new array with the given fieldName in the given builder. If
@@ -218,10 +233,6 @@ private:
     // The resolved primary of the recipient shard
     const HostAndPort _recipientHost;
 
-    // Registered deletion notifications plan executor, which will listen for document deletions
-    // during the cloning stage
-    std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _deleteNotifyExec;
-
     std::unique_ptr<SessionCatalogMigrationSource> _sessionCatalogSource;
 
     // Protects the entries below
@@ -230,12 +241,33 @@ private:
     // The current state of the cloner
     State _state{kNew};
 
-    // List of record ids that needs to be transferred (initial clone)
-    std::set<RecordId> _cloneLocs;
+    // Registered index scan over the shard key range of the chunk, which returns the documents
+    // to be transferred during the initial clone in shard key order. It is kept saved and detached
+    // from any operation context between calls to nextCloneBatch and is disposed of as soon as it
+    // is exhausted.
+    std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _cloneExec;
+
+    // The _ids of the documents _cloneExec has returned so far. Only kept on MMAPv1, where a
+    // document that grows moves to a new RecordId and may be returned again by the saved index
+    // scan, which the recipient would reject as a duplicate key.
+    boost::optional<SimpleBSONObjSet> _clonedIds;
+
+    // Estimated number of documents, which still need to be transferred (initial clone). Only
+    // used for reporting and buffer size pre-allocation, since documents may be deleted or
+    // inserted while the clone is running.
+    long long _cloneRecordsRemaining{0};
 
     // The estimated average object size during the clone phase. Used for buffer size
     // pre-allocation (initial clone).
-    uint64_t _averageObjectSizeForCloneLocs{0};
+    uint64_t _averageObjectSizeForClone{0};
+
+    // Statistics of the initial clone, reported by commitClone
+    long long _numClonedDocs{0};
+    long long _numClonedBytes{0};
+    long long _numCloneBatches{0};
+    Milliseconds _cloneReadTime{0};
+    boost::optional<Date_t> _cloneStartDate;
+    boost::optional<Date_t> _cloneEndDate;
 
     // List of _id of documents that were modified that must be re-cloned (xfer mods)
     std::list<BSONObj> _reload;
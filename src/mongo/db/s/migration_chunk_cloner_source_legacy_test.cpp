@@ -303,6 +303,66 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
     futureCommit.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationChunkClonerSourceLegacyTest, DocumentsClonedInShardKeyOrder) {
+    // Insert the documents so that their _id and insertion order is the reverse of the shard key
+    std::vector<BSONObj> contents;
+    for (int i = 0; i < 10; i++) {
+        contents.push_back(BSON("_id" << i << "X" << 199 - i));
+    }
+
+    createShardedCollection(contents);
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+
+    {
+        auto futureStartClone = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+        });
+
+        ASSERT_OK(cloner.startClone(operationContext()));
+        futureStartClone.timed_get(kFutureTimeout);
+    }
+
+    {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IS);
+
+        {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(
+                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_EQ(10, arrBuilder.arrSize());
+
+            const auto arr = arrBuilder.arr();
+            for (int i = 0; i < 10; i++) {
+                ASSERT_BSONOBJ_EQ(contents[9 - i], arr[i].Obj());
+            }
+        }
+
+        {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(
+                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            ASSERT_EQ(0, arrBuilder.arrSize());
+        }
+    }
+
+    auto futureCommit = launchAsync([&]() {
+        onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+    });
+
+    auto commitCloneResponse = cloner.commitClone(operationContext());
+    ASSERT_OK(commitCloneResponse.getStatus());
+    futureCommit.timed_get(kFutureTimeout);
+
+    const auto donorCloneStats = commitCloneResponse.getValue()["donorCloneStats"].Obj();
+    ASSERT_EQ(10, donorCloneStats["clonedDocs"].numberLong());
+    ASSERT_EQ(1, donorCloneStats["batches"].numberLong());
+}
+
 TEST_F(MigrationChunkClonerSourceLegacyTest, CollectionNotFound) {
     MigrationChunkClonerSourceLegacy cloner(
         createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
@@ -52,6 +52,7 @@
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/move_timing_helper.h"
 #include "mongo/db/s/start_chunk_clone_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/client/shard_registry.h"
@@ -66,6 +67,16 @@
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneInserterThreads, int, 4)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "migrateCloneInserterThreads must be between 1 and 64");
+        }
+        return Status::OK();
+    });
+
 namespace {
 
 const auto getMigrationDestinationManager =
@@ -278,7 +289,7 @@ void MigrationDestinationManager::report(BSONObjBuilder& b,
         }
         b.append("waited", true);
     }
-    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     b.appendBool("active", _sessionId.is_initialized());
 
@@ -305,9 +316,32 @@ void MigrationDestinationManager::report(BSONObjBuilder& b,
     bb.append("clonedBytes", _clonedBytes);
     bb.append("catchup", _numCatchup);
     bb.append("steady", _numSteady);
+    if (_cloneStats) {
+        BSONObjBuilder cloneStatsBuilder(bb.subobjStart("cloneStats"));
+        _appendCloneStats(lk, &cloneStatsBuilder);
+    }
     bb.done();
 }
 
+void MigrationDestinationManager::_appendCloneStats(WithLock, BSONObjBuilder* builder) const {
+    invariant(_cloneStats);
+
+    builder->append("inserterThreads", _cloneStats->numInserters);
+    builder->appendNumber("batches", _cloneStats->numBatches);
+    builder->appendNumber("cloneMillis", durationCount<Milliseconds>(_cloneStats->totalTime));
+    builder->appendNumber("fetchMillis", durationCount<Milliseconds>(_cloneStats->fetchTime));
+    builder->appendNumber("waitForInsertersMillis",
+                          durationCount<Milliseconds>(_cloneStats->waitForInsertersTime));
+    builder->appendNumber("insertersIdleMillis",
+                          durationCount<Milliseconds>(_cloneStats->insertersIdleTime));
+
+    if (_cloneStats->totalTime > Milliseconds(0)) {
+        const double seconds = durationCount<Milliseconds>(_cloneStats->totalTime) / 1000.0;
+        builder->append("docsPerSec", _numCloned / seconds);
+        builder->append("bytesPerSec", _clonedBytes / seconds);
+    }
+}
+
 BSONObj MigrationDestinationManager::getMigrationStatusReport() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     if (_isActive(lk)) {
@@ -352,6 +386,7 @@ Status MigrationDestinationManager::start(OperationContext* opCtx,
     _clonedBytes = 0;
     _numCatchup = 0;
     _numSteady = 0;
+    _cloneStats = boost::none;
 
     _sessionId = cloneRequest.getSessionId();
     _scopedReceiveChunk = std::move(scopedReceiveChunk);
@@ -371,51 +406,93 @@ Status MigrationDestinationManager::start(OperationContext* opCtx,
     return Status::OK();
 }
 
-void MigrationDestinationManager::cloneDocumentsFromDonor(
+MigrationDestinationManager::CloneStats MigrationDestinationManager::cloneDocumentsFromDonor(
     OperationContext* opCtx,
     stdx::function<void(OperationContext*, BSONObj)> insertBatchFn,
     stdx::function<BSONObj(OperationContext*)> fetchBatchFn) {
 
-    ProducerConsumerQueue<BSONObj> batches(1);
-    stdx::thread inserterThread{[&] {
+    CloneStats stats;
+    stats.numInserters = migrateCloneInserterThreads.load();
+
+    Timer cloneTimer;
+
+    // Allow the fetcher to run one batch ahead of each inserter, so that neither side has to wait
+    // for the other as long as they keep up
+    ProducerConsumerQueue<BSONObj> batches(stats.numInserters);
+
+    stdx::mutex idleTimeMutex;
+
+    auto inserterFn = [&] {
         Client::initThreadIfNotAlready("chunkInserter");
         auto inserterOpCtx = Client::getCurrent()->makeOperationContext();
         auto consumerGuard = MakeGuard([&] { batches.closeConsumerEnd(); });
+
+        Milliseconds idleTime{0};
+        auto idleTimeGuard = MakeGuard([&] {
+            stdx::lock_guard<stdx::mutex> lk(idleTimeMutex);
+            stats.insertersIdleTime += idleTime;
+        });
+
         try {
             while (true) {
+                Timer popTimer;
                 auto nextBatch = batches.pop(inserterOpCtx.get());
-                auto arr = nextBatch["objects"].Obj();
-                if (arr.isEmpty()) {
-                    return;
-                }
-                insertBatchFn(inserterOpCtx.get(), arr);
+                idleTime += Milliseconds(popTimer.millis());
+
+                insertBatchFn(inserterOpCtx.get(), nextBatch["objects"].Obj());
             }
+        } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+            // Either the fetcher has finished or another inserter failed, in which case it has
+            // already interrupted the fetcher
+            consumerGuard.Dismiss();
         } catch (...) {
             stdx::lock_guard<Client> lk(*opCtx->getClient());
             opCtx->getServiceContext()->killOperation(opCtx, exceptionToStatus().code());
             log() << "Batch insertion failed " << causedBy(redact(exceptionToStatus()));
         }
-    }};
-    auto inserterThreadJoinGuard = MakeGuard([&] {
+    };
+
+    std::vector<stdx::thread> inserterThreads;
+    auto inserterThreadsJoinGuard = MakeGuard([&] {
         batches.closeProducerEnd();
-        inserterThread.join();
+        for (auto& inserterThread : inserterThreads) {
+            inserterThread.join();
+        }
     });
 
+    for (int i = 0; i < stats.numInserters; i++) {
+        inserterThreads.emplace_back(inserterFn);
+    }
+
     while (true) {
         opCtx->checkForInterrupt();
 
+        Timer fetchTimer;
         auto res = fetchBatchFn(opCtx);
+        stats.fetchTime += Milliseconds(fetchTimer.millis());
 
         opCtx->checkForInterrupt();
-        batches.push(res.getOwned(), opCtx);
+
         auto arr = res["objects"].Obj();
         if (arr.isEmpty()) {
-            inserterThreadJoinGuard.Dismiss();
-            inserterThread.join();
+            // Closing the producer end lets the inserters drain the remaining batches and exit
+            inserterThreadsJoinGuard.Dismiss();
+            batches.closeProducerEnd();
+            for (auto& inserterThread : inserterThreads) {
+                inserterThread.join();
+            }
             opCtx->checkForInterrupt();
             break;
         }
+
+        Timer pushTimer;
+        batches.push(res.getOwned(), opCtx);
+        stats.waitForInsertersTime += Milliseconds(pushTimer.millis());
+        stats.numBatches++;
     }
+
+    stats.totalTime = Milliseconds(cloneTimer.millis());
+    return stats;
 }
 
 Status MigrationDestinationManager::abort(const MigrationSessionId& sessionId) {
@@ -756,6 +833,10 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx) {
 
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
+        // The cloned documents are inserted on separate threads, so the latest of their optimes
+        // has to be tracked explicitly in order to wait for them to replicate
+        repl::OpTime lastClonedOpTime;
+
         auto assertNotAborted = [&](OperationContext* opCtx) {
             opCtx->checkForInterrupt();
             uassert(50748, "Migration aborted while copying documents", getState() != ABORT);
@@ -789,17 +870,19 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx) {
                                                          << " failed.");
             }
 
+            const auto batchLastOpTime =
+                repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp();
+
             {
                 stdx::lock_guard<stdx::mutex> statsLock(_mutex);
                 _numCloned += batchNumCloned;
                 _clonedBytes += batchClonedBytes;
+                lastClonedOpTime = std::max(lastClonedOpTime, batchLastOpTime);
             }
             if (_writeConcern.shouldWaitForOtherNodes()) {
                 repl::ReplicationCoordinator::StatusAndDuration replStatus =
                     repl::ReplicationCoordinator::get(opCtx)->awaitReplication(
-                        opCtx,
-                        repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp(),
-                        _writeConcern);
+                        opCtx, batchLastOpTime, _writeConcern);
                 if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
                     warning() << "secondaryThrottle on, but doc insert timed out; "
                                  "continuing";
@@ -824,7 +907,26 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx) {
             return res.response;
         };
 
-        cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn);
+        const auto cloneStats = cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn);
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _cloneStats = cloneStats;
+
+            BSONObjBuilder cloneStatsBuilder;
+            _appendCloneStats(lk, &cloneStatsBuilder);
+            timing.appendDetails(BSON("cloneStats" << cloneStatsBuilder.obj()));
+
+            auto& clientLastOp = repl::ReplClientInfo::forClient(opCtx->getClient());
+            if (clientLastOp.getLastOp() < lastClonedOpTime) {
+                clientLastOp.setLastOp(lastClonedOpTime);
+            }
+        }
+
+        log() << "Finished cloning " << _numCloned << " documents for migration of chunk "
+              << redact(_min) << " -> " << redact(_max) << " using "
+              << cloneStats.numInserters << " inserter threads in "
+              << cloneStats.totalTime;
 
         timing.done(3);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
@@ -41,11 +41,13 @@
 #include "mongo/db/s/collection_sharding_runtime.h"
 #include "mongo/db/s/migration_session_id.h"
 #include "mongo/db/s/session_catalog_migration_destination.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/shard_id.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -59,6 +61,10 @@ namespace repl {
 class OpTime;
 }
 
+// Number of threads, which insert the documents fetched from the donor during the initial clone
+// phase of a migration. Exposed so that tests can override it.
+extern AtomicInt32 migrateCloneInserterThreads;
+
 /**
  * Drives the receiving side of the MongoD migration process. One instance exists per shard.
  */
@@ -108,9 +114,37 @@ public:
                  const WriteConcernOptions& writeConcern);
 
     /**
-     * Clones documents from a donor shard.
+     * Timing of the initial clone phase, which is used to report its throughput and whether the
+     * donor or the inserters were the bottleneck.
      */
-    static void cloneDocumentsFromDonor(
+    struct CloneStats {
+        // Number of non-empty batches fetched from the donor
+        long long numBatches{0};
+
+        // Number of threads, which inserted the fetched batches
+        int numInserters{0};
+
+        // Wall clock time of the whole clone phase
+        Milliseconds totalTime{0};
+
+        // Time spent waiting for the donor to return batches
+        Milliseconds fetchTime{0};
+
+        // Time the fetcher spent blocked because all the inserters were busy (backpressure from
+        // the recipient's writes)
+        Milliseconds waitForInsertersTime{0};
+
+        // Time spent by all the inserters waiting for the fetcher to produce batches (backpressure
+        // from the donor), summed across threads
+        Milliseconds insertersIdleTime{0};
+    };
+
+    /**
+     * Clones documents from a donor shard. Batches returned by fetchBatchFn are handed to
+     * 'migrateCloneInserterThreads' inserter threads, each of which runs insertBatchFn
+     * concurrently with the others and with the fetching of subsequent batches.
+     */
+    static CloneStats cloneDocumentsFromDonor(
         OperationContext* opCtx,
         stdx::function<void(OperationContext*, BSONObj)> insertBatchFn,
         stdx::function<BSONObj(OperationContext*)> fetchBatchFn);
@@ -176,6 +210,11 @@ private:
      */
     bool _isActive(WithLock) const;
 
+    /**
+     * Appends the statistics of the completed initial clone phase to 'builder'.
+     */
+    void _appendCloneStats(WithLock, BSONObjBuilder* builder) const;
+
     // Mutex to guard all fields
     mutable stdx::mutex _mutex;
 
@@ -211,6 +250,9 @@ private:
     long long _numCatchup{0};
     long long _numSteady{0};
 
+    // Set once the initial clone phase has completed
+    boost::optional<CloneStats> _cloneStats;
+
     State _state{READY};
     std::string _errmsg;
 
@@ -28,9 +28,14 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/s/migration_destination_manager.h"
 #include "mongo/s/shard_server_test_fixture.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -104,6 +109,65 @@ TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWorksCorrectly) {
     }
 }
 
+// Tests that batches are inserted by multiple threads concurrently and that all of them make it
+// into the collection.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorInsertsBatchesInParallel) {
+    const auto originalInserterThreads = migrateCloneInserterThreads.load();
+    ON_BLOCK_EXIT([&] { migrateCloneInserterThreads.store(originalInserterThreads); });
+    migrateCloneInserterThreads.store(3);
+
+    const int kNumBatches = 6;
+    int numBatchesFetched = 0;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        BSONObjBuilder fetchBatchResultBuilder;
+
+        if (numBatchesFetched == kNumBatches) {
+            fetchBatchResultBuilder.append("objects", BSONObj());
+        } else {
+            numBatchesFetched++;
+            fetchBatchResultBuilder.append("objects",
+                                           BSON_ARRAY(createDocument(numBatchesFetched)));
+        }
+
+        return fetchBatchResultBuilder.obj();
+    };
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    int numInFlight = 0;
+    bool sawConcurrentInserts = false;
+    std::vector<int> resultIds;
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        for (auto&& docToClone : docs) {
+            resultIds.push_back(docToClone.Obj()["_id"].numberInt());
+        }
+
+        // Hold on to the first batch until another inserter picks up the second one
+        numInFlight++;
+        cv.notify_all();
+        sawConcurrentInserts |= cv.wait_for(lk, Seconds(10).toSystemDuration(), [&] {
+            return numInFlight > 1 || sawConcurrentInserts;
+        });
+        numInFlight--;
+    };
+
+    const auto stats = MigrationDestinationManager::cloneDocumentsFromDonor(
+        operationContext(), insertBatchFn, fetchBatchFn);
+
+    ASSERT(sawConcurrentInserts);
+    ASSERT_EQ(3, stats.numInserters);
+    ASSERT_EQ(kNumBatches, stats.numBatches);
+
+    std::sort(resultIds.begin(), resultIds.end());
+    ASSERT_EQ(static_cast<size_t>(kNumBatches), resultIds.size());
+    for (int i = 0; i < kNumBatches; i++) {
+        ASSERT_EQ(i + 1, resultIds[i]);
+    }
+}
+
 // Tests that an exception in the fetch logic will successfully throw an exception on the main
 // thread.
 TEST_F(MigrationDestinationManagerTest, CloneDocumentsThrowsFetchErrors) {
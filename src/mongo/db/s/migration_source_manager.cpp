@@ -366,6 +366,11 @@ Status MigrationSourceManager::commitChunkOnRecipient(OperationContext* opCtx) {
 
     _recipientCloneCounts = commitCloneStatus.getValue()["counts"].Obj().getOwned();
 
+    const auto donorCloneStatsElem = commitCloneStatus.getValue()["donorCloneStats"];
+    if (donorCloneStatsElem.type() == Object) {
+        _donorCloneStats = donorCloneStatsElem.Obj().getOwned();
+    }
+
     _state = kCloneCompleted;
     scopedGuard.Dismiss();
     return Status::OK();
@@ -592,7 +597,9 @@ Status MigrationSourceManager::commitChunkMetadataOnConfig(OperationContext* opC
                                << "to"
                                << _args.getToShardId()
                                << "counts"
-                               << _recipientCloneCounts),
+                               << _recipientCloneCounts
+                               << "donorCloneStats"
+                               << _donorCloneStats),
                     ShardingCatalogClient::kMajorityWriteConcern)
         .ignore();
 
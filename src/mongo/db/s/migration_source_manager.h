@@ -235,6 +235,9 @@ private:
     // The statistics about a chunk migration to be included in moveChunk.commit
     BSONObj _recipientCloneCounts;
 
+    // Throughput statistics of the initial clone as seen from the donor side
+    BSONObj _donorCloneStats;
+
     boost::optional<CollectionCriticalSection> _critSec;
 };
 
@@ -54,6 +54,11 @@ public:
 
     void done(int step);
 
+    /**
+     * Adds the fields of 'details' to the change log entry written on destruction.
+     */
+    void appendDetails(const BSONObj& details);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
@@ -31,6 +31,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/s/active_migrations_registry.h"
+#include "mongo/db/s/collection_range_deleter.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/s/sharding_statistics.h"
 #include "mongo/db/server_options.h"
@@ -114,6 +115,11 @@ public:
         BSONObjBuilder result;
         ShardingStatistics::get(opCtx).report(&result);
         catalogCache->report(&result);
+
+        BSONObjBuilder rangeDeleterBuilder(result.subobjStart("rangeDeleter"));
+        CollectionRangeDeleter::appendStats(&rangeDeleterBuilder);
+        rangeDeleterBuilder.doneFast();
+
         return result.obj();
     }
 
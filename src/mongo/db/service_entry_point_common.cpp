@@ -61,6 +61,8 @@
 #include "mongo/db/ops/write_ops.h"
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/query/find.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/query/getmore_request.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/repl/read_concern_args.h"
@@ -89,6 +91,7 @@
 #include "mongo/rpc/metadata/sharding_metadata.h"
 #include "mongo/rpc/metadata/tracking_metadata.h"
 #include "mongo/rpc/op_msg.h"
+#include "mongo/rpc/op_msg_rpc_impls.h"
 #include "mongo/rpc/reply_builder_interface.h"
 #include "mongo/s/cannot_implicitly_create_collection_info.h"
 #include "mongo/s/grid.h"
@@ -503,7 +506,9 @@ bool runCommandImpl(OperationContext* opCtx,
                     BSONObjBuilder* extraFieldsBuilder,
                     const boost::optional<OperationSessionInfoFromClient>& sessionOptions) {
     const Command* command = invocation->definition();
-    auto bytesToReserve = command->reserveBytesForReply();
+    auto bytesToReserve = replyBuilder->getProtocol() == rpc::Protocol::kOpMsg
+        ? command->reserveBytesForSplicedReply()
+        : command->reserveBytesForReply();
 
 // SERVER-22100: In Windows DEBUG builds, the CRT heap debugging overhead, in conjunction with the
 // additional memory pressure introduced by reply buffer pre-allocation, causes the concurrency
@@ -989,14 +994,76 @@ void curOpCommandSetup(OperationContext* opCtx, const OpMsgRequest& request) {
     curop->setNS_inlock(nss.ns());
 }
 
+/**
+ * If 'request' is a find, aggregate or getMore whose successful reply, with body 'replyBody',
+ * leaves its cursor open, returns the getMore that fetches the cursor's next batch, to be run on
+ * behalf of a client that allows exhaust. Statements of multi-document transactions aren't
+ * streamed, since the client has to send each of them itself.
+ *
+ * A getMore that returns an empty batch without having waited for one, as on a tailable cursor
+ * which isn't awaitData, ends the stream, since the next one would return straight away too.
+ */
+boost::optional<BSONObj> makeExhaustGetMore(OperationContext* opCtx,
+                                            const OpMsgRequest& request,
+                                            const Command* command,
+                                            const BSONObj& replyBody) {
+    const auto& name = command->getName();
+    if ((name != "find" && name != "aggregate" && name != "getMore") ||
+        request.body.hasField(OperationSessionInfo::kTxnNumberFieldName)) {
+        return boost::none;
+    }
+
+    auto cursor = replyBody["cursor"];
+    if (!replyBody["ok"].trueValue() || cursor.type() != Object || !cursor["id"].isNumber() ||
+        cursor["id"].numberLong() == 0) {
+        return boost::none;
+    }
+
+    if (name == "getMore") {
+        if (CurOp::get(opCtx)->debug().nreturned == 0 &&
+            !awaitDataState(opCtx).shouldWaitForInserts) {
+            return boost::none;
+        }
+
+        // The same getMore fetches each following batch.
+        return request.body.getOwned();
+    }
+
+    boost::optional<std::int64_t> batchSize;
+    auto batchSizeElem =
+        name == "find" ? request.body["batchSize"] : request.body["cursor"]["batchSize"];
+    if (batchSizeElem.isNumber() && batchSizeElem.numberLong() > 0) {
+        batchSize = batchSizeElem.numberLong();
+    }
+
+    GetMoreRequest getMore(NamespaceString(cursor["ns"].str()),
+                           cursor["id"].numberLong(),
+                           batchSize,
+                           boost::none,
+                           boost::none,
+                           boost::none);
+
+    BSONObjBuilder bob(getMore.toBSON());
+    if (auto lsid = request.body[OperationSessionInfo::kSessionIdFieldName]) {
+        bob.append(lsid);
+    }
+    bob.append("$db", request.getDatabase());
+    return bob.obj();
+}
+
 DbResponse receivedCommands(OperationContext* opCtx,
                             const Message& message,
                             const ServiceEntryPointCommon::Hooks& behaviors) {
     auto replyBuilder = rpc::makeReplyBuilder(rpc::protocolForMessage(message));
+    const Command* exhaustCommand = nullptr;
+    OpMsgRequest exhaustRequest;
     [&] {
         OpMsgRequest request;
         try {  // Parse.
             request = rpc::opMsgRequestFromAnyProtocol(message);
+            // Let anything that needs the documents of a bulk insert owned take a reference on
+            // the message rather than copying them one by one.
+            request.shareDocumentSequenceOwnershipWith(message.sharedBuffer());
         } catch (const DBException& ex) {
             // If this error needs to fail the connection, propagate it out.
             if (ErrorCodes::isConnectionFatalMessageParseError(ex.code()))
@@ -1046,6 +1113,11 @@ DbResponse receivedCommands(OperationContext* opCtx,
             }
 
             execCommandDatabase(opCtx, c, request, replyBuilder.get(), behaviors);
+
+            if (OpMsg::isFlagSet(message, OpMsg::kExhaustSupported)) {
+                exhaustCommand = c;
+                exhaustRequest = request;
+            }
         } catch (const DBException& ex) {
             BSONObjBuilder metadataBob;
             appendReplyMetadataOnError(opCtx, &metadataBob);
@@ -1071,11 +1143,22 @@ DbResponse receivedCommands(OperationContext* opCtx,
         return {};  // Don't reply.
     }
 
+    // The exhaust flag only exists on OP_MSG requests, whose replies are built by an
+    // OpMsgReplyBuilder. Read the cursor from the body before any spliced batch is attached to it.
+    boost::optional<BSONObj> exhaustGetMore;
+    if (exhaustCommand) {
+        auto opMsgReplyBuilder = checked_cast<rpc::OpMsgReplyBuilder*>(replyBuilder.get());
+        exhaustGetMore = makeExhaustGetMore(
+            opCtx, exhaustRequest, exhaustCommand, opMsgReplyBuilder->getInPlaceBody());
+    }
+
     auto response = replyBuilder->done();
     CurOp::get(opCtx)->debug().responseLength = response.header().dataLen();
 
-    // TODO exhaust
-    return DbResponse{std::move(response)};
+    DbResponse dbResponse{std::move(response)};
+    dbResponse.shouldRunAgainForExhaust = bool(exhaustGetMore);
+    dbResponse.nextInvocation = std::move(exhaustGetMore);
+    return dbResponse;
 }
 
 DbResponse receivedQuery(OperationContext* opCtx,
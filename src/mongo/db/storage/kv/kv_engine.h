@@ -349,6 +349,13 @@ public:
         return false;
     }
 
+    /**
+     * See `StorageEngine::getCacheDirtyFraction`
+     */
+    virtual boost::optional<double> getCacheDirtyFraction() const {
+        return boost::none;
+    }
+
     /**
      * See `StorageEngine::replicationBatchIsComplete()`
      */
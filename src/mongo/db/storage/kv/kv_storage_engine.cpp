@@ -684,6 +684,10 @@ bool KVStorageEngine::supportsReadConcernMajority() const {
     return _engine->supportsReadConcernMajority();
 }
 
+boost::optional<double> KVStorageEngine::getCacheDirtyFraction() const {
+    return _engine->getCacheDirtyFraction();
+}
+
 void KVStorageEngine::replicationBatchIsComplete() const {
     return _engine->replicationBatchIsComplete();
 }
@@ -140,6 +140,8 @@ public:
 
     bool supportsReadConcernMajority() const final;
 
+    boost::optional<double> getCacheDirtyFraction() const final;
+
     virtual void replicationBatchIsComplete() const override;
 
     SnapshotManager* getSnapshotManager() const final;
@@ -337,6 +337,14 @@ public:
         return false;
     }
 
+    /**
+     * Returns the fraction of the storage engine's cache, which is taken up by modified data that
+     * has not been written out yet, or boost::none if the storage engine does not track it.
+     */
+    virtual boost::optional<double> getCacheDirtyFraction() const {
+        return boost::none;
+    }
+
     /**
      * Recovers the storage engine state to the last stable timestamp. "Stable" in this case
      * refers to a timestamp that is guaranteed to never be rolled back. The stable timestamp
@@ -1561,6 +1561,21 @@ bool WiredTigerKVEngine::supportsReadConcernMajority() const {
     return _keepDataHistory;
 }
 
+boost::optional<double> WiredTigerKVEngine::getCacheDirtyFraction() const {
+    UniqueWiredTigerSession session = _sessionCache->getSession();
+    WT_SESSION* s = session->getSession();
+
+    auto bytesDirty = WiredTigerUtil::getStatisticsValueAs<int64_t>(
+        s, "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_DIRTY);
+    auto bytesMax = WiredTigerUtil::getStatisticsValueAs<int64_t>(
+        s, "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_MAX);
+    if (!bytesDirty.isOK() || !bytesMax.isOK() || bytesMax.getValue() <= 0) {
+        return boost::none;
+    }
+
+    return static_cast<double>(bytesDirty.getValue()) / bytesMax.getValue();
+}
+
 void WiredTigerKVEngine::startOplogManager(OperationContext* opCtx,
                                            const std::string& uri,
                                            WiredTigerRecordStore* oplogRecordStore) {
@@ -215,6 +215,8 @@ public:
 
     bool supportsReadConcernMajority() const final;
 
+    boost::optional<double> getCacheDirtyFraction() const final;
+
     // wiredtiger specific
     // Calls WT_CONNECTION::reconfigure on the underlying WT_CONNECTION
     // held by this class
@@ -35,6 +35,8 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/transport/service_entry_point.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/rpc/op_msg.h"
 
@@ -68,6 +70,55 @@ TEST(CommandTests, InputDocumentSequeceWorksEndToEnd) {
     ASSERT_EQ(db.count(ns.ns()), 5u);
 }
 
+/**
+ * Runs 'body' as an OP_MSG request from a client that allows exhaust, on an operation of its own.
+ */
+DbResponse runExhaustRequest(const BSONObj& body) {
+    const auto opCtxHolder = cc().makeOperationContext();
+    auto message = OpMsgRequest::fromDBAndBody(body["$db"].str(), body).serialize();
+    OpMsg::setFlag(&message, OpMsg::kExhaustSupported);
+    return getGlobalServiceContext()->getServiceEntryPoint()->handleRequest(opCtxHolder.get(),
+                                                                            message);
+}
+
+TEST(CommandTests, ExhaustStopsAfterEmptyBatchOfTailableCursor) {
+    // Skip the test if the storage engine doesn't support capped collections.
+    if (!getGlobalServiceContext()->getStorageEngine()->supportsCappedCollections()) {
+        return;
+    }
+
+    NamespaceString ns("test", "exhaust_tailable");
+    {
+        const auto opCtxHolder = cc().makeOperationContext();
+        DBDirectClient db(opCtxHolder.get());
+        db.dropCollection(ns.ns());
+        ASSERT(db.createCollection(ns.ns(), 1024 * 1024, true));
+        for (int i = 0; i < 3; ++i) {
+            db.insert(ns.ns(), BSON("_id" << i));
+        }
+    }
+
+    // The find and the getMore for the rest of the documents leave the tailable cursor open, so
+    // the next batch is streamed.
+    auto response = runExhaustRequest(
+        BSON("find" << ns.coll() << "tailable" << true << "batchSize" << 2 << "$db" << ns.db()));
+    ASSERT_TRUE(response.shouldRunAgainForExhaust);
+    ASSERT_EQ(response.nextInvocation->firstElementFieldName(), "getMore"_sd);
+
+    response = runExhaustRequest(*response.nextInvocation);
+    ASSERT_EQ(OpMsg::parse(response.response).body["cursor"]["nextBatch"].Array().size(), 1U);
+    ASSERT_TRUE(response.shouldRunAgainForExhaust);
+
+    // Without awaitData, the empty batch at the end of the collection returns straight away, and
+    // so does every one after it. The stream ends there, although the cursor stays open.
+    response = runExhaustRequest(*response.nextInvocation);
+    auto cursor = OpMsg::parse(response.response).body["cursor"];
+    ASSERT_EQ(cursor["nextBatch"].Array().size(), 0U);
+    ASSERT_NE(cursor["id"].numberLong(), 0);
+    ASSERT_FALSE(response.shouldRunAgainForExhaust);
+    ASSERT_FALSE(response.nextInvocation);
+}
+
 using std::string;
 
 /**
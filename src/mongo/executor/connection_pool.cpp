@@ -32,6 +32,8 @@
 
 #include "mongo/executor/connection_pool.h"
 
+#include <cmath>
+
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/executor/connection_pool_stats.h"
 #include "mongo/executor/remote_command_request.h"
@@ -41,9 +43,10 @@
 #include "mongo/util/log.h"
 #include "mongo/util/lru_cache.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 // One interesting implementation note herein concerns how setup() and
-// refresh() are invoked outside of the global lock, but setTimeout is not.
+// refresh() are invoked outside of the specific pool's lock, but setTimeout is not.
 // This implementation detail simplifies mocks, allowing them to return
 // synchronously sometimes, whereas having timeouts fire instantly adds little
 // value. In practice, dumping the locks is always safe (because we restrict
@@ -69,7 +72,7 @@ public:
      *
      * The complexity comes from the need to hold a lock when writing to the
      * _activeClients param on the specific pool.  Because the code beneath the client needs to lock
-     * and unlock the parent mutex (and can leave unlocked), we want to start the client with the
+     * and unlock the pool's mutex (and can leave unlocked), we want to start the client with the
      * lock acquired, move it into the client, then re-acquire to decrement the counter on the way
      * out.
      *
@@ -85,11 +88,11 @@ public:
     template <typename Callback>
     auto guardCallback(Callback&& cb) {
         return [ cb = std::forward<Callback>(cb), anchor = shared_from_this() ](auto&&... args) {
-            stdx::unique_lock<stdx::mutex> lk(anchor->_parent->_mutex);
+            auto lk = anchor->lockPool();
             ++(anchor->_activeClients);
 
             ON_BLOCK_EXIT([anchor]() {
-                stdx::unique_lock<stdx::mutex> lk(anchor->_parent->_mutex);
+                auto lk = anchor->lockPool();
                 --(anchor->_activeClients);
             });
 
@@ -101,8 +104,14 @@ public:
     ~SpecificPool();
 
     /**
-     * Gets a connection from the specific pool. Sinks a unique_lock from the
-     * parent to preserve the lock on _mutex
+     * Acquires this pool's mutex, keeping track of how often and for how long callers had to
+     * wait for another thread to release it.
+     */
+    stdx::unique_lock<stdx::mutex> lockPool();
+
+    /**
+     * Gets a connection from the specific pool. Sinks the unique_lock on _mutex obtained from
+     * lockPool().
      */
     Future<ConnectionHandle> getConnection(const HostAndPort& hostAndPort,
                                            Milliseconds timeout,
@@ -124,8 +133,8 @@ public:
     void processFailure(const Status& status, stdx::unique_lock<stdx::mutex> lk);
 
     /**
-     * Returns a connection to a specific pool. Sinks a unique_lock from the
-     * parent to preserve the lock on _mutex
+     * Returns a connection to a specific pool. Sinks the unique_lock on _mutex obtained from
+     * lockPool().
      */
     void returnConnection(ConnectionInterface* connection, stdx::unique_lock<stdx::mutex> lk);
 
@@ -156,6 +165,19 @@ public:
      */
     size_t openConnections(const stdx::unique_lock<stdx::mutex>& lk);
 
+    /**
+     * Fills in the connection and lock contention counters of this pool.
+     */
+    ConnectionStatsPer getStats(const stdx::unique_lock<stdx::mutex>& lk);
+
+    /**
+     * Returns true once the pool has started shutting down. Such a pool only waits for its
+     * processing connections to drain and must not be handed any new requests.
+     */
+    bool inShutdown(const stdx::unique_lock<stdx::mutex>& lk) const {
+        return _state == State::kInShutdown;
+    }
+
     /**
      * Return true if the tags on the specific pool match the passed in tags
      */
@@ -198,11 +220,32 @@ private:
 
     void updateStateInLock();
 
+    /**
+     * Accumulates the number of connections in use and requests waiting since the last sample,
+     * for the adaptive controller.
+     */
+    void sampleAdaptiveLoad(Date_t now);
+
+    /**
+     * Once per adaptiveInterval, sets the adaptive target to the average number of connections in
+     * use over the interval plus some headroom, plus a connection for every request by which the
+     * average queue depth exceeded adaptiveTargetQueueDepth. By Little's law, the former is the
+     * request rate times the time each request holds its connection. Growth is damped so that a
+     * burst of queued requests adds connections gradually.
+     */
+    void updateAdaptiveTarget(Date_t now);
+
 private:
     ConnectionPool* const _parent;
 
     const HostAndPort _hostAndPort;
 
+    // Guards everything below.
+    stdx::mutex _mutex;
+    size_t _lockAcquisitions = 0;
+    size_t _lockContended = 0;
+    Microseconds _lockWaitTime{0};
+
     LRUOwnershipPool _readyPool;
     OwnershipPool _processingPool;
     OwnershipPool _droppedProcessingPool;
@@ -219,6 +262,15 @@ private:
 
     size_t _created;
 
+    // Adaptive sizing state. The integrals are in connection- and request-milliseconds.
+    size_t _adaptiveTarget;
+    Date_t _adaptiveIntervalStart;
+    Date_t _adaptiveLastSample;
+    double _inUseIntegral = 0;
+    double _queuedIntegral = 0;
+    double _avgInUse = 0;
+    double _avgQueued = 0;
+
     transport::Session::TagMask _tags = transport::Session::kPending;
 
     /**
@@ -251,6 +303,8 @@ constexpr Milliseconds ConnectionPool::kDefaultHostTimeout;
 size_t const ConnectionPool::kDefaultMaxConns = std::numeric_limits<size_t>::max();
 size_t const ConnectionPool::kDefaultMinConns = 1;
 size_t const ConnectionPool::kDefaultMaxConnecting = std::numeric_limits<size_t>::max();
+constexpr Milliseconds ConnectionPool::kDefaultAdaptiveInterval;
+constexpr size_t ConnectionPool::kDefaultAdaptiveTargetQueueDepth;
 constexpr Milliseconds ConnectionPool::kDefaultRefreshRequirement;
 constexpr Milliseconds ConnectionPool::kDefaultRefreshTimeout;
 
@@ -289,7 +343,7 @@ void ConnectionPool::shutdown() {
     }();
 
     for (const auto& pair : pools) {
-        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        auto lk = pair.second->lockPool();
         pair.second->triggerShutdown(
             Status(ErrorCodes::ShutdownInProgress, "Shutting down the connection pool"),
             std::move(lk));
@@ -297,14 +351,12 @@ void ConnectionPool::shutdown() {
 }
 
 void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    auto pool = findPool(hostAndPort);
 
-    auto iter = _pools.find(hostAndPort);
-
-    if (iter == _pools.end())
+    if (!pool)
         return;
 
-    auto pool = iter->second;
+    auto lk = pool->lockPool();
     pool->processFailure(Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"),
                          std::move(lk));
 }
@@ -319,7 +371,7 @@ void ConnectionPool::dropConnections(transport::Session::TagMask tags) {
     for (const auto& pair : pools) {
         auto& pool = pair.second;
 
-        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        auto lk = pool->lockPool();
         if (pool->matchesTags(lk, tags))
             continue;
 
@@ -332,14 +384,12 @@ void ConnectionPool::dropConnections(transport::Session::TagMask tags) {
 void ConnectionPool::mutateTags(
     const HostAndPort& hostAndPort,
     const stdx::function<transport::Session::TagMask(transport::Session::TagMask)>& mutateFunc) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    auto iter = _pools.find(hostAndPort);
+    auto pool = findPool(hostAndPort);
 
-    if (iter == _pools.end())
+    if (!pool)
         return;
 
-    auto pool = iter->second;
+    auto lk = pool->lockPool();
     pool->mutateTags(lk, mutateFunc);
 }
 
@@ -351,59 +401,79 @@ void ConnectionPool::get(const HostAndPort& hostAndPort,
 
 Future<ConnectionPool::ConnectionHandle> ConnectionPool::get(const HostAndPort& hostAndPort,
                                                              Milliseconds timeout) {
-    std::shared_ptr<SpecificPool> pool;
-
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (true) {
+        auto pool = [&] {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-    auto iter = _pools.find(hostAndPort);
+            auto& pool = _pools[hostAndPort];
+            if (!pool) {
+                pool = std::make_shared<SpecificPool>(this, hostAndPort);
+            }
+            return pool;
+        }();
 
-    if (iter == _pools.end()) {
-        pool = stdx::make_unique<SpecificPool>(this, hostAndPort);
-        _pools[hostAndPort] = pool;
-    } else {
-        pool = iter->second;
-    }
+        auto lk = pool->lockPool();
+        if (!pool->inShutdown(lk)) {
+            return pool->getConnection(hostAndPort, timeout, std::move(lk));
+        }
 
-    invariant(pool);
+        // The pool shut down between our finding it and locking it, and is only waiting for its
+        // processing connections to drain. Replace it with a fresh one; it will not delist the
+        // replacement once it has drained.
+        lk.unlock();
 
-    return pool->getConnection(hostAndPort, timeout, std::move(lk));
+        stdx::lock_guard<stdx::mutex> poolsLk(_mutex);
+        auto iter = _pools.find(hostAndPort);
+        if (iter != _pools.end() && iter->second == pool) {
+            _pools.erase(iter);
+        }
+    }
 }
 
 void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    for (const auto& kv : _pools) {
-        HostAndPort host = kv.first;
+    // Grab all current pools (under the lock)
+    auto pools = [&] {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        return _pools;
+    }();
 
+    for (const auto& kv : pools) {
         auto& pool = kv.second;
-        ConnectionStatsPer hostStats{pool->inUseConnections(lk),
-                                     pool->availableConnections(lk),
-                                     pool->createdConnections(lk),
-                                     pool->refreshingConnections(lk)};
-        stats->updateStatsForHost(_name, host, hostStats);
+
+        auto lk = pool->lockPool();
+        stats->updateStatsForHost(_name, kv.first, pool->getStats(lk));
     }
 }
 
 size_t ConnectionPool::getNumConnectionsPerHost(const HostAndPort& hostAndPort) const {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-    auto iter = _pools.find(hostAndPort);
-    if (iter != _pools.end()) {
-        return iter->second->openConnections(lk);
+    auto pool = findPool(hostAndPort);
+    if (pool) {
+        auto lk = pool->lockPool();
+        return pool->openConnections(lk);
     }
 
     return 0;
 }
 
-void ConnectionPool::returnConnection(ConnectionInterface* conn) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+std::shared_ptr<ConnectionPool::SpecificPool> ConnectionPool::findPool(
+    const HostAndPort& hostAndPort) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-    auto iter = _pools.find(conn->getHostAndPort());
+    auto iter = _pools.find(hostAndPort);
+    if (iter == _pools.end())
+        return nullptr;
+
+    return iter->second;
+}
+
+void ConnectionPool::returnConnection(ConnectionInterface* conn) {
+    auto pool = findPool(conn->getHostAndPort());
 
-    invariant(iter != _pools.end(),
+    invariant(pool,
               str::stream() << "Tried to return connection but no pool found for "
                             << conn->getHostAndPort());
 
-    auto pool = iter->second;
+    auto lk = pool->lockPool();
     pool->returnConnection(conn, std::move(lk));
 }
 
@@ -417,6 +487,10 @@ ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAnd
       _inFulfillRequests(false),
       _inSpawnConnections(false),
       _created(0),
+      _adaptiveTarget(std::min(std::max(parent->_options.minConnections, size_t(1)),
+                               parent->_options.maxConnections)),
+      _adaptiveIntervalStart(parent->_factory->now()),
+      _adaptiveLastSample(_adaptiveIntervalStart),
       _state(State::kRunning) {}
 
 ConnectionPool::SpecificPool::~SpecificPool() {
@@ -426,6 +500,19 @@ ConnectionPool::SpecificPool::~SpecificPool() {
     invariant(_checkedOutPool.empty());
 }
 
+stdx::unique_lock<stdx::mutex> ConnectionPool::SpecificPool::lockPool() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex, stdx::try_to_lock);
+    if (!lk.owns_lock()) {
+        // Only time the wait when there is one, to keep the uncontended path free of clock reads.
+        Timer timer;
+        lk.lock();
+        ++_lockContended;
+        _lockWaitTime += Microseconds(timer.micros());
+    }
+    ++_lockAcquisitions;
+    return lk;
+}
+
 size_t ConnectionPool::SpecificPool::inUseConnections(const stdx::unique_lock<stdx::mutex>& lk) {
     return _checkedOutPool.size();
 }
@@ -448,6 +535,23 @@ size_t ConnectionPool::SpecificPool::openConnections(const stdx::unique_lock<std
     return _checkedOutPool.size() + _readyPool.size() + _processingPool.size();
 }
 
+ConnectionStatsPer ConnectionPool::SpecificPool::getStats(
+    const stdx::unique_lock<stdx::mutex>& lk) {
+    ConnectionStatsPer stats{inUseConnections(lk),
+                             availableConnections(lk),
+                             createdConnections(lk),
+                             refreshingConnections(lk)};
+    stats.lockAcquisitions = _lockAcquisitions;
+    stats.lockContended = _lockContended;
+    stats.lockWaitMicros = durationCount<Microseconds>(_lockWaitTime);
+    if (_parent->_options.adaptiveSizing) {
+        stats.adaptiveTarget = _adaptiveTarget;
+        stats.adaptiveAvgInUse = _avgInUse;
+        stats.adaptiveAvgQueued = _avgQueued;
+    }
+    return stats;
+}
+
 Future<ConnectionPool::ConnectionHandle> ConnectionPool::SpecificPool::getConnection(
     const HostAndPort& hostAndPort, Milliseconds timeout, stdx::unique_lock<stdx::mutex> lk) {
     invariant(_state != State::kInShutdown);
@@ -456,9 +560,14 @@ Future<ConnectionPool::ConnectionHandle> ConnectionPool::SpecificPool::getConnec
         timeout = _parent->_options.refreshTimeout;
     }
 
-    const auto expiration = _parent->_factory->now() + timeout;
+    const auto now = _parent->_factory->now();
+    const auto expiration = now + timeout;
     auto pf = makePromiseFuture<ConnectionHandle>();
 
+    if (_parent->_options.adaptiveSizing) {
+        sampleAdaptiveLoad(now);
+    }
+
     _requests.push_back(make_pair(expiration, pf.promise.share()));
     std::push_heap(begin(_requests), end(_requests), RequestComparator{});
 
@@ -474,6 +583,10 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
                                                     stdx::unique_lock<stdx::mutex> lk) {
     auto needsRefreshTP = connPtr->getLastUsed() + _parent->_options.refreshRequirement;
 
+    if (_parent->_options.adaptiveSizing) {
+        sampleAdaptiveLoad(_parent->_factory->now());
+    }
+
     auto conn = takeFromPool(_checkedOutPool, connPtr);
     invariant(conn);
 
@@ -552,6 +665,12 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
     }
 
     updateStateInLock();
+
+    // The adaptive controller may have held back connections for requests that are still
+    // waiting; give it a chance to grow the pool now rather than at the next request.
+    if (_parent->_options.adaptiveSizing && _requests.size()) {
+        spawnConnections(lk);
+    }
 }
 
 // Adds a live connection to the ready pool
@@ -652,54 +771,73 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
     _inFulfillRequests = true;
     auto guard = MakeGuard([&] { _inFulfillRequests = false; });
 
-    while (_requests.size()) {
-        // _readyPool is an LRUCache, so its begin() object is the MRU item.
-        auto iter = _readyPool.begin();
+    // Check out connections for as many requests as we can, then hand them all over with a
+    // single release of the lock rather than one per request. Connections that became ready while
+    // we were handing over the last batch are picked up by the next pass.
+    std::vector<std::pair<SharedPromise<ConnectionHandle>, ConnectionInterface*>> fulfilled;
+    while (true) {
+        if (_parent->_options.adaptiveSizing && _requests.size() && _readyPool.size()) {
+            sampleAdaptiveLoad(_parent->_factory->now());
+        }
+
+        while (_requests.size()) {
+            // _readyPool is an LRUCache, so its begin() object is the MRU item.
+            auto iter = _readyPool.begin();
 
-        if (iter == _readyPool.end())
-            break;
+            if (iter == _readyPool.end())
+                break;
 
-        // Grab the connection and cancel its timeout
-        auto conn = std::move(iter->second);
-        _readyPool.erase(iter);
-        conn->cancelTimeout();
+            // Grab the connection and cancel its timeout
+            auto conn = std::move(iter->second);
+            _readyPool.erase(iter);
+            conn->cancelTimeout();
 
-        if (!conn->isHealthy()) {
-            log() << "dropping unhealthy pooled connection to " << conn->getHostAndPort();
+            if (!conn->isHealthy()) {
+                log() << "dropping unhealthy pooled connection to " << conn->getHostAndPort();
+
+                if (_readyPool.empty()) {
+                    log() << "after drop, pool was empty, going to spawn some connections";
+                    // Spawn some more connections to the bad host if we're all out.
+                    spawnConnections(lk);
+                }
 
-            if (_readyPool.empty()) {
-                log() << "after drop, pool was empty, going to spawn some connections";
-                // Spawn some more connections to the bad host if we're all out.
-                spawnConnections(lk);
+                // Drop the bad connection.
+                conn.reset();
+                // Retry.
+                continue;
             }
 
-            // Drop the bad connection.
-            conn.reset();
-            // Retry.
-            continue;
-        }
+            // Grab the request and callback
+            auto promise = std::move(_requests.front().second);
+            std::pop_heap(begin(_requests), end(_requests), RequestComparator{});
+            _requests.pop_back();
+
+            auto connPtr = conn.get();
 
-        // Grab the request and callback
-        auto promise = std::move(_requests.front().second);
-        std::pop_heap(begin(_requests), end(_requests), RequestComparator{});
-        _requests.pop_back();
+            // check out the connection
+            _checkedOutPool[connPtr] = std::move(conn);
 
-        auto connPtr = conn.get();
+            connPtr->resetToUnknown();
+            fulfilled.emplace_back(std::move(promise), connPtr);
+        }
 
-        // check out the connection
-        _checkedOutPool[connPtr] = std::move(conn);
+        if (fulfilled.empty())
+            return;
 
         updateStateInLock();
 
-        // pass it to the user
-        connPtr->resetToUnknown();
+        // pass them to the users
         lk.unlock();
-        ConnectionHandle handle(connPtr,
-                                guardCallback([this](stdx::unique_lock<stdx::mutex> localLk,
-                                                     ConnectionPool::ConnectionInterface* conn) {
-                                    returnConnection(conn, std::move(localLk));
-                                }));
-        promise.emplaceValue(std::move(handle));
+        for (auto& request : fulfilled) {
+            ConnectionHandle handle(
+                request.second,
+                guardCallback([this](stdx::unique_lock<stdx::mutex> localLk,
+                                     ConnectionPool::ConnectionInterface* conn) {
+                    returnConnection(conn, std::move(localLk));
+                }));
+            request.first.emplaceValue(std::move(handle));
+        }
+        fulfilled.clear();
         lk.lock();
     }
 }
@@ -715,11 +853,19 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
     _inSpawnConnections = true;
     auto guard = MakeGuard([&] { _inSpawnConnections = false; });
 
-    // We want minConnections <= outstanding requests <= maxConnections
+    if (_parent->_options.adaptiveSizing) {
+        updateAdaptiveTarget(_parent->_factory->now());
+    }
+
+    // We want minConnections <= outstanding requests <= maxConnections, and with adaptive sizing
+    // no more than the adaptive target, which itself lies within those bounds.
     auto target = [&] {
-        return std::max(
-            _parent->_options.minConnections,
-            std::min(_requests.size() + _checkedOutPool.size(), _parent->_options.maxConnections));
+        auto cap = _parent->_options.maxConnections;
+        if (_parent->_options.adaptiveSizing) {
+            cap = _adaptiveTarget;
+        }
+        return std::max(_parent->_options.minConnections,
+                        std::min(_requests.size() + _checkedOutPool.size(), cap));
     };
 
     // While all of our inflight connections are less than our target
@@ -798,15 +944,60 @@ ConnectionPool::SpecificPool::OwnedConnection ConnectionPool::SpecificPool::take
     return takeFromPool(_droppedProcessingPool, connPtr);
 }
 
+void ConnectionPool::SpecificPool::sampleAdaptiveLoad(Date_t now) {
+    if (now <= _adaptiveLastSample)
+        return;
+
+    const auto elapsed = durationCount<Milliseconds>(now - _adaptiveLastSample);
+    _inUseIntegral += static_cast<double>(_checkedOutPool.size()) * elapsed;
+    _queuedIntegral += static_cast<double>(_requests.size()) * elapsed;
+    _adaptiveLastSample = now;
+}
+
+void ConnectionPool::SpecificPool::updateAdaptiveTarget(Date_t now) {
+    sampleAdaptiveLoad(now);
+
+    const auto elapsed = _adaptiveLastSample - _adaptiveIntervalStart;
+    if (elapsed < _parent->_options.adaptiveInterval)
+        return;
+
+    const double elapsedMillis = durationCount<Milliseconds>(elapsed);
+    _avgInUse = _inUseIntegral / elapsedMillis;
+    _avgQueued = _queuedIntegral / elapsedMillis;
+    _inUseIntegral = 0;
+    _queuedIntegral = 0;
+    _adaptiveIntervalStart = _adaptiveLastSample;
+
+    // Leave a quarter again of the connections in use idle, so that ordinary jitter in the
+    // request rate is absorbed by the ready pool rather than by queueing.
+    constexpr double kHeadroom = 0.25;
+    auto desired = static_cast<size_t>(std::ceil(_avgInUse * (1 + kHeadroom)));
+
+    const double targetQueueDepth = _parent->_options.adaptiveTargetQueueDepth;
+    if (_avgQueued > targetQueueDepth) {
+        desired += static_cast<size_t>(std::ceil(_avgQueued - targetQueueDepth));
+    }
+
+    const auto maxGrowth = std::max(_adaptiveTarget / 2, size_t(1));
+    desired = std::min(desired, _adaptiveTarget + maxGrowth);
+
+    const auto minTarget = std::max(_parent->_options.minConnections, size_t(1));
+    _adaptiveTarget = std::min(std::max(desired, minTarget), _parent->_options.maxConnections);
+}
 
 // Updates our state and manages the request timer
 void ConnectionPool::SpecificPool::updateStateInLock() {
     if (_state == State::kInShutdown) {
         // If we're in shutdown, there is nothing to update. Our clients are all gone.
         if (_processingPool.empty() && !_activeClients) {
-            // If we have no more clients that require access to us, delist from the parent pool
-            LOG(2) << "Delisting connection pool for " << _hostAndPort;
-            _parent->_pools.erase(_hostAndPort);
+            // If we have no more clients that require access to us, delist from the parent pool,
+            // unless a new pool for our host has already taken our place.
+            stdx::lock_guard<stdx::mutex> poolsLk(_parent->_mutex);
+            auto iter = _parent->_pools.find(_hostAndPort);
+            if (iter != _parent->_pools.end() && iter->second.get() == this) {
+                LOG(2) << "Delisting connection pool for " << _hostAndPort;
+                _parent->_pools.erase(iter);
+            }
         }
         return;
     }
@@ -814,18 +1005,26 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
     if (_requests.size()) {
         // We have some outstanding requests, we're live
 
+        // With adaptive sizing, also wake up at the end of the current interval, so that the
+        // target keeps growing while requests queue behind connections which stay checked out.
+        auto expiration = _requests.front().first;
+        if (_parent->_options.adaptiveSizing) {
+            expiration =
+                std::min(expiration, _adaptiveIntervalStart + _parent->_options.adaptiveInterval);
+        }
+
         // If we were already running and the timer is the same as it was
         // before, nothing to do
-        if (_state == State::kRunning && _requestTimerExpiration == _requests.front().first)
+        if (_state == State::kRunning && _requestTimerExpiration == expiration)
             return;
 
         _state = State::kRunning;
 
         _requestTimer->cancelTimeout();
 
-        _requestTimerExpiration = _requests.front().first;
+        _requestTimerExpiration = expiration;
 
-        auto timeout = _requests.front().first - _parent->_factory->now();
+        auto timeout = expiration - _parent->_factory->now();
 
         // We set a timer for the most recent request, then invoke each timed
         // out request we couldn't service
@@ -833,24 +1032,32 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
             timeout, guardCallback([this](stdx::unique_lock<stdx::mutex> lk) {
                 auto now = _parent->_factory->now();
 
-                while (_requests.size()) {
-                    auto& x = _requests.front();
-
-                    if (x.first <= now) {
-                        auto promise = std::move(x.second);
-                        std::pop_heap(begin(_requests), end(_requests), RequestComparator{});
-                        _requests.pop_back();
+                // Collect every expired request first so that they're all failed with a single
+                // release of the lock.
+                std::vector<SharedPromise<ConnectionHandle>> expired;
+                while (_requests.size() && _requests.front().first <= now) {
+                    expired.push_back(std::move(_requests.front().second));
+                    std::pop_heap(begin(_requests), end(_requests), RequestComparator{});
+                    _requests.pop_back();
+                }
 
-                        lk.unlock();
-                        promise.setError(Status(ErrorCodes::NetworkInterfaceExceededTimeLimit,
-                                                "Couldn't get a connection within the time limit"));
-                        lk.lock();
-                    } else {
-                        break;
-                    }
+                // Re-evaluate the adaptive target, and open connections for the remaining
+                // requests if it grew.
+                if (_parent->_options.adaptiveSizing && _requests.size()) {
+                    updateAdaptiveTarget(now);
+                    spawnConnections(lk);
                 }
 
                 updateStateInLock();
+
+                if (expired.empty())
+                    return;
+
+                lk.unlock();
+                for (auto& promise : expired) {
+                    promise.setError(Status(ErrorCodes::NetworkInterfaceExceededTimeLimit,
+                                            "Couldn't get a connection within the time limit"));
+                }
             }));
     } else if (_checkedOutPool.size()) {
         // If we have no requests, but someone's using a connection, we just
@@ -876,7 +1083,7 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
 
         // Set the shutdown timer, this gets reset on any request
         _requestTimer->setTimeout(timeout, [ this, anchor = shared_from_this() ]() {
-            stdx::unique_lock<stdx::mutex> lk(anchor->_parent->_mutex);
+            auto lk = anchor->lockPool();
             if (_state != State::kIdle)
                 return;
 
@@ -78,6 +78,8 @@ public:
     static const size_t kDefaultMaxConnecting;
     static constexpr Milliseconds kDefaultRefreshRequirement = Milliseconds(60000);  // 1min
     static constexpr Milliseconds kDefaultRefreshTimeout = Milliseconds(20000);      // 20secs
+    static constexpr Milliseconds kDefaultAdaptiveInterval = Milliseconds(100);
+    static constexpr size_t kDefaultAdaptiveTargetQueueDepth = 1;
 
     static const Status kConnectionStateUnknown;
 
@@ -122,6 +124,26 @@ public:
          */
         Milliseconds hostTimeout = kDefaultHostTimeout;
 
+        /**
+         * If set, each host's pool sizes itself to the concurrency it has actually needed
+         * recently, rather than opening a connection for every queued request. This keeps a
+         * latency blip on one host, which makes requests pile up, from turning into a
+         * connection storm against it. Bounded by minConnections and maxConnections.
+         */
+        bool adaptiveSizing = false;
+
+        /**
+         * How often the adaptive controller re-evaluates a pool's target size. The target may
+         * grow by at most half of itself (and at least one connection) per interval.
+         */
+        Milliseconds adaptiveInterval = kDefaultAdaptiveInterval;
+
+        /**
+         * The average number of requests the adaptive controller lets wait for a connection
+         * before it grows a pool beyond the connections that have been in use.
+         */
+        size_t adaptiveTargetQueueDepth = kDefaultAdaptiveTargetQueueDepth;
+
         /**
          * An egress tag closer manager which will provide global access to this connection pool.
          * The manager set's tags and potentially drops connections that don't match those tags.
@@ -157,6 +179,12 @@ public:
 private:
     void returnConnection(ConnectionInterface* connection);
 
+    /**
+     * Returns the pool for 'hostAndPort', or nullptr if there is none. Callers must hold on to the
+     * returned pointer while they use the pool, since it may delist itself at any time.
+     */
+    std::shared_ptr<SpecificPool> findPool(const HostAndPort& hostAndPort) const;
+
     std::string _name;
 
     // Options are set at startup and never changed at run time, so these are
@@ -165,7 +193,9 @@ private:
 
     const std::shared_ptr<DependentTypeFactoryInterface> _factory;
 
-    // The global mutex for specific pool access and the generation counter
+    // Guards only the map of specific pools. Each SpecificPool has its own mutex for its
+    // connections and requests, so that egress to one host never waits on egress to another. A
+    // SpecificPool's mutex may be held while acquiring this one, but never the other way around.
     mutable stdx::mutex _mutex;
     stdx::unordered_map<HostAndPort, std::shared_ptr<SpecificPool>> _pools;
 
@@ -35,6 +35,18 @@
 
 namespace mongo {
 namespace executor {
+namespace {
+
+void appendAdaptiveStats(BSONObjBuilder& hostInfo, const ConnectionStatsPer& hostStats) {
+    if (!hostStats.adaptiveTarget)
+        return;
+
+    hostInfo.appendNumber("adaptiveTarget", hostStats.adaptiveTarget);
+    hostInfo.append("adaptiveAvgInUse", hostStats.adaptiveAvgInUse);
+    hostInfo.append("adaptiveAvgQueued", hostStats.adaptiveAvgQueued);
+}
+
+}  // namespace
 
 ConnectionStatsPer::ConnectionStatsPer(size_t nInUse,
                                        size_t nAvailable,
@@ -49,6 +61,12 @@ ConnectionStatsPer& ConnectionStatsPer::operator+=(const ConnectionStatsPer& oth
     available += other.available;
     created += other.created;
     refreshing += other.refreshing;
+    lockAcquisitions += other.lockAcquisitions;
+    lockContended += other.lockContended;
+    lockWaitMicros += other.lockWaitMicros;
+    adaptiveTarget += other.adaptiveTarget;
+    adaptiveAvgInUse += other.adaptiveAvgInUse;
+    adaptiveAvgQueued += other.adaptiveAvgQueued;
 
     return *this;
 }
@@ -66,6 +84,9 @@ void ConnectionPoolStats::updateStatsForHost(std::string pool,
     totalAvailable += newStats.available;
     totalCreated += newStats.created;
     totalRefreshing += newStats.refreshing;
+    totalLockAcquisitions += newStats.lockAcquisitions;
+    totalLockContended += newStats.lockContended;
+    totalLockWaitMicros += newStats.lockWaitMicros;
 }
 
 void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
@@ -73,6 +94,9 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
     result.appendNumber("totalAvailable", totalAvailable);
     result.appendNumber("totalCreated", totalCreated);
     result.appendNumber("totalRefreshing", totalRefreshing);
+    result.appendNumber("totalLockAcquisitions", totalLockAcquisitions);
+    result.appendNumber("totalLockContended", totalLockContended);
+    result.appendNumber("totalLockWaitMicros", totalLockWaitMicros);
 
     {
         BSONObjBuilder poolBuilder(result.subobjStart("pools"));
@@ -83,6 +107,14 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
             poolInfo.appendNumber("poolAvailable", poolStats.available);
             poolInfo.appendNumber("poolCreated", poolStats.created);
             poolInfo.appendNumber("poolRefreshing", poolStats.refreshing);
+            poolInfo.appendNumber("poolLockAcquisitions", poolStats.lockAcquisitions);
+            poolInfo.appendNumber("poolLockContended", poolStats.lockContended);
+            poolInfo.appendNumber("poolLockWaitMicros", poolStats.lockWaitMicros);
+            if (poolStats.adaptiveTarget) {
+                poolInfo.appendNumber("poolAdaptiveTarget", poolStats.adaptiveTarget);
+                poolInfo.append("poolAdaptiveAvgInUse", poolStats.adaptiveAvgInUse);
+                poolInfo.append("poolAdaptiveAvgQueued", poolStats.adaptiveAvgQueued);
+            }
             for (auto&& host : statsByPoolHost[pool.first]) {
                 BSONObjBuilder hostInfo(poolInfo.subobjStart(host.first.toString()));
                 auto hostStats = host.second;
@@ -90,6 +122,10 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
                 hostInfo.appendNumber("available", hostStats.available);
                 hostInfo.appendNumber("created", hostStats.created);
                 hostInfo.appendNumber("refreshing", hostStats.refreshing);
+                hostInfo.appendNumber("lockAcquisitions", hostStats.lockAcquisitions);
+                hostInfo.appendNumber("lockContended", hostStats.lockContended);
+                hostInfo.appendNumber("lockWaitMicros", hostStats.lockWaitMicros);
+                appendAdaptiveStats(hostInfo, hostStats);
             }
         }
     }
@@ -102,6 +138,10 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
             hostInfo.appendNumber("available", hostStats.available);
             hostInfo.appendNumber("created", hostStats.created);
             hostInfo.appendNumber("refreshing", hostStats.refreshing);
+            hostInfo.appendNumber("lockAcquisitions", hostStats.lockAcquisitions);
+            hostInfo.appendNumber("lockContended", hostStats.lockContended);
+            hostInfo.appendNumber("lockWaitMicros", hostStats.lockWaitMicros);
+            appendAdaptiveStats(hostInfo, hostStats);
         }
     }
 }
@@ -49,6 +49,19 @@ struct ConnectionStatsPer {
     size_t available = 0u;
     size_t created = 0u;
     size_t refreshing = 0u;
+
+    // How often the pool's lock was taken, how often that had to wait for another thread, and
+    // for how long in total.
+    size_t lockAcquisitions = 0u;
+    size_t lockContended = 0u;
+    size_t lockWaitMicros = 0u;
+
+    // The state of the adaptive sizing controller, if the pool uses one: the number of
+    // connections it is currently willing to open, and the average number of connections in use
+    // and requests waiting over its last interval.
+    size_t adaptiveTarget = 0u;
+    double adaptiveAvgInUse = 0;
+    double adaptiveAvgQueued = 0;
 };
 
 /**
@@ -65,6 +78,9 @@ struct ConnectionPoolStats {
     size_t totalAvailable = 0u;
     size_t totalCreated = 0u;
     size_t totalRefreshing = 0u;
+    size_t totalLockAcquisitions = 0u;
+    size_t totalLockContended = 0u;
+    size_t totalLockWaitMicros = 0u;
 
     stdx::unordered_map<std::string, ConnectionStatsPer> statsByPool;
     stdx::unordered_map<HostAndPort, ConnectionStatsPer> statsByHost;
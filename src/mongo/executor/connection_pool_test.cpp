@@ -34,6 +34,7 @@
 #include "mongo/executor/connection_pool_test_fixture.h"
 
 #include "mongo/executor/connection_pool.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
@@ -1376,6 +1377,194 @@ TEST_F(ConnectionPoolTest, DropConnectionsByTagInMultipleViaManager) {
     dropConnectionsByTagTest(pool, manager);
 }
 
+/**
+ * Verify that a pool which has been shut down, but is still listed because a callback is running
+ * on it, is replaced by a fresh pool for new requests rather than handed them.
+ */
+TEST_F(ConnectionPoolTest, ShutdownPoolIsReplacedWhileInUse) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool");
+
+    ConnectionPool::ConnectionHandle connA;
+    bool reachedB = false;
+
+    // The setup callback fulfills this request, and keeps the pool listed while it runs
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 connA = std::move(swConn.getValue());
+
+                 pool.shutdown();
+
+                 pool.get(HostAndPort(),
+                          Milliseconds(5000),
+                          [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                              ASSERT(swConn.isOK());
+                              ASSERT_NE(CONN2ID(swConn),
+                                        static_cast<ConnectionImpl*>(connA.get())->id());
+                              reachedB = true;
+                              doneWith(swConn.getValue());
+                          });
+             });
+
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT(connA);
+    ASSERT(!reachedB);
+
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT(reachedB);
+
+    doneWith(connA);
+    connA.reset();
+
+    ASSERT_EQ(pool.getNumConnectionsPerHost(HostAndPort()), 1u);
+}
+
+/**
+ * Verify that each host's pool reports how often its lock was taken.
+ */
+TEST_F(ConnectionPoolTest, LockStatsAreReportedPerHost) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool");
+
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(HostAndPort("localhost:30000"),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 doneWith(swConn.getValue());
+             });
+
+    ConnectionPoolStats stats;
+    pool.appendConnectionStats(&stats);
+
+    auto& hostStats = stats.statsByHost[HostAndPort("localhost:30000")];
+    ASSERT_EQ(hostStats.available, 1u);
+    ASSERT_GT(hostStats.lockAcquisitions, 0u);
+    ASSERT_EQ(hostStats.lockContended, 0u);
+    ASSERT_EQ(stats.totalLockAcquisitions, hostStats.lockAcquisitions);
+
+    BSONObjBuilder bob;
+    stats.appendToBSON(bob);
+    auto obj = bob.obj();
+    ASSERT_EQ(obj["totalLockContended"].numberLong(), 0);
+    ASSERT(obj["hosts"]["localhost:30000"]["lockWaitMicros"].isNumber());
+}
+
+/**
+ * Verify that with adaptive sizing, a burst of queued requests grows the pool gradually rather
+ * than opening a connection for every request, and that the controller reports its target.
+ */
+TEST_F(ConnectionPoolTest, adaptiveSizingDampsGrowth) {
+    ConnectionPool::Options options;
+    options.adaptiveSizing = true;
+    options.adaptiveInterval = Milliseconds(100);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
+
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    std::vector<ConnectionPool::ConnectionHandle> connections;
+    const auto guard = MakeGuard([&] {
+        for (auto& conn : connections) {
+            doneWith(conn);
+        }
+        connections.clear();
+    });
+
+    for (size_t i = 0; i < 10; ++i) {
+        pool.get(HostAndPort(),
+                 Milliseconds(5000),
+                 [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                     if (swConn.isOK()) {
+                         connections.push_back(std::move(swConn.getValue()));
+                     }
+                 });
+    }
+
+    // Only the initial target of one connection is being set up
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), 1u);
+
+    // After an interval of ten queued requests, the target grows by one connection
+    PoolImpl::setNow(now + Milliseconds(100));
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT_EQ(connections.size(), 1u);
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), 1u);
+
+    ConnectionPoolStats stats;
+    pool.appendConnectionStats(&stats);
+    auto& hostStats = stats.statsByHost[HostAndPort()];
+    ASSERT_EQ(hostStats.adaptiveTarget, 2u);
+    ASSERT_EQ(hostStats.adaptiveAvgQueued, 10.0);
+
+    // Without adaptive sizing, every queued request gets a connection of its own
+    ConnectionPool unboundedPool(stdx::make_unique<PoolImpl>(), "unbounded pool");
+    for (size_t i = 0; i < 10; ++i) {
+        unboundedPool.get(HostAndPort("localhost:30000"),
+                          Milliseconds(5000),
+                          [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                              if (swConn.isOK()) {
+                                  connections.push_back(std::move(swConn.getValue()));
+                              }
+                          });
+    }
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), 11u);
+}
+
+/**
+ * Verify that with adaptive sizing, the target keeps growing while requests are queued even if no
+ * connection is returned and no new request arrives.
+ */
+TEST_F(ConnectionPoolTest, adaptiveSizingGrowsWhileConnectionsStayCheckedOut) {
+    ConnectionPool::Options options;
+    options.adaptiveSizing = true;
+    options.adaptiveInterval = Milliseconds(100);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
+
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    std::vector<ConnectionPool::ConnectionHandle> connections;
+    const auto guard = MakeGuard([&] {
+        for (auto& conn : connections) {
+            doneWith(conn);
+        }
+        connections.clear();
+    });
+
+    auto getConnection = [&] {
+        pool.get(HostAndPort(),
+                 Milliseconds(5000),
+                 [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                     if (swConn.isOK()) {
+                         connections.push_back(std::move(swConn.getValue()));
+                     }
+                 });
+    };
+
+    // Check out the initial target of one connection, and queue more requests behind it
+    getConnection();
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT_EQ(connections.size(), 1u);
+    for (size_t i = 0; i < 10; ++i) {
+        getConnection();
+    }
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), 0u);
+
+    // Once the interval ends, the request timer grows the target and opens a connection
+    PoolImpl::setNow(now + Milliseconds(100));
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), 1u);
+
+    ConnectionPoolStats stats;
+    pool.appendConnectionStats(&stats);
+    ASSERT_EQ(stats.statsByHost[HostAndPort()].adaptiveTarget, 2u);
+
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT_EQ(connections.size(), 2u);
+
+    // And again at the end of the next interval
+    PoolImpl::setNow(now + Milliseconds(200));
+    ASSERT_EQ(ConnectionImpl::setupQueueDepth(), 1u);
+}
+
 }  // namespace connection_pool_test_details
 }  // namespace executor
 }  // namespace mongo
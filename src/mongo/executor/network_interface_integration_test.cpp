@@ -36,9 +36,11 @@
 #include "mongo/base/status_with.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/db/commands/test_commands_enabled.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/executor/network_connection_hook.h"
 #include "mongo/executor/network_interface_integration_fixture.h"
+#include "mongo/executor/network_interface_tl.h"
 #include "mongo/executor/test_network_connection_hook.h"
 #include "mongo/rpc/factory.h"
 #include "mongo/rpc/get_status_from_command_result.h"
@@ -161,6 +163,30 @@ public:
                                     timeout ? *timeout : RemoteCommandRequest::kNoTimeout);
     }
 
+    // A find that may be coalesced with identical ones in flight: its reply holds the whole result,
+    // and its readConcern pins the point in time the reply must reflect.
+    RemoteCommandRequest makeCoalescibleFind() {
+        return makeTestCommand(boost::none,
+                               BSON("find"
+                                    << "system.version"
+                                    << "singleBatch"
+                                    << true
+                                    << "readConcern"
+                                    << BSON("level"
+                                            << "local"
+                                            << "afterClusterTime"
+                                            << Timestamp(1, 1))));
+    }
+
+    RemoteCommandResponse configureFindFailPoint(StringData mode) {
+        auto request = makeTestCommand(boost::none,
+                                       BSON("configureFailPoint"
+                                            << "waitInFindBeforeMakingBatch"
+                                            << "mode"
+                                            << mode));
+        return runCommandSync(request);
+    }
+
     struct IsMasterData {
         BSONObj request;
         RemoteCommandResponse response;
@@ -377,6 +403,126 @@ TEST_F(NetworkInterfaceTest, IsMasterRequestMissingInternalClientInfoWhenNotInte
     assertNumOps(0u, 0u, 0u, 1u);
 }
 
+TEST_F(NetworkInterfaceTest, IdenticalReadsInFlightShareOneReply) {
+    // Only replica set members accept an afterClusterTime.
+    auto request = makeCoalescibleFind();
+    auto res = runCommandSync(request);
+    if (!res.isOK() || !getStatusFromCommandResult(res.data).isOK()) {
+        return;
+    }
+
+    // Hold the find on the server so that the identical ones are sure to find it in flight.
+    // mongos doesn't run finds itself, so there's nothing to hold it with there.
+    res = configureFindFailPoint("alwaysOn");
+    if (!res.isOK() || !getStatusFromCommandResult(res.data).isOK()) {
+        return;
+    }
+
+    networkInterfaceCoalesceReads.store(true);
+    ON_BLOCK_EXIT([] { networkInterfaceCoalesceReads.store(false); });
+
+    std::vector<Future<RemoteCommandResponse>> results;
+    for (int i = 0; i < 4; i++) {
+        results.push_back(runCommand(makeCallbackHandle(), request));
+    }
+
+    uassertStatusOK(configureFindFailPoint("off").status);
+
+    auto first = results.front().get();
+    uassertStatusOK(first.status);
+    uassertStatusOK(getStatusFromCommandResult(first.data));
+    for (auto&& result : results) {
+        auto reply = result.get();
+        ASSERT(reply.elapsedMillis);
+        ASSERT_BSONOBJ_EQ(reply.data, first.data);
+    }
+
+    // Only the first find went over the network, along with the find run before coalescing was
+    // enabled and the two configureFailPoint commands.
+    assertNumOps(0u, 0u, 0u, 4u);
+}
+
+TEST_F(NetworkInterfaceTest, ReadsWithoutPinnedReadTimeSeeEarlierWrites) {
+    const NamespaceString nss("test.network_interface_coalesced_reads");
+    auto makeNssCommand = [&](BSONObj cmdObj) {
+        return RemoteCommandRequest(
+            fixture().getServers().front(), nss.db().toString(), cmdObj, BSONObj(), nullptr);
+    };
+    auto insert = [&](int id) {
+        auto request = makeNssCommand(
+            BSON("insert" << nss.coll() << "documents" << BSON_ARRAY(BSON("_id" << id))));
+        auto res = runCommandSync(request);
+        uassertStatusOK(res.status);
+        uassertStatusOK(getStatusFromCommandResult(res.data));
+    };
+    auto drop = [&] {
+        auto request = makeNssCommand(BSON("drop" << nss.coll()));
+        runCommandSync(request);
+    };
+    insert(0);
+
+    auto res = configureFindFailPoint("alwaysOn");
+    if (!res.isOK() || !getStatusFromCommandResult(res.data).isOK()) {
+        drop();
+        return;
+    }
+
+    networkInterfaceCoalesceReads.store(true);
+    ON_BLOCK_EXIT([] { networkInterfaceCoalesceReads.store(false); });
+
+    // A read issued after a write is acknowledged must see it, even while an identical read
+    // issued before the write is still in flight.
+    auto request = makeNssCommand(BSON("find" << nss.coll() << "singleBatch" << true));
+    auto before = runCommand(makeCallbackHandle(), request);
+    insert(1);
+    auto after = runCommand(makeCallbackHandle(), request);
+
+    uassertStatusOK(configureFindFailPoint("off").status);
+
+    uassertStatusOK(before.get().status);
+    auto afterRes = after.get();
+    uassertStatusOK(afterRes.status);
+    uassertStatusOK(getStatusFromCommandResult(afterRes.data));
+    auto batch = afterRes.data["cursor"]["firstBatch"].Array();
+    ASSERT(std::any_of(batch.begin(), batch.end(), [](const BSONElement& doc) {
+        return doc["_id"].numberInt() == 1;
+    })) << afterRes.data;
+
+    // Both finds went over the network, along with the two inserts and the two
+    // configureFailPoint commands.
+    assertNumOps(0u, 0u, 0u, 6u);
+
+    drop();
+}
+
+TEST_F(NetworkInterfaceTest, ReadsWaitingOnCanceledReadAreSentAlone) {
+    networkInterfaceCoalesceReads.store(true);
+    ON_BLOCK_EXIT([] { networkInterfaceCoalesceReads.store(false); });
+
+    auto request = makeCoalescibleFind();
+    auto cbh = makeCallbackHandle();
+    Future<RemoteCommandResponse> first;
+    std::vector<Future<RemoteCommandResponse>> waiting;
+    {
+        FailPointEnableBlock fpb("networkInterfaceDiscardCommandsBeforeAcquireConn");
+        first = runCommand(cbh, request);
+        for (int i = 0; i < 3; i++) {
+            waiting.push_back(runCommand(makeCallbackHandle(), request));
+        }
+    }
+
+    net().cancelCommand(cbh);
+    ASSERT_EQ(ErrorCodes::CallbackCanceled, first.get().status);
+
+    // Cancelation is particular to the first read, so the others are sent once it's canceled.
+    for (auto&& result : waiting) {
+        auto res = result.get();
+        ASSERT(res.elapsedMillis);
+        uassertStatusOK(res.status);
+    }
+    assertNumOps(1u, 0u, 0u, 3u);
+}
+
 }  // namespace
 }  // namespace executor
 }  // namespace mongo
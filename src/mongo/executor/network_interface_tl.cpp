@@ -32,9 +32,13 @@
 
 #include "mongo/executor/network_interface_tl.h"
 
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/commands/test_commands_enabled.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/connection_pool_tl.h"
+#include "mongo/rpc/metadata/logical_time_metadata.h"
 #include "mongo/transport/transport_layer_manager.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/log.h"
@@ -43,6 +47,106 @@
 namespace mongo {
 namespace executor {
 
+MONGO_EXPORT_SERVER_PARAMETER(networkInterfaceCoalesceReads, bool, false);
+
+namespace {
+
+// Reads sent while identical ones could wait for their reply.
+Counter64 coalescedReadsSent;
+ServerStatusMetricField<Counter64> displayCoalescedReadsSent("network.coalescedReads.sent",
+                                                            &coalescedReadsSent);
+
+// Reads that waited for the reply to an identical one instead of being sent.
+Counter64 coalescedReadsJoined;
+ServerStatusMetricField<Counter64> displayCoalescedReadsJoined("network.coalescedReads.joined",
+                                                              &coalescedReadsJoined);
+
+// Reads that waited, but were then sent on their own since the reply couldn't be shared.
+Counter64 coalescedReadsResent;
+ServerStatusMetricField<Counter64> displayCoalescedReadsResent("network.coalescedReads.resent",
+                                                              &coalescedReadsResent);
+
+// Commands whose reply depends only on the command and the state of the host, and which leave no
+// state behind on the host once any cursor they open is exhausted.
+const StringData kCoalescibleCommands[] = {
+    "find"_sd, "count"_sd, "distinct"_sd, "listCollections"_sd, "listIndexes"_sd};
+
+// How many documents a find returns in its first batch when it doesn't specify a batchSize.
+const long long kDefaultFindBatchSize = 101;
+
+/**
+ * Returns whether the reply to 'cmdObj' can be expected to close any cursor it opens, so that it
+ * holds the whole result. A reply leaving a cursor open can't be shared, and the readers waiting
+ * for it would have to be sent again, so only these commands are coalesced.
+ */
+bool closesCursorInFirstBatch(StringData name, const BSONObj& cmdObj) {
+    if (name == "count"_sd || name == "distinct"_sd) {
+        return true;
+    }
+
+    if (name == "find"_sd) {
+        if (cmdObj["singleBatch"].trueValue()) {
+            return true;
+        }
+        auto limit = cmdObj["limit"];
+        if (!limit.isNumber() || limit.numberLong() <= 0) {
+            return false;
+        }
+        auto batchSize = cmdObj["batchSize"];
+        return limit.numberLong() <=
+            (batchSize.eoo() ? kDefaultFindBatchSize : batchSize.numberLong());
+    }
+
+    // listCollections and listIndexes return everything in their first batch unless asked not to.
+    return cmdObj.getObjectField("cursor")["batchSize"].eoo();
+}
+
+/**
+ * Returns whether the readConcern of 'cmdObj' names the point in time its reply must reflect. A
+ * read that doesn't may be relying on seeing the writes acknowledged before it was issued, which a
+ * reply to an identical read sent earlier can miss.
+ */
+bool pinsReadTime(const BSONObj& cmdObj) {
+    auto readConcern = cmdObj["readConcern"];
+    if (readConcern.type() != BSONType::Object) {
+        return false;
+    }
+    auto readConcernObj = readConcern.Obj();
+    return readConcernObj.hasField("afterClusterTime") || readConcernObj.hasField("afterOpTime");
+}
+
+/**
+ * Returns the key under which 'request' is coalesced with identical reads in flight, or none if
+ * it can't be.
+ */
+boost::optional<std::string> makeCoalescingKey(const RemoteCommandRequest& request) {
+    if (!networkInterfaceCoalesceReads.load()) {
+        return boost::none;
+    }
+
+    const auto& cmdObj = request.cmdObj;
+    auto name = cmdObj.firstElementFieldName();
+    if (std::find(std::begin(kCoalescibleCommands), std::end(kCoalescibleCommands), name) ==
+            std::end(kCoalescibleCommands) ||
+        cmdObj.hasField("lsid") || cmdObj.hasField("txnNumber") || cmdObj["tailable"].trueValue() ||
+        !pinsReadTime(cmdObj) || !closesCursorInFirstBatch(name, cmdObj)) {
+        return boost::none;
+    }
+
+    // The gossiped cluster time changes from one request to the next without changing the reply.
+    auto metadata = request.metadata.removeField(rpc::LogicalTimeMetadata::fieldName());
+
+    std::string key = request.target.toString();
+    key.push_back('\0');
+    key.append(request.dbname);
+    key.push_back('\0');
+    key.append(cmdObj.objdata(), cmdObj.objsize());
+    key.append(metadata.objdata(), metadata.objsize());
+    return key;
+}
+
+}  // namespace
+
 NetworkInterfaceTL::NetworkInterfaceTL(std::string instanceName,
                                        ConnectionPool::Options connPoolOpts,
                                        ServiceContext* svcCtx,
@@ -189,10 +293,74 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
         request.metadata = newMetadata.obj();
     }
 
+    auto key = makeCoalescingKey(request);
+    if (!key) {
+        _startCommand(cbHandle, request, onFinish, baton);
+        return Status::OK();
+    }
+
+    auto start = now();
+    auto deadline = RemoteCommandRequest::kNoExpirationDate;
+    if (request.timeout != request.kNoTimeout) {
+        deadline = start + request.timeout;
+    }
+
+    std::shared_ptr<ReadFlight> flight;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        auto it = _readFlights.find(*key);
+        if (it == _readFlights.end()) {
+            flight = std::make_shared<ReadFlight>();
+            flight->deadline = deadline;
+            _readFlights.emplace(*key, flight);
+        } else if (it->second->deadline <= deadline) {
+            // The read in flight will have finished, one way or another, before this one must.
+            auto read = std::make_shared<CoalescedRead>(request, cbHandle, onFinish, baton);
+            read->start = start;
+            read->deadline = deadline;
+            it->second->waiters.push_back(read);
+            _coalescedReads.emplace(cbHandle, read);
+            coalescedReadsJoined.increment();
+            return Status::OK();
+        }
+    }
+
+    if (!flight) {
+        // The identical read in flight may outlast this one's deadline.
+        _startCommand(cbHandle, request, onFinish, baton);
+        return Status::OK();
+    }
+
+    coalescedReadsSent.increment();
+    _startCommand(cbHandle,
+                  request,
+                  [ this, key = std::move(*key), flight, onFinish ](
+                      const RemoteCommandResponse& response) {
+                      _finishReadFlight(key, flight, response);
+                      onFinish(response);
+                  },
+                  baton);
+    return Status::OK();
+}
+
+void NetworkInterfaceTL::_startCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                                       RemoteCommandRequest& request,
+                                       const RemoteCommandCompletionFn& onFinish,
+                                       const transport::BatonHandle& baton,
+                                       const std::shared_ptr<CoalescedRead>& coalescedRead) {
     auto pf = makePromiseFuture<RemoteCommandResponse>();
     auto state = std::make_shared<CommandState>(request, cbHandle, std::move(pf.promise));
     {
         stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        if (coalescedRead) {
+            // cancelCommand removes the read from _coalescedReads under this lock. Checking here,
+            // where the command becomes visible to cancelCommand, leaves no window in which a
+            // cancel finishes the read but misses the command.
+            if (coalescedRead->done.load() || !_coalescedReads.count(cbHandle)) {
+                return;
+            }
+            coalescedRead->sentAlone = true;
+        }
         _inProgress.insert({state->cbHandle, state});
     }
 
@@ -206,7 +374,7 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
         std::move(pf.future).getAsync([onFinish](StatusWith<RemoteCommandResponse> response) {
             onFinish(RemoteCommandResponse(response.getStatus(), Milliseconds{0}));
         });
-        return Status::OK();
+        return;
     }
 
     // Interacting with the connection pool can involve more work than just getting a connection
@@ -287,8 +455,94 @@ Status NetworkInterfaceTL::startCommand(const TaskExecutor::CallbackHandle& cbHa
                 std::move(rw)(std::move(swConn));
             });
     }
+}
 
-    return Status::OK();
+void NetworkInterfaceTL::_finishReadFlight(const std::string& key,
+                                           const std::shared_ptr<ReadFlight>& flight,
+                                           const RemoteCommandResponse& response) {
+    std::vector<std::shared_ptr<CoalescedRead>> waiters;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        auto it = _readFlights.find(key);
+        if (it != _readFlights.end() && it->second == flight) {
+            _readFlights.erase(it);
+        }
+        waiters = std::move(flight->waiters);
+    }
+
+    // A failure may be particular to the read that was sent, for instance if it was canceled, and
+    // an open cursor can only be continued by one reader. Only reads expected to close their cursor
+    // are coalesced, but a first batch can still be cut short by its size in bytes.
+    auto cursorId = response.isOK() ? response.data.getObjectField("cursor")["id"] : BSONElement();
+    bool shareable = response.isOK() && !(cursorId.isNumber() && cursorId.numberLong() != 0);
+
+    for (auto&& read : waiters) {
+        if (shareable) {
+            _finishCoalescedRead(read, response);
+        } else {
+            coalescedReadsResent.increment();
+            _sendCoalescedReadAlone(read);
+        }
+    }
+}
+
+void NetworkInterfaceTL::_finishCoalescedRead(const std::shared_ptr<CoalescedRead>& read,
+                                              RemoteCommandResponse response) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        _coalescedReads.erase(read->cbHandle);
+    }
+
+    if (read->done.swap(true)) {
+        return;
+    }
+
+    response.elapsedMillis = now() - read->start;
+    if (read->baton) {
+        read->baton->schedule([read, response] { read->onFinish(response); });
+    } else {
+        read->onFinish(response);
+    }
+}
+
+void NetworkInterfaceTL::_sendCoalescedReadAlone(const std::shared_ptr<CoalescedRead>& read) {
+    if (read->done.load()) {
+        // Canceled while it waited.
+        return;
+    }
+
+    if (inShutdown()) {
+        _finishCoalescedRead(read,
+                             RemoteCommandResponse(
+                                 Status(ErrorCodes::ShutdownInProgress,
+                                        "NetworkInterface shutdown in progress"),
+                                 Milliseconds{0}));
+        return;
+    }
+
+    if (read->deadline != RemoteCommandRequest::kNoExpirationDate) {
+        auto nowVal = now();
+        if (nowVal >= read->deadline) {
+            _finishCoalescedRead(
+                read,
+                RemoteCommandResponse(
+                    Status(ErrorCodes::NetworkInterfaceExceededTimeLimit,
+                           str::stream() << "Remote command timed out while waiting for an "
+                                            "identical command in flight, timeout was set to "
+                                         << read->request.timeout),
+                    Milliseconds{0}));
+            return;
+        }
+        read->request.timeout = read->deadline - nowVal;
+    }
+
+    _startCommand(read->cbHandle,
+                  read->request,
+                  [this, read](const RemoteCommandResponse& response) {
+                      _finishCoalescedRead(read, response);
+                  },
+                  read->baton,
+                  read);
 }
 
 // This is only called from within a then() callback on a future, so throwing is equivalent to
@@ -406,6 +660,31 @@ void NetworkInterfaceTL::_eraseInUseConn(const TaskExecutor::CallbackHandle& cbH
 void NetworkInterfaceTL::cancelCommand(const TaskExecutor::CallbackHandle& cbHandle,
                                        const transport::BatonHandle& baton) {
     stdx::unique_lock<stdx::mutex> lk(_inProgressMutex);
+    auto readIt = _coalescedReads.find(cbHandle);
+    if (readIt != _coalescedReads.end()) {
+        auto read = readIt->second;
+        _coalescedReads.erase(readIt);
+
+        // A read that is being sent on its own is also canceled below, and counted there.
+        auto sentAlone = read->sentAlone;
+        lk.unlock();
+
+        if (!sentAlone && !read->done.load() && getTestCommandsEnabled()) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _counters.canceled++;
+        }
+
+        LOG(2) << "Canceling coalesced read; original request was: "
+               << redact(read->request.toString());
+        _finishCoalescedRead(read,
+                             RemoteCommandResponse(
+                                 Status(ErrorCodes::CallbackCanceled,
+                                        str::stream() << "Command canceled; original request was: "
+                                                      << redact(read->request.toString())),
+                                 Milliseconds{0}));
+        lk.lock();
+    }
+
     auto it = _inProgress.find(cbHandle);
     if (it == _inProgress.end()) {
         return;
@@ -29,11 +29,14 @@
 #pragma once
 
 #include <deque>
+#include <string>
+#include <vector>
 
 #include "mongo/client/async_client.h"
 #include "mongo/db/service_context.h"
 #include "mongo/executor/connection_pool.h"
 #include "mongo/executor/network_interface.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/rpc/metadata/metadata_hook.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/stdx/unordered_map.h"
@@ -43,6 +46,10 @@
 namespace mongo {
 namespace executor {
 
+// Whether concurrent identical reads to the same host are sent once, with the reply handed to
+// each of them. See NetworkInterfaceTL::startCommand.
+extern AtomicBool networkInterfaceCoalesceReads;
+
 class NetworkInterfaceTL : public NetworkInterface {
 public:
     NetworkInterfaceTL(std::string instanceName,
@@ -63,6 +70,18 @@ public:
     void waitForWorkUntil(Date_t when) override;
     void signalWorkAvailable() override;
     Date_t now() override;
+
+    /**
+     * When networkInterfaceCoalesceReads is set, a find, count, distinct, listCollections or
+     * listIndexes outside of a session that is identical to one already in flight to the same
+     * host, and that can wait as long for it, isn't sent. It gets the reply to the one in flight
+     * instead, unless that reply leaves a cursor open or the request fails, in which case it is
+     * sent on its own.
+     *
+     * The read in flight may have been sent before the identical one was issued, so only reads
+     * whose readConcern pins an afterClusterTime or afterOpTime are coalesced: any reply that
+     * satisfies the one in flight satisfies the identical read too.
+     */
     Status startCommand(const TaskExecutor::CallbackHandle& cbHandle,
                         RemoteCommandRequest& request,
                         const RemoteCommandCompletionFn& onFinish,
@@ -110,7 +129,53 @@ private:
         Promise<RemoteCommandResponse> promise;
     };
 
+    /**
+     * A read waiting for the reply to an identical one in flight.
+     */
+    struct CoalescedRead {
+        CoalescedRead(RemoteCommandRequest request_,
+                      TaskExecutor::CallbackHandle cbHandle_,
+                      RemoteCommandCompletionFn onFinish_,
+                      transport::BatonHandle baton_)
+            : request(std::move(request_)),
+              cbHandle(std::move(cbHandle_)),
+              onFinish(std::move(onFinish_)),
+              baton(std::move(baton_)) {}
+
+        RemoteCommandRequest request;
+        TaskExecutor::CallbackHandle cbHandle;
+        RemoteCommandCompletionFn onFinish;
+        transport::BatonHandle baton;
+        Date_t deadline = RemoteCommandRequest::kNoExpirationDate;
+        Date_t start;
+
+        // Set once the read has been sent on its own, after the reply to the one it waited for
+        // couldn't be shared.
+        bool sentAlone = false;  // (M) _inProgressMutex
+
+        AtomicBool done;
+    };
+
+    /**
+     * A read in flight, and the identical reads waiting for its reply.
+     */
+    struct ReadFlight {
+        Date_t deadline = RemoteCommandRequest::kNoExpirationDate;
+        std::vector<std::shared_ptr<CoalescedRead>> waiters;
+    };
+
     void _run();
+    void _startCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                       RemoteCommandRequest& request,
+                       const RemoteCommandCompletionFn& onFinish,
+                       const transport::BatonHandle& baton,
+                       const std::shared_ptr<CoalescedRead>& coalescedRead = nullptr);
+    void _finishReadFlight(const std::string& key,
+                           const std::shared_ptr<ReadFlight>& flight,
+                           const RemoteCommandResponse& response);
+    void _finishCoalescedRead(const std::shared_ptr<CoalescedRead>& read,
+                              RemoteCommandResponse response);
+    void _sendCoalescedReadAlone(const std::shared_ptr<CoalescedRead>& read);
     void _eraseInUseConn(const TaskExecutor::CallbackHandle& handle);
     Future<RemoteCommandResponse> _onAcquireConn(std::shared_ptr<CommandState> state,
                                                  Future<RemoteCommandResponse> future,
@@ -137,6 +202,9 @@ private:
     stdx::mutex _inProgressMutex;
     stdx::unordered_map<TaskExecutor::CallbackHandle, std::shared_ptr<CommandState>> _inProgress;
     stdx::unordered_set<std::shared_ptr<transport::ReactorTimer>> _inProgressAlarms;
+    stdx::unordered_map<std::string, std::shared_ptr<ReadFlight>> _readFlights;
+    stdx::unordered_map<TaskExecutor::CallbackHandle, std::shared_ptr<CoalescedRead>>
+        _coalescedReads;
 
     stdx::condition_variable _workReadyCond;
     bool _isExecutorRunnable = false;
@@ -30,7 +30,10 @@
 
 #include "mongo/rpc/message.h"
 
+#include <cstring>
+
 #include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
 
 namespace mongo {
 
@@ -42,4 +45,35 @@ int32_t nextMessageId() {
     return NextMsgId.fetchAndAdd(1);
 }
 
+void Message::splice(int offset, std::vector<SplicedBuffer> buffers) {
+    invariant(_buf);
+    invariant(_spliced.empty());
+    // The header must stay in our own buffer so it can be read and updated without flattening.
+    invariant(offset >= static_cast<int>(sizeof(MSGHEADER::Value)));
+
+    size_t splicedBytes = 0;
+    for (auto&& spliced : buffers) {
+        splicedBytes += spliced.size;
+    }
+    invariant(offset + splicedBytes <= static_cast<size_t>(size()));
+
+    _spliced = std::move(buffers);
+    _spliceOffset = offset;
+    _splicedBytes = splicedBytes;
+}
+
+void Message::_flattenSlow() const {
+    auto flat = SharedBuffer::allocate(size());
+    auto out = flat.get();
+    forEachSegment([&](const char* data, size_t size) {
+        memcpy(out, data, size);
+        out += size;
+    });
+
+    _buf = std::move(flat);
+    _spliced.clear();
+    _spliceOffset = 0;
+    _splicedBytes = 0;
+}
+
 }  // namespace mongo
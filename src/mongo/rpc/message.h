@@ -29,12 +29,15 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/encoded_value_storage.h"
 #include "mongo/base/static_assert.h"
+#include "mongo/platform/compiler.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
@@ -395,6 +398,15 @@ inline int ConstView::dataLen() const {
 
 class Message {
 public:
+    /**
+     * A buffer whose first 'size' bytes are sent as part of a message without being copied into
+     * the message's own buffer. See splice().
+     */
+    struct SplicedBuffer {
+        ConstSharedBuffer buffer;
+        size_t size;
+    };
+
     Message() = default;
     explicit Message(SharedBuffer data) : _buf(std::move(data)) {}
 
@@ -409,6 +421,7 @@ public:
 
     MsgData::View singleData() const {
         massert(13273, "single data buffer expected", _buf);
+        _flatten();
         return header();
     }
 
@@ -429,6 +442,48 @@ public:
 
     void reset() {
         _buf = {};
+        _clearSplice();
+    }
+
+    /**
+     * Releases this Message's reference to its buffer, leaving it empty. Any spliced buffers are
+     * dropped rather than copied into the returned buffer.
+     */
+    SharedBuffer releaseBuffer() {
+        _clearSplice();
+        return std::move(_buf);
+    }
+
+    /**
+     * Arranges for 'buffers' to be sent right after the first 'offset' bytes of this message's own
+     * buffer without being copied into it. The length in the header must already count them.
+     *
+     * Only the transport layer sends the pieces separately, see forEachSegment(). Anything that
+     * reads the message's bytes through buf(), sharedBuffer() or singleData() gets them copied
+     * into one contiguous buffer first.
+     */
+    void splice(int offset, std::vector<SplicedBuffer> buffers);
+
+    bool isSpliced() const {
+        return !_spliced.empty();
+    }
+
+    /**
+     * Calls 'cb(const char* data, size_t size)' for each contiguous piece of the message, in the
+     * order they go out on the wire.
+     */
+    template <typename Callback>
+    void forEachSegment(Callback&& cb) const {
+        if (_spliced.empty()) {
+            cb(_buf.get(), static_cast<size_t>(size()));
+            return;
+        }
+
+        cb(_buf.get(), static_cast<size_t>(_spliceOffset));
+        for (auto&& spliced : _spliced) {
+            cb(spliced.buffer.get(), spliced.size);
+        }
+        cb(_buf.get() + _spliceOffset, size() - _splicedBytes - _spliceOffset);
     }
 
     // use to set first buffer if empty
@@ -451,23 +506,47 @@ public:
     }
 
     char* buf() {
+        _flatten();
         return _buf.get();
     }
 
     const char* buf() const {
+        _flatten();
         return _buf.get();
     }
 
     SharedBuffer sharedBuffer() {
+        _flatten();
         return _buf;
     }
 
     ConstSharedBuffer sharedBuffer() const {
+        _flatten();
         return _buf;
     }
 
 private:
-    SharedBuffer _buf;
+    /**
+     * Copies any spliced buffers into a single buffer holding the whole message. This is logically
+     * const since the bytes of the message don't change.
+     */
+    void _flatten() const {
+        if (MONGO_unlikely(!_spliced.empty())) {
+            _flattenSlow();
+        }
+    }
+    void _flattenSlow() const;
+
+    void _clearSplice() {
+        _spliced.clear();
+        _spliceOffset = 0;
+        _splicedBytes = 0;
+    }
+
+    mutable SharedBuffer _buf;
+    mutable std::vector<SplicedBuffer> _spliced;
+    mutable int _spliceOffset = 0;
+    mutable size_t _splicedBytes = 0;
 };
 
 /**
@@ -45,7 +45,8 @@
 namespace mongo {
 namespace {
 
-auto kAllSupportedFlags = OpMsg::kChecksumPresent | OpMsg::kMoreToCome;
+auto kAllSupportedFlags =
+    OpMsg::kChecksumPresent | OpMsg::kMoreToCome | OpMsg::kExhaustSupported;
 
 bool containsUnknownRequiredFlags(uint32_t flags) {
     const uint32_t kRequiredFlagMask = 0xffff;  // Low 2 bytes are required, high 2 are optional.
@@ -63,8 +64,9 @@ uint32_t OpMsg::flags(const Message& message) {
     if (message.operation() != dbMsg)
         return 0;  // Other command protocols are the same as no flags set.
 
-    return BufReader(message.singleData().data(), message.dataSize())
-        .read<LittleEndian<uint32_t>>();
+    // The flags always precede anything spliced into the message, so read them from the header's
+    // buffer rather than flattening the message.
+    return BufReader(message.header().data(), message.dataSize()).read<LittleEndian<uint32_t>>();
 }
 
 void OpMsg::replaceFlags(Message* message, uint32_t flags) {
@@ -72,7 +74,7 @@ void OpMsg::replaceFlags(Message* message, uint32_t flags) {
     invariant(message->operation() == dbMsg);
     invariant(message->dataSize() >= static_cast<int>(sizeof(uint32_t)));
 
-    DataView(message->singleData().data()).write<LittleEndian<uint32_t>>(flags);
+    DataView(message->header().data()).write<LittleEndian<uint32_t>>(flags);
 }
 
 OpMsg OpMsg::parse(const Message& message) try {
@@ -174,6 +176,10 @@ void OpMsg::shareOwnershipWith(const ConstSharedBuffer& buffer) {
     if (!body.isOwned()) {
         body.shareOwnershipWith(buffer);
     }
+    shareDocumentSequenceOwnershipWith(buffer);
+}
+
+void OpMsg::shareDocumentSequenceOwnershipWith(const ConstSharedBuffer& buffer) {
     for (auto&& seq : sequences) {
         for (auto&& obj : seq.objs) {
             if (!obj.isOwned()) {
@@ -221,6 +227,65 @@ BSONObjBuilder OpMsgBuilder::resumeBody() {
 
 AtomicBool OpMsgBuilder::disableDupeFieldCheck_forTest{false};
 
+thread_local OpMsgBuilder* OpMsgBuilder::_splicingBuilder = nullptr;
+
+void OpMsgBuilder::enableSplicing() {
+    if (_splicingEnabled) {
+        return;
+    }
+    _previousSplicingBuilder = _splicingBuilder;
+    _splicingBuilder = this;
+    _splicingEnabled = true;
+}
+
+void OpMsgBuilder::disableSplicing() {
+    if (!_splicingEnabled) {
+        return;
+    }
+    // Builders are enabled and disabled in LIFO order on a thread, for example when a command
+    // runs another one through DBDirectClient, but be careful not to resurrect a stale builder.
+    if (_splicingBuilder == this) {
+        _splicingBuilder = _previousSplicingBuilder;
+    }
+    _previousSplicingBuilder = nullptr;
+    _splicingEnabled = false;
+}
+
+OpMsgBuilder* OpMsgBuilder::getSplicingBuilder(const BSONObjBuilder& body) {
+    auto builder = _splicingBuilder;
+    if (!builder || builder->_state != kBody || !builder->_spliced.empty()) {
+        return nullptr;
+    }
+    if (&body.bb() != &builder->_buf || body.offset() != builder->_bodyStart) {
+        return nullptr;
+    }
+    return builder;
+}
+
+void OpMsgBuilder::discardSplicedBuffers(const BufBuilder& buf) {
+    auto builder = _splicingBuilder;
+    if (builder && &buf == &builder->_buf) {
+        builder->_spliceOffset = 0;
+        builder->_spliced.clear();
+        builder->_splicedLengthOffsets.clear();
+    }
+}
+
+void OpMsgBuilder::splice(int offset,
+                          std::vector<Message::SplicedBuffer> buffers,
+                          std::vector<int> lengthOffsets) {
+    invariant(_state == kBody);
+    invariant(_spliced.empty());
+    invariant(offset > _bodyStart && offset < _buf.len());
+    for (auto lengthOffset : lengthOffsets) {
+        invariant(lengthOffset > _bodyStart && lengthOffset < offset);
+    }
+
+    _spliceOffset = offset;
+    _spliced = std::move(buffers);
+    _splicedLengthOffsets = std::move(lengthOffsets);
+}
+
 Message OpMsgBuilder::finish() {
     if (kDebugBuild && !disableDupeFieldCheck_forTest.load()) {
         std::set<StringData> seenFields;
@@ -238,13 +303,33 @@ Message OpMsgBuilder::finish() {
     invariant(!_openBuilder);
     _state = kDone;
 
-    const auto size = _buf.len();
+    disableSplicing();
+
+    int32_t splicedBytes = 0;
+    for (auto&& spliced : _spliced) {
+        splicedBytes += spliced.size;
+    }
+    if (splicedBytes) {
+        // Now that nothing else can be appended, grow the enclosing objects by the spliced bytes.
+        _splicedLengthOffsets.push_back(_bodyStart);
+        for (auto lengthOffset : _splicedLengthOffsets) {
+            DataView view(_buf.buf() + lengthOffset);
+            view.write<LittleEndian<int32_t>>(view.read<LittleEndian<int32_t>>() + splicedBytes);
+        }
+    }
+
+    const auto size = _buf.len() + splicedBytes;
     MSGHEADER::View header(_buf.buf());
     header.setMessageLength(size);
     // header.setRequestMsgId(...); // These are currently filled in by the networking layer.
     // header.setResponseToMsgId(...);
     header.setOpCode(dbMsg);
-    return Message(_buf.release());
+
+    Message message(_buf.release());
+    if (splicedBytes) {
+        message.splice(_spliceOffset, std::move(_spliced));
+    }
+    return message;
 }
 
 }  // namespace mongo
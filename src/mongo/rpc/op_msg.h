@@ -35,6 +35,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/rpc/message.h"
+#include "mongo/util/shared_buffer_pool.h"
 
 namespace mongo {
 
@@ -47,6 +48,11 @@ struct OpMsg {
     static constexpr uint32_t kChecksumPresent = 1 << 0;
     static constexpr uint32_t kMoreToCome = 1 << 1;
 
+    // Set by a client on a cursor-generating command or a getMore to let the server stream the
+    // following batches of the cursor as replies with kMoreToCome set, without waiting for a
+    // getMore for each of them. This is an optional flag, so servers that don't know it ignore it.
+    static constexpr uint32_t kExhaustSupported = 1 << 16;
+
     /**
      * Returns the unvalidated flags for the given message if it is an OP_MSG message.
      * Returns 0 for other message kinds since they are the equivalent of no flags set.
@@ -92,6 +98,15 @@ struct OpMsg {
      */
     void shareOwnershipWith(const ConstSharedBuffer& buffer);
 
+    /**
+     * Makes only the documents in this object's sequences share ownership with buffer, leaving the
+     * body unowned. Sequence documents can then be retained, for example as transaction
+     * operations, by holding a reference on the message rather than by copying each of them.
+     * Unlike the body, they are never stashed for longer than the operation they belong to, so
+     * they won't pin a large message buffer for the lifetime of a cursor.
+     */
+    void shareDocumentSequenceOwnershipWith(const ConstSharedBuffer& buffer);
+
     /**
      * Returns a pointer to the sequence with the given name or nullptr if there are none.
      */
@@ -161,10 +176,49 @@ class OpMsgBuilder {
     MONGO_DISALLOW_COPYING(OpMsgBuilder);
 
 public:
-    OpMsgBuilder() {
+    OpMsgBuilder() : _buf(0) {
+        // Messages are usually built on the thread which handles them, so start from a buffer
+        // recycled from a previous message if one is available.
+        _buf.useSharedBuffer(SharedBufferPool::allocate(kInitialBufferBytes));
         skipHeaderAndFlags();
     }
 
+    ~OpMsgBuilder() {
+        disableSplicing();
+    }
+
+    /**
+     * Lets code that builds a large part of the body, such as a cursor batch, hand it over as
+     * separate buffers to be sent with writev rather than appending it to the body in place. See
+     * getSplicingBuilder(). Splicing stays enabled for this thread until finish(), or until
+     * disableSplicing() is called or this object is destroyed.
+     */
+    void enableSplicing();
+    void disableSplicing();
+
+    /**
+     * Returns the OpMsgBuilder that has enabled splicing on this thread if 'body' is the builder
+     * for its body and it hasn't had buffers spliced into it yet. Otherwise returns nullptr.
+     */
+    static OpMsgBuilder* getSplicingBuilder(const BSONObjBuilder& body);
+
+    /**
+     * Drops anything spliced into the OpMsgBuilder building into 'buf' on this thread. Code that
+     * resets a body without going through reset() must call this, since the spliced buffers went
+     * with the rest of the body.
+     */
+    static void discardSplicedBuffers(const BufBuilder& buf);
+
+    /**
+     * Arranges for 'buffers' to be sent at 'offset' in the finished message without being copied
+     * into it. The body and every BSON object whose int32 length is at one of 'lengthOffsets' are
+     * grown by the spliced bytes when the message is finished, so they must all enclose 'offset'.
+     * Until then the body reads as if the spliced bytes weren't there.
+     */
+    void splice(int offset,
+                std::vector<Message::SplicedBuffer> buffers,
+                std::vector<int> lengthOffsets);
+
     /**
      * See the documentation for DocSequenceBuilder below.
      */
@@ -211,6 +265,9 @@ public:
         _bodyStart = 0;
         _state = kEmpty;
         _openBuilder = false;
+        _spliceOffset = 0;
+        _spliced.clear();
+        _splicedLengthOffsets.clear();
     }
 
     /**
@@ -230,6 +287,8 @@ private:
         kDone,
     };
 
+    static constexpr size_t kInitialBufferBytes = 512;
+
     void finishDocumentStream(DocSequenceBuilder* docSequenceBuilder);
 
     void skipHeaderAndFlags() {
@@ -237,11 +296,20 @@ private:
         _buf.appendNum(uint32_t(0));           // flags (currently always 0).
     }
 
+    static thread_local OpMsgBuilder* _splicingBuilder;
+
     // When adding members, remember to update reset().
     BufBuilder _buf;
     int _bodyStart = 0;
     State _state = kEmpty;
     bool _openBuilder = false;
+    int _spliceOffset = 0;
+    std::vector<Message::SplicedBuffer> _spliced;
+    std::vector<int> _splicedLengthOffsets;
+
+    // The builder that had splicing enabled on this thread before us, restored when we're done.
+    OpMsgBuilder* _previousSplicingBuilder = nullptr;
+    bool _splicingEnabled = false;
 };
 
 /**
@@ -65,6 +65,8 @@ public:
         // to it.
         bob.bb().reserveBytes(reserveBytes);
         bob.bb().claimReservedBytes(reserveBytes);
+        // Commands build their reply in place, so let large cursor batches be spliced into it.
+        _builder.enableSplicing();
         return bob;
     }
     ReplyBuilderInterface& setMetadata(const BSONObj& metadata) override {
@@ -81,6 +83,14 @@ public:
         return _builder.finish();
     }
 
+    /**
+     * Returns the reply body built so far, without copying any cursor batch spliced into it, which
+     * the body reads as if it weren't there. Only valid until the builder is next used.
+     */
+    BSONObj getInPlaceBody() {
+        return _builder.resumeBody().asTempObj();
+    }
+
 private:
     OpMsgBuilder _builder;
 };
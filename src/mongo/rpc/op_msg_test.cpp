@@ -205,6 +205,32 @@ TEST_F(OpMsgParser, SucceedsWithBodyThenSequence) {
     ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[1], fromjson("{a: 2}"));
 }
 
+TEST_F(OpMsgParser, DocumentSequencesShareOwnershipWithMessage) {
+    auto message = OpMsgBytes{
+        kNoFlags,  //
+        kBodySection,
+        fromjson("{insert: 'coll'}"),
+
+        kDocSequenceSection,
+        Sized{
+            "documents",  //
+            fromjson("{a: 1}"),
+            fromjson("{a: 2}"),
+        },
+    }.done();
+
+    auto msg = OpMsg::parse(message);
+    msg.shareDocumentSequenceOwnershipWith(message.sharedBuffer());
+
+    ASSERT_FALSE(msg.body.isOwned());
+    ASSERT_EQ(msg.sequences[0].objs.size(), 2u);
+    for (auto&& obj : msg.sequences[0].objs) {
+        ASSERT_TRUE(obj.isOwned());
+        // Owning the documents must not have required copying them out of the message.
+        ASSERT_EQ(obj.getOwned().objdata(), obj.objdata());
+    }
+}
+
 TEST_F(OpMsgParser, SucceedsWithSequenceThenBody) {
     auto msg = OpMsgBytes{
         kNoFlags,  //
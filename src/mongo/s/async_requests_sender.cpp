@@ -117,6 +117,15 @@ void AsyncRequestsSender::stopRetrying() {
     _stopRetrying = true;
 }
 
+void AsyncRequestsSender::addRequests(const std::vector<AsyncRequestsSender::Request>& requests) {
+    invariant(!_stopRetrying);
+    for (const auto& request : requests) {
+        _remotes.emplace_back(request.shardId, request.cmdObj);
+    }
+
+    _scheduleRequests();
+}
+
 bool AsyncRequestsSender::done() {
     return std::all_of(
         _remotes.begin(), _remotes.end(), [](const RemoteData& remote) { return remote.done; });
@@ -145,14 +154,16 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
 
     // Check if any remote is ready.
     invariant(!_remotes.empty());
-    for (auto& remote : _remotes) {
+    for (size_t i = 0; i < _remotes.size(); ++i) {
+        auto& remote = _remotes[i];
         if (remote.swResponse && !remote.done) {
             remote.done = true;
             if (remote.swResponse->isOK()) {
                 invariant(remote.shardHostAndPort);
                 return Response(std::move(remote.shardId),
                                 std::move(remote.swResponse->getValue()),
-                                std::move(*remote.shardHostAndPort));
+                                std::move(*remote.shardHostAndPort),
+                                i);
             } else {
                 // If _interruptStatus is set, promote CallbackCanceled errors to it.
                 if (!_interruptStatus.isOK() &&
@@ -161,7 +172,8 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
                 }
                 return Response(std::move(remote.shardId),
                                 std::move(remote.swResponse->getStatus()),
-                                std::move(remote.shardHostAndPort));
+                                std::move(remote.shardHostAndPort),
+                                i);
             }
         }
     }
@@ -302,15 +314,21 @@ AsyncRequestsSender::Request::Request(ShardId shardId, BSONObj cmdObj)
 
 AsyncRequestsSender::Response::Response(ShardId shardId,
                                         executor::RemoteCommandResponse response,
-                                        HostAndPort hp)
+                                        HostAndPort hp,
+                                        size_t requestIndex)
     : shardId(std::move(shardId)),
+      requestIndex(requestIndex),
       swResponse(std::move(response)),
       shardHostAndPort(std::move(hp)) {}
 
 AsyncRequestsSender::Response::Response(ShardId shardId,
                                         Status status,
-                                        boost::optional<HostAndPort> hp)
-    : shardId(std::move(shardId)), swResponse(std::move(status)), shardHostAndPort(std::move(hp)) {}
+                                        boost::optional<HostAndPort> hp,
+                                        size_t requestIndex)
+    : shardId(std::move(shardId)),
+      requestIndex(requestIndex),
+      swResponse(std::move(status)),
+      shardHostAndPort(std::move(hp)) {}
 
 AsyncRequestsSender::RemoteData::RemoteData(ShardId shardId, BSONObj cmdObj)
     : shardId(std::move(shardId)), cmdObj(std::move(cmdObj)) {}
@@ -100,14 +100,24 @@ public:
      */
     struct Response {
         // Constructor for a response that was successfully received.
-        Response(ShardId shardId, executor::RemoteCommandResponse response, HostAndPort hp);
+        Response(ShardId shardId,
+                 executor::RemoteCommandResponse response,
+                 HostAndPort hp,
+                 size_t requestIndex = 0);
 
         // Constructor that specifies the reason the response was not successfully received.
-        Response(ShardId shardId, Status status, boost::optional<HostAndPort> hp);
+        Response(ShardId shardId,
+                 Status status,
+                 boost::optional<HostAndPort> hp,
+                 size_t requestIndex = 0);
 
         // The shard to which the request was sent.
         ShardId shardId;
 
+        // The position of the request among all requests given to the ARS, counting those passed
+        // to the constructor first and those passed to addRequests() in the order they were added.
+        size_t requestIndex;
+
         // The response or error from the remote.
         StatusWith<executor::RemoteCommandResponse> swResponse;
 
@@ -138,6 +148,13 @@ public:
      */
     bool done();
 
+    /**
+     * Schedules further requests alongside the ones which are already outstanding, which allows
+     * the caller to keep sending requests while it consumes responses. Invalid to call after
+     * stopRetrying() or after the operation has been interrupted.
+     */
+    void addRequests(const std::vector<AsyncRequestsSender::Request>& requests);
+
     /**
      * Returns the next available response or error.
      *
@@ -36,6 +36,7 @@
 #include "mongo/db/logical_clock.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/repl/optime_with.h"
+#include "mongo/platform/bits.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/client/shard_registry.h"
@@ -582,7 +583,12 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
 
             LOG_CATALOG_REFRESH(0) << "Refresh for collection " << nss << " took " << t.millis()
                                    << " ms and failed" << causedBy(redact(status));
-        } else if (routingInfoAfterRefresh) {
+            return;
+        }
+
+        _stats.refreshDurationMillis.record(t.millis());
+
+        if (routingInfoAfterRefresh) {
             const int logLevel = (!existingRoutingInfo || (existingRoutingInfo &&
                                                            routingInfoAfterRefresh->getVersion() !=
                                                                existingRoutingInfo->getVersion()))
@@ -623,6 +629,10 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
         [ this, collEntry, nss, existingRoutingInfo, onRefreshFailed, onRefreshCompleted ](
             OperationContext * opCtx,
             StatusWith<CatalogCacheLoader::CollectionAndChangedChunks> swCollAndChunks) noexcept {
+        if (swCollAndChunks.isOK()) {
+            _stats.refreshChangedChunks.record(swCollAndChunks.getValue().changedChunks.size());
+        }
+
         std::shared_ptr<RoutingTableHistory> newRoutingInfo;
         try {
             newRoutingInfo = refreshCollectionRoutingInfo(
@@ -687,6 +697,32 @@ void CatalogCache::Stats::report(BSONObjBuilder* builder) const {
     builder->append("countFullRefreshesStarted", countFullRefreshesStarted.load());
 
     builder->append("countFailedRefreshes", countFailedRefreshes.load());
+
+    refreshDurationMillis.report("refreshDurationMillis", builder);
+    refreshChangedChunks.report("refreshChangedChunks", builder);
+}
+
+constexpr int CatalogCache::PowerOfTwoHistogram::kNumBuckets;
+
+void CatalogCache::PowerOfTwoHistogram::record(long long value) {
+    const int bucket = (value <= 0) ? 0 : 64 - countLeadingZeros64(value);
+    _buckets[std::min(bucket, kNumBuckets - 1)].addAndFetch(1);
+}
+
+void CatalogCache::PowerOfTwoHistogram::report(StringData fieldName,
+                                               BSONObjBuilder* builder) const {
+    BSONArrayBuilder arrayBuilder(builder->subarrayStart(fieldName));
+    for (int i = 0; i < kNumBuckets; i++) {
+        const auto count = _buckets[i].load();
+        if (count == 0)
+            continue;
+
+        BSONObjBuilder entryBuilder(arrayBuilder.subobjStart());
+        entryBuilder.append("lowerBound", (i == 0) ? 0LL : (1LL << (i - 1)));
+        entryBuilder.append("count", count);
+        entryBuilder.doneFast();
+    }
+    arrayBuilder.doneFast();
 }
 
 CachedDatabaseInfo::CachedDatabaseInfo(DatabaseType dbt, std::shared_ptr<Shard> primaryShard)
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
@@ -333,6 +335,26 @@ private:
     // Interface from which chunks will be retrieved
     CatalogCacheLoader& _cacheLoader;
 
+    /**
+     * Distribution of a non-negative quantity over power of two buckets, the first of which holds
+     * the value 0 and the i-th of which holds the values in [2^(i-1), 2^i).
+     */
+    class PowerOfTwoHistogram {
+    public:
+        void record(long long value);
+
+        /**
+         * Appends the non-empty buckets as an array of {lowerBound, count} documents named
+         * 'fieldName'.
+         */
+        void report(StringData fieldName, BSONObjBuilder* builder) const;
+
+    private:
+        static constexpr int kNumBuckets = 40;
+
+        std::array<AtomicInt64, kNumBuckets> _buckets;
+    };
+
     // Encapsulates runtime statistics across all collections in the catalog cache
     struct Stats {
         // Counts how many times threads hit stale config exception (which is what triggers metadata
@@ -360,6 +382,13 @@ private:
         // for whatever reason
         AtomicInt64 countFailedRefreshes{0};
 
+        // Distribution of the duration of successful refreshes, full or incremental
+        PowerOfTwoHistogram refreshDurationMillis;
+
+        // Distribution of the number of chunks returned by the loader for each refresh attempt,
+        // which for incremental refreshes are the chunks changed since the cached version
+        PowerOfTwoHistogram refreshChangedChunks;
+
         /**
          * Reports the accumulated statistics for serverStatus.
          */
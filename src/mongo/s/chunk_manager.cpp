@@ -66,15 +66,229 @@ std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering orde
     return {ks.getBuffer(), ks.getSize()};
 }
 
+bool keyStringLessThanEntry(const std::string& keyString, const ChunkInfoMapEntry& entry) {
+    return keyString < entry.first;
+}
+
+bool entryLessThanKeyString(const ChunkInfoMapEntry& entry, const std::string& keyString) {
+    return entry.first < keyString;
+}
+
+/**
+ * Checks that the chunk stored under 'keyString' in 'chunkMap' starts where the chunk before it
+ * ends and ends where the chunk after it starts, or at MinKey and MaxKey respectively if there is
+ * no such chunk.
+ */
+void checkChunkIsContiguous(const ChunkInfoMap& chunkMap, const std::string& keyString) {
+    const auto it = chunkMap.lowerBound(keyString);
+    invariant(it != chunkMap.end() && it->first == keyString);
+
+    const auto& chunk = it->second;
+
+    if (it == chunkMap.begin()) {
+        checkAllElementsAreOfType(MinKey, chunk->getMin());
+    } else {
+        const auto& prevChunk = std::prev(it)->second;
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Gap or an overlap between ranges "
+                              << ChunkRange(prevChunk->getMin(), prevChunk->getMax()).toString()
+                              << " and "
+                              << ChunkRange(chunk->getMin(), chunk->getMax()).toString(),
+                SimpleBSONObjComparator::kInstance.evaluate(prevChunk->getMax() ==
+                                                            chunk->getMin()));
+    }
+
+    const auto next = std::next(it);
+    if (next == chunkMap.end()) {
+        checkAllElementsAreOfType(MaxKey, chunk->getMax());
+    } else {
+        const auto& nextChunk = next->second;
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "Gap or an overlap between ranges "
+                              << ChunkRange(chunk->getMin(), chunk->getMax()).toString()
+                              << " and "
+                              << ChunkRange(nextChunk->getMin(), nextChunk->getMax()).toString(),
+                SimpleBSONObjComparator::kInstance.evaluate(chunk->getMax() ==
+                                                            nextChunk->getMin()));
+    }
+}
+
 }  // namespace
 
+constexpr size_t ChunkInfoMap::kMaxBlockSize;
+constexpr size_t ChunkInfoMap::kMinBlockSize;
+
+ChunkInfoMap::ChunkInfoMap(Block entries) {
+    BlockVector blocks;
+    _appendEntries(std::move(entries), &blocks);
+    *this = ChunkInfoMap(std::move(blocks));
+}
+
+ChunkInfoMap::ChunkInfoMap(BlockVector blocks) : _blocks(std::move(blocks)) {
+    _blockMaxKeys.reserve(_blocks.size());
+    for (const auto& block : _blocks) {
+        dassert(!block->empty());
+        _blockMaxKeys.push_back(block->back().first);
+        _size += block->size();
+    }
+}
+
+void ChunkInfoMap::_appendEntries(Block entries, BlockVector* blocks) {
+    if (entries.size() < kMinBlockSize && !blocks->empty()) {
+        Block merged(*blocks->back());
+        blocks->pop_back();
+        merged.insert(merged.end(),
+                      std::make_move_iterator(entries.begin()),
+                      std::make_move_iterator(entries.end()));
+        entries = std::move(merged);
+    }
+
+    if (entries.empty()) {
+        return;
+    }
+
+    // Split into equally sized blocks, each of which holds at least half of kMaxBlockSize entries
+    // unless there are fewer entries than that in total
+    const size_t numBlocks = (entries.size() + kMaxBlockSize - 1) / kMaxBlockSize;
+    if (numBlocks == 1) {
+        blocks->push_back(std::make_shared<const Block>(std::move(entries)));
+        return;
+    }
+
+    for (size_t i = 0; i < numBlocks; ++i) {
+        const auto blockBegin = entries.begin() + entries.size() * i / numBlocks;
+        const auto blockEnd = entries.begin() + entries.size() * (i + 1) / numBlocks;
+        blocks->push_back(std::make_shared<const Block>(std::make_move_iterator(blockBegin),
+                                                        std::make_move_iterator(blockEnd)));
+    }
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::upperBound(const std::string& keyString) const {
+    const size_t block =
+        std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), keyString) -
+        _blockMaxKeys.begin();
+    if (block == _blocks.size()) {
+        return end();
+    }
+
+    const auto& entries = *_blocks[block];
+    const size_t pos =
+        std::upper_bound(entries.begin(), entries.end(), keyString, keyStringLessThanEntry) -
+        entries.begin();
+    return {&_blocks, block, pos};
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::lowerBound(const std::string& keyString) const {
+    const size_t block =
+        std::lower_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), keyString) -
+        _blockMaxKeys.begin();
+    if (block == _blocks.size()) {
+        return end();
+    }
+
+    const auto& entries = *_blocks[block];
+    const size_t pos =
+        std::lower_bound(entries.begin(), entries.end(), keyString, entryLessThanKeyString) -
+        entries.begin();
+    return {&_blocks, block, pos};
+}
+
+ChunkInfoMap ChunkInfoMap::makeUpdated(
+    const std::vector<std::pair<std::string, std::string>>& replacedRanges,
+    Block inserted,
+    std::vector<std::shared_ptr<ChunkInfo>>* removed) const {
+    if (_blocks.empty()) {
+        return ChunkInfoMap(std::move(inserted));
+    }
+
+    const auto blockMaxKeysIndex = [this](std::vector<std::string>::const_iterator it) {
+        return static_cast<size_t>(it - _blockMaxKeys.begin());
+    };
+
+    // Returns the block which holds 'keyString' or, if it is greater than all keys, the last one
+    const auto blockFor = [&](const std::string& keyString) {
+        return std::min(blockMaxKeysIndex(std::lower_bound(
+                            _blockMaxKeys.begin(), _blockMaxKeys.end(), keyString)),
+                        _blocks.size() - 1);
+    };
+
+    // Mark the blocks which hold replaced entries or into which new entries are inserted. These
+    // are the only ones which need to be copied.
+    std::vector<bool> touched(_blocks.size(), false);
+    for (const auto& range : replacedRanges) {
+        const size_t first = blockMaxKeysIndex(
+            std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), range.first));
+        const size_t last = blockFor(range.second);
+        for (size_t i = first; i <= last; ++i) {
+            touched[i] = true;
+        }
+    }
+
+    for (const auto& entry : inserted) {
+        touched[blockFor(entry.first)] = true;
+    }
+
+    BlockVector blocks;
+    blocks.reserve(_blocks.size() + inserted.size() / kMaxBlockSize + 1);
+
+    auto rangeIt = replacedRanges.cbegin();
+    auto insertedIt = inserted.begin();
+
+    size_t i = 0;
+    while (i < _blocks.size()) {
+        if (!touched[i]) {
+            blocks.push_back(_blocks[i]);
+            ++i;
+            continue;
+        }
+
+        // Merge each run of touched blocks with the entries inserted into it
+        Block entries;
+        for (; i < _blocks.size() && touched[i]; ++i) {
+            for (const auto& entry : *_blocks[i]) {
+                while (rangeIt != replacedRanges.cend() && rangeIt->second < entry.first) {
+                    ++rangeIt;
+                }
+
+                while (insertedIt != inserted.end() && insertedIt->first < entry.first) {
+                    entries.push_back(std::move(*insertedIt));
+                    ++insertedIt;
+                }
+
+                if (rangeIt != replacedRanges.cend() && rangeIt->first < entry.first) {
+                    removed->push_back(entry.second);
+                    continue;
+                }
+
+                entries.push_back(entry);
+            }
+
+            // The inserted entries up to the max of the block belong to it even if they sort
+            // after all of its remaining entries and those after the last block belong to it
+            const bool isLastBlock = (i == _blocks.size() - 1);
+            while (insertedIt != inserted.end() &&
+                   (isLastBlock || insertedIt->first <= _blockMaxKeys[i])) {
+                entries.push_back(std::move(*insertedIt));
+                ++insertedIt;
+            }
+        }
+
+        _appendEntries(std::move(entries), &blocks);
+    }
+
+    invariant(insertedIt == inserted.end());
+
+    return ChunkInfoMap(std::move(blocks));
+}
+
 RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
                                          boost::optional<UUID> uuid,
                                          KeyPattern shardKeyPattern,
                                          std::unique_ptr<CollatorInterface> defaultCollator,
                                          bool unique,
                                          ChunkInfoMap chunkMap,
-                                         ChunkVersion collectionVersion)
+                                         ChunkVersion collectionVersion,
+                                         ShardVersionMap shardVersions)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
       _uuid(uuid),
@@ -83,8 +297,7 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
       _defaultCollator(std::move(defaultCollator)),
       _unique(unique),
       _chunkMap(std::move(chunkMap)),
-      _shardVersions(
-          _constructShardVersionMap(collectionVersion.epoch(), _chunkMap, _shardKeyOrdering)),
+      _shardVersions(std::move(shardVersions)),
       _collectionVersion(collectionVersion) {}
 
 Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj& collation) const {
@@ -99,7 +312,7 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
         }
     }
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    const auto it = _rt->_upperBound(_rt->_extractKeyString(shardKey));
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
             it != _rt->getChunkMap().end() && it->second->containsKey(shardKey));
@@ -111,7 +324,7 @@ bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& sha
     if (shardKey.isEmpty())
         return false;
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    const auto it = _rt->_upperBound(_rt->_extractKeyString(shardKey));
     if (it == _rt->getChunkMap().end())
         return false;
 
@@ -120,6 +333,37 @@ bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& sha
     return it->second->getShardIdAt(_clusterTime) == shardId;
 }
 
+boost::optional<ChunkManager::KeyStringOwnershipRange> ChunkManager::getKeyStringOwnershipRange(
+    const std::string& keyString, size_t maxChunks) const {
+    const auto& chunkMap = _rt->getChunkMap();
+
+    const auto it = _rt->_upperBound(keyString);
+    if (it == chunkMap.end())
+        return boost::none;
+
+    const auto& shardId = it->second->getShardIdAt(_clusterTime);
+
+    auto first = it;
+    for (size_t i = 0; i < maxChunks && first != chunkMap.begin(); ++i) {
+        const auto prev = std::prev(first);
+        if (prev->second->getShardIdAt(_clusterTime) != shardId)
+            break;
+        first = prev;
+    }
+
+    auto last = it;
+    for (size_t i = 0; i < maxChunks; ++i) {
+        const auto next = std::next(last);
+        if (next == chunkMap.end() || next->second->getShardIdAt(_clusterTime) != shardId)
+            break;
+        last = next;
+    }
+
+    // Chunks are contiguous, so the max of the chunk before the range is the min of the range
+    return KeyStringOwnershipRange{
+        first == chunkMap.begin() ? std::string() : std::prev(first)->first, last->first, shardId};
+}
+
 void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
                                        const BSONObj& query,
                                        const BSONObj& collation,
@@ -211,7 +455,7 @@ bool ChunkManager::rangeOverlapsShard(const ChunkRange& range, const ShardId& sh
 
 ChunkManager::ConstRangeOfChunks ChunkManager::getNextChunkOnShard(const BSONObj& shardKey,
                                                                    const ShardId& shardId) const {
-    for (auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    for (auto it = _rt->_upperBound(_rt->_extractKeyString(shardKey));
          it != _rt->getChunkMap().end();
          ++it) {
         const auto& chunk = it->second;
@@ -237,10 +481,10 @@ RoutingTableHistory::overlappingRanges(const BSONObj& min,
                                        const BSONObj& max,
                                        bool isMaxInclusive) const {
 
-    const auto itMin = _chunkMap.upper_bound(_extractKeyString(min));
+    const auto itMin = _upperBound(_extractKeyString(min));
     const auto itMax = [this, &max, isMaxInclusive]() {
-        auto it = isMaxInclusive ? _chunkMap.upper_bound(_extractKeyString(max))
-                                 : _chunkMap.lower_bound(_extractKeyString(max));
+        auto it = isMaxInclusive ? _upperBound(_extractKeyString(max))
+                                 : _lowerBound(_extractKeyString(max));
         return it == _chunkMap.end() ? it : ++it;
     }();
 
@@ -381,7 +625,7 @@ ChunkVersion RoutingTableHistory::getVersion(const ShardId& shardName) const {
         return ChunkVersion(0, 0, _collectionVersion.epoch());
     }
 
-    return it->second;
+    return it->second.shardVersion;
 }
 
 std::string RoutingTableHistory::toString() const {
@@ -395,7 +639,7 @@ std::string RoutingTableHistory::toString() const {
 
     sb << "Shard versions:\n";
     for (const auto& entry : _shardVersions) {
-        sb << "\t" << entry.first << ": " << entry.second.toString() << '\n';
+        sb << "\t" << entry.first << ": " << entry.second.shardVersion.toString() << '\n';
     }
 
     return sb.str();
@@ -418,16 +662,18 @@ ShardVersionMap RoutingTableHistory::_constructShardVersionMap(const OID& epoch,
         if (shardVersionIt == shardVersions.end()) {
             shardVersionIt = shardVersions
                                  .emplace(firstChunkInRange->getShardIdAt(boost::none),
-                                          ChunkVersion(0, 0, epoch))
+                                          ShardVersionTargetingInfo(epoch))
                                  .first;
         }
 
-        auto& maxShardVersion = shardVersionIt->second;
+        auto& maxShardVersion = shardVersionIt->second.shardVersion;
+        auto& numChunks = shardVersionIt->second.numChunks;
 
         current = std::find_if(
             current,
             chunkMap.cend(),
-            [&firstChunkInRange, &maxShardVersion](const ChunkInfoMap::value_type& chunkMapEntry) {
+            [&firstChunkInRange, &maxShardVersion, &numChunks](
+                const ChunkInfoMap::value_type& chunkMapEntry) {
                 const auto& currentChunk = chunkMapEntry.second;
 
                 if (currentChunk->getShardIdAt(boost::none) !=
@@ -437,6 +683,8 @@ ShardVersionMap RoutingTableHistory::_constructShardVersionMap(const OID& epoch,
                 if (currentChunk->getLastmod() > maxShardVersion)
                     maxShardVersion = currentChunk->getLastmod();
 
+                ++numChunks;
+
                 return false;
             });
 
@@ -489,6 +737,66 @@ std::string RoutingTableHistory::_extractKeyString(const BSONObj& shardKeyValue)
     return extractKeyStringInternal(shardKeyValue, _shardKeyOrdering);
 }
 
+boost::optional<ShardVersionMap> RoutingTableHistory::_updateShardVersionMap(
+    const OID& epoch,
+    const std::vector<std::shared_ptr<ChunkInfo>>& removedChunks,
+    const std::map<std::string, std::shared_ptr<ChunkInfo>>& insertedChunks) const {
+    ShardVersionMap shardVersions(_shardVersions);
+
+    // Shards which lost the chunk whose version is their shard version
+    std::set<ShardId> shardsWithRemovedMaxVersion;
+
+    for (const auto& chunk : removedChunks) {
+        const auto& shardId = chunk->getShardIdAt(boost::none);
+        auto it = shardVersions.find(shardId);
+        invariant(it != shardVersions.end());
+        invariant(it->second.numChunks > 0);
+
+        --it->second.numChunks;
+        if (chunk->getLastmod() == it->second.shardVersion) {
+            shardsWithRemovedMaxVersion.insert(shardId);
+        }
+    }
+
+    for (const auto& entry : insertedChunks) {
+        const auto& chunk = entry.second;
+        auto it = shardVersions
+                      .emplace(chunk->getShardIdAt(boost::none), ShardVersionTargetingInfo(epoch))
+                      .first;
+
+        ++it->second.numChunks;
+        if (chunk->getLastmod() > it->second.shardVersion) {
+            it->second.shardVersion = chunk->getLastmod();
+        }
+    }
+
+    for (const auto& shardId : shardsWithRemovedMaxVersion) {
+        const auto& info = shardVersions.find(shardId)->second;
+        if (info.numChunks > 0 &&
+            _shardVersions.find(shardId)->second.shardVersion == info.shardVersion) {
+            return boost::none;
+        }
+    }
+
+    for (auto it = shardVersions.begin(); it != shardVersions.end();) {
+        if (it->second.numChunks == 0) {
+            it = shardVersions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return shardVersions;
+}
+
+ChunkInfoMap::const_iterator RoutingTableHistory::_upperBound(const std::string& keyString) const {
+    return _chunkMap.upperBound(keyString);
+}
+
+ChunkInfoMap::const_iterator RoutingTableHistory::_lowerBound(const std::string& keyString) const {
+    return _chunkMap.lowerBound(keyString);
+}
+
 std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeNew(
     NamespaceString nss,
     boost::optional<UUID> uuid,
@@ -503,7 +811,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeNew(
                                std::move(defaultCollator),
                                std::move(unique),
                                {},
-                               {0, 0, epoch})
+                               {0, 0, epoch},
+                               {})
         .makeUpdated(chunks);
 }
 
@@ -511,7 +820,14 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
-    auto chunkMap = _chunkMap;
+
+    // The changed chunks are first applied among themselves, recording the key ranges (min, max]
+    // they replace, and then merged with the blocks of existing chunks which they touch. This gives
+    // the same result as applying them one at a time to the full chunk map, without copying the
+    // chunks which did not change.
+    std::map<std::string, std::shared_ptr<ChunkInfo>> updatedChunks;
+    std::vector<std::pair<std::string, std::string>> replacedRanges;
+    replacedRanges.reserve(changedChunks.size());
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -532,17 +848,18 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
 
         // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
         // min
-        const auto low = chunkMap.upper_bound(chunkMinKeyString);
+        const auto low = updatedChunks.upper_bound(chunkMinKeyString);
 
         // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
         // not overlap max
-        const auto high = chunkMap.upper_bound(chunkMaxKeyString);
+        const auto high = updatedChunks.upper_bound(chunkMaxKeyString);
 
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
+        // Erase all earlier changed chunks which overlap the chunk we got from the persistent store
+        updatedChunks.erase(low, high);
 
         // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunkMaxKeyString, std::make_shared<ChunkInfo>(chunk)));
+        updatedChunks.emplace(chunkMaxKeyString, std::make_shared<ChunkInfo>(chunk));
+        replacedRanges.emplace_back(chunkMinKeyString, chunkMaxKeyString);
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -556,6 +873,43 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         return shared_from_this();
     }
 
+    // Coalesce the replaced ranges so that the merge below can walk them in step with the chunks.
+    std::sort(replacedRanges.begin(), replacedRanges.end());
+    std::vector<std::pair<std::string, std::string>> coalescedRanges;
+    for (auto& range : replacedRanges) {
+        if (!coalescedRanges.empty() && range.first <= coalescedRanges.back().second) {
+            if (coalescedRanges.back().second < range.second) {
+                coalescedRanges.back().second = std::move(range.second);
+            }
+        } else {
+            coalescedRanges.push_back(std::move(range));
+        }
+    }
+
+    // Only the blocks of the chunk map and the entries of the shard version map which the changes
+    // touch are rebuilt, the rest is shared with or derived from this routing table
+    std::vector<std::shared_ptr<ChunkInfo>> removedChunks;
+    auto chunkMap =
+        _chunkMap.makeUpdated(coalescedRanges,
+                              ChunkInfoMap::Block(updatedChunks.begin(), updatedChunks.end()),
+                              &removedChunks);
+
+    boost::optional<ShardVersionMap> shardVersions;
+    if (!_chunkMap.empty()) {
+        // This routing table was consistent, so any gap or overlap must be next to a changed chunk
+        for (const auto& entry : updatedChunks) {
+            checkChunkIsContiguous(chunkMap, entry.first);
+        }
+
+        shardVersions =
+            _updateShardVersionMap(collectionVersion.epoch(), removedChunks, updatedChunks);
+    }
+
+    if (!shardVersions) {
+        shardVersions =
+            _constructShardVersionMap(collectionVersion.epoch(), chunkMap, _shardKeyOrdering);
+    }
+
     return std::shared_ptr<RoutingTableHistory>(
         new RoutingTableHistory(_nss,
                                 _uuid,
@@ -563,7 +917,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
                                 CollatorInterface::cloneCollator(getDefaultCollator()),
                                 isUnique(),
                                 std::move(chunkMap),
-                                collectionVersion));
+                                collectionVersion,
+                                std::move(*shardVersions)));
 }
 
 }  // namespace mongo
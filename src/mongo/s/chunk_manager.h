@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include <iterator>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -49,11 +51,180 @@ struct QuerySolutionNode;
 class OperationContext;
 class ChunkManager;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkInfoMap = std::map<std::string, std::shared_ptr<ChunkInfo>>;
+// The KeyString-encoded max of a chunk and the entry describing the chunk
+using ChunkInfoMapEntry = std::pair<std::string, std::shared_ptr<ChunkInfo>>;
 
-// Map from a shard is to the max chunk version on that shard
-using ShardVersionMap = std::map<ShardId, ChunkVersion>;
+/**
+ * Entries for all chunks of a collection sorted by max. The entries are kept in contiguous blocks
+ * of bounded size, which are immutable and shared between successive versions of a routing table.
+ * Applying a refresh copies only the blocks which contain changed chunks and the index of blocks,
+ * while targeting does a binary search over the index followed by one over a single block.
+ */
+class ChunkInfoMap {
+public:
+    using value_type = ChunkInfoMapEntry;
+    using Block = std::vector<ChunkInfoMapEntry>;
+
+    // Bounds on the number of entries in a block. A block rebuilt by an update which ends up with
+    // fewer than kMinBlockSize entries is merged into the block before it.
+    static constexpr size_t kMaxBlockSize = 512;
+    static constexpr size_t kMinBlockSize = kMaxBlockSize / 4;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = ChunkInfoMapEntry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ChunkInfoMapEntry*;
+        using reference = const ChunkInfoMapEntry&;
+
+        const_iterator() = default;
+
+        reference operator*() const {
+            return (*(*_blocks)[_block])[_pos];
+        }
+        pointer operator->() const {
+            return &**this;
+        }
+
+        const_iterator& operator++() {
+            if (++_pos == (*_blocks)[_block]->size()) {
+                ++_block;
+                _pos = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator previous(*this);
+            ++*this;
+            return previous;
+        }
+
+        const_iterator& operator--() {
+            if (_pos == 0) {
+                --_block;
+                _pos = (*_blocks)[_block]->size();
+            }
+            --_pos;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator previous(*this);
+            --*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return _block == other._block && _pos == other._pos;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkInfoMap;
+
+        const_iterator(const std::vector<std::shared_ptr<const Block>>* blocks,
+                       size_t block,
+                       size_t pos)
+            : _blocks(blocks), _block(block), _pos(pos) {}
+
+        const std::vector<std::shared_ptr<const Block>>* _blocks{nullptr};
+        size_t _block{0};
+        size_t _pos{0};
+    };
+
+    ChunkInfoMap() = default;
+
+    /**
+     * Builds a map from entries which are already sorted by max.
+     */
+    explicit ChunkInfoMap(Block entries);
+
+    const_iterator begin() const {
+        return {&_blocks, 0, 0};
+    }
+    const_iterator end() const {
+        return {&_blocks, _blocks.size(), 0};
+    }
+    const_iterator cbegin() const {
+        return begin();
+    }
+    const_iterator cend() const {
+        return end();
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t numBlocks() const {
+        return _blocks.size();
+    }
+
+    /**
+     * Returns the first entry whose max is greater than 'keyString', or end().
+     */
+    const_iterator upperBound(const std::string& keyString) const;
+
+    /**
+     * Returns the first entry whose max is greater than or equal to 'keyString', or end().
+     */
+    const_iterator lowerBound(const std::string& keyString) const;
+
+    /**
+     * Returns a map in which the entries whose max falls within any of the (min, max] key ranges
+     * in 'replacedRanges' are removed and the entries in 'inserted' are added. Both must be sorted
+     * and the ranges must not overlap. The removed chunks are appended to 'removed'.
+     *
+     * Blocks which contain no removed entry and no insertion point are shared with this map, so
+     * the cost is proportional to the number of changes times the block size plus the number of
+     * blocks, rather than to the number of chunks.
+     */
+    ChunkInfoMap makeUpdated(const std::vector<std::pair<std::string, std::string>>& replacedRanges,
+                             Block inserted,
+                             std::vector<std::shared_ptr<ChunkInfo>>* removed) const;
+
+private:
+    using BlockVector = std::vector<std::shared_ptr<const Block>>;
+
+    explicit ChunkInfoMap(BlockVector blocks);
+
+    /**
+     * Splits 'entries' into blocks of at most kMaxBlockSize and appends them to 'blocks', first
+     * absorbing the last block of 'blocks' if 'entries' is too small to make a block of its own.
+     */
+    static void _appendEntries(Block entries, BlockVector* blocks);
+
+    // The blocks in key order, none of which is empty
+    BlockVector _blocks;
+
+    // The max of the last entry of each block, for locating the block containing a key without
+    // touching the blocks themselves
+    std::vector<std::string> _blockMaxKeys;
+
+    // Total number of entries across all blocks
+    size_t _size{0};
+};
+
+// Targeting information for a shard which owns chunks of a collection
+struct ShardVersionTargetingInfo {
+    explicit ShardVersionTargetingInfo(const OID& epoch) : shardVersion(0, 0, epoch) {}
+
+    // Max chunk version for the shard
+    ChunkVersion shardVersion;
+
+    // Number of chunks owned by the shard, so that a refresh can tell when the shard loses its
+    // last chunk without scanning the chunk map
+    size_t numChunks{0};
+};
+
+// Map from a shard id to the targeting information for that shard
+using ShardVersionMap = std::map<ShardId, ShardVersionTargetingInfo>;
 
 /**
  * In-memory representation of the routing table for a single sharded collection at various points
@@ -157,16 +328,40 @@ private:
                                                      const ChunkInfoMap& chunkMap,
                                                      Ordering shardKeyOrdering);
 
+    /**
+     * Derives the ShardVersionMap after an update from the one of this routing table, given the
+     * chunks which the update removed and inserted. Returns boost::none if a shard lost the chunk
+     * carrying its shard version without gaining a newer one, in which case its version can only
+     * be found by scanning the chunk map.
+     */
+    boost::optional<ShardVersionMap> _updateShardVersionMap(
+        const OID& epoch,
+        const std::vector<std::shared_ptr<ChunkInfo>>& removedChunks,
+        const std::map<std::string, std::shared_ptr<ChunkInfo>>& insertedChunks) const;
+
     RoutingTableHistory(NamespaceString nss,
                         boost::optional<UUID> uuid,
                         KeyPattern shardKeyPattern,
                         std::unique_ptr<CollatorInterface> defaultCollator,
                         bool unique,
                         ChunkInfoMap chunkMap,
-                        ChunkVersion collectionVersion);
+                        ChunkVersion collectionVersion,
+                        ShardVersionMap shardVersions);
 
     std::string _extractKeyString(const BSONObj& shardKeyValue) const;
 
+    /**
+     * Returns the first chunk whose max is greater than 'keyString', that is the chunk which
+     * contains it, or the end of the chunk map.
+     */
+    ChunkInfoMap::const_iterator _upperBound(const std::string& keyString) const;
+
+    /**
+     * Returns the first chunk whose max is greater than or equal to 'keyString', or the end of the
+     * chunk map.
+     */
+    ChunkInfoMap::const_iterator _lowerBound(const std::string& keyString) const;
+
     // The shard versioning mechanism hinges on keeping track of the number of times we reload
     // ChunkManagers.
     const unsigned long long _sequenceNumber;
@@ -192,8 +387,8 @@ private:
     // ranges must cover the complete space from [MinKey, MaxKey).
     const ChunkInfoMap _chunkMap;
 
-    // Map from shard id to the maximum chunk version for that shard. If a shard contains no
-    // chunks, it won't be present in this map.
+    // Map from shard id to the maximum chunk version and number of chunks for that shard. If a
+    // shard contains no chunks, it won't be present in this map.
     const ShardVersionMap _shardVersions;
 
     // Max version across all chunks
@@ -271,6 +466,17 @@ public:
         ConstChunkIterator _end;
     };
 
+    /**
+     * A range [min, max) of KeyString-encoded shard keys, as returned by extractKeyString(), in
+     * which all chunks are owned by the same shard. An empty min stands for the start of the key
+     * space.
+     */
+    struct KeyStringOwnershipRange {
+        std::string min;
+        std::string max;
+        ShardId shardId;
+    };
+
     ChunkManager(std::shared_ptr<RoutingTableHistory> rt, boost::optional<Timestamp> clusterTime)
         : _rt(std::move(rt)), _clusterTime(std::move(clusterTime)) {}
 
@@ -321,6 +527,23 @@ public:
      */
     bool keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const;
 
+    /**
+     * Returns the KeyString encoding of "shardKey" under which the routing table orders chunks.
+     * Callers which check many keys can compare encodings against a KeyStringOwnershipRange
+     * instead of looking up each key in the routing table.
+     */
+    std::string extractKeyString(const BSONObj& shardKey) const {
+        return _rt->_extractKeyString(shardKey);
+    }
+
+    /**
+     * Returns the range covered by the chunk which contains the KeyString-encoded "keyString",
+     * widened over up to "maxChunks" adjacent chunks on either side which belong to the same
+     * shard. Returns boost::none if no chunk contains "keyString".
+     */
+    boost::optional<KeyStringOwnershipRange> getKeyStringOwnershipRange(
+        const std::string& keyString, size_t maxChunks) const;
+
     /**
      * Returns true if any chunk owned by the shard with the given "shardId" overlaps "range".
      */
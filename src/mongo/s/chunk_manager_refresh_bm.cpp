@@ -120,7 +120,9 @@ void BM_IncrementalRefreshOfPessimalBalancedDistribution(benchmark::State& state
     }
 }
 
-BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)->Args({2, 50000});
+BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)
+    ->Args({2, 50000})
+    ->Args({2, 500000});
 
 template <typename ShardSelectorFn>
 auto BM_FullBuildOfChunkManager(benchmark::State& state, ShardSelectorFn selectShard) {
@@ -313,6 +315,27 @@ void BM_RangeOverlapsChunk(benchmark::State& state,
     state.SetItemsProcessed(state.iterations());
 }
 
+// Measures targeting throughput when many threads route through the same routing table, as on a
+// busy mongos.
+void BM_FindIntersectingChunkConcurrently(benchmark::State& state) {
+    constexpr int nShards = 10;
+    constexpr int nChunks = 500000;
+
+    static const auto cm = makeChunkManagerWithOptimalBalancedDistribution(nShards, nChunks);
+    static const auto keys = makeKeys(nChunks);
+    auto keysIter = makeCircularIterator(keys);
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(
+            cm->getChunkManager()->findIntersectingChunkWithSimpleCollation(*keysIter));
+        ++keysIter;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FindIntersectingChunkConcurrently)->ThreadRange(1, 16);
+
 // The following was adapted from the BENCHMARK_CAPTURE() macro where the
 // benchmark::internal::Benchmark* is returned rather than declared as a static variable.
 #define REGISTER_BENCHMARK_CAPTURE(func, test_case_name, ...) \
@@ -346,6 +369,7 @@ MONGO_INITIALIZER(RegisterBenchmarks)(InitializerContext* context) {
             ->Args({10, 50000})
             ->Args({100, 50000})
             ->Args({1000, 50000})
+            ->Args({10, 500000})
             ->Args({2, 2});
     }
 
@@ -71,6 +71,7 @@
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/socket_utils.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -197,7 +198,8 @@ BSONObj createCommandForTargetedShards(
     const BSONObj originalCmdObj,
     const std::unique_ptr<Pipeline, PipelineDeleter>& pipelineForTargetedShards,
     const BSONObj collationObj,
-    boost::optional<LogicalTime> atClusterTime) {
+    boost::optional<LogicalTime> atClusterTime,
+    size_t exchangePartitions) {
 
     // Create the command for the shards.
     MutableDocument targetedCmd(request.serializeToCommandObj());
@@ -212,6 +214,11 @@ BSONObj createCommandForTargetedShards(
             targetedCmd[AggregationRequest::kNeedsMergeName] = Value(true);
             targetedCmd[AggregationRequest::kCursorName] =
                 Value(DOC(AggregationRequest::kBatchSizeName << 0));
+
+            if (exchangePartitions > 0) {
+                targetedCmd[AggregationRequest::kExchangePartitionsName] =
+                    Value(static_cast<int>(exchangePartitions));
+            }
         }
     }
 
@@ -245,14 +252,13 @@ BSONObj createCommandForTargetedShards(
     return appendAllowImplicitCreate(cmdObj, true);
 }
 
-BSONObj createCommandForMergingShard(
-    const AggregationRequest& request,
-    const boost::intrusive_ptr<ExpressionContext>& mergeCtx,
-    const BSONObj originalCmdObj,
-    const std::unique_ptr<Pipeline, PipelineDeleter>& pipelineForMerging) {
+BSONObj createCommandForMergingShard(const AggregationRequest& request,
+                                     const boost::intrusive_ptr<ExpressionContext>& mergeCtx,
+                                     const BSONObj originalCmdObj,
+                                     std::vector<Value> serializedPipelineForMerging) {
     MutableDocument mergeCmd(request.serializeToCommandObj());
 
-    mergeCmd["pipeline"] = Value(pipelineForMerging->serialize());
+    mergeCmd["pipeline"] = Value(std::move(serializedPipelineForMerging));
     mergeCmd[AggregationRequest::kFromMongosName] = Value(true);
     mergeCmd["writeConcern"] = Value(originalCmdObj["writeConcern"]);
 
@@ -268,6 +274,15 @@ BSONObj createCommandForMergingShard(
     return appendAllowImplicitCreate(mergeCmd.freeze().toBson(), true);
 }
 
+BSONObj createCommandForMergingShard(
+    const AggregationRequest& request,
+    const boost::intrusive_ptr<ExpressionContext>& mergeCtx,
+    const BSONObj originalCmdObj,
+    const std::unique_ptr<Pipeline, PipelineDeleter>& pipelineForMerging) {
+    return createCommandForMergingShard(
+        request, mergeCtx, originalCmdObj, pipelineForMerging->serialize());
+}
+
 std::vector<RemoteCursor> establishShardCursors(
     OperationContext* opCtx,
     const NamespaceString& nss,
@@ -345,6 +360,15 @@ struct DispatchShardPipelineResults {
     // The merging half of the pipeline if more than one shard was targeted, otherwise nullptr.
     std::unique_ptr<Pipeline, PipelineDeleter> pipelineForMerging;
 
+    // If the merging half of the pipeline begins with a $group whose merge is spread across
+    // several shards, the part of it which runs on each of those shards, otherwise nullptr. In that
+    // case 'pipelineForMerging' holds only what remains to be done after the partitions are merged.
+    std::unique_ptr<Pipeline, PipelineDeleter> pipelineForPartitionedMerge;
+
+    // The number of partitions between which each targeted shard splits its output, or 0 if the
+    // output is not partitioned. Each shard returns one cursor per partition, in partition order.
+    size_t exchangePartitions;
+
     // The command object to send to the targeted shards.
     BSONObj commandForTargetedShards;
 };
@@ -413,14 +437,34 @@ DispatchShardPipelineResults dispatchShardPipeline(
                              (needsPrimaryShardMerge && executionNsRoutingInfo &&
                               *(shardIds.begin()) != executionNsRoutingInfo->db().primaryId()));
 
+    std::unique_ptr<Pipeline, PipelineDeleter> pipelineForPartitionedMerge;
+    size_t exchangePartitions = 0;
+
     if (needsSplit) {
         pipelineForMerging = std::move(pipelineForTargetedShards);
         pipelineForTargetedShards = pipelineForMerging->splitForSharded();
+
+        // If the merge begins by completing the shards' partial groups, spread that work over
+        // several of the targeted shards, each of which completes a disjoint subset of the groups.
+        const size_t maxMergers = std::max(internalQueryMaxPartitionedGroupMergers.load(), 0);
+        if (maxMergers > 1 && shardIds.size() > 1 && !needsMongosMerge && !mustRunOnAll &&
+            !expCtx->explain && expCtx->tailableMode == TailableModeEnum::kNormal &&
+            !liteParsedPipeline.hasChangeStream() && !opCtx->getTxnNumber()) {
+            pipelineForPartitionedMerge = pipelineForMerging->splitForPartitionedMerge();
+            if (pipelineForPartitionedMerge) {
+                exchangePartitions = std::min(maxMergers, shardIds.size());
+            }
+        }
     }
 
     // Generate the command object for the targeted shards.
-    BSONObj targetedCommand = createCommandForTargetedShards(
-        opCtx, aggRequest, originalCmdObj, pipelineForTargetedShards, collationObj, atClusterTime);
+    BSONObj targetedCommand = createCommandForTargetedShards(opCtx,
+                                                             aggRequest,
+                                                             originalCmdObj,
+                                                             pipelineForTargetedShards,
+                                                             collationObj,
+                                                             atClusterTime,
+                                                             exchangePartitions);
 
     // Refresh the shard registry if we're targeting all shards.  We need the shard registry
     // to be at least as current as the logical time used when creating the command for
@@ -481,6 +525,8 @@ DispatchShardPipelineResults dispatchShardPipeline(
                                         std::move(shardResults),
                                         std::move(pipelineForTargetedShards),
                                         std::move(pipelineForMerging),
+                                        std::move(pipelineForPartitionedMerge),
+                                        exchangePartitions,
                                         targetedCommand};
 }
 
@@ -827,6 +873,105 @@ Status runPipelineOnMongoS(const boost::intrusive_ptr<ExpressionContext>& expCtx
     return getStatusFromCommandResult(result->asTempObj());
 }
 
+/**
+ * Establishes one cursor per partition of the shards' output, each on a different targeted shard,
+ * which merges that partition from every shard through $mergeCursors and runs the partitioned part
+ * of the merging pipeline over it. Replaces the shard cursors in 'shardDispatchResults' with the
+ * cursors on the merging shards, so that the rest of the merging pipeline consumes the completed
+ * partitions just as it would otherwise consume the shards' results.
+ */
+void dispatchPartitionedMerge(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                              const ClusterAggregate::Namespaces& namespaces,
+                              const AggregationRequest& request,
+                              BSONObj cmdObj,
+                              DispatchShardPipelineResults* shardDispatchResults) {
+    const auto opCtx = expCtx->opCtx;
+    const size_t nPartitions = shardDispatchResults->exchangePartitions;
+    auto* executor = Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor();
+
+    // Until the merging cursors are established, nothing else owns the shards' cursors, so kill
+    // them if dispatching the merge fails. Cursors a merging shard did take over may already be
+    // gone, which killCursors tolerates. Only the cursor ids are needed, not the first batches.
+    std::vector<RemoteCursor> shardCursors;
+    for (const auto& remoteCursor : shardDispatchResults->remoteCursors) {
+        const auto& cursorResponse = remoteCursor.getCursorResponse();
+        RemoteCursor cursor;
+        cursor.setShardId(remoteCursor.getShardId());
+        cursor.setHostAndPort(remoteCursor.getHostAndPort());
+        cursor.setCursorResponse(
+            CursorResponse(cursorResponse.getNSS(), cursorResponse.getCursorId(), {}));
+        shardCursors.push_back(std::move(cursor));
+    }
+    auto killShardCursors = MakeGuard([&] {
+        killRemoteCursors(opCtx, executor, namespaces.executionNss, shardCursors);
+    });
+
+    // Each shard returned its cursors in partition order.
+    std::vector<ShardId> shardIds;
+    std::map<ShardId, size_t> nCursorsByShard;
+    std::vector<std::vector<RemoteCursor>> cursorsByPartition(nPartitions);
+    for (auto&& remoteCursor : shardDispatchResults->remoteCursors) {
+        ShardId shardId(remoteCursor.getShardId().toString());
+        auto& nCursors = nCursorsByShard[shardId];
+        if (nCursors == 0) {
+            shardIds.push_back(shardId);
+        }
+        uassert(50956,
+                str::stream() << "Shard " << shardId << " returned more than " << nPartitions
+                              << " cursors for a partitioned aggregation",
+                nCursors < nPartitions);
+        cursorsByPartition[nCursors++].push_back(std::move(remoteCursor));
+    }
+    shardDispatchResults->remoteCursors.clear();
+
+    for (auto&& shardCursors : nCursorsByShard) {
+        uassert(50957,
+                str::stream() << "Shard " << shardCursors.first << " returned "
+                              << shardCursors.second << " cursors for an aggregation split into "
+                              << nPartitions << " partitions",
+                shardCursors.second == nPartitions);
+    }
+
+    // Start from a random shard so that the merging work does not always land on the same ones.
+    const auto serializedPartitionPipeline =
+        shardDispatchResults->pipelineForPartitionedMerge->serialize();
+    const size_t firstMergingShard = opCtx->getClient()->getPrng().nextInt32(shardIds.size());
+
+    std::vector<std::pair<ShardId, BSONObj>> requests;
+    for (size_t partition = 0; partition < nPartitions; ++partition) {
+        AsyncResultsMergerParams armParams;
+        armParams.setRemotes(std::move(cursorsByPartition[partition]));
+        armParams.setTailableMode(TailableModeEnum::kNormal);
+        armParams.setNss(expCtx->ns);
+
+        std::vector<Value> serializedPipeline;
+        DocumentSourceMergeCursors::create(executor, std::move(armParams), expCtx)
+            ->serializeToArray(serializedPipeline);
+        serializedPipeline.insert(serializedPipeline.end(),
+                                  serializedPartitionPipeline.begin(),
+                                  serializedPartitionPipeline.end());
+
+        // Return an empty first batch, so that the merging shards complete their groups in
+        // parallel as the cursors are iterated rather than while this command waits on each.
+        MutableDocument mergeCmd(Document(createCommandForMergingShard(
+            request, expCtx, cmdObj, std::move(serializedPipeline))));
+        mergeCmd[AggregationRequest::kCursorName] =
+            Value(DOC(AggregationRequest::kBatchSizeName << 0));
+
+        requests.emplace_back(shardIds[(firstMergingShard + partition) % shardIds.size()],
+                              mergeCmd.freeze().toBson());
+    }
+
+    shardDispatchResults->remoteCursors =
+        establishCursors(opCtx,
+                         executor,
+                         namespaces.executionNss,
+                         ReadPreferenceSetting::get(opCtx),
+                         requests,
+                         false /* do not allow partial results */);
+    killShardCursors.Dismiss();
+}
+
 Status dispatchMergingPipeline(const boost::intrusive_ptr<ExpressionContext>& expCtx,
                                const ClusterAggregate::Namespaces& namespaces,
                                const AggregationRequest& request,
@@ -993,6 +1138,11 @@ Status ClusterAggregate::runAggregate(OperationContext* opCtx,
             remoteCursor.getShardId().toString(), reply, result);
     }
 
+    // If the shards partitioned their output, have several shards merge it before the final merge.
+    if (shardDispatchResults.pipelineForPartitionedMerge) {
+        dispatchPartitionedMerge(expCtx, namespaces, request, cmdObj, &shardDispatchResults);
+    }
+
     // If we reach here, we have a merge pipeline to dispatch.
     return dispatchMergingPipeline(
         expCtx, namespaces, request, cmdObj, litePipe, routingInfo, shardDispatchResults, result);
@@ -1038,7 +1188,7 @@ Status ClusterAggregate::aggPassthrough(OperationContext* opCtx,
     // Format the command for the shard. This adds the 'fromMongos' field, wraps the command as an
     // explain if necessary, and rewrites the result into a format safe to forward to shards.
     cmdObj = CommandHelpers::filterCommandRequestForPassthrough(createCommandForTargetedShards(
-        opCtx, aggRequest, cmdObj, nullptr, BSONObj(), atClusterTime));
+        opCtx, aggRequest, cmdObj, nullptr, BSONObj(), atClusterTime, 0));
 
     auto cmdResponse = uassertStatusOK(shard->runCommandWithFixedRetryAttempts(
         opCtx,
@@ -371,6 +371,9 @@ private:
         CurOp::get(opCtx)->debug().nShards = stats.getTargetedShards().size();
 
         result.appendElements(response.toBSON());
+
+        // Report how long the child batches took on each shard, if they were pipelined.
+        stats.appendShardLatencies(&result);
         return response.getOk();
     }
 
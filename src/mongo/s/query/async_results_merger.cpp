@@ -34,10 +34,13 @@
 
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/pipeline/change_stream_constants.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/util/assert_util.h"
@@ -45,6 +48,15 @@
 
 namespace mongo {
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMergerPrefetchWatermark, int, 0)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue,
+                          "internalQueryMergerPrefetchWatermark must be non-negative");
+        }
+        return Status::OK();
+    });
+
 constexpr StringData AsyncResultsMerger::kSortKeyField;
 const BSONObj AsyncResultsMerger::kWholeSortKeySortPattern = BSON(kSortKeyField << 1);
 
@@ -91,9 +103,7 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       _tailableMode(params.getTailableMode() ? *params.getTailableMode()
                                              : TailableModeEnum::kNormal),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(_remotes,
-                                    _params.getSort() ? *_params.getSort() : BSONObj(),
-                                    _params.getCompareWholeSortKey())) {
+      _mergeTree(_remotes, _params.getSort() ? *_params.getSort() : BSONObj()) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
     }
@@ -109,6 +119,7 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
         _addBatchToBuffer(WithLock::withoutLock(), remoteIndex, remote.getCursorResponse());
         ++remoteIndex;
     }
+    _mergeTree.rebuild();
 }
 
 AsyncResultsMerger::~AsyncResultsMerger() {
@@ -179,6 +190,7 @@ void AsyncResultsMerger::addNewShardCursors(std::vector<RemoteCursor>&& newCurso
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId());
     }
+    _mergeTree.rebuild();
 }
 
 bool AsyncResultsMerger::_ready(WithLock lk) {
@@ -220,14 +232,11 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock) {
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
-    auto smallestResult = _remotes[smallestRemote].docBuffer.front();
-    auto keyWeWantToReturn =
-        extractSortKey(*smallestResult.getResult(), _params.getCompareWholeSortKey());
+    const auto& keyWeWantToReturn = _remotes[_mergeTree.top()].frontSortKey;
     for (const auto& remote : _remotes) {
         if (!remote.promisedMinSortKey) {
             // In order to merge sorted tailable cursors, we need this value to be populated.
@@ -277,16 +286,15 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return _params.getSort() ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
 
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
@@ -294,16 +302,14 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
     _remotes[smallestRemote].docBuffer.pop();
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
-    }
+    // Replay the matches of 'smallestRemote' with its next result, if it has a next result.
+    _onFrontChanged(lk, smallestRemote);
+    _prefetchIfBelowWatermark(lk, smallestRemote);
 
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
@@ -321,6 +327,7 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
                 _eofNext = true;
             }
 
+            _prefetchIfBelowWatermark(lk, _gettingFromRemote);
             return front;
         }
 
@@ -334,6 +341,36 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
+void AsyncResultsMerger::_onFrontChanged(WithLock, size_t remoteIndex) {
+    if (!_params.getSort()) {
+        return;
+    }
+
+    auto& remote = _remotes[remoteIndex];
+    remote.frontSortKey = remote.docBuffer.empty()
+        ? BSONObj()
+        : extractSortKey(*remote.docBuffer.front().getResult(), _params.getCompareWholeSortKey());
+    _mergeTree.update(remoteIndex);
+}
+
+void AsyncResultsMerger::_prefetchIfBelowWatermark(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    // Tailable cursors pass the batches of their remotes through as they are, so they must not
+    // request a batch before the previous one has been returned.
+    if (_tailableMode != TailableModeEnum::kNormal || _lifecycleState != kAlive || !_opCtx ||
+        !remote.status.isOK() || remote.exhausted() || remote.cbHandle.isValid()) {
+        return;
+    }
+
+    const auto watermark = static_cast<size_t>(internalQueryMergerPrefetchWatermark.load());
+    if (remote.docBuffer.size() >= watermark) {
+        return;
+    }
+
+    remote.status = _askForNextBatch(lk, remoteIndex);
+}
+
 Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     invariant(_opCtx, "Cannot schedule a getMore without an OperationContext");
     auto& remote = _remotes[remoteIndex];
@@ -385,6 +422,7 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    remote.requestStartDate = _executor->now();
     return Status::OK();
 }
 
@@ -527,7 +565,10 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
                                               CbData const& cbData,
                                               size_t remoteIndex) {
     // Got a response from remote, so indicate we are no longer waiting for one.
-    _remotes[remoteIndex].cbHandle = executor::TaskExecutor::CallbackHandle();
+    auto& remote = _remotes[remoteIndex];
+    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    remote.totalWaitTime += _executor->now() - remote.requestStartDate;
+    ++remote.numBatchesReceived;
 
     //  On shutdown, there is no need to process the response.
     if (_lifecycleState != kAlive) {
@@ -570,6 +611,7 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
         remote.cursorId = 0;
+        _onFrontChanged(lk, remoteIndex);
     }
 }
 
@@ -620,6 +662,7 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
     updateRemoteMetadata(&remote, response);
+    const bool wasEmpty = remote.docBuffer.empty();
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (_params.getSort()) {
@@ -646,10 +689,11 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
-    // queue.
-    if (_params.getSort() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+    // If we're doing a sorted merge and this remote had nothing buffered, then it has a new front
+    // result which must take its place in the merge tree. A batch which was prefetched while
+    // results were still buffered does not change the front.
+    if (wasEmpty && !response.getBatch().empty()) {
+        _onFrontChanged(lk, remoteIndex);
     }
     return true;
 }
@@ -757,16 +801,73 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
 }
 
 //
-// AsyncResultsMerger::MergingComparator
+// AsyncResultsMerger::MergeLoserTree
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+void AsyncResultsMerger::MergeLoserTree::rebuild() {
+    const size_t numLeaves = _remotes.size();
+    _nodes.assign(numLeaves, 0);
+    if (numLeaves <= 1) {
+        return;
+    }
+
+    // Play the tournament bottom-up, recording the winner of each node so that it can compete at
+    // the parent node, and keeping only the loser in the tree.
+    std::vector<size_t> winners(2 * numLeaves);
+    for (size_t i = 0; i < numLeaves; ++i) {
+        winners[numLeaves + i] = i;
+    }
+    for (size_t node = numLeaves - 1; node > 0; --node) {
+        const size_t left = winners[2 * node];
+        const size_t right = winners[2 * node + 1];
+        const bool rightWins = _beats(right, left);
+        winners[node] = rightWins ? right : left;
+        _nodes[node] = rightWins ? left : right;
+    }
+    _nodes[0] = winners[1];
+}
+
+void AsyncResultsMerger::MergeLoserTree::update(size_t remoteIndex) {
+    // Remotes which are not part of the tree yet will be placed when it is next rebuilt.
+    if (remoteIndex >= _nodes.size()) {
+        return;
+    }
+
+    // The losers stored on a path are only meaningful for the remote which won every match on it,
+    // so a remote other than the overall winner requires the whole tournament to be replayed. This
+    // happens at most once per batch received, whereas the winner changes once per result.
+    if (remoteIndex != _nodes[0]) {
+        rebuild();
+        return;
+    }
+
+    size_t winner = remoteIndex;
+    for (size_t node = (_nodes.size() + remoteIndex) / 2; node > 0; node /= 2) {
+        if (_beats(_nodes[node], winner)) {
+            std::swap(_nodes[node], winner);
+        }
+    }
+    _nodes[0] = winner;
+}
+
+bool AsyncResultsMerger::MergeLoserTree::empty() const {
+    return _nodes.empty() || !_remotes[_nodes[0]].hasNext();
+}
+
+size_t AsyncResultsMerger::MergeLoserTree::top() const {
+    invariant(!empty());
+    return _nodes[0];
+}
+
+bool AsyncResultsMerger::MergeLoserTree::_beats(size_t lhs, size_t rhs) const {
+    const auto& left = _remotes[lhs];
+    const auto& right = _remotes[rhs];
+    if (!left.hasNext() || !right.hasNext()) {
+        return left.hasNext() || (!right.hasNext() && lhs < rhs);
+    }
 
-    return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
-                           extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
+    const int cmp = compareSortKeys(left.frontSortKey, right.frontSortKey, _sort);
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
 }
 
 void AsyncResultsMerger::blockingKill(OperationContext* opCtx) {
@@ -778,6 +879,34 @@ void AsyncResultsMerger::blockingKill(OperationContext* opCtx) {
     _executor->waitForEvent(killEvent);
 }
 
+BSONArray AsyncResultsMerger::getRemoteCursorStats() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    BSONArrayBuilder arrBuilder;
+    for (const auto& remote : _remotes) {
+        BSONObjBuilder remoteBuilder(arrBuilder.subobjStart());
+        remoteBuilder.append("host", remote.shardHostAndPort.toString());
+        remoteBuilder.append("cursorId", remote.cursorId);
+        remoteBuilder.appendNumber("bufferedDocs", static_cast<long long>(remote.docBuffer.size()));
+        remoteBuilder.append("batchesReceived", remote.numBatchesReceived);
+        remoteBuilder.append("totalWaitMillis", durationCount<Milliseconds>(remote.totalWaitTime));
+        if (remote.cbHandle.isValid()) {
+            remoteBuilder.append("waitingSince", remote.requestStartDate);
+        }
+    }
+    return arrBuilder.arr();
+}
+
+void AsyncResultsMerger::_reportRemoteCursorStats() {
+    if (!_opCtx) {
+        return;
+    }
+
+    auto stats = getRemoteCursorStats();
+    stdx::lock_guard<Client> lk(*_opCtx->getClient());
+    CurOp::get(_opCtx)->setRemoteCursorStats_inlock(std::move(stats));
+}
+
 StatusWith<ClusterQueryResult> AsyncResultsMerger::blockingNext() {
     while (!ready()) {
         auto nextEventStatus = nextEvent();
@@ -786,6 +915,9 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::blockingNext() {
         }
         auto event = nextEventStatus.getValue();
 
+        // Make the remotes we are about to wait for visible to currentOp.
+        _reportRemoteCursorStats();
+
         // Block until there are further results to return.
         auto status = _executor->waitForEvent(_opCtx, event);
 
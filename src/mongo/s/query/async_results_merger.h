@@ -37,6 +37,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
 #include "mongo/s/query/cluster_query_result.h"
 #include "mongo/stdx/mutex.h"
@@ -48,6 +49,11 @@ namespace mongo {
 
 class CursorResponse;
 
+// When a non-tailable merge consumes a result from a remote and fewer than this many results remain
+// buffered for that remote, the next batch is requested right away instead of once the buffer has
+// run dry. Zero, the default, disables prefetching.
+extern AtomicInt32 internalQueryMergerPrefetchWatermark;
+
 /**
  * Given a set of cursorIds across one or more shards, the AsyncResultsMerger calls getMore on the
  * cursors to present a single sorted or unsorted stream of documents.
@@ -87,8 +93,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, the remotes with
+     * buffered results are merged through _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      *
@@ -243,6 +249,13 @@ public:
      */
     void blockingKill(OperationContext*);
 
+    /**
+     * Returns an array with one entry per remote, describing the remote host, the number of
+     * results buffered for it, the number of batches received from it and the time spent waiting
+     * for them, as well as the start time of the outstanding request to it, if any.
+     */
+    BSONArray getRemoteCursorStats();
+
 private:
     /**
      * We instantiate one of these per remote host. It contains the buffer of results we've
@@ -301,26 +314,72 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // The sort key of the result at the front of 'docBuffer', extracted once when that result
+        // reaches the front so that the merge does not re-extract it for every comparison. Only
+        // set if there is a sort and 'docBuffer' is non-empty.
+        BSONObj frontSortKey;
+
+        // The time at which the outstanding request to this remote was scheduled, if any.
+        Date_t requestStartDate;
+
+        // The total time spent waiting for responses from this remote and the number of batches
+        // received from it, reported by currentOp.
+        Milliseconds totalWaitTime{0};
+        long long numBatchesReceived = 0;
     };
 
-    class MergingComparator {
+    /**
+     * A tournament tree of losers over the remotes, used to find the remote whose next buffered
+     * result sorts first. Each internal node holds the index of the remote which lost the match
+     * played at that node, and the overall winner is kept separately. A remote with nothing
+     * buffered loses every match, and ties between equal sort keys are broken by remote index.
+     *
+     * When the result at the front of the winning remote changes, the winner is recomputed by
+     * replaying only the matches on the path from that remote's leaf to the root, which costs
+     * log(k) comparisons of cached sort keys for k remotes.
+     */
+    class MergeLoserTree {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes,
-                          const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
+        MergeLoserTree(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
+            : _remotes(remotes), _sort(sort) {}
+
+        /**
+         * Replays every match in the tree. Must be called whenever remotes are added.
+         */
+        void rebuild();
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        /**
+         * Recomputes the winner after the front of the buffer for 'remoteIndex' has changed.
+         */
+        void update(size_t remoteIndex);
+
+        /**
+         * Returns true if none of the remotes has a buffered result.
+         */
+        bool empty() const;
+
+        /**
+         * Returns the index of the remote with the smallest buffered result. Illegal to call if
+         * empty().
+         */
+        size_t top() const;
 
     private:
+        /**
+         * Returns true if the next result from remote 'lhs' should be returned before that of
+         * remote 'rhs'.
+         */
+        bool _beats(size_t lhs, size_t rhs) const;
+
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj _sort;
 
-        // When '_compareWholeSortKey' is true, $sortKey is a scalar value, rather than an object.
-        // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
-        // be {$sortKey: 1}.
-        const bool _compareWholeSortKey;
+        // Position 0 holds the overall winner. Positions [1, k) hold the loser of the match at
+        // each internal node, where the children of node n are at 2n and 2n + 1, and the leaf for
+        // remote i is at position k + i.
+        std::vector<size_t> _nodes;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -422,6 +481,23 @@ private:
      */
     void _scheduleKillCursors(WithLock, OperationContext* opCtx);
 
+    /**
+     * Must be called after the result at the front of the buffer for 'remoteIndex' has changed.
+     * Refreshes the remote's cached sort key and its position in the merge tree.
+     */
+    void _onFrontChanged(WithLock, size_t remoteIndex);
+
+    /**
+     * Asks the remote for its next batch ahead of time if fewer results than the
+     * internalQueryMergerPrefetchWatermark are buffered for it and no request is outstanding.
+     */
+    void _prefetchIfBelowWatermark(WithLock, size_t remoteIndex);
+
+    /**
+     * Publishes the per-remote statistics on the CurOp of the attached operation, if any.
+     */
+    void _reportRemoteCursorStats();
+
     /**
      * Updates 'remote's metadata (e.g. the cursor id) based on information in 'response'.
      */
@@ -438,9 +514,9 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // The winner of this tree is the index into '_remotes' for the remote host that has the next
+    // document to return, according to the sort order. Used only if there is a sort.
+    MergeLoserTree _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
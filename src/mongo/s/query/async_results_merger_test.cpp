@@ -45,6 +45,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -631,6 +632,117 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergePrefetchesBatchesBelowWatermark) {
+    const auto oldWatermark = internalQueryMergerPrefetchWatermark.load();
+    internalQueryMergerPrefetchWatermark.store(2);
+    ON_BLOCK_EXIT([&] { internalQueryMergerPrefetchWatermark.store(oldWatermark); });
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<BSONObj> firstBatch1 = {fromjson("{$sortKey: {'': 1}}"),
+                                        fromjson("{$sortKey: {'': 3}}"),
+                                        fromjson("{$sortKey: {'': 5}}")};
+    std::vector<BSONObj> firstBatch2 = {fromjson("{$sortKey: {'': 2}}"),
+                                        fromjson("{$sortKey: {'': 4}}")};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, firstBatch1)));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(kTestNss, 6, firstBatch2)));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    // The first shard still has two results buffered after the first one is returned, so nothing
+    // is prefetched.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // The second shard drops below the watermark, so its next batch is requested although it
+    // still has a result buffered.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+    auto request = GetMoreRequest::parseFromBSON("anydbname", getNthPendingRequest(0).cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(request.getValue().cursorid, 6LL);
+
+    // The prefetched batch is appended behind the result which is still buffered.
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 6}}"),
+                                   fromjson("{$sortKey: {'': 7}}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses));
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 3}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    auto prefetchRequest =
+        GetMoreRequest::parseFromBSON("anydbname", getNthPendingRequest(0).cmdObj);
+    ASSERT_OK(prefetchRequest.getStatus());
+    ASSERT_EQ(prefetchRequest.getValue().cursorid, 5LL);
+
+    responses.clear();
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 8}}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch1);
+    scheduleNetworkResponses(std::move(responses));
+
+    // Both shards are exhausted, and the remaining results are merged in sorted order.
+    ASSERT_TRUE(arm->remotesExhausted());
+    for (int expected : {4, 5, 6, 7, 8}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("$sortKey" << BSON("" << expected)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_FALSE(networkHasReadyRequests());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, RemoteCursorStatsReportTimeSpentWaitingForBatches) {
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, {})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    // While the getMore is outstanding, the remote reports when it was sent.
+    auto stats = arm->getRemoteCursorStats();
+    ASSERT_EQ(stats.nFields(), 1);
+    auto remoteStats = stats[0].Obj();
+    ASSERT_EQ(remoteStats["host"].String(), kTestShardHosts[0].toString());
+    ASSERT_EQ(remoteStats["batchesReceived"].numberLong(), 0LL);
+    ASSERT_EQ(remoteStats["waitingSince"].type(), BSONType::Date);
+
+    // Deliver the response 100ms after the request was sent.
+    std::vector<BSONObj> batch = {fromjson("{_id: 1}")};
+    {
+        NetworkInterfaceMock::InNetworkGuard guard(network());
+        const auto responseDate = guard->now() + Milliseconds(100);
+        guard->scheduleResponse(
+            guard->getNextReadyRequest(),
+            responseDate,
+            RemoteCommandResponse(CursorResponse(kTestNss, CursorId(0), batch)
+                                      .toBSON(CursorResponse::ResponseType::SubsequentResponse),
+                                  BSONObj(),
+                                  Milliseconds(100)));
+        guard->runUntil(responseDate);
+    }
+    executor()->waitForEvent(readyEvent);
+
+    stats = arm->getRemoteCursorStats();
+    remoteStats = stats[0].Obj();
+    ASSERT_EQ(remoteStats["batchesReceived"].numberLong(), 1LL);
+    ASSERT_EQ(remoteStats["totalWaitMillis"].numberLong(), 100LL);
+    ASSERT_EQ(remoteStats["bufferedDocs"].numberLong(), 1LL);
+    ASSERT_FALSE(remoteStats.hasField("waitingSince"));
+
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
@@ -45,4 +45,13 @@ extern AtomicBool internalQueryAlwaysMergeOnPrimaryShard;
 // of merging on mongoS will always do so.
 extern AtomicBool internalQueryProhibitMergingOnMongoS;
 
+// The maximum number of shards between which mongos spreads the merging of the shards' partial
+// results, when the merging half of a split pipeline begins with a $group. Each shard then
+// hash-partitions its partial groups by key, and each merging shard completes the groups of one
+// partition, so that only final results reach the last merger. Fewer merging shards are used if
+// fewer shards are targeted. A value of 0 or 1 disables partitioned merging, which is the default:
+// shards older than this mongos reject the 'exchangePartitions' option, so it may only be raised
+// once every shard has been upgraded.
+extern AtomicInt32 internalQueryMaxPartitionedGroupMergers;
+
 }  // namespace mongo
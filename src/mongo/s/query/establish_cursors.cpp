@@ -39,13 +39,35 @@
 #include "mongo/db/query/killcursors_request.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/async_requests_sender.h"
 #include "mongo/s/grid.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
+namespace {
+
+// Cumulative, always-increasing counters describing the calls to establishCursors.
+struct CursorEstablishmentStats {
+    // How many calls were made, and how many of them targeted a single remote.
+    AtomicInt64 count{0};
+    AtomicInt64 countSingleTarget{0};
+
+    // How many remotes were targeted across all calls.
+    AtomicInt64 remotesTargeted{0};
+
+    // How many calls failed to establish their cursors.
+    AtomicInt64 countFailed{0};
+
+    // How long the calls took, from sending the first request to receiving the last response.
+    AtomicInt64 totalMicros{0};
+    AtomicInt64 totalSingleTargetMicros{0};
+} cursorEstablishmentStats;
+
+}  // namespace
 
 std::vector<RemoteCursor> establishCursors(OperationContext* opCtx,
                                            executor::TaskExecutor* executor,
@@ -53,6 +75,18 @@ std::vector<RemoteCursor> establishCursors(OperationContext* opCtx,
                                            const ReadPreferenceSetting readPref,
                                            const std::vector<std::pair<ShardId, BSONObj>>& remotes,
                                            bool allowPartialResults) {
+    Timer timer;
+    ON_BLOCK_EXIT([&] {
+        const auto micros = timer.micros();
+        cursorEstablishmentStats.count.addAndFetch(1);
+        cursorEstablishmentStats.remotesTargeted.addAndFetch(remotes.size());
+        cursorEstablishmentStats.totalMicros.addAndFetch(micros);
+        if (remotes.size() == 1) {
+            cursorEstablishmentStats.countSingleTarget.addAndFetch(1);
+            cursorEstablishmentStats.totalSingleTargetMicros.addAndFetch(micros);
+        }
+    });
+
     // Construct the requests
     std::vector<AsyncRequestsSender::Request> requests;
     for (const auto& remote : remotes) {
@@ -77,13 +111,24 @@ std::vector<RemoteCursor> establishCursors(OperationContext* opCtx,
                 // to do this after parsing the cursor response to ensure the response was ok.
                 // Additionally, be careful not to push into 'remoteCursors' until we are sure we
                 // have a valid cursor, since the error handling path will attempt to clean up
-                // anything in 'remoteCursors'
-                RemoteCursor cursor;
-                cursor.setCursorResponse(CursorResponse::parseFromBSONThrowing(
-                    uassertStatusOK(std::move(response.swResponse)).data));
-                cursor.setShardId(std::move(response.shardId));
-                cursor.setHostAndPort(*response.shardHostAndPort);
-                remoteCursors.push_back(std::move(cursor));
+                // anything in 'remoteCursors'. A single response may carry several cursors when
+                // the remote partitions its output between several consumers; keep the valid ones
+                // so that they are cleaned up if any of their siblings failed.
+                auto cursorResponses = CursorResponse::parseFromBSONMany(
+                    uassertStatusOK(std::move(response.swResponse)).data);
+                Status cursorsStatus = Status::OK();
+                for (auto&& swCursorResponse : cursorResponses) {
+                    if (!swCursorResponse.isOK()) {
+                        cursorsStatus = swCursorResponse.getStatus();
+                        continue;
+                    }
+                    RemoteCursor cursor;
+                    cursor.setCursorResponse(std::move(swCursorResponse.getValue()));
+                    cursor.setShardId(response.shardId);
+                    cursor.setHostAndPort(*response.shardHostAndPort);
+                    remoteCursors.push_back(std::move(cursor));
+                }
+                uassertStatusOK(cursorsStatus);
             } catch (const DBException& ex) {
                 // Retriable errors are swallowed if 'allowPartialResults' is true.
                 if (allowPartialResults &&
@@ -98,6 +143,8 @@ std::vector<RemoteCursor> establishCursors(OperationContext* opCtx,
         }
         return remoteCursors;
     } catch (const DBException&) {
+        cursorEstablishmentStats.countFailed.addAndFetch(1);
+
         // If one of the remotes had an error, we make a best effort to finish retrieving responses
         // for other requests that were already sent, so that we can send killCursors to any cursors
         // that we know were established.
@@ -109,37 +156,25 @@ std::vector<RemoteCursor> establishCursors(OperationContext* opCtx,
             while (!ars.done()) {
                 auto response = ars.next();
 
-                // Check if the response contains an established cursor, and if so, store it.
-                StatusWith<CursorResponse> swCursorResponse(
-                    response.swResponse.isOK()
-                        ? CursorResponse::parseFromBSON(response.swResponse.getValue().data)
-                        : response.swResponse.getStatus());
+                // Check if the response contains any established cursors, and if so, store them.
+                if (!response.swResponse.isOK()) {
+                    continue;
+                }
 
-                if (swCursorResponse.isOK()) {
-                    RemoteCursor cursor;
-                    cursor.setShardId(std::move(response.shardId));
-                    cursor.setHostAndPort(*response.shardHostAndPort);
-                    cursor.setCursorResponse(std::move(swCursorResponse.getValue()));
-                    remoteCursors.push_back(std::move(cursor));
+                for (auto&& swCursorResponse :
+                     CursorResponse::parseFromBSONMany(response.swResponse.getValue().data)) {
+                    if (swCursorResponse.isOK()) {
+                        RemoteCursor cursor;
+                        cursor.setShardId(response.shardId);
+                        cursor.setHostAndPort(*response.shardHostAndPort);
+                        cursor.setCursorResponse(std::move(swCursorResponse.getValue()));
+                        remoteCursors.push_back(std::move(cursor));
+                    }
                 }
             }
 
             // Schedule killCursors against all cursors that were established.
-            for (const auto& remoteCursor : remoteCursors) {
-                BSONObj cmdObj =
-                    KillCursorsRequest(nss, {remoteCursor.getCursorResponse().getCursorId()})
-                        .toBSON();
-                executor::RemoteCommandRequest request(
-                    remoteCursor.getHostAndPort(), nss.db().toString(), cmdObj, opCtx);
-
-                // We do not process the response to the killCursors request (we make a good-faith
-                // attempt at cleaning up the cursors, but ignore any returned errors).
-                executor
-                    ->scheduleRemoteCommand(
-                        request,
-                        [](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {})
-                    .status_with_transitional_ignore();
-            }
+            killRemoteCursors(opCtx, executor, nss, remoteCursors);
         } catch (const DBException&) {
             // Ignore the new error and rethrow the original one.
         }
@@ -148,4 +183,34 @@ std::vector<RemoteCursor> establishCursors(OperationContext* opCtx,
     }
 }
 
+void killRemoteCursors(OperationContext* opCtx,
+                       executor::TaskExecutor* executor,
+                       const NamespaceString& nss,
+                       const std::vector<RemoteCursor>& remoteCursors) {
+    for (const auto& remoteCursor : remoteCursors) {
+        BSONObj cmdObj =
+            KillCursorsRequest(nss, {remoteCursor.getCursorResponse().getCursorId()}).toBSON();
+        executor::RemoteCommandRequest request(
+            remoteCursor.getHostAndPort(), nss.db().toString(), cmdObj, opCtx);
+
+        // We do not process the response to the killCursors request (we make a good-faith attempt
+        // at cleaning up the cursors, but ignore any returned errors).
+        executor
+            ->scheduleRemoteCommand(
+                request, [](const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {})
+            .status_with_transitional_ignore();
+    }
+}
+
+void reportCursorEstablishmentStats(BSONObjBuilder* builder) {
+    BSONObjBuilder statsBuilder(builder->subobjStart("cursorEstablishment"));
+    statsBuilder.append("count", cursorEstablishmentStats.count.load());
+    statsBuilder.append("countSingleTarget", cursorEstablishmentStats.countSingleTarget.load());
+    statsBuilder.append("remotesTargeted", cursorEstablishmentStats.remotesTargeted.load());
+    statsBuilder.append("countFailed", cursorEstablishmentStats.countFailed.load());
+    statsBuilder.append("totalMicros", cursorEstablishmentStats.totalMicros.load());
+    statsBuilder.append("totalSingleTargetMicros",
+                        cursorEstablishmentStats.totalSingleTargetMicros.load());
+}
+
 }  // namespace mongo
@@ -43,6 +43,7 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
 class CursorResponse;
 
 /**
@@ -68,4 +69,20 @@ std::vector<RemoteCursor> establishCursors(OperationContext* opCtx,
                                            const std::vector<std::pair<ShardId, BSONObj>>& remotes,
                                            bool allowPartialResults);
 
+/**
+ * Schedules a killCursors request against each of 'remoteCursors' on 'nss', without waiting for
+ * the responses. This is a best-effort cleanup: errors scheduling or running the requests are
+ * ignored.
+ */
+void killRemoteCursors(OperationContext* opCtx,
+                       executor::TaskExecutor* executor,
+                       const NamespaceString& nss,
+                       const std::vector<RemoteCursor>& remoteCursors);
+
+/**
+ * Appends the cumulative statistics about the calls to establishCursors made by this node, such as
+ * their number and the total time spent waiting for the remotes to respond, for serverStatus.
+ */
+void reportCursorEstablishmentStats(BSONObjBuilder* builder);
+
 }  // namespace mongo
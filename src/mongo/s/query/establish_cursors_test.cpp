@@ -148,6 +148,62 @@ TEST_F(EstablishCursorsTest, SingleRemoteRespondsWithNonretriableError) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(EstablishCursorsTest, StatsCountEstablishedAndFailedCalls) {
+    auto getStats = [] {
+        BSONObjBuilder builder;
+        reportCursorEstablishmentStats(&builder);
+        return builder.obj()["cursorEstablishment"].Obj().getOwned();
+    };
+    const auto statsBefore = getStats();
+
+    BSONObj cmdObj = fromjson("{find: 'testcoll'}");
+    std::vector<std::pair<ShardId, BSONObj>> remotes{{kTestShardIds[0], cmdObj},
+                                                     {kTestShardIds[1], cmdObj}};
+
+    auto future = launchAsync([&] {
+        auto cursors = establishCursors(operationContext(),
+                                        executor(),
+                                        _nss,
+                                        ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+                                        {remotes.front()},
+                                        false);  // allowPartialResults
+        ASSERT_EQUALS(1U, cursors.size());
+
+        ASSERT_THROWS(establishCursors(operationContext(),
+                                       executor(),
+                                       _nss,
+                                       ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+                                       remotes,
+                                       false),  // allowPartialResults
+                      ExceptionFor<ErrorCodes::FailedToParse>);
+    });
+
+    // The remote of the single-target call responds.
+    onCommand([this](const RemoteCommandRequest& request) {
+        CursorResponse cursorResponse(_nss, CursorId(0), {fromjson("{_id: 1}")});
+        return cursorResponse.toBSON(CursorResponse::ResponseType::InitialResponse);
+    });
+
+    // Both remotes of the second call respond with a non-retriable error.
+    onCommand([](const RemoteCommandRequest& request) {
+        return Status(ErrorCodes::FailedToParse, "failed to parse");
+    });
+    onCommand([](const RemoteCommandRequest& request) {
+        return Status(ErrorCodes::FailedToParse, "failed to parse");
+    });
+    future.timed_get(kFutureTimeout);
+
+    const auto statsAfter = getStats();
+    auto delta = [&](StringData field) {
+        return statsAfter[field].numberLong() - statsBefore[field].numberLong();
+    };
+    ASSERT_EQ(2, delta("count"));
+    ASSERT_EQ(1, delta("countSingleTarget"));
+    ASSERT_EQ(3, delta("remotesTargeted"));
+    ASSERT_EQ(1, delta("countFailed"));
+    ASSERT_GTE(delta("totalMicros"), delta("totalSingleTargetMicros"));
+}
+
 TEST_F(EstablishCursorsTest, SingleRemoteRespondsWithNonretriableErrorAllowPartialResults) {
     BSONObj cmdObj = fromjson("{find: 'testcoll'}");
     std::vector<std::pair<ShardId, BSONObj>> remotes{{kTestShardIds[0], cmdObj}};
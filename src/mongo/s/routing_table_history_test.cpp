@@ -0,0 +1,277 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const KeyPattern kShardKeyPattern(BSON("x" << 1));
+
+class RoutingTableHistoryTest : public unittest::Test {
+protected:
+    /**
+     * Makes a routing table with chunks [MinKey, 0), [0, 10), ..., [80, 90), [90, MaxKey), owned
+     * round-robin by shards "0", "1" and "2".
+     */
+    std::shared_ptr<RoutingTableHistory> makeRoutingTable() {
+        std::vector<ChunkType> chunks;
+        BSONObj min = BSON("x" << MINKEY);
+        for (int i = 0; i <= 10; ++i) {
+            BSONObj max = i < 10 ? BSON("x" << i * 10) : BSON("x" << MAXKEY);
+            chunks.emplace_back(kNss, ChunkRange(min, max), nextVersion(), shardFor(i));
+            min = max;
+        }
+
+        return RoutingTableHistory::makeNew(
+            kNss, UUID::gen(), kShardKeyPattern, nullptr, false, _epoch, chunks);
+    }
+
+    ChunkVersion nextVersion() {
+        return ChunkVersion(++_majorVersion, 0, _epoch);
+    }
+
+    static ShardId shardFor(int i) {
+        return ShardId(std::to_string(i % 3));
+    }
+
+    /**
+     * Asserts that the chunks of 'rt', in order, have the given bounds and owning shards.
+     */
+    static void assertChunks(const std::shared_ptr<RoutingTableHistory>& rt,
+                             const std::vector<std::pair<ChunkRange, ShardId>>& expected) {
+        ChunkManager cm(rt, boost::none);
+        ASSERT_EQ(static_cast<int>(expected.size()), cm.numChunks());
+
+        auto expectedIt = expected.begin();
+        for (const auto& chunk : cm.chunks()) {
+            ASSERT_BSONOBJ_EQ(expectedIt->first.getMin(), chunk.getMin());
+            ASSERT_BSONOBJ_EQ(expectedIt->first.getMax(), chunk.getMax());
+            ASSERT_EQ(expectedIt->second, chunk.getShardId());
+            ++expectedIt;
+        }
+    }
+
+    const OID _epoch = OID::gen();
+    uint32_t _majorVersion = 0;
+};
+
+TEST_F(RoutingTableHistoryTest, UpdateWithSplitAndMove) {
+    auto rt = makeRoutingTable();
+
+    // Split [10, 20) at 15 and move [50, 60) to shard "0".
+    std::vector<ChunkType> changes;
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 10), BSON("x" << 15)), nextVersion(), shardFor(2));
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 15), BSON("x" << 20)), nextVersion(), shardFor(2));
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 50), BSON("x" << 60)), nextVersion(), ShardId("0"));
+
+    auto updated = rt->makeUpdated(changes);
+    ASSERT_NE(rt, updated);
+    ASSERT_EQ(12, ChunkManager(updated, boost::none).numChunks());
+
+    ChunkManager cm(updated, boost::none);
+    auto chunk = cm.findIntersectingChunkWithSimpleCollation(BSON("x" << 17));
+    ASSERT_BSONOBJ_EQ(BSON("x" << 15), chunk.getMin());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 20), chunk.getMax());
+    ASSERT_EQ(ShardId("0"),
+              cm.findIntersectingChunkWithSimpleCollation(BSON("x" << 55)).getShardId());
+
+    // The original routing table is unchanged.
+    ASSERT_EQ(11, ChunkManager(rt, boost::none).numChunks());
+    ASSERT_EQ(shardFor(6),
+              ChunkManager(rt, boost::none)
+                  .findIntersectingChunkWithSimpleCollation(BSON("x" << 55))
+                  .getShardId());
+}
+
+TEST_F(RoutingTableHistoryTest, UpdateWithChangesOverlappingEachOther) {
+    auto rt = makeRoutingTable();
+
+    // Split [20, 30) at 25, then merge [0, 10), [10, 20) and [20, 25), then move the first chunk.
+    std::vector<ChunkType> changes;
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 20), BSON("x" << 25)), nextVersion(), shardFor(3));
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 25), BSON("x" << 30)), nextVersion(), shardFor(3));
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 0), BSON("x" << 25)), nextVersion(), ShardId("1"));
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << MINKEY), BSON("x" << 0)), nextVersion(), ShardId("2"));
+
+    assertChunks(rt->makeUpdated(changes),
+                 {{ChunkRange(BSON("x" << MINKEY), BSON("x" << 0)), ShardId("2")},
+                  {ChunkRange(BSON("x" << 0), BSON("x" << 25)), ShardId("1")},
+                  {ChunkRange(BSON("x" << 25), BSON("x" << 30)), shardFor(3)},
+                  {ChunkRange(BSON("x" << 30), BSON("x" << 40)), shardFor(4)},
+                  {ChunkRange(BSON("x" << 40), BSON("x" << 50)), shardFor(5)},
+                  {ChunkRange(BSON("x" << 50), BSON("x" << 60)), shardFor(6)},
+                  {ChunkRange(BSON("x" << 60), BSON("x" << 70)), shardFor(7)},
+                  {ChunkRange(BSON("x" << 70), BSON("x" << 80)), shardFor(8)},
+                  {ChunkRange(BSON("x" << 80), BSON("x" << 90)), shardFor(9)},
+                  {ChunkRange(BSON("x" << 90), BSON("x" << MAXKEY)), shardFor(10)}});
+}
+
+TEST_F(RoutingTableHistoryTest, UpdateSharesUnchangedChunks) {
+    // Enough chunks for the chunk map to be split into several blocks
+    const int numChunks = 4 * ChunkInfoMap::kMaxBlockSize;
+
+    std::vector<ChunkType> chunks;
+    BSONObj min = BSON("x" << MINKEY);
+    for (int i = 0; i < numChunks; ++i) {
+        BSONObj max = i < numChunks - 1 ? BSON("x" << i) : BSON("x" << MAXKEY);
+        chunks.emplace_back(kNss, ChunkRange(min, max), nextVersion(), shardFor(i));
+        min = max;
+    }
+
+    auto rt = RoutingTableHistory::makeNew(
+        kNss, UUID::gen(), kShardKeyPattern, nullptr, false, _epoch, chunks);
+    ASSERT_GT(rt->getChunkMap().numBlocks(), 1U);
+
+    // Move the last chunk
+    std::vector<ChunkType> changes;
+    changes.emplace_back(kNss,
+                         ChunkRange(BSON("x" << numChunks - 2), BSON("x" << MAXKEY)),
+                         nextVersion(),
+                         shardFor(numChunks));
+
+    auto updated = rt->makeUpdated(changes);
+    ASSERT_EQ(rt->getChunkMap().size(), updated->getChunkMap().size());
+    ASSERT_EQ(rt->getChunkMap().numBlocks(), updated->getChunkMap().numBlocks());
+
+    // The entries at the start of the map are the very same objects in both routing tables
+    ASSERT_EQ(&*rt->getChunkMap().begin(), &*updated->getChunkMap().begin());
+
+    ChunkManager cm(updated, boost::none);
+    ASSERT_EQ(shardFor(numChunks),
+              cm.findIntersectingChunkWithSimpleCollation(BSON("x" << numChunks)).getShardId());
+    ASSERT_EQ(shardFor(0),
+              cm.findIntersectingChunkWithSimpleCollation(BSON("x" << -1)).getShardId());
+}
+
+TEST_F(RoutingTableHistoryTest, UpdateMaintainsShardVersions) {
+    auto rt = makeRoutingTable();
+
+    // Each chunk i has version (i + 1, 0), so shard "1" owns chunks 1, 4, 7 and 10 and has the
+    // version of chunk 10
+    ASSERT_EQ(ChunkVersion(11, 0, _epoch), rt->getVersion(ShardId("1")));
+
+    // Moving chunk 10 without a new version for its donor leaves shard "1" with the version of
+    // chunk 7
+    std::vector<ChunkType> changes;
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 90), BSON("x" << MAXKEY)), nextVersion(), ShardId("0"));
+
+    auto updated = rt->makeUpdated(changes);
+    ASSERT_EQ(ChunkVersion(8, 0, _epoch), updated->getVersion(ShardId("1")));
+    ASSERT_EQ(ChunkVersion(12, 0, _epoch), updated->getVersion(ShardId("0")));
+    ASSERT_EQ(ChunkVersion(9, 0, _epoch), updated->getVersion(ShardId("2")));
+
+    // Moving all of the chunks of shard "2" away removes it from the routing table
+    changes.clear();
+    for (int i : {2, 5, 8}) {
+        changes.emplace_back(kNss,
+                             ChunkRange(BSON("x" << (i - 1) * 10), BSON("x" << i * 10)),
+                             nextVersion(),
+                             ShardId("0"));
+    }
+
+    updated = updated->makeUpdated(changes);
+    ASSERT_EQ(ChunkVersion(15, 0, _epoch), updated->getVersion(ShardId("0")));
+    ASSERT_EQ(ChunkVersion(0, 0, _epoch), updated->getVersion(ShardId("2")));
+
+    std::set<ShardId> shardIds;
+    updated->getAllShardIds(&shardIds);
+    ASSERT_EQ(2U, shardIds.size());
+    ASSERT_EQ(0U, shardIds.count(ShardId("2")));
+}
+
+TEST_F(RoutingTableHistoryTest, UpdateWhichLeavesAnOverlapFails) {
+    auto rt = makeRoutingTable();
+
+    // Only half of a split of [10, 20)
+    std::vector<ChunkType> changes;
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 10), BSON("x" << 15)), nextVersion(), shardFor(2));
+
+    ASSERT_THROWS_CODE(
+        rt->makeUpdated(changes), DBException, ErrorCodes::ConflictingOperationInProgress);
+}
+
+TEST_F(RoutingTableHistoryTest, KeyStringOwnershipRangeCoalescesChunksOfTheSameShard) {
+    auto rt = makeRoutingTable();
+
+    // Move [10, 20) and [20, 30) to shard "1", which then owns [0, 40)
+    std::vector<ChunkType> changes;
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 10), BSON("x" << 20)), nextVersion(), ShardId("1"));
+    changes.emplace_back(
+        kNss, ChunkRange(BSON("x" << 20), BSON("x" << 30)), nextVersion(), ShardId("1"));
+
+    ChunkManager cm(rt->makeUpdated(changes), boost::none);
+    const auto keyString = cm.extractKeyString(BSON("x" << 25));
+
+    auto range = cm.getKeyStringOwnershipRange(keyString, 10);
+    ASSERT(range);
+    ASSERT_EQ(ShardId("1"), range->shardId);
+    ASSERT_EQ(cm.extractKeyString(BSON("x" << 0)), range->min);
+    ASSERT_EQ(cm.extractKeyString(BSON("x" << 40)), range->max);
+    ASSERT_LTE(range->min, keyString);
+    ASSERT_LT(keyString, range->max);
+
+    // Widening stops after the given number of chunks on either side
+    range = cm.getKeyStringOwnershipRange(keyString, 1);
+    ASSERT(range);
+    ASSERT_EQ(cm.extractKeyString(BSON("x" << 10)), range->min);
+    ASSERT_EQ(cm.extractKeyString(BSON("x" << 40)), range->max);
+
+    // The first chunk's range starts at the beginning of the key space
+    range = cm.getKeyStringOwnershipRange(cm.extractKeyString(BSON("x" << -5)), 10);
+    ASSERT(range);
+    ASSERT_EQ(shardFor(0), range->shardId);
+    ASSERT_EQ(std::string(), range->min);
+    ASSERT_EQ(cm.extractKeyString(BSON("x" << 0)), range->max);
+
+    // No chunk contains MaxKey
+    ASSERT_FALSE(cm.getKeyStringOwnershipRange(cm.extractKeyString(BSON("x" << MAXKEY)), 10));
+}
+
+TEST_F(RoutingTableHistoryTest, UpdateWithNoNewVersionReturnsSameRoutingTable) {
+    auto rt = makeRoutingTable();
+    ASSERT_EQ(rt, rt->makeUpdated({}));
+}
+
+}  // namespace
+}  // namespace mongo
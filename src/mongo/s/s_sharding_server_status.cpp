@@ -34,6 +34,7 @@
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query/establish_cursors.h"
 
 namespace mongo {
 namespace {
@@ -82,6 +83,7 @@ public:
 
         BSONObjBuilder result;
         catalogCache->report(&result);
+        reportCursorEstablishmentStats(&result);
         return result.obj();
     }
 
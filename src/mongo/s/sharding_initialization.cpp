@@ -96,6 +96,17 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolRefreshTimeoutMS,
                                       int,
                                       ConnectionPool::kDefaultRefreshTimeout.count());
 
+// Lets each shard's pool size itself from the concurrency it has recently needed instead of
+// opening a connection per queued request, which damps connection storms after latency blips.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolAdaptiveSizing, bool, false);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolAdaptiveIntervalMS,
+                                      int,
+                                      ConnectionPool::kDefaultAdaptiveInterval.count());
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(
+    ShardingTaskExecutorPoolAdaptiveTargetQueueDepth,
+    int,
+    static_cast<int>(ConnectionPool::kDefaultAdaptiveTargetQueueDepth));
+
 namespace {
 
 using executor::NetworkInterface;
@@ -191,6 +202,11 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
     connPoolOptions.minConnections = ShardingTaskExecutorPoolMinSize;
     connPoolOptions.refreshRequirement = Milliseconds(ShardingTaskExecutorPoolRefreshRequirementMS);
     connPoolOptions.refreshTimeout = Milliseconds(ShardingTaskExecutorPoolRefreshTimeoutMS);
+    connPoolOptions.adaptiveSizing = ShardingTaskExecutorPoolAdaptiveSizing;
+    connPoolOptions.adaptiveInterval =
+        Milliseconds(std::max(ShardingTaskExecutorPoolAdaptiveIntervalMS, 1));
+    connPoolOptions.adaptiveTargetQueueDepth =
+        std::max(ShardingTaskExecutorPoolAdaptiveTargetQueueDepth, 0);
 
     if (connPoolOptions.refreshRequirement <= connPoolOptions.refreshTimeout) {
         auto newRefreshTimeout = connPoolOptions.refreshRequirement - Milliseconds(1);
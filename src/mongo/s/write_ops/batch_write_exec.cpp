@@ -38,6 +38,7 @@
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/s/async_requests_sender.h"
 #include "mongo/s/client/shard_registry.h"
@@ -45,8 +46,19 @@
 #include "mongo/s/write_ops/batch_write_op.h"
 #include "mongo/s/write_ops/write_error_detail.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(maxInFlightWriteBatchesPerShard, int, 1)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "maxInFlightWriteBatchesPerShard must be at least 1");
+        }
+        return Status::OK();
+    });
+
 namespace {
 
 const ReadPreferenceSetting kPrimaryOnlyReadPreference(ReadPreference::PrimaryOnly);
@@ -79,6 +91,281 @@ void noteStaleResponses(const std::vector<ShardError>& staleErrors, NSTargeter*
 // applies when no writes are occurring and metadata is not changing on reload.
 const int kMaxRoundsWithoutProgress(5);
 
+/**
+ * Builds the command which sends the child batch 'targetedBatch' to its shard.
+ */
+BSONObj buildShardBatchCommand(OperationContext* opCtx,
+                               const BatchWriteOp& batchOp,
+                               const TargetedWriteBatch& targetedBatch) {
+    const auto shardBatchRequest(batchOp.buildBatchRequest(targetedBatch));
+
+    BSONObjBuilder requestBuilder;
+    shardBatchRequest.serialize(&requestBuilder);
+
+    {
+        OperationSessionInfo sessionInfo;
+
+        if (opCtx->getLogicalSessionId()) {
+            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
+        }
+
+        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
+        sessionInfo.serialize(&requestBuilder);
+    }
+
+    return requestBuilder.obj();
+}
+
+/**
+ * Notes the response for the child batch 'batch' in 'batchOp' and in 'stats', and notes any stale
+ * shard versions it reports on 'targeter'. Returns true if the response indicated that some of the
+ * writes in 'batch' must be retargeted after the targeter has been refreshed.
+ */
+bool noteShardBatchResponse(NSTargeter& targeter,
+                            BatchWriteOp& batchOp,
+                            const TargetedWriteBatch& batch,
+                            AsyncRequestsSender::Response response,
+                            BatchWriteExecStats* stats) {
+    // First check if we were able to target a shard host.
+    if (!response.shardHostAndPort) {
+        invariant(!response.swResponse.isOK());
+
+        // Record a resolve failure
+        batchOp.noteBatchError(batch, errorFromStatus(response.swResponse.getStatus()));
+
+        // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel and
+        // retarget the batch
+        LOG(4) << "Unable to send write batch to " << batch.getEndpoint().shardName
+               << causedBy(response.swResponse.getStatus());
+        return false;
+    }
+
+    const auto shardHost(std::move(*response.shardHostAndPort));
+
+    // Then check if we successfully got a response.
+    Status responseStatus = response.swResponse.getStatus();
+    BatchedCommandResponse batchedCommandResponse;
+    if (responseStatus.isOK()) {
+        std::string errMsg;
+        if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data, &errMsg) ||
+            !batchedCommandResponse.isValid(&errMsg)) {
+            responseStatus = {ErrorCodes::FailedToParse, errMsg};
+        }
+    }
+
+    if (!responseStatus.isOK()) {
+        // Error occurred dispatching, note it
+        const Status status = responseStatus.withContext(
+            str::stream() << "Write results unavailable from " << shardHost);
+
+        batchOp.noteBatchError(batch, errorFromStatus(status));
+
+        LOG(4) << "Unable to receive write results from " << shardHost << causedBy(redact(status));
+        return false;
+    }
+
+    TrackedErrors trackedErrors;
+    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
+    trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
+
+    LOG(4) << "Write results received from " << shardHost.toString() << ": "
+           << redact(batchedCommandResponse.toString());
+
+    // Dispatch was ok, note response
+    batchOp.noteBatchResponse(batch, batchedCommandResponse, &trackedErrors);
+
+    // Note if anything was stale
+    const auto& staleErrors = trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+    if (!staleErrors.empty()) {
+        noteStaleResponses(staleErrors, &targeter);
+        ++stats->numStaleBatches;
+    }
+
+    const auto& cannotImplicitlyCreateErrors =
+        trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
+    if (!cannotImplicitlyCreateErrors.empty()) {
+        // This forces the chunk manager to reload so we can attach the correct version on retry
+        // and make sure we route to the correct shard.
+        targeter.noteCouldNotTarget();
+    }
+
+    // Remember that we successfully wrote to this shard
+    // NOTE: This will record lastOps for shards where we actually didn't update or delete any
+    // documents, which preserves old behavior but is conservative
+    stats->noteWriteAt(shardHost,
+                       batchedCommandResponse.isLastOpSet() ? batchedCommandResponse.getLastOp()
+                                                            : repl::OpTime(),
+                       batchedCommandResponse.isElectionIdSet()
+                           ? batchedCommandResponse.getElectionId()
+                           : OID());
+
+    return !staleErrors.empty() || !cannotImplicitlyCreateErrors.empty();
+}
+
+/**
+ * Executes an unordered batch write by keeping up to maxInFlightWriteBatchesPerShard child batches
+ * outstanding against every shard. Rather than waiting for a whole round of child batches before
+ * targeting the next one, a further round is targeted as soon as no shard has reached its limit,
+ * and writes which hit a stale shard version are retargeted as soon as their child batch returns.
+ *
+ * Returns once 'batchOp' is finished.
+ */
+void executeUnorderedBatchPipelined(OperationContext* opCtx,
+                                    NSTargeter& targeter,
+                                    const BatchedCommandRequest& clientRequest,
+                                    BatchWriteOp& batchOp,
+                                    BatchWriteExecStats* stats) {
+    const int maxInFlightPerShard = maxInFlightWriteBatchesPerShard.load();
+
+    struct InFlightBatch {
+        std::unique_ptr<TargetedWriteBatch> batch;
+        Timer timer;
+    };
+
+    // The child batches which have been sent, keyed by the index of their request in 'ars'.
+    std::map<size_t, InFlightBatch> inFlightBatches;
+    std::map<ShardId, int> numInFlightByShard;
+    size_t numRequestsSent = 0;
+
+    AsyncRequestsSender ars(opCtx,
+                            Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(),
+                            clientRequest.getTargetingNS().db().toString(),
+                            {},
+                            kPrimaryOnlyReadPreference,
+                            opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
+                                                  : Shard::RetryPolicy::kNoRetry);
+
+    bool refreshedTargeter = false;
+    int numCompletedOps = 0;
+    int numRoundsWithoutProgress = 0;
+
+    // Set once the remaining writes should fail with this error rather than be sent. Because the
+    // batch can only be aborted once none of its writes are pending, this waits for the responses
+    // to all in-flight child batches first.
+    boost::optional<WriteErrorDetail> abortError;
+
+    // Refreshes the targeter and checks that progress is being made towards completing the batch.
+    auto refreshTargeter = [&] {
+        bool targeterChanged = false;
+        Status refreshStatus = targeter.refreshIfNeeded(opCtx, &targeterChanged);
+        if (!refreshStatus.isOK()) {
+            // It's okay if we can't refresh, we'll just record errors for the ops if needed.
+            warning() << "could not refresh targeter" << causedBy(refreshStatus.reason());
+        }
+
+        int currCompletedOps = batchOp.numWriteOpsIn(WriteOpState_Completed);
+        if (currCompletedOps == numCompletedOps && !targeterChanged) {
+            ++numRoundsWithoutProgress;
+        } else {
+            numRoundsWithoutProgress = 0;
+        }
+        numCompletedOps = currCompletedOps;
+
+        if (numRoundsWithoutProgress > kMaxRoundsWithoutProgress && !abortError) {
+            abortError = errorFromStatus(
+                {ErrorCodes::NoProgressMade,
+                 str::stream() << "no progress was made executing batch write op in "
+                               << clientRequest.getNS().ns()
+                               << " after "
+                               << kMaxRoundsWithoutProgress
+                               << " rounds ("
+                               << numCompletedOps
+                               << " ops completed in "
+                               << stats->numRounds
+                               << " rounds total)"});
+        }
+    };
+
+    while (!batchOp.isFinished()) {
+        if (!abortError) {
+            const Status interruptStatus = opCtx->checkForInterruptNoAssert();
+            if (!interruptStatus.isOK()) {
+                abortError = errorFromStatus(interruptStatus);
+            }
+        }
+
+        // Target and send further rounds of child batches for as long as no shard has reached its
+        // limit of in-flight batches.
+        while (!abortError &&
+               std::all_of(numInFlightByShard.begin(),
+                           numInFlightByShard.end(),
+                           [&](const auto& entry) { return entry.second < maxInFlightPerShard; })) {
+            OwnedPointerMap<ShardId, TargetedWriteBatch> childBatchesOwned;
+            std::map<ShardId, TargetedWriteBatch*>& childBatches = childBatchesOwned.mutableMap();
+
+            // If we've already had a targeting error, we've refreshed the metadata once and can
+            // record target errors definitively.
+            Status targetStatus = batchOp.targetBatch(targeter, refreshedTargeter, &childBatches);
+            if (!targetStatus.isOK()) {
+                targeter.noteCouldNotTarget();
+                refreshedTargeter = true;
+                ++stats->numTargetErrors;
+                dassert(childBatches.size() == 0u);
+                refreshTargeter();
+                continue;
+            }
+
+            if (childBatches.empty()) {
+                break;
+            }
+
+            ++stats->numRounds;
+
+            std::vector<AsyncRequestsSender::Request> requests;
+            for (auto& childBatch : childBatches) {
+                const auto& targetShardId = childBatch.first;
+                stats->noteTargetedShard(targetShardId);
+
+                const auto request = buildShardBatchCommand(opCtx, batchOp, *childBatch.second);
+
+                LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
+
+                requests.emplace_back(targetShardId, request);
+                ++numInFlightByShard[targetShardId];
+
+                // The in-flight batch takes over ownership of the child batch.
+                inFlightBatches[numRequestsSent++].batch.reset(childBatch.second);
+                childBatch.second = nullptr;
+            }
+
+            ars.addRequests(requests);
+        }
+
+        if (inFlightBatches.empty()) {
+            if (abortError) {
+                batchOp.abortBatch(*abortError);
+                break;
+            }
+
+            // Nothing could be targeted, so wait for the targeter to make progress.
+            refreshTargeter();
+            continue;
+        }
+
+        // Block until a response is available.
+        auto response = ars.next();
+
+        auto it = inFlightBatches.find(response.requestIndex);
+        invariant(it != inFlightBatches.end());
+        const TargetedWriteBatch& batch = *it->second.batch;
+        const ShardId shardId = batch.getEndpoint().shardName;
+
+        stats->noteShardBatchLatency(shardId, Milliseconds(it->second.timer.millis()));
+        if (--numInFlightByShard[shardId] == 0) {
+            numInFlightByShard.erase(shardId);
+        }
+
+        const bool needsRetargeting =
+            noteShardBatchResponse(targeter, batchOp, batch, std::move(response), stats);
+        inFlightBatches.erase(it);
+
+        // Retarget the writes of this child batch without waiting for the other ones.
+        if (needsRetargeting) {
+            refreshTargeter();
+        }
+    }
+}
+
 }  // namespace
 
 void BatchWriteExec::executeBatch(OperationContext* opCtx,
@@ -93,6 +380,11 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
 
     BatchWriteOp batchOp(opCtx, clientRequest);
 
+    if (!clientRequest.getWriteCommandBase().getOrdered() &&
+        maxInFlightWriteBatchesPerShard.load() > 1) {
+        executeUnorderedBatchPipelined(opCtx, targeter, clientRequest, batchOp, stats);
+    }
+
     // Current batch status
     bool refreshedTargeter = false;
     int rounds = 0;
@@ -173,25 +465,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
 
                 stats->noteTargetedShard(targetShardId);
 
-                const auto request = [&] {
-                    const auto shardBatchRequest(batchOp.buildBatchRequest(*nextBatch));
-
-                    BSONObjBuilder requestBuilder;
-                    shardBatchRequest.serialize(&requestBuilder);
-
-                    {
-                        OperationSessionInfo sessionInfo;
-
-                        if (opCtx->getLogicalSessionId()) {
-                            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
-                        }
-
-                        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
-                        sessionInfo.serialize(&requestBuilder);
-                    }
-
-                    return requestBuilder.obj();
-                }();
+                const auto request = buildShardBatchCommand(opCtx, batchOp, *nextBatch);
 
                 LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
 
@@ -227,88 +501,7 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
                 dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
                 TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
 
-                // First check if we were able to target a shard host.
-                if (!response.shardHostAndPort) {
-                    invariant(!response.swResponse.isOK());
-
-                    // Record a resolve failure
-                    batchOp.noteBatchError(*batch,
-                                           errorFromStatus(response.swResponse.getStatus()));
-
-                    // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
-                    // and retarget the batch
-                    LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
-                           << causedBy(response.swResponse.getStatus());
-
-                    // We're done with this batch. Clean up when we can't resolve a host.
-                    auto it = childBatches.find(batch->getEndpoint().shardName);
-                    invariant(it != childBatches.end());
-                    delete it->second;
-                    it->second = nullptr;
-                    continue;
-                }
-
-                const auto shardHost(std::move(*response.shardHostAndPort));
-
-                // Then check if we successfully got a response.
-                Status responseStatus = response.swResponse.getStatus();
-                BatchedCommandResponse batchedCommandResponse;
-                if (responseStatus.isOK()) {
-                    std::string errMsg;
-                    if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
-                                                          &errMsg) ||
-                        !batchedCommandResponse.isValid(&errMsg)) {
-                        responseStatus = {ErrorCodes::FailedToParse, errMsg};
-                    }
-                }
-
-                if (responseStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
-                    trackedErrors.startTracking(ErrorCodes::CannotImplicitlyCreateCollection);
-
-                    LOG(4) << "Write results received from " << shardHost.toString() << ": "
-                           << redact(batchedCommandResponse.toString());
-
-                    // Dispatch was ok, note response
-                    batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
-
-                    // Note if anything was stale
-                    const auto& staleErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
-                    if (!staleErrors.empty()) {
-                        noteStaleResponses(staleErrors, &targeter);
-                        ++stats->numStaleBatches;
-                    }
-
-                    const auto& cannotImplicitlyCreateErrors =
-                        trackedErrors.getErrors(ErrorCodes::CannotImplicitlyCreateCollection);
-                    if (!cannotImplicitlyCreateErrors.empty()) {
-                        // This forces the chunk manager to reload so we can attach the correct
-                        // version on retry and make sure we route to the correct shard.
-                        targeter.noteCouldNotTarget();
-                    }
-
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    stats->noteWriteAt(shardHost,
-                                       batchedCommandResponse.isLastOpSet()
-                                           ? batchedCommandResponse.getLastOp()
-                                           : repl::OpTime(),
-                                       batchedCommandResponse.isElectionIdSet()
-                                           ? batchedCommandResponse.getElectionId()
-                                           : OID());
-                } else {
-                    // Error occurred dispatching, note it
-                    const Status status = responseStatus.withContext(
-                        str::stream() << "Write results unavailable from " << shardHost);
-
-                    batchOp.noteBatchError(*batch, errorFromStatus(status));
-
-                    LOG(4) << "Unable to receive write results from " << shardHost
-                           << causedBy(redact(status));
-                }
+                noteShardBatchResponse(targeter, batchOp, *batch, std::move(response), stats);
             }
         }
 
@@ -383,6 +576,13 @@ void BatchWriteExecStats::noteWriteAt(const HostAndPort& host,
     _writeOpTimes[ConnectionString(host)] = HostOpTime(opTime, electionId);
 }
 
+void BatchWriteExecStats::noteShardBatchLatency(const ShardId& shardId, Milliseconds latency) {
+    auto& shardLatency = _shardLatencies[shardId];
+    ++shardLatency.numBatches;
+    shardLatency.totalLatency += latency;
+    shardLatency.maxLatency = std::max(shardLatency.maxLatency, latency);
+}
+
 const std::set<ShardId>& BatchWriteExecStats::getTargetedShards() const {
     return _targetedShards;
 }
@@ -391,4 +591,23 @@ const HostOpTimeMap& BatchWriteExecStats::getWriteOpTimes() const {
     return _writeOpTimes;
 }
 
+const std::map<ShardId, BatchWriteExecStats::ShardLatency>&
+BatchWriteExecStats::getShardLatencies() const {
+    return _shardLatencies;
+}
+
+void BatchWriteExecStats::appendShardLatencies(BSONObjBuilder* builder) const {
+    if (_shardLatencies.empty()) {
+        return;
+    }
+
+    BSONObjBuilder latenciesBuilder(builder->subobjStart("shardLatencies"));
+    for (const auto& entry : _shardLatencies) {
+        BSONObjBuilder shardBuilder(latenciesBuilder.subobjStart(entry.first.toString()));
+        shardBuilder.append("batches", entry.second.numBatches);
+        shardBuilder.append("totalMillis", durationCount<Milliseconds>(entry.second.totalLatency));
+        shardBuilder.append("maxMillis", durationCount<Milliseconds>(entry.second.maxLatency));
+    }
+}
+
 }  // namespace
@@ -34,6 +34,7 @@
 #include "mongo/bson/timestamp.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/db/repl/optime.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/ns_targeter.h"
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/s/write_ops/batched_command_response.h"
@@ -41,8 +42,14 @@
 namespace mongo {
 
 class BatchWriteExecStats;
+class BSONObjBuilder;
 class OperationContext;
 
+// The number of child batches of an unordered write which may be outstanding against a single
+// shard at any time. The default of 1 sends child batches in rounds, waiting for the responses to
+// a whole round before targeting the next one.
+extern AtomicInt32 maxInFlightWriteBatchesPerShard;
+
 /**
  * The BatchWriteExec is able to execute client batch write requests, resulting in a batch
  * response to send back to the client.
@@ -87,11 +94,28 @@ public:
     BatchWriteExecStats()
         : numRounds(0), numTargetErrors(0), numResolveErrors(0), numStaleBatches(0) {}
 
+    /**
+     * The time it took for the child batches sent to a shard to return.
+     */
+    struct ShardLatency {
+        long long numBatches = 0;
+        Milliseconds totalLatency{0};
+        Milliseconds maxLatency{0};
+    };
+
     void noteWriteAt(const HostAndPort& host, repl::OpTime opTime, const OID& electionId);
     void noteTargetedShard(const ShardId& shardId);
+    void noteShardBatchLatency(const ShardId& shardId, Milliseconds latency);
 
     const std::set<ShardId>& getTargetedShards() const;
     const HostOpTimeMap& getWriteOpTimes() const;
+    const std::map<ShardId, ShardLatency>& getShardLatencies() const;
+
+    /**
+     * Appends a 'shardLatencies' sub-document with the per-shard child batch latencies, if any
+     * were recorded.
+     */
+    void appendShardLatencies(BSONObjBuilder* builder) const;
 
     // Expose via helpers if this gets more complex
 
@@ -107,6 +131,9 @@ public:
 private:
     std::set<ShardId> _targetedShards;
     HostOpTimeMap _writeOpTimes;
+
+    // Only recorded for unordered writes whose child batches are pipelined.
+    std::map<ShardId, ShardLatency> _shardLatencies;
 };
 
 }  // namespace mongo
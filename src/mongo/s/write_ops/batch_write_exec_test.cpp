@@ -41,6 +41,7 @@
 #include "mongo/s/write_ops/mock_ns_targeter.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -412,6 +413,95 @@ TEST_F(BatchWriteExecTest, TooManyStaleOp) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(BatchWriteExecTest, PipelinedUnorderedRetargetsStaleBatchWithoutWaitingForOthers) {
+    const auto oldMaxInFlight = maxInFlightWriteBatchesPerShard.load();
+    maxInFlightWriteBatchesPerShard.store(2);
+    ON_BLOCK_EXIT([&] { maxInFlightWriteBatchesPerShard.store(oldMaxInFlight); });
+
+    const int kNumDocsToInsert = 100'000;
+    const std::string kDocValue(200, 'x');
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+        ASSERT_EQUALS(stats.numStaleBatches, 1);
+        ASSERT_EQUALS(stats.numRounds, 3);
+
+        const auto& shardLatencies = stats.getShardLatencies();
+        ASSERT_EQUALS(shardLatencies.size(), 1u);
+        ASSERT_EQUALS(shardLatencies.begin()->first, ShardId(shardName));
+        ASSERT_EQUALS(shardLatencies.begin()->second.numBatches, 3LL);
+    });
+
+    // Both child batches are sent before the first one returns, so the stale first batch is resent
+    // after the second one rather than before it.
+    const std::vector<BSONObj> firstBatch(docsToInsert.begin(), docsToInsert.begin() + 66576);
+    expectInsertsReturnStaleVersionErrors(firstBatch);
+    expectInsertsReturnSuccess(docsToInsert.begin() + 66576, docsToInsert.end());
+    expectInsertsReturnSuccess(firstBatch);
+
+    future.timed_get(kFutureTimeout);
+}
+
+TEST_F(BatchWriteExecTest, PipelinedUnorderedTooManyStaleOp) {
+    const auto oldMaxInFlight = maxInFlightWriteBatchesPerShard.load();
+    maxInFlightWriteBatchesPerShard.store(2);
+    ON_BLOCK_EXIT([&] { maxInFlightWriteBatchesPerShard.store(oldMaxInFlight); });
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments({BSON("x" << 1), BSON("x" << 2)});
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+        ASSERT(response.getOk());
+        ASSERT_EQ(0, response.getN());
+        ASSERT(response.isErrDetailsSet());
+        ASSERT_EQUALS(response.getErrDetailsAt(0)->toStatus().code(), ErrorCodes::NoProgressMade);
+        ASSERT_EQUALS(response.getErrDetailsAt(1)->toStatus().code(), ErrorCodes::NoProgressMade);
+
+        ASSERT_EQUALS(stats.numStaleBatches, (1 + kMaxRoundsWithoutProgress));
+    });
+
+    for (int i = 0; i < (1 + kMaxRoundsWithoutProgress); i++) {
+        expectInsertsReturnStaleVersionErrors({BSON("x" << 1), BSON("x" << 2)});
+    }
+
+    future.timed_get(kFutureTimeout);
+}
+
 TEST_F(BatchWriteExecTest, RetryableWritesLargeBatch) {
     // A retryable error without a txnNumber is not retried.
 
@@ -267,9 +267,11 @@ DbResponse ServiceEntryPointBridge::handleRequest(OperationContext* opCtx, const
     if (dest.inExhaust()) {
         DbMessage dbm(request);
 
+        // Decompress with the manager of the connection to 'dest', since compressors may keep
+        // state across the messages of a connection.
         auto response = uassertStatusOK(dest->sourceMessage());
         if (response.operation() == dbCompressed) {
-            MessageCompressorManager compressorMgr;
+            auto& compressorMgr = MessageCompressorManager::forSession(dest.getSession());
             response = uassertStatusOK(compressorMgr.decompressMessage(response));
         }
 
@@ -33,6 +33,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
 
+#include <memory>
 #include <type_traits>
 
 namespace mongo {
@@ -40,6 +41,7 @@ enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
+    kZlibStream = 3,
     kExtended = 255,
 };
 
@@ -66,6 +68,16 @@ public:
         return _id;
     }
 
+    /*
+     * Compressors that keep state from one message to the next, such as a streaming compression
+     * context, return a new instance here for each connection, and the MessageCompressorManager
+     * of the connection compresses and decompresses through that instance only. Its counters
+     * are those of the registered compressor. Stateless compressors return nullptr.
+     */
+    virtual std::unique_ptr<MessageCompressorBase> makeSessionInstance() {
+        return nullptr;
+    }
+
     /*
      * This returns the maximum output size of a call to compressData. It is used
      * by the MessageCompressorManager to determine how big a buffer to allocate.
@@ -114,6 +126,30 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the number of microseconds spent in compressData
+     */
+    int64_t getCompressorMicros() const {
+        return _compressMicros.loadRelaxed();
+    }
+
+    /*
+     * This returns the number of microseconds spent in decompressData
+     */
+    int64_t getDecompressorMicros() const {
+        return _decompressMicros.loadRelaxed();
+    }
+
+    /*
+     * Called by the MessageCompressorManager to bump the time spent compressing and decompressing
+     */
+    void counterHitCompressTime(int64_t micros) {
+        _statsOwner->_compressMicros.addAndFetch(micros);
+    }
+
+    void counterHitDecompressTime(int64_t micros) {
+        _statsOwner->_decompressMicros.addAndFetch(micros);
+    }
 
 protected:
     /*
@@ -121,32 +157,47 @@ protected:
      */
     MessageCompressorBase(MessageCompressor id)
         : _id{static_cast<MessageCompressorId>(id)},
-          _name{getMessageCompressorName(id).toString()} {}
+          _name{getMessageCompressorName(id).toString()},
+          _statsOwner{this} {}
+
+    /*
+     * This is called by sub-classes to construct a per-connection instance of the registered
+     * compressor 'registered' (see makeSessionInstance()).
+     */
+    explicit MessageCompressorBase(MessageCompressorBase* registered)
+        : _id{registered->_id}, _name{registered->_name}, _statsOwner{registered} {}
 
     /*
      * Called by sub-classes to bump their bytesIn/bytesOut counters for compression
      */
     void counterHitCompress(int64_t bytesIn, int64_t bytesOut) {
-        _compressBytesIn.addAndFetch(bytesIn);
-        _compressBytesOut.addAndFetch(bytesOut);
+        _statsOwner->_compressBytesIn.addAndFetch(bytesIn);
+        _statsOwner->_compressBytesOut.addAndFetch(bytesOut);
     }
 
     /*
      * Called by sub-classes to bump their bytesIn/bytesOut counters for decompression
      */
     void counterHitDecompress(int64_t bytesIn, int64_t bytesOut) {
-        _decompressBytesIn.addAndFetch(bytesIn);
-        _decompressBytesOut.addAndFetch(bytesOut);
+        _statsOwner->_decompressBytesIn.addAndFetch(bytesIn);
+        _statsOwner->_decompressBytesOut.addAndFetch(bytesOut);
     }
 
 private:
     const MessageCompressorId _id;
     const std::string _name;
 
+    // The compressor whose counters this one bumps: itself, unless it's a per-connection
+    // instance.
+    MessageCompressorBase* const _statsOwner;
+
     AtomicInt64 _compressBytesIn;
     AtomicInt64 _compressBytesOut;
 
     AtomicInt64 _decompressBytesIn;
     AtomicInt64 _decompressBytesOut;
+
+    AtomicInt64 _compressMicros;
+    AtomicInt64 _decompressMicros;
 };
 }  // namespace mongo
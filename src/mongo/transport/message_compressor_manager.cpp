@@ -40,6 +40,7 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -103,8 +104,10 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     }
 
     LOG(3) << "Compressing message with " << compressor->getName();
+    compressor = _forThisSession(compressor);
 
-    auto inputHeader = msg.header();
+    // Any buffers spliced into the message have to be copied in before it can be compressed.
+    auto inputHeader = msg.singleData();
     size_t bufferSize = compressor->getMaxCompressedSize(msg.dataSize()) +
         CompressionHeader::size() + MsgData::MsgDataHeaderSize;
 
@@ -129,7 +132,9 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
+    Timer timer;
     auto sws = compressor->compressData(input, output);
+    compressor->counterHitCompressTime(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -160,6 +165,7 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
     }
 
     LOG(3) << "Decompressing message with " << compressor->getName();
+    compressor = _forThisSession(compressor);
 
     size_t bufferSize = compressionHeader.uncompressedSize + MsgData::MsgDataHeaderSize;
     if (bufferSize > MaxMessageSizeBytes) {
@@ -176,7 +182,9 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
+    Timer timer;
     auto sws = compressor->decompressData(input, output);
+    compressor->counterHitDecompressTime(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -194,7 +202,10 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
     LOG(3) << "Starting client-side compression negotiation";
 
     // We're about to update the compressor list with the negotiation result from the server.
+    // Negotiation starts a new compressed stream, often on a new connection, so drop any state
+    // the compressors kept from the previous one.
     _negotiated.clear();
+    _sessionInstances.clear();
 
     auto& compressorList = _registry->getCompressorNames();
     if (compressorList.size() == 0)
@@ -256,8 +267,10 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
     }
 
     // If compression has already been negotiated, then this is a renegotiation, so we should
-    // reset the state of the manager.
+    // reset the state of the manager. The client drops its compressors' stream state when it
+    // begins negotiating, so drop ours too.
     _negotiated.clear();
+    _sessionInstances.clear();
 
     // First we go through all the compressor names that the client has requested support for
     BSONObj theirObj = elem.Obj();
@@ -293,6 +306,22 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
     }
 }
 
+MessageCompressorBase* MessageCompressorManager::_forThisSession(
+    MessageCompressorBase* compressor) {
+    for (auto&& instance : _sessionInstances) {
+        if (instance->getId() == compressor->getId()) {
+            return instance.get();
+        }
+    }
+
+    auto instance = compressor->makeSessionInstance();
+    if (!instance) {
+        return compressor;
+    }
+    _sessionInstances.push_back(std::move(instance));
+    return _sessionInstances.back().get();
+}
+
 MessageCompressorManager& MessageCompressorManager::forSession(
     const transport::SessionHandle& session) {
     return getForSession(session.get());
@@ -33,6 +33,7 @@
 #include "mongo/transport/message_compressor_base.h"
 #include "mongo/transport/session.h"
 
+#include <memory>
 #include <vector>
 
 namespace mongo {
@@ -64,6 +65,9 @@ public:
      * Called by a client constructing an isMaster request. This function will append the result
      * of _registry->getCompressorNames() to the BSONObjBuilder as a BSON array. If no compressors
      * are configured, it won't append anything.
+     *
+     * This resets the state that compressors keep across messages, so it must be called again
+     * whenever the client reconnects, even if it reuses this manager.
      */
     void clientBegin(BSONObjBuilder* output);
 
@@ -99,6 +103,10 @@ public:
      * it will return a ref-count bumped copy of the input message.
      *
      * If an error occurs in the compressor, it will return a Status error.
+     *
+     * Compressors that keep state across messages (see MessageCompressorBase::makeSessionInstance)
+     * rely on messages being compressed and decompressed in the order they're sent, so neither
+     * this nor decompressMessage may be called concurrently.
      */
     StatusWith<Message> compressMessage(const Message& msg,
                                         const MessageCompressorId* compressorId = nullptr);
@@ -126,8 +134,17 @@ public:
     static MessageCompressorManager& forSession(const transport::SessionHandle& session);
 
 private:
+    /*
+     * Returns the instance of 'compressor' to use on this connection, making it if needed.
+     */
+    MessageCompressorBase* _forThisSession(MessageCompressorBase* compressor);
+
     std::vector<MessageCompressorBase*> _negotiated;
     MessageCompressorRegistry* _registry;
+
+    // Per-connection instances of the compressors that keep state across messages. Both sides
+    // drop them when compression is negotiated, which starts their streams afresh.
+    std::vector<std::unique_ptr<MessageCompressorBase>> _sessionInstances;
 };
 
 }  // namespace mongo
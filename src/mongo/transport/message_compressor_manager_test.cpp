@@ -166,8 +166,7 @@ void checkOverflow(std::unique_ptr<MessageCompressorBase> compressor) {
         compressor->decompressData(tooSmallRange, DataRange(scratch.data(), scratch.size())));
 }
 
-Message buildMessage() {
-    const auto data = std::string{"Hello, world!"};
+Message buildMessage(const std::string& data = "Hello, world!") {
     const auto bufferSize = MsgData::MsgDataHeaderSize + data.size();
     auto buf = SharedBuffer::allocate(bufferSize);
     MsgData::View testView(buf.get());
@@ -233,6 +232,128 @@ TEST(ZlibMessageCompressor, Fidelity) {
     checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>());
 }
 
+TEST(ZlibStreamMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZlibStreamMessageCompressor>());
+}
+
+TEST(ZlibStreamMessageCompressor, CompressesAgainstEarlierMessages) {
+    auto compressor = stdx::make_unique<ZlibStreamMessageCompressor>();
+    const auto compressorName = compressor->getName();
+    const auto compressorId = compressor->getId();
+
+    MessageCompressorRegistry registry;
+    registry.setSupportedCompressors({compressorName});
+    registry.registerImplementation(std::move(compressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    MessageCompressorManager clientManager(&registry);
+    MessageCompressorManager serverManager(&registry);
+
+    BSONObjBuilder clientOutput;
+    clientManager.clientBegin(&clientOutput);
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(clientOutput.done(), &serverOutput);
+    clientManager.clientFinish(serverOutput.done());
+
+    const auto data = std::string{
+        "replSetUpdatePosition optimes durableOpTime appliedOpTime memberId cfgver"};
+    std::vector<int> compressedSizes;
+    for (int i = 0; i < 3; i++) {
+        auto original = buildMessage(data);
+        auto compressed = assertOk(clientManager.compressMessage(original, &compressorId));
+        compressedSizes.push_back(compressed.size());
+
+        MessageCompressorId usedId;
+        auto decompressed = assertOk(serverManager.decompressMessage(compressed, &usedId));
+        ASSERT_EQ(usedId, compressorId);
+        ASSERT_EQ(decompressed.size(), original.size());
+        ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+    }
+
+    // The dictionary shrinks even the first message, and each repeat is a back-reference.
+    ASSERT_LT(compressedSizes[0], buildMessage(data).size());
+    ASSERT_LT(compressedSizes[1], compressedSizes[0]);
+    ASSERT_LTE(compressedSizes[2], compressedSizes[1]);
+
+    // The per-connection instances count against the registered compressor.
+    auto registered = registry.getCompressor(compressorId);
+    ASSERT_EQ(registered->getCompressorBytesIn(), registered->getDecompressorBytesOut());
+    ASSERT_EQ(registered->getCompressorBytesOut(), registered->getDecompressorBytesIn());
+    ASSERT_GT(registered->getCompressorBytesIn(), registered->getCompressorBytesOut());
+}
+
+TEST(ZlibStreamMessageCompressor, RenegotiationStartsNewStream) {
+    auto compressor = stdx::make_unique<ZlibStreamMessageCompressor>();
+    const auto compressorId = compressor->getId();
+
+    MessageCompressorRegistry registry;
+    registry.setSupportedCompressors({compressor->getName()});
+    registry.registerImplementation(std::move(compressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    const auto negotiate = [](MessageCompressorManager* client, MessageCompressorManager* server) {
+        BSONObjBuilder clientOutput;
+        client->clientBegin(&clientOutput);
+        BSONObjBuilder serverOutput;
+        server->serverNegotiate(clientOutput.done(), &serverOutput);
+        client->clientFinish(serverOutput.done());
+    };
+
+    const auto checkRoundTrip = [&](MessageCompressorManager* client,
+                                    MessageCompressorManager* server) {
+        auto original = buildMessage("getMore collection batchSize maxTimeMS");
+        auto compressed = assertOk(client->compressMessage(original, &compressorId));
+        auto decompressed = assertOk(server->decompressMessage(compressed));
+        ASSERT_EQ(decompressed.size(), original.size());
+        ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+    };
+
+    MessageCompressorManager clientManager(&registry);
+    {
+        MessageCompressorManager serverManager(&registry);
+        negotiate(&clientManager, &serverManager);
+        checkRoundTrip(&clientManager, &serverManager);
+        checkRoundTrip(&clientManager, &serverManager);
+
+        // Renegotiating on the same connection restarts both streams.
+        negotiate(&clientManager, &serverManager);
+        checkRoundTrip(&clientManager, &serverManager);
+    }
+
+    // A client that reconnects keeps its manager, but the server's manager for the new connection
+    // is new, so the client's stream must not continue from the old connection.
+    MessageCompressorManager newServerManager(&registry);
+    negotiate(&clientManager, &newServerManager);
+    checkRoundTrip(&clientManager, &newServerManager);
+    checkRoundTrip(&clientManager, &newServerManager);
+}
+
+TEST(ZlibStreamMessageCompressor, FailuresAreSticky) {
+    ZlibStreamMessageCompressor registered;
+    auto sender = registered.makeSessionInstance();
+    auto receiver = registered.makeSessionInstance();
+
+    const auto data = std::string{"find filter batchSize singleBatch"};
+    ConstDataRange input(data.data(), data.size());
+    std::vector<std::vector<char>> compressed;
+    for (int i = 0; i < 2; i++) {
+        std::vector<char> buffer(sender->getMaxCompressedSize(data.size()));
+        DataRange output(buffer.data(), buffer.size());
+        buffer.resize(assertOk(sender->compressData(input, output)));
+        compressed.push_back(std::move(buffer));
+    }
+
+    // Once a message is lost, the receiver's stream no longer matches the sender's, so even the
+    // intact message that follows it is refused.
+    std::vector<char> scratch(data.size());
+    DataRange output(scratch.data(), scratch.size());
+    ASSERT_NOT_OK(receiver->decompressData(
+        ConstDataRange(compressed[0].data(), compressed[0].size() / 2), output));
+    ASSERT_NOT_OK(receiver->decompressData(
+        ConstDataRange(compressed[1].data(), compressed[1].size()), output));
+}
+
 TEST(SnappyMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<SnappyMessageCompressor>());
 }
@@ -35,6 +35,13 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kRatio = "ratio"_sd;
+const auto kTimeMicros = "timeMicros"_sd;
+
+// Uncompressed bytes per compressed byte, or 0 if nothing was compressed.
+double compressionRatio(int64_t uncompressed, int64_t compressed) {
+    return compressed ? static_cast<double>(uncompressed) / compressed : 0;
+}
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -51,12 +58,18 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
 
         BSONObjBuilder compressorSection(base.subobjStart("compressor"));
         compressorSection << kBytesIn << compressor->getCompressorBytesIn() << kBytesOut
-                          << compressor->getCompressorBytesOut();
+                          << compressor->getCompressorBytesOut() << kRatio
+                          << compressionRatio(compressor->getCompressorBytesIn(),
+                                              compressor->getCompressorBytesOut())
+                          << kTimeMicros << compressor->getCompressorMicros();
         compressorSection.doneFast();
 
         BSONObjBuilder decompressorSection(base.subobjStart("decompressor"));
         decompressorSection << kBytesIn << compressor->getDecompressorBytesIn() << kBytesOut
-                            << compressor->getDecompressorBytesOut();
+                            << compressor->getDecompressorBytesOut() << kRatio
+                            << compressionRatio(compressor->getDecompressorBytesOut(),
+                                                compressor->getDecompressorBytesIn())
+                            << kTimeMicros << compressor->getDecompressorMicros();
         decompressorSection.doneFast();
         base.doneFast();
     }
@@ -30,7 +30,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/init.h"
+#include "mongo/base/string_data.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_zlib.h"
@@ -77,6 +79,162 @@ StatusWith<std::size_t> ZlibMessageCompressor::decompressData(ConstDataRange inp
     return {output.length()};
 }
 
+namespace {
+
+// Raw deflate, so that no header or checksum is sent with each message.
+constexpr int kWindowBits = -15;
+constexpr int kMemLevel = 8;
+
+// Room for the empty stored block that the sync flush ends each message with.
+constexpr std::size_t kSyncFlushBound = 16;
+
+// Field names and values common in commands, replies and oplog entries, each as it appears in
+// BSON. The most frequent are last, since they are then nearest to the data. Both ends of a
+// connection must use the same dictionary: changing it needs a new compressor name and id.
+const char kDictionaryChars[] =
+    "$gleStats\0electionId\0$configServerState\0$oplogQueryData\0$replData\0lastOpCommitted\0"
+    "lastOpVisible\0configVersion\0replicaSetId\0primaryIndex\0syncSourceIndex\0"
+    "replSetUpdatePosition\0optimes\0appliedOpTime\0durableOpTime\0memberId\0cfgver\0"
+    "replSetHeartbeat\0isMaster\0ismaster\0ping\0pipeline\0$match\0$project\0$group\0aggregate\0"
+    "projection\0sort\0limit\0skip\0singleBatch\0maxTimeMS\0delete\0deletes\0update\0updates\0"
+    "upsert\0multi\0nModified\0insert\0documents\0ordered\0writeConcern\0wtimeout\0majority\0"
+    "readConcern\0level\0afterClusterTime\0$readPreference\0mode\0primaryPreferred\0secondary\0"
+    "find\0filter\0getMore\0collection\0batchSize\0maxAwaitTimeMS\0term\0"
+    "lastKnownCommittedOpTime\0local\0oplog.rs\0admin\0firstBatch\0nextBatch\0cursor\0ns\0lsid\0"
+    "txnNumber\0autocommit\0stmtId\0prevOpTime\0fromMigrate\0wall\0ui\0o2\0ts\0t\0h\0v\0op\0o\0"
+    "_id\0n\0errmsg\0code\0codeName\0operationTime\0$clusterTime\0clusterTime\0signature\0hash\0"
+    "keyId\0id\0$db\0ok\0";
+const StringData kDictionary(kDictionaryChars, sizeof(kDictionaryChars) - 1);
+
+}  // namespace
+
+class ZlibStreamMessageCompressor::Stream {
+    MONGO_DISALLOW_COPYING(Stream);
+
+public:
+    enum Mode { kDeflate, kInflate };
+
+    explicit Stream(Mode mode) : _mode(mode) {
+        int ret = _mode == kDeflate ? ::deflateInit2(&zs,
+                                                     Z_DEFAULT_COMPRESSION,
+                                                     Z_DEFLATED,
+                                                     kWindowBits,
+                                                     kMemLevel,
+                                                     Z_DEFAULT_STRATEGY)
+                                    : ::inflateInit2(&zs, kWindowBits);
+        if (ret != Z_OK) {
+            status = {ErrorCodes::InternalError, "Could not initialize zlib stream"};
+            return;
+        }
+        _initialized = true;
+
+        auto dictionary = reinterpret_cast<const Bytef*>(kDictionary.rawData());
+        ret = _mode == kDeflate ? ::deflateSetDictionary(&zs, dictionary, kDictionary.size())
+                                : ::inflateSetDictionary(&zs, dictionary, kDictionary.size());
+        if (ret != Z_OK) {
+            status = {ErrorCodes::InternalError, "Could not set zlib stream dictionary"};
+        }
+    }
+
+    ~Stream() {
+        if (!_initialized) {
+            return;
+        }
+        if (_mode == kDeflate) {
+            ::deflateEnd(&zs);
+        } else {
+            ::inflateEnd(&zs);
+        }
+    }
+
+    z_stream zs{};
+
+    // Once a message fails, the stream no longer matches the peer's, so every later one fails too.
+    Status status = Status::OK();
+
+private:
+    const Mode _mode;
+    bool _initialized = false;
+};
+
+ZlibStreamMessageCompressor::ZlibStreamMessageCompressor()
+    : MessageCompressorBase(MessageCompressor::kZlibStream), _isSessionInstance(false) {}
+
+ZlibStreamMessageCompressor::ZlibStreamMessageCompressor(ZlibStreamMessageCompressor* registered)
+    : MessageCompressorBase(registered), _isSessionInstance(true) {}
+
+ZlibStreamMessageCompressor::~ZlibStreamMessageCompressor() = default;
+
+std::unique_ptr<MessageCompressorBase> ZlibStreamMessageCompressor::makeSessionInstance() {
+    invariant(!_isSessionInstance);
+    return std::unique_ptr<MessageCompressorBase>(new ZlibStreamMessageCompressor(this));
+}
+
+std::size_t ZlibStreamMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ::compressBound(inputSize) + kSyncFlushBound;
+}
+
+StatusWith<std::size_t> ZlibStreamMessageCompressor::compressData(ConstDataRange input,
+                                                                  DataRange output) {
+    invariant(_isSessionInstance);
+    if (!_deflate) {
+        _deflate = stdx::make_unique<Stream>(Stream::kDeflate);
+    }
+    if (!_deflate->status.isOK()) {
+        return _deflate->status;
+    }
+    if (input.length() == 0) {
+        return {0};
+    }
+
+    auto& zs = _deflate->zs;
+    zs.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    zs.avail_in = input.length();
+    zs.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    zs.avail_out = output.length();
+
+    // If deflate fills the output, it may be holding back the end of the message.
+    int ret = ::deflate(&zs, Z_SYNC_FLUSH);
+    if (ret != Z_OK || zs.avail_in != 0 || zs.avail_out == 0) {
+        _deflate->status = {ErrorCodes::BadValue, "Could not compress input"};
+        return _deflate->status;
+    }
+
+    size_t outLength = output.length() - zs.avail_out;
+    counterHitCompress(input.length(), outLength);
+    return {outLength};
+}
+
+StatusWith<std::size_t> ZlibStreamMessageCompressor::decompressData(ConstDataRange input,
+                                                                    DataRange output) {
+    invariant(_isSessionInstance);
+    if (!_inflate) {
+        _inflate = stdx::make_unique<Stream>(Stream::kInflate);
+    }
+    if (!_inflate->status.isOK()) {
+        return _inflate->status;
+    }
+    if (input.length() == 0 && output.length() == 0) {
+        return {0};
+    }
+
+    auto& zs = _inflate->zs;
+    zs.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    zs.avail_in = input.length();
+    zs.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    zs.avail_out = output.length();
+
+    // The sender flushed the whole message, and the output is sized to hold exactly all of it, so
+    // anything short of consuming all the input and filling all the output is corruption.
+    int ret = ::inflate(&zs, Z_SYNC_FLUSH);
+    if (ret != Z_OK || zs.avail_in != 0 || zs.avail_out != 0) {
+        _inflate->status = {ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+        return _inflate->status;
+    }
+
+    counterHitDecompress(input.length(), output.length());
+    return {output.length()};
+}
 
 MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
                           ("EndStartupOptionHandling"),
@@ -84,6 +242,7 @@ MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
 (InitializerContext* context) {
     auto& compressorRegistry = MessageCompressorRegistry::get();
     compressorRegistry.registerImplementation(stdx::make_unique<ZlibMessageCompressor>());
+    compressorRegistry.registerImplementation(stdx::make_unique<ZlibStreamMessageCompressor>());
     return Status::OK();
 }
 }  // namespace mongo
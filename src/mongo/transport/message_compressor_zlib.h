@@ -40,5 +40,37 @@ public:
     StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
 };
 
+/*
+ * zlib compression that keeps one deflate stream per connection and direction, so each message
+ * is compressed against the ones sent before it, starting from a preset dictionary of common
+ * command and field names. Each message is ended with a sync flush so the peer can decompress
+ * it as soon as it arrives.
+ *
+ * The registered instance only makes the per-connection instances that do the work.
+ */
+class ZlibStreamMessageCompressor final : public MessageCompressorBase {
+public:
+    ZlibStreamMessageCompressor();
+    ~ZlibStreamMessageCompressor();
+
+    std::unique_ptr<MessageCompressorBase> makeSessionInstance() override;
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+private:
+    class Stream;
+
+    explicit ZlibStreamMessageCompressor(ZlibStreamMessageCompressor* registered);
+
+    const bool _isSessionInstance;
+
+    // Made on first use, since many connections only ever compress in one direction.
+    std::unique_ptr<Stream> _deflate;
+    std::unique_ptr<Stream> _inflate;
+};
 
 }  // namespace mongo
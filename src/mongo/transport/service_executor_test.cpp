@@ -35,6 +35,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
@@ -175,6 +176,21 @@ protected:
     std::unique_ptr<ServiceExecutorSynchronous> executor;
 };
 
+class ServiceExecutorThreadPerCoreFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = ServiceContext::make();
+        setGlobalServiceContext(std::move(scOwned));
+
+        std::vector<ReactorHandle> reactors{std::make_shared<ASIOReactor>(),
+                                            std::make_shared<ASIOReactor>()};
+        executor = stdx::make_unique<ServiceExecutorThreadPerCore>(getGlobalServiceContext(),
+                                                                   std::move(reactors));
+    }
+
+    std::unique_ptr<ServiceExecutorThreadPerCore> executor;
+};
+
 void scheduleBasicTask(ServiceExecutor* exec, bool expectSuccess) {
     stdx::condition_variable cond;
     stdx::mutex mutex;
@@ -216,6 +232,112 @@ TEST_F(ServiceExecutorSynchronousFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorThreadPerCoreFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, IdleWorkerStealsQueuedTasks) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    constexpr int kQueuedTasks = 8;
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool releaseBlocker = false;
+    int queuedTasksRun = 0;
+    bool allScheduled = true;
+
+    // The blocking task queues more tasks behind itself on its own worker. They can only run
+    // before it's released if the other worker steals them.
+    auto blocker = [&] {
+        for (int i = 0; i < kQueuedTasks; ++i) {
+            auto status = executor->schedule(
+                [&] {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    ++queuedTasksRun;
+                    cond.notify_all();
+                },
+                ServiceExecutor::kEmptyFlags,
+                ServiceExecutorTaskName::kSSMProcessMessage);
+            allScheduled = allScheduled && status.isOK();
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return releaseBlocker; });
+    };
+    ASSERT_OK(executor->schedule(std::move(blocker),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMStartSession));
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_TRUE(
+        cond.wait_for(lk, Seconds{10}.toSystemDuration(), [&] { return queuedTasksRun > 0; }));
+    releaseBlocker = true;
+    cond.notify_all();
+    cond.wait(lk, [&] { return queuedTasksRun == kQueuedTasks; });
+    ASSERT_TRUE(allScheduled);
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    auto stats = bob.obj()["serviceExecutorTaskStats"].Obj();
+    ASSERT_EQ(stats["executor"].str(), "threadPerCore");
+    ASSERT_GT(stats["totalStolen"].numberLong(), 0);
+    ASSERT_EQ(stats["workers"].Array().size(), 2U);
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, SpareThreadRunsTasksBehindBlockedTask) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool queuedTaskRun = false;
+    bool blockerDone = false;
+    bool scheduled = false;
+
+    // The blocking task waits on a task it queues behind itself on its own worker, as a write
+    // waiting for replication waits on the updates that arrive on other sessions. Too few tasks are
+    // queued for the other worker to steal them, so only a spare thread can run it.
+    auto blocker = [&] {
+        auto status = executor->schedule(
+            [&] {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                queuedTaskRun = true;
+                cond.notify_all();
+            },
+            ServiceExecutor::kEmptyFlags,
+            ServiceExecutorTaskName::kSSMProcessMessage);
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        scheduled = status.isOK();
+        cond.wait_for(lk, Seconds{10}.toSystemDuration(), [&] { return queuedTaskRun; });
+        blockerDone = true;
+        cond.notify_all();
+    };
+    ASSERT_OK(executor->schedule(std::move(blocker),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMStartSession));
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return blockerDone; });
+        ASSERT_TRUE(scheduled);
+        ASSERT_TRUE(queuedTaskRun);
+    }
+
+    BSONObjBuilder bob;
+    executor->appendStats(&bob);
+    auto stats = bob.obj()["serviceExecutorTaskStats"].Obj();
+    ASSERT_GT(stats["stuckThreadsDetected"].numberLong(), 0);
+}
+
 
 }  // namespace
 }  // namespace mongo
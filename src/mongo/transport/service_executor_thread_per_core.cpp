@@ -0,0 +1,514 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_thread_per_core.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/transport/thread_idle_callback.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// The number of worker threads, and therefore ingress reactors, to run. A negative value runs one
+// worker per available core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(threadPerCoreServiceExecutorWorkers, int, -1);
+
+// Whether each worker thread should be pinned to one of the cores the process may run on.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(threadPerCoreServiceExecutorPinThreads, bool, true);
+
+// When a worker has this many tasks queued, an idle worker is asked to steal half of them. A value
+// of zero or less disables work stealing.
+MONGO_EXPORT_SERVER_PARAMETER(threadPerCoreServiceExecutorStealThreshold, int, 4);
+
+// Tasks scheduled with MayRecurse may be called recursively if the recursion depth is below this
+// value.
+MONGO_EXPORT_SERVER_PARAMETER(threadPerCoreServiceExecutorRecursionLimit, int, 8);
+
+// When every thread running a worker's reactor has been inside a task without any of them
+// completing one for this long, a spare thread is started on that reactor so that its sessions
+// can still make progress.
+MONGO_EXPORT_SERVER_PARAMETER(threadPerCoreServiceExecutorStuckThreadTimeoutMillis, int, 250);
+
+// The most spare threads that may be running across all workers at once.
+MONGO_EXPORT_SERVER_PARAMETER(threadPerCoreServiceExecutorMaxSpareThreads, int, 256);
+
+// Workers check whether the executor is still running each time they return from their reactor.
+// Shutdown stops the reactors, so this only bounds how long a worker can miss that check.
+constexpr Milliseconds kWorkerRunTime{1000};
+
+// Spare threads check whether their worker has another thread free each time they return from the
+// reactor, and exit if so.
+constexpr Milliseconds kSpareThreadRunTime{1000};
+
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "threadPerCore"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kSpareThreadsRunning = "spareThreadsRunning"_sd;
+constexpr auto kStuckDetection = "stuckThreadsDetected"_sd;
+constexpr auto kWorkers = "workers"_sd;
+constexpr auto kCore = "core"_sd;
+constexpr auto kQueueDepth = "queueDepth"_sd;
+constexpr auto kExecuted = "executed"_sd;
+constexpr auto kStolen = "stolen"_sd;
+constexpr auto kStolenFrom = "stolenFrom"_sd;
+constexpr auto kThreads = "threads"_sd;
+
+void pinThreadToCore(int core) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+        warning() << "Failed to pin service executor worker thread to core " << core << ": "
+                  << errnoWithDescription(ret);
+    }
+#endif
+}
+
+}  // namespace
+
+thread_local ServiceExecutorThreadPerCore::ThreadState
+    ServiceExecutorThreadPerCore::_localThreadState;
+
+ServiceExecutorThreadPerCore::ServiceExecutorThreadPerCore(ServiceContext* ctx,
+                                                           std::vector<ReactorHandle> reactors) {
+    invariant(!reactors.empty());
+    for (auto&& reactor : reactors) {
+        _workers.emplace_back(stdx::make_unique<Worker>(std::move(reactor)));
+    }
+}
+
+ServiceExecutorThreadPerCore::~ServiceExecutorThreadPerCore() {
+    invariant(!_isRunning.load());
+}
+
+size_t ServiceExecutorThreadPerCore::configuredWorkerCount() {
+    int value = threadPerCoreServiceExecutorWorkers;
+    if (value < 0) {
+        value = static_cast<int>(ProcessInfo::getNumAvailableCores());
+    }
+    return static_cast<size_t>(std::max(value, 1));
+}
+
+Status ServiceExecutorThreadPerCore::start() {
+    invariant(!_isRunning.load());
+
+#ifdef __linux__
+    if (threadPerCoreServiceExecutorPinThreads) {
+        // Only pin workers to the cores this process is allowed to run on, which may be a subset
+        // of the machine's cores when running under taskset or in a container.
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    _cores.push_back(cpu);
+                }
+            }
+        } else {
+            warning() << "Unable to get the CPU affinity of the process, worker threads will not "
+                         "be pinned: "
+                      << errnoWithDescription();
+        }
+    }
+#endif
+
+    _isRunning.store(true);
+    for (size_t workerId = 0; workerId < _workers.size(); ++workerId) {
+        _numRunningWorkerThreads.addAndFetch(1);
+        _workers[workerId]->threads.addAndFetch(1);
+        Status status =
+            launchServiceWorkerThread([this, workerId] { _workerThreadRoutine(workerId); });
+        if (!status.isOK()) {
+            _workers[workerId]->threads.subtractAndFetch(1);
+            _numRunningWorkerThreads.subtractAndFetch(1);
+            return status;
+        }
+    }
+
+    _numRunningWorkerThreads.addAndFetch(1);
+    Status status = launchServiceWorkerThread([this] { _controllerThreadRoutine(); });
+    if (!status.isOK()) {
+        _numRunningWorkerThreads.subtractAndFetch(1);
+        return status;
+    }
+
+    return Status::OK();
+}
+
+Status ServiceExecutorThreadPerCore::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    LOG(3) << "Shutting down thread-per-core executor";
+
+    _isRunning.store(false);
+    for (auto&& worker : _workers) {
+        worker->reactor->stop();
+    }
+
+    stdx::unique_lock<stdx::mutex> lock(_shutdownMutex);
+    _controllerCondition.notify_all();
+    bool result = _shutdownCondition.wait_for(lock, timeout.toSystemDuration(), [this]() {
+        return _numRunningWorkerThreads.load() == 0;
+    });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "thread-per-core executor couldn't shutdown all worker threads within time "
+                 "limit.");
+}
+
+Status ServiceExecutorThreadPerCore::schedule(Task task,
+                                              ScheduleFlags flags,
+                                              ServiceExecutorTaskName taskName) {
+    if (!_isRunning.load()) {
+        return Status{ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    _totalQueued.addAndFetch(1);
+
+    auto localWorker = _localWorker();
+    if (localWorker) {
+        if ((flags & kMayYieldBeforeSchedule) && (_localThreadState.markIdleCounter++ & 0xf) == 0) {
+            markThreadIdle();
+        }
+
+        // Execute the task directly (recurse) if allowed by the caller and we're already on the
+        // worker that owns the session. Limit the recursion so we don't blow up the stack.
+        if ((flags & kMayRecurse) &&
+            (_localThreadState.recursionDepth <
+             threadPerCoreServiceExecutorRecursionLimit.loadRelaxed())) {
+            _runTask(localWorker, task);
+            return Status::OK();
+        }
+
+        _enqueue(localWorker, std::move(task));
+        return Status::OK();
+    }
+
+    // Tasks scheduled from outside the executor, such as the first task of a new session, are
+    // spread across the workers. Once the session's network callbacks fire on the worker owning
+    // its reactor, everything it schedules after that stays on that worker.
+    auto worker = _workers[_nextWorker.fetchAndAdd(1) % _workers.size()].get();
+    _enqueue(worker, std::move(task));
+    return Status::OK();
+}
+
+ServiceExecutorThreadPerCore::Worker* ServiceExecutorThreadPerCore::_localWorker() const {
+    return _localThreadState.executor == this ? _localThreadState.worker : nullptr;
+}
+
+void ServiceExecutorThreadPerCore::_enqueue(Worker* worker, Task task) {
+    int64_t depth;
+    {
+        stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+        worker->queue.emplace_back(std::move(task));
+        depth = worker->queueDepth.addAndFetch(1);
+    }
+
+    // Every queued task gets exactly one runner posted to the owning worker's reactor. If the task
+    // is stolen before its runner fires, the runner either finds the queue empty or runs the next
+    // task in line a little early, so no task is ever left without a runner.
+    worker->reactor->schedule(Reactor::kPost, [this, worker] { _runQueuedTask(worker); });
+
+    auto stealThreshold = threadPerCoreServiceExecutorStealThreshold.loadRelaxed();
+    if (stealThreshold > 0 && depth >= stealThreshold) {
+        _requestSteal(worker);
+    }
+}
+
+void ServiceExecutorThreadPerCore::_runQueuedTask(Worker* worker) {
+    Task task;
+    {
+        stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+        if (worker->queue.empty()) {
+            return;
+        }
+        task = std::move(worker->queue.front());
+        worker->queue.pop_front();
+        worker->queueDepth.subtractAndFetch(1);
+    }
+
+    _runTask(worker, task);
+}
+
+void ServiceExecutorThreadPerCore::_runTask(Worker* worker, const Task& task) {
+    if (_localThreadState.recursionDepth++ == 0) {
+        worker->busyThreads.addAndFetch(1);
+    }
+    const auto guard = MakeGuard([worker] {
+        if (--_localThreadState.recursionDepth == 0) {
+            worker->busyThreads.subtractAndFetch(1);
+        }
+        worker->executed.addAndFetch(1);
+    });
+
+    task();
+}
+
+void ServiceExecutorThreadPerCore::_requestSteal(Worker* victim) {
+    // Ask the first idle worker that doesn't already have a steal request outstanding. The thief
+    // picks the busiest worker when the request runs, which may not be the one that asked.
+    for (auto&& worker : _workers) {
+        auto thief = worker.get();
+        if (thief == victim || thief->busyThreads.load() > 0 || thief->queueDepth.load() > 0) {
+            continue;
+        }
+
+        if (thief->stealRequested.swap(true)) {
+            continue;
+        }
+
+        thief->reactor->schedule(Reactor::kPost, [this, thief] {
+            thief->stealRequested.store(false);
+            _stealTasks(thief);
+        });
+        return;
+    }
+}
+
+void ServiceExecutorThreadPerCore::_stealTasks(Worker* thief) {
+    auto stealThreshold = threadPerCoreServiceExecutorStealThreshold.loadRelaxed();
+    if (stealThreshold <= 0 || !_isRunning.load()) {
+        return;
+    }
+
+    Worker* victim = nullptr;
+    int64_t victimDepth = stealThreshold - 1;
+    for (auto&& worker : _workers) {
+        auto depth = worker->queueDepth.load();
+        if (worker.get() != thief && depth > victimDepth) {
+            victim = worker.get();
+            victimDepth = depth;
+        }
+    }
+
+    if (!victim) {
+        return;
+    }
+
+    // Take half of the victim's backlog from the back of its queue, leaving the tasks that have
+    // been waiting longest with the worker whose caches they're warm in.
+    std::deque<Task> stolen;
+    {
+        stdx::lock_guard<stdx::mutex> lk(victim->mutex);
+        auto count = std::max<size_t>(victim->queue.size() / 2, 1);
+        while (count-- && !victim->queue.empty()) {
+            stolen.emplace_front(std::move(victim->queue.back()));
+            victim->queue.pop_back();
+        }
+        victim->queueDepth.subtractAndFetch(stolen.size());
+    }
+
+    if (stolen.empty()) {
+        return;
+    }
+
+    victim->stolenFrom.addAndFetch(stolen.size());
+    thief->stolen.addAndFetch(stolen.size());
+    for (auto&& task : stolen) {
+        _enqueue(thief, std::move(task));
+    }
+}
+
+void ServiceExecutorThreadPerCore::_workerThreadRoutine(size_t workerId) {
+    auto worker = _workers[workerId].get();
+    _localThreadState.executor = this;
+    _localThreadState.worker = worker;
+    {
+        std::string threadName = str::stream() << "worker-" << workerId;
+        setThreadName(threadName);
+    }
+
+    if (!_cores.empty()) {
+        auto core = _cores[workerId % _cores.size()];
+        pinThreadToCore(core);
+        log() << "Started thread-per-core worker thread " << workerId << " on core " << core;
+    } else {
+        log() << "Started thread-per-core worker thread " << workerId;
+    }
+
+    while (_isRunning.load()) {
+        worker->reactor->runFor(kWorkerRunTime);
+    }
+
+    _localThreadState = ThreadState{};
+    worker->threads.subtractAndFetch(1);
+    _workerThreadExited();
+}
+
+void ServiceExecutorThreadPerCore::_spareThreadRoutine(size_t workerId) {
+    auto worker = _workers[workerId].get();
+    _localThreadState.executor = this;
+    _localThreadState.worker = worker;
+    {
+        std::string threadName = str::stream() << "worker-" << workerId << "-spare";
+        setThreadName(threadName);
+    }
+
+    LOG(1) << "Started spare thread for thread-per-core worker " << workerId;
+
+    // Keep running the reactor while every other thread on it is busy. The spare isn't pinned,
+    // since it only runs while the threads sharing its reactor are blocked.
+    while (_isRunning.load()) {
+        worker->reactor->runFor(kSpareThreadRunTime);
+        if (worker->busyThreads.load() < worker->threads.load() - 1) {
+            break;
+        }
+    }
+
+    LOG(1) << "Stopping spare thread for thread-per-core worker " << workerId;
+
+    _localThreadState = ThreadState{};
+    worker->threads.subtractAndFetch(1);
+    _numSpareThreads.subtractAndFetch(1);
+    _workerThreadExited();
+}
+
+void ServiceExecutorThreadPerCore::_controllerThreadRoutine() {
+    setThreadName("worker-controller");
+
+    std::vector<int64_t> lastExecuted(_workers.size(), 0);
+    stdx::unique_lock<stdx::mutex> lk(_shutdownMutex);
+    while (_isRunning.load()) {
+        Milliseconds stuckThreadTimeout{
+            std::max(threadPerCoreServiceExecutorStuckThreadTimeoutMillis.load(), 1)};
+        if (_controllerCondition.wait_for(lk, stuckThreadTimeout.toSystemDuration(), [this] {
+                return !_isRunning.load();
+            })) {
+            break;
+        }
+
+        // A worker is stuck if all of the threads running its reactor are inside tasks and none of
+        // them finished a task since the last check. Blocking tasks, such as those waiting for
+        // write concern or in an awaitData getMore, would otherwise keep every other session on
+        // the reactor waiting, including the sessions whose requests they are waiting on.
+        for (size_t workerId = 0; workerId < _workers.size(); ++workerId) {
+            auto worker = _workers[workerId].get();
+            const auto executed = worker->executed.load();
+            const auto busyThreads = worker->busyThreads.load();
+            const bool stuck = busyThreads > 0 && busyThreads >= worker->threads.load() &&
+                executed == lastExecuted[workerId];
+            lastExecuted[workerId] = executed;
+            if (!stuck) {
+                continue;
+            }
+
+            if (_numSpareThreads.load() >= threadPerCoreServiceExecutorMaxSpareThreads.load()) {
+                warning() << "Thread-per-core worker " << workerId << " is stuck, but "
+                          << _numSpareThreads.load() << " spare threads are already running";
+                continue;
+            }
+
+            _stuckThreadsDetected.addAndFetch(1);
+            _numSpareThreads.addAndFetch(1);
+            _numRunningWorkerThreads.addAndFetch(1);
+            worker->threads.addAndFetch(1);
+            Status status =
+                launchServiceWorkerThread([this, workerId] { _spareThreadRoutine(workerId); });
+            if (!status.isOK()) {
+                warning() << "Failed to start a spare thread for stuck thread-per-core worker "
+                          << workerId << ": " << status;
+                worker->threads.subtractAndFetch(1);
+                _numRunningWorkerThreads.subtractAndFetch(1);
+                _numSpareThreads.subtractAndFetch(1);
+            }
+        }
+    }
+
+    if (_numRunningWorkerThreads.subtractAndFetch(1) == 0) {
+        _shutdownCondition.notify_all();
+    }
+}
+
+void ServiceExecutorThreadPerCore::_workerThreadExited() {
+    stdx::lock_guard<stdx::mutex> lk(_shutdownMutex);
+    if (_numRunningWorkerThreads.subtractAndFetch(1) == 0) {
+        _shutdownCondition.notify_all();
+    }
+}
+
+void ServiceExecutorThreadPerCore::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+    section << kExecutorLabel << kExecutorName << kThreadsRunning
+            << static_cast<int>(_numRunningWorkerThreads.load()) << kSpareThreadsRunning
+            << static_cast<int>(_numSpareThreads.load()) << kTotalQueued << _totalQueued.load()
+            << kStuckDetection << _stuckThreadsDetected.load();
+
+    int64_t totalExecuted = 0;
+    int64_t totalStolen = 0;
+    BSONArrayBuilder workers(section.subarrayStart(kWorkers));
+    for (size_t workerId = 0; workerId < _workers.size(); ++workerId) {
+        const auto& worker = _workers[workerId];
+        BSONObjBuilder workerStats(workers.subobjStart());
+        if (!_cores.empty()) {
+            workerStats << kCore << _cores[workerId % _cores.size()];
+        }
+        auto executed = worker->executed.load();
+        auto stolen = worker->stolen.load();
+        workerStats << kThreads << worker->threads.load() << kQueueDepth
+                    << worker->queueDepth.load() << kExecuted << executed << kStolen << stolen
+                    << kStolenFrom << worker->stolenFrom.load();
+        workerStats.doneFast();
+
+        totalExecuted += executed;
+        totalStolen += stolen;
+    }
+    workers.doneFast();
+
+    section << kTotalExecuted << totalExecuted << kTotalStolen << totalStolen;
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
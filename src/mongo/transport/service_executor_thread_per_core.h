@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/transport_layer.h"
+
+namespace mongo {
+namespace transport {
+
+/**
+ * The thread-per-core service executor runs one worker thread per reactor and, where the platform
+ * allows it, pins each worker to its own core. Every accepted session is assigned to one of the
+ * reactors by the TransportLayer, so all of a session's network callbacks and the tasks they
+ * schedule run on the same worker and stay warm in that core's caches.
+ *
+ * Tasks are queued on the scheduling worker's own queue. When a worker falls behind and its queue
+ * reaches the steal threshold, an idle worker is asked to take half of the backlog off the back
+ * of the queue and run it instead.
+ *
+ * Tasks may block, for example while waiting for write concern, for an awaitData getMore or for a
+ * lock, and a session can only make progress on its own worker's reactor. So a controller thread
+ * watches for workers whose threads are all inside tasks without completing any, and starts a
+ * spare thread on such a worker's reactor, which runs until another of its threads is free.
+ */
+class ServiceExecutorThreadPerCore final : public ServiceExecutor {
+public:
+    /**
+     * Each reactor gets its own worker thread, and only that worker ever runs the reactor.
+     */
+    ServiceExecutorThreadPerCore(ServiceContext* ctx, std::vector<ReactorHandle> reactors);
+    ~ServiceExecutorThreadPerCore();
+
+    /**
+     * Returns the number of workers (and therefore ingress reactors) that the executor should be
+     * configured with, based on the threadPerCoreServiceExecutorWorkers server parameter.
+     */
+    static size_t configuredWorkerCount();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags, ServiceExecutorTaskName taskName) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+private:
+    struct Worker {
+        explicit Worker(ReactorHandle reactor) : reactor(std::move(reactor)) {}
+
+        const ReactorHandle reactor;
+
+        stdx::mutex mutex;
+        std::deque<Task> queue;
+
+        AtomicWord<int64_t> queueDepth{0};
+        AtomicWord<int64_t> executed{0};
+        AtomicWord<int64_t> stolen{0};
+        AtomicWord<int64_t> stolenFrom{0};
+
+        // The threads running the worker's reactor, including spare threads, and how many of them
+        // are inside a task. The worker is idle when none of them are.
+        AtomicWord<int> threads{0};
+        AtomicWord<int> busyThreads{0};
+        // Set while a steal request is outstanding on this worker's reactor.
+        AtomicWord<bool> stealRequested{false};
+    };
+
+    struct ThreadState {
+        ServiceExecutorThreadPerCore* executor = nullptr;
+        Worker* worker = nullptr;
+        int recursionDepth = 0;
+        int64_t markIdleCounter = 0;
+    };
+
+    void _workerThreadRoutine(size_t workerId);
+    void _spareThreadRoutine(size_t workerId);
+    void _controllerThreadRoutine();
+    void _workerThreadExited();
+
+    Worker* _localWorker() const;
+    void _enqueue(Worker* worker, Task task);
+    void _runQueuedTask(Worker* worker);
+    void _runTask(Worker* worker, const Task& task);
+    void _requestSteal(Worker* victim);
+    void _stealTasks(Worker* thief);
+
+    static thread_local ThreadState _localThreadState;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<int> _cores;
+
+    AtomicWord<bool> _isRunning{false};
+    AtomicWord<size_t> _nextWorker{0};
+    AtomicWord<int64_t> _totalQueued{0};
+    AtomicWord<int64_t> _stuckThreadsDetected{0};
+    AtomicWord<int> _numSpareThreads{0};
+
+    stdx::mutex _shutdownMutex;
+    stdx::condition_variable _shutdownCondition;
+    stdx::condition_variable _controllerCondition;
+    AtomicWord<size_t> _numRunningWorkerThreads{0};
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/rpc/message.h"
+#include "mongo/rpc/op_msg.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/service_entry_point.h"
@@ -51,6 +52,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/quick_exit.h"
+#include "mongo/util/shared_buffer_pool.h"
 
 namespace mongo {
 namespace {
@@ -87,6 +89,17 @@ bool setExhaustMessage(Message* m, const DbResponse& dbresponse) {
     return true;
 }
 
+// Builds the OP_MSG request to run on the client's behalf for the next batch of an exhaust
+// stream. Its id is that of the reply it follows, so that the next reply is a response to it.
+Message makeExhaustMessage(const BSONObj& nextInvocation, int32_t requestIdToReplyTo) {
+    OpMsgBuilder builder;
+    builder.setBody(nextInvocation);
+    auto message = builder.finish();
+    message.header().setId(requestIdToReplyTo);
+    OpMsg::setFlag(&message, OpMsg::kExhaustSupported);
+    return message;
+}
+
 }  // namespace
 
 using transport::ServiceExecutor;
@@ -359,7 +372,10 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
 
     auto& compressorMgr = MessageCompressorManager::forSession(_session());
 
-    _compressorId = boost::none;
+    // Replies streamed for an exhaust cursor are compressed like the request that started it.
+    if (!_inExhaust) {
+        _compressorId = boost::none;
+    }
     if (_inMessage.operation() == dbCompressed) {
         MessageCompressorId compressorId;
         auto swm = compressorMgr.decompressMessage(_inMessage, &compressorId);
@@ -391,9 +407,17 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         // If this is an exhaust cursor, don't source more Messages
         if (dbresponse.exhaustNS.size() > 0 && setExhaustMessage(&_inMessage, dbresponse)) {
             _inExhaust = true;
+        } else if (dbresponse.shouldRunAgainForExhaust) {
+            // Tell the client that more replies follow without it asking for them, and run the
+            // getMore for the next one as if the client had sent it.
+            invariant(dbresponse.nextInvocation);
+            OpMsg::setFlag(&toSink, OpMsg::kMoreToCome);
+            SharedBufferPool::recycle(_inMessage.releaseBuffer());
+            _inMessage = makeExhaustMessage(*dbresponse.nextInvocation, toSink.header().getId());
+            _inExhaust = true;
         } else {
             _inExhaust = false;
-            _inMessage.reset();
+            SharedBufferPool::recycle(_inMessage.releaseBuffer());
         }
 
         networkCounter.hitLogicalOut(toSink.size());
@@ -407,7 +431,7 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
 
     } else {
         _state.store(State::Source);
-        _inMessage.reset();
+        SharedBufferPool::recycle(_inMessage.releaseBuffer());
         return _scheduleNextWithGuard(std::move(guard),
                                       ServiceExecutor::kDeferredTask,
                                       transport::ServiceExecutorTaskName::kSSMSourceMessage);
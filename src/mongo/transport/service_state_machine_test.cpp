@@ -69,8 +69,13 @@ public:
         _ranHandler = true;
         ASSERT_TRUE(haveClient());
 
+        _lastRequestId = request.header().getId();
         auto req = OpMsgRequest::parse(request);
-        ASSERT_BSONOBJ_EQ(BSON("ping" << 1), req.body);
+        if (OpMsg::isFlagSet(request, OpMsg::kExhaustSupported)) {
+            ASSERT_BSONOBJ_EQ(BSON("getMore" << 1), req.body);
+        } else {
+            ASSERT_BSONOBJ_EQ(BSON("ping" << 1), req.body);
+        }
 
         // Build out a dummy reply
         OpMsgBuilder builder;
@@ -79,7 +84,13 @@ public:
         if (_uassertInHandler)
             uassert(40469, "Synthetic uassert failure", false);
 
-        return DbResponse{builder.finish()};
+        DbResponse response{builder.finish()};
+        if (_exhaustRepliesLeft > 0) {
+            --_exhaustRepliesLeft;
+            response.shouldRunAgainForExhaust = true;
+            response.nextInvocation = BSON("getMore" << 1);
+        }
+        return response;
     }
 
     void endAllSessions(transport::Session::TagMask tags) override {}
@@ -106,9 +117,19 @@ public:
         return ret;
     }
 
+    void setExhaustReplies(int count) {
+        _exhaustRepliesLeft = count;
+    }
+
+    int32_t lastRequestId() const {
+        return _lastRequestId;
+    }
+
 private:
     bool _uassertInHandler = false;
     bool _ranHandler = false;
+    int _exhaustRepliesLeft = 0;
+    int32_t _lastRequestId = 0;
 };
 
 using namespace transport;
@@ -339,6 +360,23 @@ TEST_F(ServiceStateMachineFixture, TestOkaySimpleCommand) {
     checkPingOk();
 }
 
+TEST_F(ServiceStateMachineFixture, OpMsgExhaustStreamsRepliesWithoutSourcing) {
+    _sep->setExhaustReplies(2);
+    runPingTest(State::Process, State::Process);
+
+    // Each reply but the last tells the client more are coming, and the next invocation is run
+    // as a request with the id of the reply it follows.
+    for (auto expected : {State::Process, State::Source}) {
+        auto reply = _tl->getLastSunk();
+        ASSERT_TRUE(OpMsg::isFlagSet(reply, OpMsg::kMoreToCome));
+        _ssm->runNext();
+        ASSERT_EQ(_ssm->state(), expected);
+        ASSERT_EQ(_sep->lastRequestId(), reply.header().getId());
+    }
+
+    ASSERT_FALSE(OpMsg::isFlagSet(_tl->getLastSunk(), OpMsg::kMoreToCome));
+}
+
 TEST_F(ServiceStateMachineFixture, TestThrowHandling) {
     _sep->setUassertInHandler();
 
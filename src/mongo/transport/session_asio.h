@@ -32,12 +32,14 @@
 
 #include "mongo/base/system_error.h"
 #include "mongo/config.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/transport/asio_utils.h"
 #include "mongo/transport/baton.h"
 #include "mongo/transport/transport_layer_asio.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/net/socket_utils.h"
+#include "mongo/util/shared_buffer_pool.h"
 #ifdef MONGO_CONFIG_SSL
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_types.h"
@@ -53,6 +55,12 @@ namespace transport {
 
 MONGO_FAIL_POINT_DEFINE(transportLayerASIOshortOpportunisticReadWrite);
 
+// The number of bytes a session on an unencrypted socket asks the socket for when it begins reading
+// a message. Any message which arrives whole within them is read with a single receive, rather than
+// one for its header and another for its body, and any bytes received past its end are kept for the
+// next message. Zero reads the header and the body of each message separately.
+MONGO_EXPORT_SERVER_PARAMETER(transportLayerASIOReadAheadBytes, int, 4096);
+
 template <typename SuccessValue>
 auto futurize(const std::error_code& ec, SuccessValue&& successValue) {
     using Result = Future<std::decay_t<SuccessValue>>;
@@ -139,23 +147,27 @@ public:
     Status sinkMessage(Message message) override {
         ensureSync();
 
-        return write(asio::buffer(message.buf(), message.size()))
-            .then([this, &message] {
-                if (_isIngressSession) {
-                    networkCounter.hitPhysicalOut(message.size());
-                }
-            })
-            .getNoThrow();
+        auto status = writeMessage(message)
+                          .then([this, &message] {
+                              if (_isIngressSession) {
+                                  networkCounter.hitPhysicalOut(message.size());
+                              }
+                          })
+                          .getNoThrow();
+
+        SharedBufferPool::recycle(message.releaseBuffer());
+        return status;
     }
 
     Future<void> asyncSinkMessage(Message message,
                                   const transport::BatonHandle& baton = nullptr) override {
         ensureAsync();
-        return write(asio::buffer(message.buf(), message.size()), baton)
-            .then([this, message /*keep the buffer alive*/]() {
+        return writeMessage(message, baton)
+            .then([this, message /*keep the buffer alive*/]() mutable {
                 if (_isIngressSession) {
                     networkCounter.hitPhysicalOut(message.size());
                 }
+                SharedBufferPool::recycle(message.releaseBuffer());
             });
     }
 
@@ -344,6 +356,10 @@ private:
     Future<Message> sourceMessageImpl(const transport::BatonHandle& baton = nullptr) {
         static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
 
+        if (canReadAhead()) {
+            return sourceMessageWithReadAhead(baton);
+        }
+
         auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
         auto ptr = headerBuffer.get();
         return read(asio::buffer(ptr, kHeaderSize), baton)
@@ -353,14 +369,9 @@ private:
                 }
 
                 const auto msgLen = size_t(MSGHEADER::View(headerBuffer.get()).getMessageLength());
-                if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
-                    StringBuilder sb;
-                    sb << "recv(): message msgLen " << msgLen << " is invalid. "
-                       << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
-                    const auto str = sb.str();
-                    LOG(0) << str;
-
-                    return Future<Message>::makeReady(Status(ErrorCodes::ProtocolError, str));
+                auto status = checkMessageLength(msgLen);
+                if (!status.isOK()) {
+                    return Future<Message>::makeReady(std::move(status));
                 }
 
                 if (msgLen == kHeaderSize) {
@@ -371,7 +382,7 @@ private:
                     return Future<Message>::makeReady(Message(std::move(headerBuffer)));
                 }
 
-                auto buffer = SharedBuffer::allocate(msgLen);
+                auto buffer = SharedBufferPool::allocate(msgLen);
                 memcpy(buffer.get(), headerBuffer.get(), kHeaderSize);
 
                 MsgData::View msgView(buffer.get());
@@ -385,6 +396,103 @@ private:
             });
     }
 
+    /**
+     * Returns whether the next message may be read together with whatever follows it on the socket,
+     * which requires that the bytes are read from the socket directly rather than through TLS.
+     */
+    bool canReadAhead() const {
+#ifdef MONGO_CONFIG_SSL
+        // The header of the first message on a session must be read on its own, so that it can be
+        // inspected for the beginning of a TLS handshake.
+        if (_sslSocket || !_ranHandshake) {
+            return false;
+        }
+#endif
+        return _readAheadSize > 0 || transportLayerASIOReadAheadBytes.load() > 0;
+    }
+
+    /**
+     * Sources the next message starting with the bytes read past the end of the previous message,
+     * if any, and otherwise with a single receive of up to transportLayerASIOReadAheadBytes. Only
+     * the part of a message which does not arrive with that receive is read separately.
+     */
+    Future<Message> sourceMessageWithReadAhead(const transport::BatonHandle& baton) {
+        static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+        const size_t readAheadBytes = std::max(transportLayerASIOReadAheadBytes.load(), 0);
+        auto buffer =
+            SharedBufferPool::allocate(std::max({kHeaderSize, readAheadBytes, _readAheadSize}));
+        const size_t capacity = buffer.capacity();
+
+        const size_t buffered = _readAheadSize;
+        if (buffered > 0) {
+            memcpy(buffer.get(), _readAhead.get(), buffered);
+            _readAhead = {};
+            _readAheadSize = 0;
+        }
+
+        auto headerReceived = (buffered >= kHeaderSize)
+            ? Future<size_t>::makeReady(0)
+            : opportunisticReadAtLeast(_socket,
+                                       asio::buffer(buffer.get() + buffered, capacity - buffered),
+                                       kHeaderSize - buffered,
+                                       baton);
+
+        return std::move(headerReceived)
+            .then([ this, buffer = std::move(buffer), buffered, baton ](size_t size) mutable {
+                const size_t received = buffered + size;
+                if (checkForHTTPRequest(asio::buffer(buffer.get(), kHeaderSize))) {
+                    return sendHTTPResponse(baton);
+                }
+
+                const auto msgLen = size_t(MSGHEADER::View(buffer.get()).getMessageLength());
+                auto status = checkMessageLength(msgLen);
+                if (!status.isOK()) {
+                    return Future<Message>::makeReady(std::move(status));
+                }
+
+                if (msgLen <= received) {
+                    // The whole message has arrived. Keep whatever follows it for the next one.
+                    if (received > msgLen) {
+                        _readAheadSize = received - msgLen;
+                        _readAhead = SharedBuffer::allocate(_readAheadSize);
+                        memcpy(_readAhead.get(), buffer.get() + msgLen, _readAheadSize);
+                    }
+
+                    if (_isIngressSession) {
+                        networkCounter.hitPhysicalIn(msgLen);
+                    }
+                    return Future<Message>::makeReady(Message(std::move(buffer)));
+                }
+
+                // Read exactly the rest of the message, so that nothing is left over.
+                buffer.realloc(msgLen);
+                auto ptr = buffer.get() + received;
+                return read(asio::buffer(ptr, msgLen - received), baton)
+                    .then([ this, buffer = std::move(buffer), msgLen ]() mutable {
+                        if (_isIngressSession) {
+                            networkCounter.hitPhysicalIn(msgLen);
+                        }
+                        return Message(std::move(buffer));
+                    });
+            });
+    }
+
+    Status checkMessageLength(size_t msgLen) {
+        static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+        if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+            StringBuilder sb;
+            sb << "recv(): message msgLen " << msgLen << " is invalid. "
+               << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+            const auto str = sb.str();
+            LOG(0) << str;
+
+            return Status(ErrorCodes::ProtocolError, str);
+        }
+        return Status::OK();
+    }
+
     template <typename MutableBufferSequence>
     Future<void> read(const MutableBufferSequence& buffers,
                       const transport::BatonHandle& baton = nullptr) {
@@ -411,6 +519,43 @@ private:
         return opportunisticRead(_socket, buffers, baton);
     }
 
+    /**
+     * Writes out 'message', gathering the pieces of a spliced message with a single writev rather
+     * than copying them into one buffer. The message must stay alive until the write completes.
+     */
+    Future<void> writeMessage(const Message& message,
+                              const transport::BatonHandle& baton = nullptr) {
+        if (!message.isSpliced()) {
+            return write(asio::buffer(message.buf(), message.size()), baton);
+        }
+
+        std::vector<asio::const_buffer> buffers;
+        message.forEachSegment(
+            [&](const char* data, size_t size) { buffers.emplace_back(data, size); });
+        return write(buffers, baton);
+    }
+
+    /**
+     * Returns what's left of 'buffers' after the first 'bytes' of them have been written.
+     */
+    static asio::const_buffer advanceBuffers(const asio::const_buffer& buffers, size_t bytes) {
+        return buffers + bytes;
+    }
+
+    static std::vector<asio::const_buffer> advanceBuffers(
+        const std::vector<asio::const_buffer>& buffers, size_t bytes) {
+        std::vector<asio::const_buffer> remaining;
+        for (auto&& buffer : buffers) {
+            if (bytes >= buffer.size()) {
+                bytes -= buffer.size();
+                continue;
+            }
+            remaining.push_back(buffer + bytes);
+            bytes = 0;
+        }
+        return remaining;
+    }
+
     template <typename ConstBufferSequence>
     Future<void> write(const ConstBufferSequence& buffers,
                        const transport::BatonHandle& baton = nullptr) {
@@ -481,6 +626,51 @@ private:
         }
     }
 
+    /**
+     * Like opportunisticRead, but completes as soon as at least 'minBytes' have been read into
+     * 'buffer' rather than when it is full, and returns the number of bytes read.
+     */
+    template <typename Stream>
+    Future<size_t> opportunisticReadAtLeast(Stream& stream,
+                                            asio::mutable_buffer buffer,
+                                            size_t minBytes,
+                                            const transport::BatonHandle& baton = nullptr) {
+        std::error_code ec;
+        size_t size;
+
+        if (MONGO_FAIL_POINT(transportLayerASIOshortOpportunisticReadWrite) &&
+            _blockingMode == Async) {
+            size = asio::read(stream, asio::buffer(buffer, 1), ec);
+            if (!ec && size < minBytes) {
+                ec = asio::error::would_block;
+            }
+        } else {
+            size = asio::read(stream, buffer, asio::transfer_at_least(minBytes), ec);
+        }
+
+        if (((ec == asio::error::would_block) || (ec == asio::error::try_again)) &&
+            (_blockingMode == Async)) {
+            // Continue where the synchronous read left off.
+            const auto asyncBuffer = buffer + size;
+            const auto remaining = minBytes - size;
+            const auto addReadSoFar = [size](size_t asyncSize) { return size + asyncSize; };
+
+            if (baton) {
+                return baton->addSession(*this, Baton::Type::In)
+                    .then([&stream, asyncBuffer, remaining, baton, this] {
+                        return opportunisticReadAtLeast(stream, asyncBuffer, remaining, baton);
+                    })
+                    .then(addReadSoFar);
+            }
+
+            return asio::async_read(
+                       stream, asyncBuffer, asio::transfer_at_least(remaining), UseFuture{})
+                .then(addReadSoFar);
+        } else {
+            return futurize(ec, size);
+        }
+    }
+
     /**
      * moreToSend checks the ssl socket after an opportunisticWrite.  If there are still bytes to
      * send, we manually send them off the underlying socket.  Then we hook that up with a future
@@ -522,14 +712,14 @@ private:
 
         if (MONGO_FAIL_POINT(transportLayerASIOshortOpportunisticReadWrite) &&
             _blockingMode == Async) {
-            asio::const_buffer localBuffer = buffers;
+            asio::const_buffer localBuffer = *asio::buffer_sequence_begin(buffers);
 
-            if (buffers.size()) {
-                localBuffer = asio::const_buffer(buffers.data(), 1);
+            if (localBuffer.size()) {
+                localBuffer = asio::const_buffer(localBuffer.data(), 1);
             }
 
             size = asio::write(stream, localBuffer, ec);
-            if (!ec && buffers.size() > 1) {
+            if (!ec && asio::buffer_size(buffers) > 1) {
                 ec = asio::error::would_block;
             }
         } else {
@@ -542,10 +732,7 @@ private:
             // asio::write is a loop internally, so some of buffers may have been read into already.
             // So we need to adjust the buffers passed into async_write to be offset by size, if
             // size is > 0.
-            ConstBufferSequence asyncBuffers(buffers);
-            if (size > 0) {
-                asyncBuffers += size;
-            }
+            auto asyncBuffers = advanceBuffers(buffers, size);
 
             if (auto more = moreToSend(stream, asyncBuffers, baton)) {
                 return std::move(*more);
@@ -710,6 +897,10 @@ private:
 
     TransportLayerASIO* const _tl;
 
+    // Bytes read past the end of the last message sourced, which begin the next message.
+    SharedBuffer _readAhead;
+    size_t _readAheadSize = 0;
+
 
     bool _isIngressSession;
 };
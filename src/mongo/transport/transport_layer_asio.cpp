@@ -240,6 +240,10 @@ TransportLayerASIO::TransportLayerASIO(const TransportLayerASIO::Options& opts,
 #endif
       _sep(sep),
       _listenerOptions(opts) {
+    _ingressReactors.push_back(_ingressReactor);
+    for (size_t i = 1; i < _listenerOptions.ingressReactors; ++i) {
+        _ingressReactors.push_back(std::make_shared<ASIOReactor>());
+    }
 }
 
 TransportLayerASIO::~TransportLayerASIO() = default;
@@ -828,6 +832,10 @@ ReactorHandle TransportLayerASIO::getReactor(WhichReactor which) {
     MONGO_UNREACHABLE;
 }
 
+std::vector<ReactorHandle> TransportLayerASIO::getIngressReactors() {
+    return std::vector<ReactorHandle>(_ingressReactors.begin(), _ingressReactors.end());
+}
+
 void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
     auto acceptCb = [this, &acceptor](const std::error_code& ec, GenericSocket peerSocket) mutable {
         if (!_running.load())
@@ -851,7 +859,9 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
         _acceptConnection(acceptor);
     };
 
-    acceptor.async_accept(*_ingressReactor, std::move(acceptCb));
+    auto& ingressReactor =
+        _ingressReactors[_nextIngressReactor.fetchAndAdd(1) % _ingressReactors.size()];
+    acceptor.async_accept(*ingressReactor, std::move(acceptCb));
 }
 
 #ifdef MONGO_CONFIG_SSL
@@ -107,6 +107,8 @@ public:
         Mode transportMode = Mode::kSynchronous;  // whether accepted sockets should be put into
                                                   // non-blocking mode after they're accepted
         size_t maxConns = DEFAULT_MAX_CONN;       // maximum number of active connections
+        size_t ingressReactors = 1;               // number of reactors accepted sockets are
+                                                  // spread across
     };
 
     TransportLayerASIO(const Options& opts, ServiceEntryPoint* sep);
@@ -126,6 +128,12 @@ public:
 
     ReactorHandle getReactor(WhichReactor which) final;
 
+    /**
+     * Returns every reactor that accepted sockets are assigned to. The first one is the reactor
+     * returned by getReactor(kIngress).
+     */
+    std::vector<ReactorHandle> getIngressReactors();
+
     Status start() final;
 
     void shutdown() final;
@@ -184,6 +192,11 @@ private:
     std::shared_ptr<ASIOReactor> _egressReactor;
     std::shared_ptr<ASIOReactor> _acceptorReactor;
 
+    // When more than one ingress reactor is configured, accepted sockets are assigned to them in
+    // turn. _ingressReactor is always the first of these.
+    std::vector<std::shared_ptr<ASIOReactor>> _ingressReactors;
+    AtomicWord<size_t> _nextIngressReactor{0};
+
 #ifdef MONGO_CONFIG_SSL
     std::unique_ptr<asio::ssl::context> _ingressSSLContext;
     std::unique_ptr<asio::ssl::context> _egressSSLContext;
@@ -304,6 +304,61 @@ TEST(TransportLayerASIO, SourceSyncTimeoutSucceeds) {
     tla->shutdown();
 }
 
+/* check that messages which arrive together, or which outgrow the read-ahead, are sourced whole */
+class PipelinedMessagesSEP : public TimeoutSEP {
+public:
+    explicit PipelinedMessagesSEP(std::vector<BSONObj> expectedBodies)
+        : _expectedBodies(std::move(expectedBodies)) {}
+
+    void startSession(transport::SessionHandle session) override {
+        log() << "Accepted connection from " << session->remote();
+        stdx::thread([ this, session = std::move(session) ]() mutable {
+            for (const auto& expectedBody : _expectedBodies) {
+                auto swMessage = session->sourceMessage();
+                ASSERT_OK(swMessage.getStatus());
+                ASSERT_BSONOBJ_EQ(OpMsg::parse(swMessage.getValue()).body, expectedBody);
+            }
+
+            session.reset();
+            notifyComplete();
+        }).detach();
+    }
+
+private:
+    const std::vector<BSONObj> _expectedBodies;
+};
+
+TEST(TransportLayerASIO, SourcePipelinedMessages) {
+    const std::vector<BSONObj> bodies{BSON("ping" << 1),
+                                      BSON("ping" << 2 << "padding" << std::string(64 * 1024, 'x')),
+                                      BSON("ping" << 3),
+                                      BSON("ping" << 4)};
+
+    PipelinedMessagesSEP sep(bodies);
+    auto tla = makeAndStartTL(&sep);
+
+    asio::io_context ctx;
+    asio::ip::tcp::socket sock(ctx);
+    std::error_code ec;
+    sock.connect({asio::ip::address_v4::loopback(), tla->listenerPort()}, ec);
+    ASSERT_FALSE(ec);
+
+    // Send all of the messages with a single write, so that they are likely to be received
+    // together.
+    std::string bytes;
+    for (const auto& body : bodies) {
+        auto msg = OpMsg{body}.serialize();
+        msg.header().setResponseToMsgId(0);
+        msg.header().setId(0);
+        bytes.append(msg.buf(), msg.size());
+    }
+    asio::write(sock, asio::buffer(bytes), ec);
+    ASSERT_FALSE(ec);
+
+    ASSERT_TRUE(sep.waitForTimeout(Milliseconds{30000}));
+    tla->shutdown();
+}
+
 /* check that switching from timeouts to no timeouts correctly resets the timeout to unlimited */
 class TimeoutSwitchModesSEP : public TimeoutSEP {
 public:
@@ -36,6 +36,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
 #include "mongo/util/net/ssl_types.h"
@@ -136,6 +137,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         opts.transportMode = transport::Mode::kAsynchronous;
     } else if (config->serviceExecutor == "synchronous") {
         opts.transportMode = transport::Mode::kSynchronous;
+    } else if (config->serviceExecutor == "threadPerCore") {
+        opts.transportMode = transport::Mode::kAsynchronous;
+        opts.ingressReactors = ServiceExecutorThreadPerCore::configuredWorkerCount();
     } else {
         MONGO_UNREACHABLE;
     }
@@ -148,6 +152,10 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
             stdx::make_unique<ServiceExecutorAdaptive>(ctx, std::move(reactor)));
     } else if (config->serviceExecutor == "synchronous") {
         ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorSynchronous>(ctx));
+    } else if (config->serviceExecutor == "threadPerCore") {
+        auto reactors = transportLayerASIO->getIngressReactors();
+        ctx->setServiceExecutor(
+            stdx::make_unique<ServiceExecutorThreadPerCore>(ctx, std::move(reactors)));
     }
     transportLayer = std::move(transportLayerASIO);
 
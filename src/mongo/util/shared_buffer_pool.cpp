@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/shared_buffer_pool.h"
+
+#include <array>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+namespace {
+
+// Size class i holds the buffers with a capacity in [kMinCachedBytes << i, kMinCachedBytes << i+1).
+constexpr size_t kMinCachedBytes = 512;
+constexpr int kNumSizeClasses = 8;
+constexpr int kMaxBuffersPerSizeClass = 2;
+constexpr size_t kMaxCachedBytesPerThread = 256 * 1024;
+
+// Bounds the bytes cached by all threads together, since the thread per connection executor can
+// run many thousands of threads.
+constexpr long long kDefaultMaxCachedBytes = 64 * 1024 * 1024;
+AtomicInt64 maxCachedBytes(kDefaultMaxCachedBytes);
+AtomicInt64 cachedBytes;
+
+// Requests for less than this are served by the allocator, so that small buffers do not pin
+// pooled ones.
+constexpr size_t kMinPooledAllocationBytes = kMinCachedBytes / 2;
+
+AtomicInt64 hits;
+AtomicInt64 misses;
+AtomicInt64 recycled;
+AtomicInt64 discarded;
+
+// Set once the thread's cache has been destroyed, so that buffers released by destructors which
+// run after it during thread exit bypass it.
+thread_local bool threadCacheDestroyed = false;
+
+struct ThreadCache {
+    ~ThreadCache() {
+        threadCacheDestroyed = true;
+        cachedBytes.subtractAndFetch(numBytes);
+    }
+
+    std::array<std::array<SharedBuffer, kMaxBuffersPerSizeClass>, kNumSizeClasses> buffers;
+    std::array<int, kNumSizeClasses> numBuffers{};
+    size_t numBytes = 0;
+};
+
+thread_local ThreadCache threadCache;
+
+/**
+ * Returns the smallest size class whose buffers all have a capacity of at least 'bytes', or
+ * kNumSizeClasses if there is none.
+ */
+int sizeClassToAllocate(size_t bytes) {
+    int sizeClass = 0;
+    while (sizeClass < kNumSizeClasses && (kMinCachedBytes << sizeClass) < bytes) {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+/**
+ * Returns the size class holding buffers with the given capacity, or -1 if they are not cached.
+ */
+int sizeClassToRecycle(size_t capacity) {
+    if (capacity < kMinCachedBytes || capacity >= (kMinCachedBytes << kNumSizeClasses)) {
+        return -1;
+    }
+
+    int sizeClass = 0;
+    while ((kMinCachedBytes << (sizeClass + 1)) <= capacity) {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+}  // namespace
+
+SharedBuffer SharedBufferPool::allocate(size_t bytes) {
+    if (bytes >= kMinPooledAllocationBytes && !threadCacheDestroyed) {
+        auto& cache = threadCache;
+
+        // Look in the size class which fits 'bytes' and in the next one up, so that a buffer is
+        // never more than four times larger than asked for.
+        const int sizeClass = sizeClassToAllocate(bytes);
+        for (int i = sizeClass; i < std::min(sizeClass + 2, kNumSizeClasses); ++i) {
+            if (cache.numBuffers[i] > 0) {
+                auto buffer = std::move(cache.buffers[i][--cache.numBuffers[i]]);
+                cache.numBytes -= buffer.capacity();
+                cachedBytes.subtractAndFetch(buffer.capacity());
+                hits.fetchAndAdd(1);
+                return buffer;
+            }
+        }
+    }
+
+    misses.fetchAndAdd(1);
+    return SharedBuffer::allocate(bytes);
+}
+
+void SharedBufferPool::recycle(SharedBuffer buffer) {
+    if (!buffer) {
+        return;
+    }
+
+    const int sizeClass = sizeClassToRecycle(buffer.capacity());
+    if (buffer.isShared() || sizeClass < 0 || threadCacheDestroyed) {
+        discarded.fetchAndAdd(1);
+        return;
+    }
+
+    auto& cache = threadCache;
+    if (cache.numBuffers[sizeClass] == kMaxBuffersPerSizeClass ||
+        cache.numBytes + buffer.capacity() > kMaxCachedBytesPerThread) {
+        discarded.fetchAndAdd(1);
+        return;
+    }
+
+    // Reserve the bytes from the process-wide budget, and give them back if that overdraws it.
+    const long long capacity = buffer.capacity();
+    if (cachedBytes.addAndFetch(capacity) > maxCachedBytes.load()) {
+        cachedBytes.subtractAndFetch(capacity);
+        discarded.fetchAndAdd(1);
+        return;
+    }
+
+    cache.numBytes += buffer.capacity();
+    cache.buffers[sizeClass][cache.numBuffers[sizeClass]++] = std::move(buffer);
+    recycled.fetchAndAdd(1);
+}
+
+SharedBufferPool::Stats SharedBufferPool::getStats() {
+    return {hits.load(), misses.load(), recycled.load(), discarded.load(), cachedBytes.load()};
+}
+
+void SharedBufferPool::setMaxCachedBytes_forTest(long long bytes) {
+    maxCachedBytes.store(bytes < 0 ? kDefaultMaxCachedBytes : bytes);
+}
+
+}  // namespace mongo
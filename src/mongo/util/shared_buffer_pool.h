@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+
+/**
+ * Per-thread caches of unshared SharedBuffers, grouped into power of two size classes, which let
+ * the buffers of network messages and of the builders of their replies be reused by the next
+ * message handled on the same thread rather than returned to the allocator.
+ *
+ * Only buffers explicitly handed to recycle() are cached. Each thread caches a bounded number of
+ * bytes, which are freed when the thread exits, and the caches of all threads together are bounded
+ * by a process-wide budget.
+ */
+class SharedBufferPool {
+public:
+    /**
+     * Cumulative counts of the pool's activity across all threads.
+     */
+    struct Stats {
+        // Allocations served from, and missed by, the calling thread's cache.
+        long long hits;
+        long long misses;
+
+        // Buffers recycled into a thread's cache, and buffers which could not be because they were
+        // still shared, of an uncached size, or would have overfilled the cache.
+        long long recycled;
+        long long discarded;
+
+        // Bytes currently held by the caches of all threads.
+        long long cachedBytes;
+    };
+
+    /**
+     * Returns an unshared buffer with a capacity of at least 'bytes', which is taken from the
+     * calling thread's cache if it holds one of no more than four times that capacity.
+     */
+    static SharedBuffer allocate(size_t bytes);
+
+    /**
+     * Caches 'buffer' for reuse by the calling thread if it is the only reference to the buffer and
+     * there is room for it. Otherwise simply releases it. Callers should move their reference in.
+     */
+    static void recycle(SharedBuffer buffer);
+
+    static Stats getStats();
+
+    /**
+     * Overrides the process-wide budget of cached bytes, or restores the default if 'bytes' is
+     * negative. Buffers already cached are kept.
+     */
+    static void setMaxCachedBytes_forTest(long long bytes);
+};
+
+}  // namespace mongo
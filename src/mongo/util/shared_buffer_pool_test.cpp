@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/shared_buffer_pool.h"
+
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Runs 'fn' on a new thread, which starts with an empty cache.
+ */
+template <typename Fn>
+void runWithEmptyCache(Fn fn) {
+    stdx::thread thread(fn);
+    thread.join();
+}
+
+TEST(SharedBufferPoolTest, RecycledBufferIsReusedByTheSameThread) {
+    runWithEmptyCache([] {
+        auto buffer = SharedBufferPool::allocate(1000);
+        ASSERT_GTE(buffer.capacity(), 1000U);
+        const char* const data = buffer.get();
+
+        const auto statsBefore = SharedBufferPool::getStats();
+        SharedBufferPool::recycle(std::move(buffer));
+
+        auto reused = SharedBufferPool::allocate(512);
+        ASSERT_EQ(reused.get(), data);
+        ASSERT_FALSE(reused.isShared());
+
+        const auto statsAfter = SharedBufferPool::getStats();
+        ASSERT_EQ(statsAfter.recycled, statsBefore.recycled + 1);
+        ASSERT_EQ(statsAfter.hits, statsBefore.hits + 1);
+    });
+}
+
+TEST(SharedBufferPoolTest, TooSmallBufferIsNotReused) {
+    runWithEmptyCache([] {
+        auto buffer = SharedBufferPool::allocate(600);
+        const char* const data = buffer.get();
+        SharedBufferPool::recycle(std::move(buffer));
+
+        // The recycled buffer may be smaller than asked for, so a new one must be allocated.
+        auto other = SharedBufferPool::allocate(1000);
+        ASSERT_NE(other.get(), data);
+        ASSERT_GTE(other.capacity(), 1000U);
+    });
+}
+
+TEST(SharedBufferPoolTest, MuchLargerBufferIsNotReused) {
+    runWithEmptyCache([] {
+        auto buffer = SharedBufferPool::allocate(16 * 1024);
+        const char* const data = buffer.get();
+        SharedBufferPool::recycle(std::move(buffer));
+
+        auto other = SharedBufferPool::allocate(1024);
+        ASSERT_NE(other.get(), data);
+        ASSERT_EQ(other.capacity(), 1024U);
+    });
+}
+
+TEST(SharedBufferPoolTest, SharedBufferIsNotRecycled) {
+    runWithEmptyCache([] {
+        auto buffer = SharedBufferPool::allocate(1024);
+        auto otherReference = buffer;
+
+        const auto statsBefore = SharedBufferPool::getStats();
+        SharedBufferPool::recycle(std::move(buffer));
+        ASSERT_EQ(SharedBufferPool::getStats().discarded, statsBefore.discarded + 1);
+
+        auto other = SharedBufferPool::allocate(1024);
+        ASSERT_NE(other.get(), otherReference.get());
+    });
+}
+
+TEST(SharedBufferPoolTest, BuffersAreNotSharedBetweenThreads) {
+    runWithEmptyCache([] {
+        auto buffer = SharedBufferPool::allocate(1024);
+        const char* const data = buffer.get();
+        SharedBufferPool::recycle(std::move(buffer));
+
+        runWithEmptyCache([data] {
+            auto other = SharedBufferPool::allocate(1024);
+            ASSERT_NE(other.get(), data);
+        });
+
+        auto reused = SharedBufferPool::allocate(1024);
+        ASSERT_EQ(reused.get(), data);
+    });
+}
+
+TEST(SharedBufferPoolTest, CachesOfAllThreadsShareOneBudget) {
+    const auto cachedBytesBefore = SharedBufferPool::getStats().cachedBytes;
+    SharedBufferPool::setMaxCachedBytes_forTest(cachedBytesBefore + 1024);
+    ON_BLOCK_EXIT([] { SharedBufferPool::setMaxCachedBytes_forTest(-1); });
+
+    runWithEmptyCache([cachedBytesBefore] {
+        SharedBufferPool::recycle(SharedBufferPool::allocate(1024));
+        ASSERT_EQ(SharedBufferPool::getStats().cachedBytes, cachedBytesBefore + 1024);
+
+        // Another thread's cache has room, but the budget is spent.
+        runWithEmptyCache([] {
+            const auto statsBefore = SharedBufferPool::getStats();
+            SharedBufferPool::recycle(SharedBufferPool::allocate(1024));
+            ASSERT_EQ(SharedBufferPool::getStats().discarded, statsBefore.discarded + 1);
+        });
+    });
+
+    // The bytes cached by the exited thread were returned to the budget.
+    ASSERT_EQ(SharedBufferPool::getStats().cachedBytes, cachedBytesBefore);
+}
+
+TEST(SharedBufferPoolTest, SmallAllocationsBypassThePool) {
+    runWithEmptyCache([] {
+        SharedBufferPool::recycle(SharedBufferPool::allocate(512));
+
+        auto small = SharedBufferPool::allocate(16);
+        ASSERT_EQ(small.capacity(), 16U);
+    });
+}
+
+}  // namespace
+}  // namespace mongo